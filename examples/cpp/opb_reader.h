@@ -14,16 +14,16 @@
 #ifndef OR_TOOLS_SAT_OPB_READER_H_
 #define OR_TOOLS_SAT_OPB_READER_H_
 
+#include <string.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "base/integral_types.h"
 #include "base/logging.h"
-#include "base/strtoint.h"
-#include "base/file.h"
-#include "base/split.h"
+#include "base/stringpiece.h"
 #include "sat/boolean_problem.pb.h"
-#include "util/filelineiter.h"
+#include "util/file_contents.h"
 
 namespace operations_research {
 namespace sat {
@@ -31,6 +31,9 @@ namespace sat {
 // This class loads a file in pbo file format into a LinearBooleanProblem.
 // The format is described here:
 //   http://www.cril.univ-artois.fr/PB12/format.pdf
+//
+// The file is memory-mapped (or decompressed in memory if it ends with ".gz")
+// and each line is split in place, without copying its words.
 class OpbReader {
  public:
   OpbReader() {}
@@ -41,13 +44,20 @@ class OpbReader {
     problem->set_name(ExtractProblemName(filename));
 
     num_variables_ = 0;
-    int num_lines = 0;
-    for (const std::string& line : FileLines(filename)) {
-      ++num_lines;
-      ProcessNewLine(problem, line);
+    FileContents contents;
+    if (!contents.Open(filename)) {
+      LOG(FATAL) << "Can't read the file " << contents.error_message();
+    }
+    if (contents.begin() == contents.end()) {
+      LOG(FATAL) << "File '" << filename << "' is empty.";
     }
-    if (num_lines == 0) {
-      LOG(FATAL) << "File '" << filename << "' is empty or can't be read.";
+    const char* const end = contents.end();
+    for (const char* line = contents.begin(); line < end;) {
+      const void* const newline = memchr(line, '\n', end - line);
+      const char* const line_end =
+          newline == nullptr ? end : static_cast<const char*>(newline);
+      ProcessNewLine(problem, line, line_end);
+      line = line_end + 1;
     }
     problem->set_num_variables(num_variables_);
     return true;
@@ -63,60 +73,109 @@ class OpbReader {
     return problem_name;
   }
 
-  void ProcessNewLine(LinearBooleanProblem* problem, const std::string& line) {
-    const std::vector<std::string> words =
-        strings::Split(line, " ", strings::SkipEmpty());
-    if (words.size() == 0 || words[0].empty() || words[0][0] == '*') {
-      return;
+  // The ';' ending each constraint is treated as a separator, so that it can
+  // be attached to the last word or not.
+  static bool IsSeparator(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == ';';
+  }
+
+  // Splits [begin, end) into words_.
+  void SplitLine(const char* begin, const char* end) {
+    words_.clear();
+    const char* c = begin;
+    while (c < end) {
+      while (c < end && IsSeparator(*c)) ++c;
+      const char* const word = c;
+      while (c < end && !IsSeparator(*c)) ++c;
+      if (c > word) words_.push_back(StringPiece(word, c - word));
+    }
+  }
+
+  // Parses an integer like "12", "+3" or "-7". Returns false if the whole
+  // word isn't a valid integer.
+  static bool ParseInteger(StringPiece word, int64* value) {
+    const char* c = word.data();
+    const char* const end = c + word.size();
+    const bool negative = c < end && *c == '-';
+    if (negative || (c < end && *c == '+')) ++c;
+    if (c == end) return false;
+    int64 result = 0;
+    for (; c < end; ++c) {
+      if (*c < '0' || *c > '9') return false;
+      result = 10 * result + (*c - '0');
+    }
+    *value = negative ? -result : result;
+    return true;
+  }
+
+  // Parses a word "x<index>" into the corresponding positive literal. Returns
+  // false if the word isn't a variable.
+  bool ParseVariable(StringPiece word, int* literal) {
+    int64 value;
+    if (word.empty() || word[0] != 'x' ||
+        !ParseInteger(StringPiece(word.data() + 1, word.size() - 1), &value) ||
+        value <= 0) {
+      return false;
     }
+    *literal = value;
+    num_variables_ = std::max(num_variables_, *literal);
+    return true;
+  }
 
-    if (words[0] == "min:") {
+  void ProcessNewLine(LinearBooleanProblem* problem, const char* begin,
+                      const char* end) {
+    SplitLine(begin, end);
+    if (words_.size() == 0 || words_[0][0] == '*') return;
+
+    int literal;
+    int64 value;
+    if (words_[0] == "min:") {
       LinearObjective* objective = problem->mutable_objective();
-      for (int i = 1; i < words.size(); ++i) {
-        const std::string& word = words[i];
-        if (word.empty() || word[0] == ';') continue;
-        if (word[0] == 'x') {
-          const int literal = atoi32(word.substr(1));
-          num_variables_ = std::max(num_variables_, literal);
+      for (int i = 1; i < words_.size(); ++i) {
+        const StringPiece word = words_[i];
+        if (ParseVariable(word, &literal)) {
           objective->add_literals(literal);
+        } else if (ParseInteger(word, &value)) {
+          objective->add_coefficients(value);
         } else {
-          objective->add_coefficients(atoi64(word));
+          LOG(FATAL) << "Failed to parse objective:\n "
+                     << std::string(begin, end);
         }
       }
       if (objective->literals_size() != objective->coefficients_size()) {
-        LOG(INFO) << "words.size() = " << words.size();
-        LOG(FATAL) << "Failed to parse objective:\n " << line;
+        LOG(INFO) << "words.size() = " << words_.size();
+        LOG(FATAL) << "Failed to parse objective:\n "
+                   << std::string(begin, end);
       }
       return;
     }
     LinearBooleanConstraint* constraint = problem->add_constraints();
-    for (int i = 0; i < words.size(); ++i) {
-      const std::string& word = words[i];
-      CHECK(!word.empty());
-      if (word == ">=") {
-        CHECK_LT(i + 1, words.size());
-        constraint->set_lower_bound(atoi64(words[i + 1]));
-        break;
-      } else if (word == "=") {
-        CHECK_LT(i + 1, words.size());
-        constraint->set_upper_bound(atoi64(words[i + 1]));
-        constraint->set_lower_bound(atoi64(words[i + 1]));
+    for (int i = 0; i < words_.size(); ++i) {
+      const StringPiece word = words_[i];
+      if (word == ">=" || word == "=") {
+        CHECK_LT(i + 1, words_.size());
+        CHECK(ParseInteger(words_[i + 1], &value))
+            << "Failed to parse constraint:\n " << std::string(begin, end);
+        if (word == "=") constraint->set_upper_bound(value);
+        constraint->set_lower_bound(value);
         break;
+      } else if (ParseVariable(word, &literal)) {
+        constraint->add_literals(literal);
+      } else if (ParseInteger(word, &value)) {
+        constraint->add_coefficients(value);
       } else {
-        if (word[0] == 'x') {
-          const int literal = atoi32(word.substr(1));
-          num_variables_ = std::max(num_variables_, literal);
-          constraint->add_literals(literal);
-        } else {
-          constraint->add_coefficients(atoi64(word));
-        }
+        LOG(FATAL) << "Failed to parse constraint:\n "
+                   << std::string(begin, end);
       }
     }
     if (constraint->literals_size() != constraint->coefficients_size()) {
-      LOG(FATAL) << "Failed to parse constraint:\n " << line;
+      LOG(FATAL) << "Failed to parse constraint:\n "
+                 << std::string(begin, end);
     }
   }
 
+  // Temporary storage for ProcessNewLine(), pointing inside the file contents.
+  std::vector<StringPiece> words_;
   int num_variables_;
   DISALLOW_COPY_AND_ASSIGN(OpbReader);
 };
@@ -14,6 +14,7 @@
 #ifndef OR_TOOLS_SAT_SAT_CNF_READER_H_
 #define OR_TOOLS_SAT_SAT_CNF_READER_H_
 
+#include <string.h>
 #include <map>
 #include <string>
 #include <vector>
@@ -24,7 +25,8 @@
 #include "base/strtoint.h"
 #include "base/split.h"
 #include "sat/boolean_problem.pb.h"
-#include "util/filelineiter.h"
+#include "sat/sat_solver.h"
+#include "util/file_contents.h"
 
 DEFINE_bool(wcnf_use_strong_slack, true,
             "If true, when we add a slack variable to reify a soft clause, we "
@@ -38,6 +40,11 @@ namespace sat {
 //    http://people.sc.fsu.edu/~jburkardt/data/cnf/cnf.html
 //
 // It also support the wcnf input format for partial weighted max-sat problems.
+//
+// The file is memory-mapped (or decompressed in memory if it ends with ".gz")
+// and scanned directly, without building a string per line. As allowed by the
+// format, a clause may span several lines, and a line may contain several
+// clauses: only the terminating 0 matters.
 class SatCnfReader {
  public:
   SatCnfReader() : interpret_cnf_as_max_sat_(false) {}
@@ -48,26 +55,11 @@ class SatCnfReader {
 
   // Loads the given cnf filename into the given problem.
   bool Load(const std::string& filename, LinearBooleanProblem* problem) {
-    positive_literal_to_weight_.clear();
-    objective_offset_ = 0;
     problem->Clear();
     problem->set_name(ExtractProblemName(filename));
-    is_wcnf_ = false;
-    end_marker_seen_ = false;
-    hard_weight_ = 0;
-    num_skipped_soft_clauses_ = 0;
-    num_singleton_soft_clauses_ = 0;
-    num_slack_variables_ = 0;
-    num_slack_binary_clauses_ = 0;
-
-    int num_lines = 0;
-    for (const std::string& line : FileLines(filename)) {
-      ++num_lines;
-      ProcessNewLine(line, problem);
-    }
-    if (num_lines == 0) {
-      LOG(FATAL) << "File '" << filename << "' is empty or can't be read.";
-    }
+    problem_ = problem;
+    solver_ = nullptr;
+    if (!Parse(filename)) return false;
     problem->set_original_num_variables(num_variables_);
     problem->set_num_variables(num_variables_ + num_slack_variables_);
 
@@ -92,6 +84,36 @@ class SatCnfReader {
     return true;
   }
 
+  // Same as Load() for a pure SAT cnf file, except that the clauses are
+  // directly added to the given solver with AddProblemClause() instead of
+  // being stored in the problem, which only gets the name and number of
+  // variables. On huge instances, this saves the time and memory needed by
+  // the proto. Returns false for a wcnf file or if InterpretCnfAsMaxSat(true)
+  // was called, since an objective is then needed.
+  //
+  // Note that the solver may be UNSAT afterwards, see
+  // SatSolver::IsModelUnsat().
+  bool LoadIntoSolver(const std::string& filename, SatSolver* solver,
+                      LinearBooleanProblem* problem) {
+    if (interpret_cnf_as_max_sat_) {
+      LOG(ERROR) << "A max-sat problem can't be loaded into a solver.";
+      return false;
+    }
+    problem->Clear();
+    problem->set_name(ExtractProblemName(filename));
+    problem_ = nullptr;
+    solver_ = solver;
+    num_added_clauses_ = 0;
+    if (!Parse(filename)) return false;
+    problem->set_original_num_variables(num_variables_);
+    problem->set_num_variables(num_variables_);
+    if (num_clauses_ != num_added_clauses_) {
+      LOG(ERROR) << "Wrong number of clauses.";
+      return false;
+    }
+    return true;
+  }
+
  private:
   // Since the problem name is not stored in the cnf format, we infer it from
   // the file name.
@@ -102,119 +124,219 @@ class SatCnfReader {
     return problem_name;
   }
 
-  int64 StringPieceAtoi(StringPiece input) {
-    // Hack: data() is not null terminated, but we do know that it points
-    // inside a std::string where numbers are separated by " " and since atoi64 will
-    // stop at the first invalid char, this works.
-    return atoi64(input.data());
+  static bool IsWhiteSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  // Returns the position of the '\n' ending the line containing c, or end.
+  static const char* LineEnd(const char* c, const char* end) {
+    const void* const newline = memchr(c, '\n', end - c);
+    return newline == nullptr ? end : static_cast<const char*>(newline);
   }
 
-  void ProcessNewLine(const std::string& line, LinearBooleanProblem* problem) {
-    static const char kWordDelimiters[] = " ";
-    words_ = strings::Split(
-        line, kWordDelimiters,
-        static_cast<int64>(strings::SkipEmpty()));
-    if (words_.size() == 0 || words_[0] == "c" || end_marker_seen_) return;
-    if (words_[0] == "%") {
-      end_marker_seen_ = true;
-      return;
+  // Parses the integer starting at *c, and moves *c just after it. Returns
+  // false if there is no valid integer there.
+  static bool ParseInteger(const char** c, const char* end, int64* value) {
+    const char* p = *c;
+    const bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+')) ++p;
+    const char* const digits = p;
+    int64 result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      result = 10 * result + (*p - '0');
+      ++p;
     }
+    if (p == digits || (p < end && !IsWhiteSpace(*p))) return false;
+    *value = negative ? -result : result;
+    *c = p;
+    return true;
+  }
 
-    if (words_[0] == "p") {
-      if (words_[1] == "cnf" || words_[1] == "wcnf") {
-        num_variables_ = StringPieceAtoi(words_[2]);
-        num_clauses_ = StringPieceAtoi(words_[3]);
-        if (words_[1] == "wcnf") {
-          is_wcnf_ = true;
-          hard_weight_ = (words_.size() > 4) ? StringPieceAtoi(words_[4]) : 0;
-        }
+  // Scans the whole file and calls ProcessClause() for each clause.
+  bool Parse(const std::string& filename) {
+    positive_literal_to_weight_.clear();
+    objective_offset_ = 0;
+    is_wcnf_ = false;
+    num_clauses_ = 0;
+    num_variables_ = 0;
+    hard_weight_ = 0;
+    num_skipped_soft_clauses_ = 0;
+    num_singleton_soft_clauses_ = 0;
+    num_slack_variables_ = 0;
+    num_slack_binary_clauses_ = 0;
+    clause_.clear();
+
+    FileContents contents;
+    if (!contents.Open(filename)) {
+      LOG(FATAL) << "Can't read the file " << contents.error_message();
+    }
+    if (contents.begin() == contents.end()) {
+      LOG(FATAL) << "File '" << filename << "' is empty.";
+    }
+    const char* const end = contents.end();
+    const char* c = contents.begin();
+    while (c < end) {
+      if (IsWhiteSpace(*c)) {
+        ++c;
+        continue;
+      }
+      if (*c == 'c') {
+        c = LineEnd(c, end);
+        continue;
+      }
+      // Some files have text after %, which marks the end of the data.
+      if (*c == '%') break;
+      if (*c == 'p') {
+        const char* const line_end = LineEnd(c, end);
+        ProcessHeader(std::string(c, line_end));
+        c = line_end;
+        continue;
+      }
+      int64 value;
+      if (!ParseInteger(&c, end, &value)) {
+        LOG(ERROR) << "Invalid token at position " << c - contents.begin()
+                   << " of '" << filename << "'.";
+        return false;
+      }
+      // In the wcnf format, the first number of a clause is its weight, which
+      // may be 0.
+      if (value == 0 && !(is_wcnf_ && clause_.empty())) {
+        if (!ProcessClause()) return false;
+        clause_.clear();
       } else {
-        // TODO(user): The ToString() is only required for the open source. Fix.
-        LOG(FATAL) << "Unknown file type: " << words_[1].ToString();
+        clause_.push_back(value);
+      }
+    }
+    // Be lenient with a last clause without its terminating 0.
+    if (!clause_.empty() && !ProcessClause()) return false;
+    return true;
+  }
+
+  void ProcessHeader(const std::string& line) {
+    static const char kWordDelimiters[] = " \t\r";
+    const std::vector<std::string> words =
+        strings::Split(line, kWordDelimiters, strings::SkipEmpty());
+    if (words.size() >= 4 && (words[1] == "cnf" || words[1] == "wcnf")) {
+      num_variables_ = atoi32(words[2]);
+      num_clauses_ = atoi32(words[3]);
+      if (words[1] == "wcnf") {
+        is_wcnf_ = true;
+        hard_weight_ = (words.size() > 4) ? atoi64(words[4]) : 0;
+      }
+      if (solver_ != nullptr) {
+        solver_->SetNumVariables(num_variables_);
       }
     } else {
-      // In the cnf file format, the last words should always be 0.
-      DCHECK_EQ("0", words_.back());
-      const int size = words_.size() - 1;
-      const int reserved_size =
-          (!is_wcnf_ && interpret_cnf_as_max_sat_) ? size + 1 : size;
-
-      LinearBooleanConstraint* constraint = problem->add_constraints();
-      constraint->mutable_literals()->Reserve(reserved_size);
-      constraint->mutable_coefficients()->Reserve(reserved_size);
-      constraint->set_lower_bound(1);
-
-      int64 weight =
-          (!is_wcnf_ && interpret_cnf_as_max_sat_) ? 1 : hard_weight_;
-      for (int i = 0; i < size; ++i) {
-        const int64 signed_value = StringPieceAtoi(words_[i]);
-        if (i == 0 && is_wcnf_) {
-          // Mathematically, a soft clause of weight 0 can be removed.
-          if (signed_value == 0) {
-            ++num_skipped_soft_clauses_;
-            problem->mutable_constraints()->RemoveLast();
-            break;
-          }
-          weight = signed_value;
-        } else {
-          DCHECK_NE(signed_value, 0);
-          constraint->add_literals(signed_value);
-          constraint->add_coefficients(1);
-        }
+      LOG(FATAL) << "Unknown file type: " << line;
+    }
+  }
+
+  // Adds the clause in clause_ to the solver or to the problem.
+  bool ProcessClause() {
+    if (solver_ == nullptr) {
+      ProcessClauseForProblem(problem_);
+      return true;
+    }
+    if (is_wcnf_) {
+      LOG(ERROR) << "A wcnf problem can't be loaded into a solver.";
+      return false;
+    }
+    literals_.clear();
+    for (const int64 signed_value : clause_) {
+      const int64 variable = signed_value > 0 ? signed_value : -signed_value;
+      if (variable > num_variables_) {
+        LOG(ERROR) << "Literal " << signed_value << " is out of range.";
+        return false;
       }
-      if (weight != hard_weight_) {
-        if (constraint->literals_size() == 1) {
-          // The max-sat formulation of an optimization sat problem with a
-          // linear objective introduces many singleton soft clauses. Because we
-          // natively work with a linear objective, we can just put the cost on
-          // the unique variable of such clause and remove the clause.
-          ++num_singleton_soft_clauses_;
-          const int literal = -constraint->literals(0);
-          if (literal > 0) {
-            positive_literal_to_weight_[literal] += weight;
-          } else {
-            positive_literal_to_weight_[-literal] -= weight;
-            objective_offset_ += weight;
-          }
+      literals_.push_back(
+          Literal(VariableIndex(variable - 1), signed_value > 0));
+    }
+    ++num_added_clauses_;
+
+    // Once the problem is UNSAT, there is no need to add more clauses.
+    if (!solver_->IsModelUnsat()) solver_->AddProblemClause(literals_);
+    return true;
+  }
+
+  void ProcessClauseForProblem(LinearBooleanProblem* problem) {
+    const int size = clause_.size();
+    const int reserved_size =
+        (!is_wcnf_ && interpret_cnf_as_max_sat_) ? size + 1 : size;
+
+    LinearBooleanConstraint* constraint = problem->add_constraints();
+    constraint->mutable_literals()->Reserve(reserved_size);
+    constraint->mutable_coefficients()->Reserve(reserved_size);
+    constraint->set_lower_bound(1);
+
+    int64 weight = (!is_wcnf_ && interpret_cnf_as_max_sat_) ? 1 : hard_weight_;
+    for (int i = 0; i < size; ++i) {
+      const int64 signed_value = clause_[i];
+      if (i == 0 && is_wcnf_) {
+        // Mathematically, a soft clause of weight 0 can be removed.
+        if (signed_value == 0) {
+          ++num_skipped_soft_clauses_;
           problem->mutable_constraints()->RemoveLast();
+          return;
+        }
+        weight = signed_value;
+      } else {
+        DCHECK_NE(signed_value, 0);
+        constraint->add_literals(signed_value);
+        constraint->add_coefficients(1);
+      }
+    }
+    if (weight != hard_weight_) {
+      if (constraint->literals_size() == 1) {
+        // The max-sat formulation of an optimization sat problem with a
+        // linear objective introduces many singleton soft clauses. Because we
+        // natively work with a linear objective, we can just put the cost on
+        // the unique variable of such clause and remove the clause.
+        ++num_singleton_soft_clauses_;
+        const int literal = -constraint->literals(0);
+        if (literal > 0) {
+          positive_literal_to_weight_[literal] += weight;
         } else {
-          // The +1 is because a positive literal is the same as the 1-based
-          // variable index.
-          const int slack_literal = num_variables_ + num_slack_variables_ + 1;
-          ++num_slack_variables_;
-          constraint->add_literals(slack_literal);
-          constraint->add_coefficients(1);
-          DCHECK_EQ(constraint->literals_size(), reserved_size);
-
-          if (slack_literal > 0) {
-            positive_literal_to_weight_[slack_literal] += weight;
-          } else {
-            positive_literal_to_weight_[-slack_literal] -= weight;
-            objective_offset_ += weight;
-          }
+          positive_literal_to_weight_[-literal] -= weight;
+          objective_offset_ += weight;
+        }
+        problem->mutable_constraints()->RemoveLast();
+      } else {
+        // The +1 is because a positive literal is the same as the 1-based
+        // variable index.
+        const int slack_literal = num_variables_ + num_slack_variables_ + 1;
+        ++num_slack_variables_;
+        constraint->add_literals(slack_literal);
+        constraint->add_coefficients(1);
+        DCHECK_EQ(constraint->literals_size(), reserved_size);
 
-          if (FLAGS_wcnf_use_strong_slack) {
-            // Add the binary implications slack_literal true => all the other
-            // clause literals are false.
-            LinearBooleanConstraint base_constraint;
-            base_constraint.set_lower_bound(1);
-            base_constraint.add_coefficients(1);
-            base_constraint.add_coefficients(1);
-            base_constraint.add_literals(-slack_literal);
-            base_constraint.add_literals(-slack_literal);
-            for (int i = 0; i + 1 < constraint->literals_size(); ++i) {
-              LinearBooleanConstraint* bc = problem->add_constraints();
-              *bc = base_constraint;
-              bc->mutable_literals()->Set(1, -constraint->literals(i));
-              ++num_slack_binary_clauses_;
-            }
+        if (slack_literal > 0) {
+          positive_literal_to_weight_[slack_literal] += weight;
+        } else {
+          positive_literal_to_weight_[-slack_literal] -= weight;
+          objective_offset_ += weight;
+        }
+
+        if (FLAGS_wcnf_use_strong_slack) {
+          // Add the binary implications slack_literal true => all the other
+          // clause literals are false.
+          LinearBooleanConstraint base_constraint;
+          base_constraint.set_lower_bound(1);
+          base_constraint.add_coefficients(1);
+          base_constraint.add_coefficients(1);
+          base_constraint.add_literals(-slack_literal);
+          base_constraint.add_literals(-slack_literal);
+          for (int i = 0; i + 1 < constraint->literals_size(); ++i) {
+            LinearBooleanConstraint* bc = problem->add_constraints();
+            *bc = base_constraint;
+            bc->mutable_literals()->Set(1, -constraint->literals(i));
+            ++num_slack_binary_clauses_;
           }
         }
-      } else {
-        // If wcnf is true, we currently reserve one more literals than needed
-        // for the hard clauses.
-        DCHECK_EQ(constraint->literals_size(), is_wcnf_ ? size - 1 : size);
       }
+    } else {
+      // If wcnf is true, we currently reserve one more literals than needed
+      // for the hard clauses.
+      DCHECK_EQ(constraint->literals_size(), is_wcnf_ ? size - 1 : size);
     }
   }
 
@@ -223,8 +345,15 @@ class SatCnfReader {
   int num_clauses_;
   int num_variables_;
 
-  // Temporary storage for ProcessNewLine().
-  std::vector<StringPiece> words_;
+  // Where the clauses go: exactly one of them is not null during Parse().
+  LinearBooleanProblem* problem_;
+  SatSolver* solver_;
+  int num_added_clauses_;
+
+  // Temporary storage for ProcessClause(). For a wcnf file, the first element
+  // of clause_ is the clause weight.
+  std::vector<int64> clause_;
+  std::vector<Literal> literals_;
 
   // We stores the objective in a map because we want the variables to appear
   // only once in the LinearObjective proto.
@@ -233,8 +362,6 @@ class SatCnfReader {
 
   // Used for the wcnf format.
   bool is_wcnf_;
-  // Some files have text after %. This indicates if we have seen the '%'.
-  bool end_marker_seen_;
   int64 hard_weight_;
 
   int num_slack_variables_;
@@ -11,6 +11,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -27,11 +28,13 @@
 #include "base/strutil.h"
 #include "algorithms/sparse_permutation.h"
 #include "sat/boolean_problem.h"
+#include "sat/drat_writer.h"
 #include "cpp/opb_reader.h"
 #include "sat/optimization.h"
 #include "cpp/sat_cnf_reader.h"
 #include "sat/sat_solver.h"
 #include "sat/simplification.h"
+#include "sat/symmetry.h"
 #include "util/time_limit.h"
 #include "base/random.h"
 #include "base/status.h"
@@ -83,6 +86,10 @@ DEFINE_bool(core_enc, false,
             "If true, search the optimal solution with the core-based "
             "cardinality encoding algo.");
 
+DEFINE_bool(oll, false,
+            "If true, search the optimal solution with the OLL core-based "
+            "algo.");
+
 DEFINE_bool(linear_scan, false,
             "If true, search the optimal solution with the linear scan algo.");
 
@@ -94,6 +101,25 @@ DEFINE_bool(use_symmetry, false,
             "If true, find and exploit the eventual symmetries "
             "of the problem.");
 
+DEFINE_double(symmetry_max_deterministic_time,
+              std::numeric_limits<double>::infinity(),
+              "Limit on the deterministic time spent finding the symmetries "
+              "with --use_symmetry. Only the symmetries found so far are used "
+              "when it is reached.");
+
+DEFINE_int32(symmetry_num_threads, 1,
+             "Number of threads used to find the symmetries with "
+             "--use_symmetry. The symmetries found do not depend on it.");
+
+DEFINE_bool(lex_leader_clauses, false,
+            "If true, the symmetries found with --use_symmetry are broken by "
+            "adding lex-leader clauses to the problem instead of being "
+            "exploited during the search.");
+
+DEFINE_int32(lex_leader_max_num_variables, 100,
+             "Maximum number of variables compared by the lex-leader clauses "
+             "of each symmetry.");
+
 DEFINE_bool(presolve, false,
             "Only work on pure SAT problem. If true, presolve the problem.");
 
@@ -105,10 +131,17 @@ DEFINE_bool(refine_core, false,
             "UNSAT, refine as much as possible its UNSAT core in order to get "
             "a small one.");
 
+DEFINE_string(drat_output, "",
+              "If non-empty, stream a proof in the binary DRAT format to this "
+              "file. It can be a named pipe read by a checker like drat-trim. "
+              "Only works on pure SAT problem without --presolve, --probing "
+              "or --use_symmetry.");
+
 DEFINE_bool(reduce_memory_usage, false,
             "If true, do not keep a copy of the original problem in memory."
             "This reduce the memory usage, but disable the solution cheking at "
-            "the end.");
+            "the end. A pure SAT cnf file is then directly loaded into the "
+            "solver, without building the problem proto.");
 
 namespace operations_research {
 namespace sat {
@@ -138,7 +171,7 @@ void LoadBooleanProblem(std::string filename, LinearBooleanProblem* problem) {
              HasSuffixString(filename, ".wcnf.gz")) {
     SatCnfReader reader;
     if (FLAGS_fu_malik || FLAGS_linear_scan || FLAGS_wpm1 || FLAGS_qmaxsat ||
-        FLAGS_core_enc) {
+        FLAGS_core_enc || FLAGS_oll) {
       reader.InterpretCnfAsMaxSat(true);
     }
     if (!reader.Load(filename, problem)) {
@@ -188,9 +221,38 @@ int Run() {
   std::unique_ptr<SatSolver> solver(new SatSolver());
   solver->SetParameters(parameters);
 
-  // Read the problem.
+  // Read the problem. When its proto is not needed, a pure SAT cnf file is
+  // directly loaded into the solver below, which is a lot faster on huge
+  // files.
+  const bool is_max_sat = FLAGS_fu_malik || FLAGS_linear_scan || FLAGS_wpm1 ||
+                          FLAGS_qmaxsat || FLAGS_core_enc || FLAGS_oll;
+  const bool load_cnf_into_solver =
+      FLAGS_reduce_memory_usage && !is_max_sat && !FLAGS_probing &&
+      !FLAGS_use_symmetry && !FLAGS_strict_validity &&
+      (HasSuffixString(FLAGS_input, ".cnf") ||
+       HasSuffixString(FLAGS_input, ".cnf.gz"));
   LinearBooleanProblem problem;
-  LoadBooleanProblem(FLAGS_input, &problem);
+  if (!load_cnf_into_solver) LoadBooleanProblem(FLAGS_input, &problem);
+
+  // The DRAT proof must be given to the solver before the problem is loaded.
+  File* drat_file = nullptr;
+  std::unique_ptr<DratWriter> drat_writer;
+  if (!FLAGS_drat_output.empty()) {
+    CHECK(!FLAGS_presolve && !FLAGS_probing && !FLAGS_use_symmetry)
+        << "incompatible";
+    CHECK(!problem.has_objective())
+        << "DRAT proofs are only supported for pure SAT problems.";
+    for (const LinearBooleanConstraint& constraint : problem.constraints()) {
+      CHECK(constraint.lower_bound() == 1 && !constraint.has_upper_bound())
+          << "DRAT proofs only support clauses.";
+      for (const int64 coefficient : constraint.coefficients()) {
+        CHECK_EQ(coefficient, 1) << "DRAT proofs only support clauses.";
+      }
+    }
+    drat_file = File::OpenOrDie(FLAGS_drat_output, "w");
+    drat_writer.reset(new DratWriter(drat_file));
+    solver->SetDratWriter(drat_writer.get());
+  }
   if (FLAGS_strict_validity) {
     const util::Status status = ValidateBooleanProblem(problem);
     if (!status.ok()) {
@@ -215,8 +277,33 @@ int Run() {
     ProbeAndSimplifyProblem(&probing_postsolver, &problem);
   }
 
+  // Symmetries! The lex-leader clauses must be in the problem before it is
+  // loaded, the symmetry propagator is added after.
+  std::vector<std::unique_ptr<SparsePermutation>> generators;
+  if (FLAGS_use_symmetry) {
+    CHECK(!FLAGS_reduce_memory_usage) << "incompatible";
+    LOG(INFO) << "Finding symmetries of the problem.";
+    FindLinearBooleanProblemSymmetries(
+        problem, FLAGS_symmetry_max_deterministic_time,
+        FLAGS_symmetry_num_threads, &generators);
+    if (FLAGS_lex_leader_clauses) {
+      CHECK(!FLAGS_probing) << "incompatible";
+      AddLexLeaderSymmetryBreakingClauses(
+          generators, FLAGS_lex_leader_max_num_variables, &problem);
+      generators.clear();
+    }
+  }
+
   // Load the problem into the solver.
-  if (FLAGS_reduce_memory_usage) {
+  if (load_cnf_into_solver) {
+    SatCnfReader reader;
+    if (!reader.LoadIntoSolver(FLAGS_input, solver.get(), &problem)) {
+      LOG(FATAL) << "Cannot load file '" << FLAGS_input << "'.";
+    }
+    if (solver->IsModelUnsat()) {
+      LOG(INFO) << "UNSAT when loading the problem.";
+    }
+  } else if (FLAGS_reduce_memory_usage) {
     if (!LoadAndConsumeBooleanProblem(&problem, solver.get())) {
       LOG(INFO) << "UNSAT when loading the problem.";
     }
@@ -232,20 +319,19 @@ int Run() {
     LOG(INFO) << "UNSAT when setting the objective constraint.";
   }
 
-  // Symmetries!
-  if (FLAGS_use_symmetry) {
-    CHECK(!FLAGS_reduce_memory_usage) << "incompatible";
-    LOG(INFO) << "Finding symmetries of the problem.";
-    std::vector<std::unique_ptr<SparsePermutation>> generators;
-    FindLinearBooleanProblemSymmetries(problem, &generators);
-    solver->AddSymmetries(&generators);
+  if (!generators.empty()) {
+    std::unique_ptr<SymmetryPropagator> propagator(new SymmetryPropagator);
+    for (int i = 0; i < generators.size(); ++i) {
+      propagator->AddSymmetry(std::move(generators[i]));
+    }
+    solver->AddPropagator(std::move(propagator));
   }
 
   // Optimize?
   std::vector<bool> solution;
   SatSolver::Status result = SatSolver::LIMIT_REACHED;
   if (FLAGS_fu_malik || FLAGS_linear_scan || FLAGS_wpm1 || FLAGS_qmaxsat ||
-      FLAGS_core_enc) {
+      FLAGS_core_enc || FLAGS_oll) {
     if (FLAGS_randomize > 0 && (FLAGS_linear_scan || FLAGS_qmaxsat)) {
       CHECK(!FLAGS_reduce_memory_usage) << "incompatible";
       result = SolveWithRandomParameters(STDOUT_LOG, problem, FLAGS_randomize,
@@ -261,6 +347,8 @@ int Run() {
       } else if (FLAGS_core_enc) {
         result = SolveWithCardinalityEncodingAndCore(STDOUT_LOG, problem,
                                                      solver.get(), &solution);
+      } else if (FLAGS_oll) {
+        result = SolveWithOLL(STDOUT_LOG, problem, solver.get(), &solution);
       } else if (FLAGS_fu_malik) {
         result = SolveWithFuMalik(STDOUT_LOG, problem, solver.get(), &solution);
       } else if (FLAGS_wpm1) {
@@ -382,7 +470,8 @@ int Run() {
 
   // Print the solution status.
   if (result == SatSolver::MODEL_SAT) {
-    if (FLAGS_fu_malik || FLAGS_linear_scan || FLAGS_wpm1 || FLAGS_core_enc) {
+    if (FLAGS_fu_malik || FLAGS_linear_scan || FLAGS_wpm1 || FLAGS_core_enc ||
+        FLAGS_oll) {
       printf("s OPTIMUM FOUND\n");
       CHECK(!solution.empty());
       const Coefficient objective = ComputeObjectiveValue(problem, solution);
@@ -417,6 +506,12 @@ int Run() {
   if (result == SatSolver::MODEL_UNSAT) {
     printf("s UNSATISFIABLE\n");
   }
+  if (drat_writer != nullptr) {
+    solver->SetDratWriter(nullptr);
+    drat_writer.reset();
+    CHECK(drat_file->Close());
+    delete drat_file;
+  }
 
   // Print objective value.
   if (solution.empty()) {
@@ -31,7 +31,7 @@
 DEFINE_string(input, "", "REQUIRED: Input file name.");
 DEFINE_string(solver, "glop",
               "The solver to use: "
-              "cbc, clp, cplex, cplex_mip, glop, glpk_lp, glpk_mip,"
+              "cbc, clp, cplex, cplex_mip, glop, glop_mip, glpk_lp, glpk_mip,"
 	          " gurobi_lp, gurobi_mip, scip.");
 DEFINE_string(params, "", "Solver specific parameters");
 DEFINE_int64(time_limit_ms, 0,
@@ -46,6 +46,13 @@ DEFINE_string(output, "",
 DEFINE_string(output_csv, "",
               "If non-empty, write the returned solution in csv format with "
               "each line formed by a variable name and its value.");
+DEFINE_string(input_basis, "",
+              "If non-empty, a MPBasisProto (binary or text) used to "
+              "warm-start the solve of a linear program.");
+DEFINE_string(output_basis, "",
+              "If non-empty, write the basis of the solution there as a "
+              "MPBasisProto. The format will be binary except if the name end "
+              "with '.txt'.");
 
 static const char kUsageStr[] =
     "Run MPSolver on the given input file. Many formats are supported: \n"
@@ -88,6 +95,8 @@ void Run() {
   } else if (FLAGS_solver == "cbc") {
     type = MPSolver::CBC_MIXED_INTEGER_PROGRAMMING;
 #endif
+  } else if (FLAGS_solver == "glop_mip") {
+    type = MPSolver::GLOP_MIXED_INTEGER_PROGRAMMING;
 #if defined(USE_GLPK)
   } else if (FLAGS_solver == "glpk_mip") {
     type = MPSolver::GLPK_MIXED_INTEGER_PROGRAMMING;
@@ -182,6 +191,12 @@ void Run() {
       << MPSolverResponseStatus_Name(status) << ": " << error_message;
   printf("%-12s: %d x %d\n", "Dimension", solver.NumConstraints(),
          solver.NumVariables());
+  if (!FLAGS_input_basis.empty()) {
+    MPBasisProto basis;
+    CHECK(ReadFileToProto(FLAGS_input_basis, &basis))
+        << "Failed to parse '" << FLAGS_input_basis << "' as an MPBasisProto.";
+    solver.LoadLpBasisFromProto(basis);
+  }
 
   // Solve.
   MPSolverParameters param;
@@ -202,6 +217,16 @@ void Run() {
       CHECK_OK(file::SetBinaryProto(FLAGS_output, result, file::Defaults()));
     }
   }
+  if (!FLAGS_output_basis.empty()) {
+    MPBasisProto basis;
+    solver.ExportLpBasisToProto(&basis);
+    if (HasSuffixString(FLAGS_output_basis, ".txt")) {
+      CHECK_OK(file::SetTextProto(FLAGS_output_basis, basis, file::Defaults()));
+    } else {
+      CHECK_OK(
+          file::SetBinaryProto(FLAGS_output_basis, basis, file::Defaults()));
+    }
+  }
   if (!FLAGS_output_csv.empty()) {
     operations_research::MPSolutionResponse result;
     solver.FillSolutionResponseProto(&result);
@@ -0,0 +1,142 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves linear programs made of independent random transportation problems
+// with and without the block decomposition, with one and several threads.
+// All the solves must find the same optimal objective. The blocks must share
+// the time limit of the whole solve, and see when it is interrupted.
+
+#include <cmath>
+#include <memory>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "glop/lp_solver.h"
+#include "glop/parameters.pb.h"
+#include "lp_data/lp_data.h"
+#include "util/time_limit.h"
+
+DEFINE_int32(num_instances, 5, "Number of random instances to solve.");
+
+namespace operations_research {
+namespace glop {
+
+// Adds 'num_blocks' independent transportation problems to lp.
+void BuildBlockProblem(int num_blocks, int seed, LinearProgram* lp) {
+  ACMRandom random(seed);
+  const int kNumSupplies = 10;
+  const int kNumDemands = 15;
+  for (int block = 0; block < num_blocks; ++block) {
+    std::vector<RowIndex> supplies;
+    std::vector<RowIndex> demands;
+    double total_demand = 0.0;
+    for (int i = 0; i < kNumDemands; ++i) {
+      const double demand = 1 + random.Uniform(100);
+      demands.push_back(lp->CreateNewConstraint());
+      lp->SetConstraintBounds(demands.back(), demand, demand);
+      total_demand += demand;
+    }
+    for (int i = 0; i < kNumSupplies; ++i) {
+      supplies.push_back(lp->CreateNewConstraint());
+      lp->SetConstraintBounds(supplies.back(), -kInfinity,
+                              1.3 * total_demand / kNumSupplies);
+    }
+    for (const RowIndex supply : supplies) {
+      for (const RowIndex demand : demands) {
+        const ColIndex col = lp->CreateNewVariable();
+        lp->SetVariableBounds(col, 0.0, kInfinity);
+        lp->SetObjectiveCoefficient(col, 1 + random.Uniform(1000));
+        lp->SetCoefficient(supply, col, 1.0);
+        lp->SetCoefficient(demand, col, 1.0);
+      }
+    }
+  }
+  lp->CleanUp();
+}
+
+GlopParameters BlockParameters(int num_threads) {
+  GlopParameters parameters;
+  parameters.set_use_preprocessing(false);
+  parameters.set_use_block_decomposition(true);
+  parameters.set_num_block_decomposition_threads(num_threads);
+  return parameters;
+}
+
+void TestSameObjective() {
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    LinearProgram lp;
+    BuildBlockProblem(2 + seed, seed, &lp);
+    GlopParameters parameters;
+    parameters.set_use_preprocessing(false);
+    LPSolver solver;
+    solver.SetParameters(parameters);
+    CHECK_EQ(ProblemStatus::OPTIMAL, solver.Solve(lp)) << "seed " << seed;
+    const double expected = solver.GetObjectiveValue();
+    for (const int num_threads : {1, 3}) {
+      LPSolver block_solver;
+      block_solver.SetParameters(BlockParameters(num_threads));
+      CHECK_EQ(ProblemStatus::OPTIMAL, block_solver.Solve(lp))
+          << "seed " << seed << ", " << num_threads << " threads";
+      CHECK_LE(std::abs(block_solver.GetObjectiveValue() - expected),
+               1e-9 * (1.0 + std::abs(expected)))
+          << "seed " << seed << ", " << num_threads << " threads";
+    }
+    LOG(INFO) << "seed " << seed << ": objective " << expected;
+  }
+}
+
+void TestSharedTimeLimit() {
+  const int kNumBlocks = 8;
+  LinearProgram lp;
+  BuildBlockProblem(kNumBlocks, 0, &lp);
+  LPSolver solver;
+  solver.SetParameters(BlockParameters(1));
+  CHECK_EQ(ProblemStatus::OPTIMAL, solver.Solve(lp));
+  const double deterministic_time = solver.DeterministicTime();
+  CHECK_GT(deterministic_time, 0.0);
+
+  // Each block alone needs much less than half of the total time, but the
+  // blocks together can not be solved in it.
+  std::unique_ptr<TimeLimit> time_limit =
+      TimeLimit::FromDeterministicTime(deterministic_time / 2);
+  LPSolver limited_solver;
+  limited_solver.SetParameters(BlockParameters(1));
+  CHECK_NE(ProblemStatus::OPTIMAL,
+           limited_solver.SolveWithTimeLimit(lp, time_limit.get()));
+  CHECK_LT(limited_solver.GetNumberOfSimplexIterations(),
+           solver.GetNumberOfSimplexIterations());
+
+  // An interrupted solve stops before solving any block.
+  for (const int num_threads : {1, 3}) {
+    bool interrupt = true;
+    std::unique_ptr<TimeLimit> interrupted_time_limit = TimeLimit::Infinite();
+    interrupted_time_limit->RegisterExternalBooleanAsLimit(&interrupt);
+    LPSolver interrupted_solver;
+    interrupted_solver.SetParameters(BlockParameters(num_threads));
+    CHECK_NE(ProblemStatus::OPTIMAL,
+             interrupted_solver.SolveWithTimeLimit(
+                 lp, interrupted_time_limit.get()));
+    CHECK_EQ(0, interrupted_solver.GetNumberOfSimplexIterations());
+  }
+}
+
+}  // namespace glop
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::glop::TestSameObjective();
+  operations_research::glop::TestSharedTimeLimit();
+  return 0;
+}
@@ -0,0 +1,178 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves small random multi-dimensional knapsack (maximization) and set cover
+// (minimization) problems with the branch and bound, and checks the objective
+// against the optimum found by enumerating all the 0-1 solutions. Each problem
+// is solved with one and several threads, and with both node selections.
+
+#include <cmath>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "glop/branch_and_bound.h"
+#include "glop/parameters.pb.h"
+#include "lp_data/lp_data.h"
+
+DEFINE_int32(num_instances, 10, "Number of random instances of each kind.");
+
+namespace operations_research {
+namespace glop {
+
+const int kNumVariables = 14;
+const int kNumConstraints = 5;
+
+// Builds a problem over kNumVariables binary variables. A knapsack maximizes
+// the value of the items whose weights fit in each constraint, a set cover
+// minimizes the cost of the sets needed to cover each element.
+void BuildProblem(bool knapsack, int seed, LinearProgram* lp) {
+  ACMRandom random(seed);
+  std::vector<RowIndex> rows;
+  for (int i = 0; i < kNumConstraints; ++i) {
+    rows.push_back(lp->CreateNewConstraint());
+  }
+  double total_weight = 0.0;
+  for (int j = 0; j < kNumVariables; ++j) {
+    const ColIndex col = lp->CreateNewVariable();
+    lp->SetVariableBounds(col, 0.0, 1.0);
+    lp->SetVariableIntegrality(col, true);
+    lp->SetObjectiveCoefficient(col, 1 + random.Uniform(100));
+    for (const RowIndex row : rows) {
+      if (knapsack) {
+        const double weight = 1 + random.Uniform(30);
+        lp->SetCoefficient(row, col, weight);
+        total_weight += weight;
+      } else if (random.Uniform(3) == 0) {
+        lp->SetCoefficient(row, col, 1.0);
+      }
+    }
+  }
+  for (const RowIndex row : rows) {
+    if (knapsack) {
+      lp->SetConstraintBounds(row, -kInfinity,
+                              total_weight / (3 * kNumConstraints));
+    } else {
+      lp->SetConstraintBounds(row, 1.0, kInfinity);
+    }
+  }
+  lp->SetMaximizationProblem(knapsack);
+  lp->CleanUp();
+}
+
+// Returns true if the given 0-1 values satisfy all the constraints of lp.
+bool IsFeasible(const LinearProgram& lp, const DenseRow& values) {
+  DenseColumn activities(lp.num_constraints(), 0.0);
+  for (ColIndex col(0); col < lp.num_variables(); ++col) {
+    for (const SparseColumn::Entry e : lp.GetSparseColumn(col)) {
+      activities[e.row()] += e.coefficient() * values[col];
+    }
+  }
+  for (RowIndex row(0); row < lp.num_constraints(); ++row) {
+    if (activities[row] < lp.constraint_lower_bounds()[row] - 1e-6 ||
+        activities[row] > lp.constraint_upper_bounds()[row] + 1e-6) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the optimal objective of lp by enumerating all the 0-1 solutions,
+// or kInfinity if none is feasible.
+Fractional OptimalObjective(const LinearProgram& lp) {
+  const int num_variables = lp.num_variables().value();
+  const Fractional sign = lp.IsMaximizationProblem() ? -1.0 : 1.0;
+  Fractional best = kInfinity;
+  DenseRow values(lp.num_variables(), 0.0);
+  for (int mask = 0; mask < (1 << num_variables); ++mask) {
+    Fractional objective = 0.0;
+    for (ColIndex col(0); col < lp.num_variables(); ++col) {
+      values[col] = (mask >> col.value()) & 1;
+      objective += values[col] * lp.objective_coefficients()[col];
+    }
+    if (IsFeasible(lp, values)) best = std::min(best, sign * objective);
+  }
+  return sign * best;
+}
+
+void TestKnownOptima() {
+  for (const bool knapsack : {true, false}) {
+    for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+      LinearProgram lp;
+      BuildProblem(knapsack, seed, &lp);
+      const Fractional optimum = OptimalObjective(lp);
+      CHECK_NE(kInfinity, std::abs(optimum)) << "seed " << seed;
+      for (const int num_threads : {1, 3}) {
+        for (const bool depth_first : {false, true}) {
+          GlopParameters parameters;
+          parameters.set_mip_num_threads(num_threads);
+          parameters.set_mip_node_selection(
+              depth_first ? GlopParameters::DEPTH_FIRST
+                          : GlopParameters::BEST_BOUND);
+          parameters.set_mip_relative_gap(0.0);
+          BranchAndBoundSolver solver;
+          solver.SetParameters(parameters);
+          CHECK_EQ(ProblemStatus::OPTIMAL, solver.Solve(lp))
+              << "seed " << seed << ", " << num_threads << " threads";
+          CHECK_LE(std::abs(solver.GetObjectiveValue() - optimum), 1e-6)
+              << "seed " << seed << ", " << num_threads << " threads";
+          if (knapsack) {
+            CHECK_GE(solver.GetBestBound(), optimum - 1e-6);
+          } else {
+            CHECK_LE(solver.GetBestBound(), optimum + 1e-6);
+          }
+          DenseRow values = solver.variable_values();
+          for (ColIndex col(0); col < lp.num_variables(); ++col) {
+            CHECK_LE(std::abs(values[col] - std::round(values[col])), 1e-6);
+            values[col] = std::round(values[col]);
+          }
+          CHECK(IsFeasible(lp, values)) << "seed " << seed;
+        }
+      }
+      LOG(INFO) << (knapsack ? "Knapsack" : "Set cover") << " seed " << seed
+                << ": optimum " << optimum;
+    }
+  }
+}
+
+// x + y = 1.5 has a feasible LP relaxation but no integer solution.
+void TestInfeasible() {
+  LinearProgram lp;
+  const RowIndex row = lp.CreateNewConstraint();
+  lp.SetConstraintBounds(row, 1.5, 1.5);
+  for (int i = 0; i < 2; ++i) {
+    const ColIndex col = lp.CreateNewVariable();
+    lp.SetVariableBounds(col, 0.0, 1.0);
+    lp.SetVariableIntegrality(col, true);
+    lp.SetObjectiveCoefficient(col, 1.0);
+    lp.SetCoefficient(row, col, 1.0);
+  }
+  for (const int num_threads : {1, 3}) {
+    GlopParameters parameters;
+    parameters.set_mip_num_threads(num_threads);
+    BranchAndBoundSolver solver;
+    solver.SetParameters(parameters);
+    CHECK_EQ(ProblemStatus::PRIMAL_INFEASIBLE, solver.Solve(lp))
+        << num_threads << " threads";
+  }
+}
+
+}  // namespace glop
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::glop::TestKnownOptima();
+  operations_research::glop::TestInfeasible();
+  return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves small random transportation problems with the PDHG and checks its
+// objective against the one of the simplex. The PDHG must return the same
+// solution with one and several threads, detect infeasible problems, and
+// stop at the iteration limit.
+
+#include <cmath>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "glop/lp_solver.h"
+#include "glop/parameters.pb.h"
+#include "lp_data/lp_data.h"
+
+DEFINE_int32(num_instances, 10, "Number of random instances to solve.");
+
+namespace operations_research {
+namespace glop {
+
+// Ships the random demand of 'num_demands' nodes from 'num_supplies' nodes,
+// each of which can supply 'supply_ratio' times its share of the total
+// demand. The problem is infeasible if supply_ratio < 1.
+void BuildTransportationProblem(int num_supplies, int num_demands,
+                                double supply_ratio, bool maximize, int seed,
+                                LinearProgram* lp) {
+  ACMRandom random(seed);
+  std::vector<RowIndex> supplies;
+  std::vector<RowIndex> demands;
+  double total_demand = 0.0;
+  for (int i = 0; i < num_demands; ++i) {
+    const double demand = 1 + random.Uniform(100);
+    demands.push_back(lp->CreateNewConstraint());
+    lp->SetConstraintBounds(demands.back(), demand, demand);
+    total_demand += demand;
+  }
+  for (int i = 0; i < num_supplies; ++i) {
+    supplies.push_back(lp->CreateNewConstraint());
+    lp->SetConstraintBounds(supplies.back(), -kInfinity,
+                            supply_ratio * total_demand / num_supplies);
+  }
+  for (const RowIndex supply : supplies) {
+    for (const RowIndex demand : demands) {
+      const ColIndex col = lp->CreateNewVariable();
+      lp->SetVariableBounds(col, 0.0, kInfinity);
+      const double cost = 1 + random.Uniform(1000);
+      lp->SetObjectiveCoefficient(col, maximize ? -cost : cost);
+      lp->SetCoefficient(supply, col, 1.0);
+      lp->SetCoefficient(demand, col, 1.0);
+    }
+  }
+  lp->SetMaximizationProblem(maximize);
+  lp->CleanUp();
+}
+
+void TestPdhgAgainstSimplex() {
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    const bool maximize = seed % 2 == 1;
+    LinearProgram lp;
+    BuildTransportationProblem(5 + seed % 4, 8 + seed % 5, 1.3, maximize, seed,
+                               &lp);
+    LPSolver simplex;
+    CHECK_EQ(ProblemStatus::OPTIMAL, simplex.Solve(lp)) << "seed " << seed;
+    const double expected = simplex.GetObjectiveValue();
+
+    GlopParameters parameters;
+    parameters.set_use_pdhg(true);
+    parameters.set_pdhg_relative_tolerance(1e-8);
+    parameters.set_solution_feasibility_tolerance(1e-4);
+    LPSolver pdhg;
+    pdhg.SetParameters(parameters);
+    CHECK_EQ(ProblemStatus::OPTIMAL, pdhg.Solve(lp)) << "seed " << seed;
+    CHECK_LE(std::abs(pdhg.GetObjectiveValue() - expected),
+             1e-6 * (1.0 + std::abs(expected)))
+        << "seed " << seed;
+    const int64 num_iterations = pdhg.GetNumberOfPdhgIterations();
+    CHECK_GT(num_iterations, 0);
+
+    // The products are split in slices computed independently, so the
+    // iterates do not depend on the number of threads.
+    parameters.set_num_pdhg_threads(3);
+    LPSolver threaded_pdhg;
+    threaded_pdhg.SetParameters(parameters);
+    CHECK_EQ(ProblemStatus::OPTIMAL, threaded_pdhg.Solve(lp)) << "seed "
+                                                               << seed;
+    CHECK_EQ(pdhg.GetObjectiveValue(), threaded_pdhg.GetObjectiveValue())
+        << "seed " << seed;
+    CHECK_EQ(num_iterations, threaded_pdhg.GetNumberOfPdhgIterations())
+        << "seed " << seed;
+
+    // The crossover must end with an optimal basic solution.
+    parameters.set_pdhg_crossover(true);
+    LPSolver crossover;
+    crossover.SetParameters(parameters);
+    CHECK_EQ(ProblemStatus::OPTIMAL, crossover.Solve(lp)) << "seed " << seed;
+    CHECK_LE(std::abs(crossover.GetObjectiveValue() - expected),
+             1e-9 * (1.0 + std::abs(expected)))
+        << "seed " << seed;
+    LOG(INFO) << "seed " << seed << ": objective " << expected << ", "
+              << num_iterations << " PDHG iterations, "
+              << crossover.GetNumberOfSimplexIterations()
+              << " simplex iterations after the crossover.";
+  }
+}
+
+void TestPdhgInfeasibility() {
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    LinearProgram lp;
+    BuildTransportationProblem(4, 6, 0.8, false, seed, &lp);
+    GlopParameters parameters;
+    parameters.set_use_pdhg(true);
+    parameters.set_use_preprocessing(false);
+    LPSolver pdhg;
+    pdhg.SetParameters(parameters);
+    CHECK_EQ(ProblemStatus::PRIMAL_INFEASIBLE, pdhg.Solve(lp)) << "seed "
+                                                                << seed;
+  }
+}
+
+void TestPdhgIterationLimit() {
+  LinearProgram lp;
+  BuildTransportationProblem(20, 30, 1.3, false, 0, &lp);
+  GlopParameters parameters;
+  parameters.set_use_pdhg(true);
+  parameters.set_max_number_of_iterations(10);
+  LPSolver pdhg;
+  pdhg.SetParameters(parameters);
+  CHECK_NE(ProblemStatus::OPTIMAL, pdhg.Solve(lp));
+  CHECK_LE(pdhg.GetNumberOfPdhgIterations(), 10);
+}
+
+}  // namespace glop
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::glop::TestPdhgAgainstSimplex();
+  operations_research::glop::TestPdhgInfeasibility();
+  operations_research::glop::TestPdhgIterationLimit();
+  return 0;
+}
@@ -0,0 +1,210 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Warm-starts LPSolver from the basis of a previous solve, given with
+// SetInitialBasis(). The optimal basis of a problem must solve it again
+// without any iteration, and a basis of a modified problem, or a basis made
+// singular by a nearly duplicated column, must still lead to the optimum.
+
+#include <cmath>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "glop/lp_solver.h"
+#include "glop/parameters.pb.h"
+#include "lp_data/lp_data.h"
+
+DEFINE_int32(num_instances, 10, "Number of random instances to solve.");
+
+namespace operations_research {
+namespace glop {
+
+// Ships the random demand of 'num_demands' nodes from 'num_supplies' nodes,
+// each of which can supply 1.3 times its share of the total demand.
+void BuildTransportationProblem(int num_supplies, int num_demands, int seed,
+                                LinearProgram* lp) {
+  ACMRandom random(seed);
+  std::vector<RowIndex> supplies;
+  std::vector<RowIndex> demands;
+  double total_demand = 0.0;
+  for (int i = 0; i < num_demands; ++i) {
+    const double demand = 1 + random.Uniform(100);
+    demands.push_back(lp->CreateNewConstraint());
+    lp->SetConstraintBounds(demands.back(), demand, demand);
+    total_demand += demand;
+  }
+  for (int i = 0; i < num_supplies; ++i) {
+    supplies.push_back(lp->CreateNewConstraint());
+    lp->SetConstraintBounds(supplies.back(), -kInfinity,
+                            1.3 * total_demand / num_supplies);
+  }
+  for (const RowIndex supply : supplies) {
+    for (const RowIndex demand : demands) {
+      const ColIndex col = lp->CreateNewVariable();
+      lp->SetVariableBounds(col, 0.0, kInfinity);
+      lp->SetObjectiveCoefficient(col, 1 + random.Uniform(1000));
+      lp->SetCoefficient(supply, col, 1.0);
+      lp->SetCoefficient(demand, col, 1.0);
+    }
+  }
+  lp->CleanUp();
+}
+
+GlopParameters WarmStartParameters() {
+  GlopParameters parameters;
+  parameters.set_use_dual_simplex(false);
+  return parameters;
+}
+
+void CheckSameObjective(Fractional expected, Fractional actual, int seed) {
+  CHECK_LE(std::abs(actual - expected), 1e-9 * (1.0 + std::abs(expected)))
+      << "seed " << seed;
+}
+
+void TestRoundTrip() {
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    LinearProgram lp;
+    BuildTransportationProblem(5 + seed % 4, 8 + seed % 5, seed, &lp);
+    LPSolver solver;
+    CHECK_EQ(ProblemStatus::OPTIMAL, solver.Solve(lp)) << "seed " << seed;
+    CHECK_GT(solver.GetNumberOfSimplexIterations(), 0);
+
+    LPSolver warm_solver;
+    warm_solver.SetParameters(WarmStartParameters());
+    warm_solver.SetInitialBasis(solver.variable_statuses(),
+                                solver.constraint_statuses());
+    CHECK_EQ(ProblemStatus::OPTIMAL, warm_solver.Solve(lp)) << "seed " << seed;
+    CheckSameObjective(solver.GetObjectiveValue(),
+                       warm_solver.GetObjectiveValue(), seed);
+    CHECK_EQ(0, warm_solver.GetNumberOfSimplexIterations()) << "seed " << seed;
+    CHECK(solver.variable_statuses() == warm_solver.variable_statuses())
+        << "seed " << seed;
+  }
+}
+
+// The basis of a problem is used on the same problem with one more demand
+// node, whose constraint and variables are unknown to the basis. The statuses
+// of the variables are also moved to the infinite upper bound, which must be
+// repaired.
+void TestModifiedProblem() {
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    LinearProgram lp;
+    BuildTransportationProblem(5, 8, seed, &lp);
+    LPSolver solver;
+    CHECK_EQ(ProblemStatus::OPTIMAL, solver.Solve(lp)) << "seed " << seed;
+    VariableStatusRow variable_statuses = solver.variable_statuses();
+    ConstraintStatusColumn constraint_statuses = solver.constraint_statuses();
+
+    LinearProgram modified_lp;
+    modified_lp.PopulateFromLinearProgram(lp);
+    const RowIndex demand = modified_lp.CreateNewConstraint();
+    modified_lp.SetConstraintBounds(demand, 10.0, 10.0);
+    constraint_statuses.push_back(ConstraintStatus::BASIC);
+    for (RowIndex supply(8); supply < RowIndex(13); ++supply) {
+      const ColIndex col = modified_lp.CreateNewVariable();
+      modified_lp.SetVariableBounds(col, 0.0, kInfinity);
+      modified_lp.SetObjectiveCoefficient(col, 100.0 * supply.value());
+      modified_lp.SetCoefficient(supply, col, 1.0);
+      modified_lp.SetCoefficient(demand, col, 1.0);
+      variable_statuses.push_back(VariableStatus::AT_LOWER_BOUND);
+    }
+    for (ColIndex col(0); col < variable_statuses.size(); col += 3) {
+      if (variable_statuses[col] == VariableStatus::AT_LOWER_BOUND) {
+        variable_statuses[col] = VariableStatus::AT_UPPER_BOUND;
+      }
+    }
+
+    LPSolver cold_solver;
+    CHECK_EQ(ProblemStatus::OPTIMAL, cold_solver.Solve(modified_lp));
+    LPSolver warm_solver;
+    warm_solver.SetParameters(WarmStartParameters());
+    warm_solver.SetInitialBasis(variable_statuses, constraint_statuses);
+    CHECK_EQ(ProblemStatus::OPTIMAL, warm_solver.Solve(modified_lp))
+        << "seed " << seed;
+    CheckSameObjective(cold_solver.GetObjectiveValue(),
+                       warm_solver.GetObjectiveValue(), seed);
+  }
+}
+
+// Adds to the problem a copy of one of its basic columns, with a relative
+// perturbation of one coefficient close to the machine precision, and makes
+// both of them basic. The basis is numerically singular, and only one of the
+// two columns can stay in it once repaired: the warm-start must not lose the
+// other basic columns.
+void TestSingularBasis() {
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    LinearProgram lp;
+    BuildTransportationProblem(5 + seed % 4, 8 + seed % 5, seed, &lp);
+    LPSolver solver;
+    CHECK_EQ(ProblemStatus::OPTIMAL, solver.Solve(lp)) << "seed " << seed;
+    VariableStatusRow variable_statuses = solver.variable_statuses();
+
+    ColIndex basic_col = kInvalidCol;
+    for (ColIndex col(0); col < lp.num_variables(); ++col) {
+      if (variable_statuses[col] == VariableStatus::BASIC) basic_col = col;
+    }
+    CHECK_NE(kInvalidCol, basic_col);
+    LinearProgram singular_lp;
+    singular_lp.PopulateFromLinearProgram(lp);
+    const ColIndex copy = singular_lp.CreateNewVariable();
+    singular_lp.SetVariableBounds(copy, 0.0, kInfinity);
+    singular_lp.SetObjectiveCoefficient(
+        copy, lp.objective_coefficients()[basic_col]);
+    bool is_first = true;
+    for (const SparseColumn::Entry e : lp.GetSparseColumn(basic_col)) {
+      singular_lp.SetCoefficient(
+          e.row(), copy, is_first ? e.coefficient() * (1.0 + 4e-16)
+                                  : e.coefficient());
+      is_first = false;
+    }
+    variable_statuses.push_back(VariableStatus::BASIC);
+
+    // Keep the number of basic variables, so that the only problem of the
+    // basis is its singularity.
+    for (ColIndex col(0); col < lp.num_variables(); ++col) {
+      if (col != basic_col &&
+          variable_statuses[col] == VariableStatus::BASIC) {
+        variable_statuses[col] = VariableStatus::AT_LOWER_BOUND;
+        break;
+      }
+    }
+
+    LPSolver warm_solver;
+    warm_solver.SetParameters(WarmStartParameters());
+    warm_solver.SetInitialBasis(variable_statuses,
+                                solver.constraint_statuses());
+    CHECK_EQ(ProblemStatus::OPTIMAL, warm_solver.Solve(singular_lp))
+        << "seed " << seed;
+    CheckSameObjective(solver.GetObjectiveValue(),
+                       warm_solver.GetObjectiveValue(), seed);
+    CHECK_LT(warm_solver.GetNumberOfSimplexIterations(),
+             solver.GetNumberOfSimplexIterations())
+        << "seed " << seed;
+    LOG(INFO) << "seed " << seed << ": "
+              << warm_solver.GetNumberOfSimplexIterations()
+              << " iterations from the singular basis, "
+              << solver.GetNumberOfSimplexIterations() << " from scratch.";
+  }
+}
+
+}  // namespace glop
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::glop::TestRoundTrip();
+  operations_research::glop::TestModifiedProblem();
+  operations_research::glop::TestSingularBasis();
+  return 0;
+}
@@ -0,0 +1,207 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Writes MPS files, plain and gzipped, and checks that the MPS reader loads
+// the same problem from both, with one and several threads. Also checks
+// that FileContents reports why a file can not be read.
+
+#include <stdio.h>
+#include <string>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "base/stringprintf.h"
+#include "lp_data/lp_data.h"
+#include "lp_data/mps_reader.h"
+#include "util/file_contents.h"
+#include "zlib.h"
+
+DECLARE_int32(mps_reader_threads);
+
+DEFINE_string(test_tmpdir, "/tmp", "Directory of the test files.");
+
+namespace operations_research {
+namespace glop {
+
+const char kSmallMps[] =
+    "NAME          TESTLP\n"
+    "ROWS\n"
+    " N  COST\n"
+    " L  LIM1\n"
+    " G  LIM2\n"
+    " E  MYEQN\n"
+    "COLUMNS\n"
+    "    XONE      COST               1.0   LIM1               1.0\n"
+    "    XONE      LIM2               1.0\n"
+    "    YTWO      COST               2.0   LIM1               1.0\n"
+    "    YTWO      MYEQN             -1.0\n"
+    "    ZTHREE    COST              -1.0   MYEQN              1.0\n"
+    "RHS\n"
+    "    RHS       LIM1               4.0   LIM2               1.0\n"
+    "    RHS       MYEQN              7.0\n"
+    "BOUNDS\n"
+    " UP BND       XONE               4.0\n"
+    " LO BND       YTWO              -1.0\n"
+    " UP BND       YTWO               1.0\n"
+    "ENDATA\n";
+
+// Returns an MPS file with enough columns to be parsed in several chunks.
+std::string LargeMps(int num_rows, int num_cols, int seed) {
+  ACMRandom random(seed);
+  std::string mps = "NAME          LARGE\nROWS\n N  COST\n";
+  for (int row = 0; row < num_rows; ++row) {
+    mps += StringPrintf(" L  R%d\n", row);
+  }
+  mps += "COLUMNS\n";
+  for (int col = 0; col < num_cols; ++col) {
+    mps += StringPrintf("    C%-7d  COST      %12d\n", col,
+                        1 + random.Uniform(1000));
+    for (int i = 0; i < 5; ++i) {
+      mps += StringPrintf("    C%-7d  R%-7d  %12d\n", col,
+                          random.Uniform(num_rows), 1 + random.Uniform(9));
+    }
+  }
+  mps += "RHS\n";
+  for (int row = 0; row < num_rows; ++row) {
+    mps += StringPrintf("    RHS       R%-7d  %12d\n", row,
+                        10 + random.Uniform(100));
+  }
+  mps += "ENDATA\n";
+  return mps;
+}
+
+void WriteFile(const std::string& file_name, const std::string& contents) {
+  FILE* const file = fopen(file_name.c_str(), "wb");
+  CHECK(file != nullptr) << file_name;
+  CHECK_EQ(contents.size(), fwrite(contents.data(), 1, contents.size(), file));
+  fclose(file);
+}
+
+void WriteGzipFile(const std::string& file_name, const std::string& contents) {
+  gzFile file = gzopen(file_name.c_str(), "wb");
+  CHECK(file != nullptr) << file_name;
+  CHECK_EQ(contents.size(), gzwrite(file, contents.data(), contents.size()));
+  gzclose(file);
+}
+
+void CheckSameProblem(const LinearProgram& a, const LinearProgram& b) {
+  CHECK_EQ(a.num_constraints(), b.num_constraints());
+  CHECK_EQ(a.num_variables(), b.num_variables());
+  CHECK_EQ(a.num_entries(), b.num_entries());
+  CHECK(a.constraint_lower_bounds() == b.constraint_lower_bounds());
+  CHECK(a.constraint_upper_bounds() == b.constraint_upper_bounds());
+  for (RowIndex row(0); row < a.num_constraints(); ++row) {
+    CHECK_EQ(a.GetConstraintName(row), b.GetConstraintName(row));
+  }
+  CHECK(a.variable_lower_bounds() == b.variable_lower_bounds());
+  CHECK(a.variable_upper_bounds() == b.variable_upper_bounds());
+  CHECK(a.objective_coefficients() == b.objective_coefficients());
+  for (ColIndex col(0); col < a.num_variables(); ++col) {
+    CHECK_EQ(a.GetVariableName(col), b.GetVariableName(col));
+    const SparseColumn& a_column = a.GetSparseColumn(col);
+    const SparseColumn& b_column = b.GetSparseColumn(col);
+    CHECK_EQ(a_column.num_entries(), b_column.num_entries());
+    for (EntryIndex i(0); i < a_column.num_entries(); ++i) {
+      CHECK_EQ(a_column.EntryRow(i), b_column.EntryRow(i));
+      CHECK_EQ(a_column.EntryCoefficient(i), b_column.EntryCoefficient(i));
+    }
+  }
+}
+
+void TestSmallFile() {
+  const std::string file_name = FLAGS_test_tmpdir + "/mps_reader_test.mps";
+  WriteFile(file_name, kSmallMps);
+  WriteGzipFile(file_name + ".gz", kSmallMps);
+  MPSReader reader;
+  LinearProgram plain;
+  CHECK(reader.LoadFile(file_name, &plain));
+  CHECK_EQ("TESTLP", reader.GetProblemName());
+  CHECK_EQ(RowIndex(3), plain.num_constraints());
+  CHECK_EQ(ColIndex(3), plain.num_variables());
+  CHECK_EQ(EntryIndex(5), plain.num_entries());
+  CHECK_EQ(4.0, plain.variable_upper_bounds()[ColIndex(0)]);
+  CHECK_EQ(-1.0, plain.variable_lower_bounds()[ColIndex(1)]);
+  CHECK_EQ(7.0, plain.constraint_lower_bounds()[RowIndex(2)]);
+  CHECK_EQ(7.0, plain.constraint_upper_bounds()[RowIndex(2)]);
+  LinearProgram gzipped;
+  CHECK(reader.LoadFile(file_name + ".gz", &gzipped));
+  CheckSameProblem(plain, gzipped);
+  remove(file_name.c_str());
+  remove((file_name + ".gz").c_str());
+}
+
+void TestLargeFile() {
+  const std::string file_name =
+      FLAGS_test_tmpdir + "/mps_reader_test_large.mps";
+  const std::string mps = LargeMps(1000, 40000, 0);
+  CHECK_GT(mps.size(), 4 << 20);
+  WriteFile(file_name, mps);
+  WriteGzipFile(file_name + ".gz", mps);
+  MPSReader reader;
+  LinearProgram expected;
+  FLAGS_mps_reader_threads = 1;
+  CHECK(reader.LoadFile(file_name, &expected));
+  CHECK_EQ(ColIndex(40000), expected.num_variables());
+  for (const int num_threads : {1, 4}) {
+    FLAGS_mps_reader_threads = num_threads;
+    LinearProgram plain;
+    CHECK(reader.LoadFile(file_name, &plain));
+    CheckSameProblem(expected, plain);
+    LinearProgram gzipped;
+    CHECK(reader.LoadFile(file_name + ".gz", &gzipped));
+    CheckSameProblem(expected, gzipped);
+  }
+  remove(file_name.c_str());
+  remove((file_name + ".gz").c_str());
+}
+
+void TestReadErrors() {
+  const std::string missing = FLAGS_test_tmpdir + "/mps_reader_test_missing";
+  for (const std::string& file_name : {missing, missing + ".gz"}) {
+    FileContents contents;
+    CHECK(!contents.Open(file_name));
+    CHECK_NE(std::string::npos,
+             contents.error_message().find("No such file or directory"))
+        << contents.error_message();
+  }
+
+  // A gzip file truncated in the middle of its compressed data.
+  const std::string truncated = FLAGS_test_tmpdir + "/mps_reader_test.mps.gz";
+  const std::string mps = LargeMps(100, 1000, 1);
+  WriteGzipFile(truncated, mps);
+  {
+    FILE* const file = fopen(truncated.c_str(), "rb");
+    CHECK(file != nullptr);
+    std::string data(1 << 20, '\0');
+    data.resize(fread(&data[0], 1, data.size(), file));
+    fclose(file);
+    WriteFile(truncated, data.substr(0, data.size() / 2));
+  }
+  FileContents contents;
+  CHECK(!contents.Open(truncated));
+  CHECK(!contents.error_message().empty());
+  LOG(INFO) << "Truncated file: " << contents.error_message();
+  remove(truncated.c_str());
+}
+
+}  // namespace glop
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::glop::TestSmallFile();
+  operations_research::glop::TestLargeFile();
+  operations_research::glop::TestReadErrors();
+  return 0;
+}
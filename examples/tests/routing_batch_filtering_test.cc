@@ -0,0 +1,157 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves small capacitated routing problems with optional nodes and span
+// costs, filtering batches of neighbors on the search thread and on several
+// threads. The thread-local filters must prune exactly the neighbors pruned by
+// the filters of the search thread, so all runs must find the same solution.
+// Batches generate neighbors ahead of the accepted one, which moves the
+// operators further than the non-batch path does; both paths must still
+// accept the same first improving neighbor.
+
+#include <vector>
+
+#include "base/callback.h"
+#include "base/commandlineflags.h"
+#include "base/integral_types.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "constraint_solver/routing.h"
+
+DECLARE_int32(cp_local_search_batch_size);
+DECLARE_int32(cp_local_search_batch_threads);
+DECLARE_int64(routing_solution_limit);
+DECLARE_bool(routing_cache_callbacks);
+DECLARE_bool(routing_no_lns);
+DECLARE_string(routing_first_solution);
+
+DEFINE_int32(num_instances, 5, "Number of random instances to solve.");
+
+namespace operations_research {
+
+class RandomInstance {
+ public:
+  RandomInstance(int num_nodes, int seed) {
+    ACMRandom random(seed);
+    for (int node = 0; node < num_nodes; ++node) {
+      x_.push_back(random.Uniform(1000));
+      y_.push_back(random.Uniform(1000));
+      demand_.push_back(node == 0 ? 0 : 1 + random.Uniform(5));
+    }
+  }
+  int64 Distance(RoutingModel::NodeIndex from,
+                 RoutingModel::NodeIndex to) const {
+    return std::abs(x_[from.value()] - x_[to.value()]) +
+           std::abs(y_[from.value()] - y_[to.value()]);
+  }
+  int64 Demand(RoutingModel::NodeIndex from,
+               RoutingModel::NodeIndex to) const {
+    return demand_[from.value()];
+  }
+
+ private:
+  std::vector<int64> x_;
+  std::vector<int64> y_;
+  std::vector<int64> demand_;
+};
+
+struct RoutingResult {
+  int64 objective_value;
+  std::vector<int64> nexts;
+  int64 filtered_neighbors;
+};
+
+RoutingResult SolveInstance(const RandomInstance& instance, int num_nodes,
+                            int batch_size, int num_threads,
+                            int64 solution_limit) {
+  FLAGS_cp_local_search_batch_size = batch_size;
+  FLAGS_cp_local_search_batch_threads = num_threads;
+  FLAGS_routing_solution_limit = solution_limit;
+  const int kNumVehicles = 4;
+  RoutingModel routing(num_nodes, kNumVehicles);
+  routing.SetDepot(RoutingModel::NodeIndex(0));
+  routing.SetArcCostEvaluatorOfAllVehicles(
+      NewPermanentCallback(&instance, &RandomInstance::Distance));
+  routing.AddDimension(NewPermanentCallback(&instance, &RandomInstance::Demand),
+                       0, 25, /*fix_start_cumul_to_zero=*/true, "Capacity");
+  routing.AddDimension(
+      NewPermanentCallback(&instance, &RandomInstance::Distance), 0, 10000,
+      /*fix_start_cumul_to_zero=*/true, "Distance");
+  // Span costs are checked by PathCumulFilter, penalties of optional nodes by
+  // NodeDisjunctionFilter; both of them add up to the arc costs.
+  routing.GetMutableDimension("Distance")
+      ->SetSpanCostCoefficientForAllVehicles(2);
+  for (int node = 1; node < num_nodes; ++node) {
+    routing.AddDisjunction(
+        std::vector<RoutingModel::NodeIndex>(1, RoutingModel::NodeIndex(node)),
+        3000);
+  }
+  const Assignment* const solution = routing.Solve();
+  CHECK(solution != nullptr);
+  RoutingResult result;
+  result.objective_value = solution->ObjectiveValue();
+  for (int i = 0; i < routing.Size(); ++i) {
+    result.nexts.push_back(solution->Value(routing.NextVar(i)));
+  }
+  result.filtered_neighbors = routing.solver()->filtered_neighbors();
+  return result;
+}
+
+void CheckSameSolutions(const RoutingResult& expected,
+                        const RoutingResult& result, int seed) {
+  CHECK_EQ(expected.objective_value, result.objective_value) << "seed "
+                                                             << seed;
+  CHECK(expected.nexts == result.nexts) << "seed " << seed;
+}
+
+void TestBatchFiltering() {
+  FLAGS_routing_first_solution = "PathCheapestArc";
+  FLAGS_routing_no_lns = true;
+  // The cached callbacks are shared by the filters of all the threads.
+  FLAGS_routing_cache_callbacks = true;
+  const int kNumNodes = 40;
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    const RandomInstance instance(kNumNodes, seed);
+    for (const int batch_size : {4, 16}) {
+      const RoutingResult serial =
+          SolveInstance(instance, kNumNodes, batch_size, 1, kint64max);
+      for (const int num_threads : {2, 3}) {
+        const RoutingResult threaded = SolveInstance(
+            instance, kNumNodes, batch_size, num_threads, kint64max);
+        CheckSameSolutions(serial, threaded, seed);
+        CHECK_EQ(serial.filtered_neighbors, threaded.filtered_neighbors)
+            << "seed " << seed << " threads " << num_threads;
+      }
+      // The first solution and the first improving neighbor.
+      const RoutingResult first_move =
+          SolveInstance(instance, kNumNodes, 1, 1, 2);
+      for (const int num_threads : {1, 3}) {
+        CheckSameSolutions(first_move,
+                           SolveInstance(instance, kNumNodes, batch_size,
+                                         num_threads, 2),
+                           seed);
+      }
+      LOG(INFO) << "seed " << seed << ", batch size " << batch_size
+                << ": cost " << serial.objective_value << ", "
+                << serial.filtered_neighbors << " filtered neighbors";
+    }
+  }
+}
+
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::TestBatchFiltering();
+  return 0;
+}
@@ -0,0 +1,207 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves small capacitated routing problems with local search neighbors
+// passed as Assignment objects and as flat deltas, with and without guided
+// local search (which reads the deltas). Both runs must explore the same
+// neighbors and find the same solution. A search monitor overriding
+// AcceptDelta() and a path filter overriding Accept() must see the same
+// deltas in both runs.
+
+#include <vector>
+
+#include "base/callback.h"
+#include "base/commandlineflags.h"
+#include "base/integral_types.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "constraint_solver/constraint_solver.h"
+#include "constraint_solver/routing.h"
+
+DECLARE_bool(cp_local_search_use_flat_deltas);
+DECLARE_bool(routing_guided_local_search);
+DECLARE_bool(routing_no_lns);
+DECLARE_int64(routing_solution_limit);
+DECLARE_string(routing_first_solution);
+
+DEFINE_int32(num_instances, 5, "Number of random instances to solve.");
+
+namespace operations_research {
+
+class RandomInstance {
+ public:
+  RandomInstance(int num_nodes, int seed) {
+    ACMRandom random(seed);
+    for (int node = 0; node < num_nodes; ++node) {
+      x_.push_back(random.Uniform(1000));
+      y_.push_back(random.Uniform(1000));
+      demand_.push_back(node == 0 ? 0 : 1 + random.Uniform(5));
+    }
+  }
+  int64 Distance(RoutingModel::NodeIndex from,
+                 RoutingModel::NodeIndex to) const {
+    return std::abs(x_[from.value()] - x_[to.value()]) +
+           std::abs(y_[from.value()] - y_[to.value()]);
+  }
+  int64 Demand(RoutingModel::NodeIndex from,
+               RoutingModel::NodeIndex to) const {
+    return demand_[from.value()];
+  }
+
+ private:
+  std::vector<int64> x_;
+  std::vector<int64> y_;
+  std::vector<int64> demand_;
+};
+
+// Counts the elements of the deltas given to AcceptDelta(). It doesn't
+// override UsesDeltas(), so it must be given the deltas of all neighbors.
+class DeltaCountingMonitor : public SearchMonitor {
+ public:
+  explicit DeltaCountingMonitor(Solver* const solver)
+      : SearchMonitor(solver), num_delta_elements_(0) {}
+  ~DeltaCountingMonitor() override {}
+  bool AcceptDelta(Assignment* delta, Assignment* deltadelta) override {
+    num_delta_elements_ += delta->IntVarContainer().Size();
+    return true;
+  }
+  int64 num_delta_elements() const { return num_delta_elements_; }
+
+ private:
+  int64 num_delta_elements_;
+};
+
+// Counts the elements of the deltas given to Accept(). Since it doesn't
+// override HasFlatAccept(), the AcceptFlat() method of BasePathFilter must not
+// be used instead.
+class DeltaCountingFilter : public BasePathFilter {
+ public:
+  explicit DeltaCountingFilter(const RoutingModel& routing)
+      : BasePathFilter(routing.Nexts(), routing.Size() + routing.vehicles(),
+                       nullptr),
+        num_delta_elements_(0) {}
+  ~DeltaCountingFilter() override {}
+  bool Accept(const Assignment* delta, const Assignment* deltadelta) override {
+    num_delta_elements_ += delta->IntVarContainer().Size();
+    return BasePathFilter::Accept(delta, deltadelta);
+  }
+  int64 num_delta_elements() const { return num_delta_elements_; }
+
+ private:
+  bool AcceptPath(int64 path_start, int64 chain_start,
+                  int64 chain_end) override {
+    return true;
+  }
+
+  int64 num_delta_elements_;
+};
+
+struct RoutingResult {
+  int64 objective_value;
+  std::vector<int64> nexts;
+  int64 neighbors;
+  int64 filtered_neighbors;
+  int64 accepted_neighbors;
+  int64 monitor_delta_elements;
+  int64 filter_delta_elements;
+};
+
+RoutingResult SolveInstance(const RandomInstance& instance, int num_nodes,
+                            bool use_flat_deltas, bool use_gls,
+                            bool use_counters) {
+  FLAGS_cp_local_search_use_flat_deltas = use_flat_deltas;
+  FLAGS_routing_guided_local_search = use_gls;
+  FLAGS_routing_solution_limit = use_gls ? 100 : kint64max;
+  const int kNumVehicles = 4;
+  RoutingModel routing(num_nodes, kNumVehicles);
+  routing.SetDepot(RoutingModel::NodeIndex(0));
+  routing.SetArcCostEvaluatorOfAllVehicles(
+      NewPermanentCallback(&instance, &RandomInstance::Distance));
+  routing.AddDimension(NewPermanentCallback(&instance, &RandomInstance::Demand),
+                       0, 25, /*fix_start_cumul_to_zero=*/true, "Capacity");
+  for (int node = 1; node < num_nodes; ++node) {
+    routing.AddDisjunction(
+        std::vector<RoutingModel::NodeIndex>(1, RoutingModel::NodeIndex(node)),
+        3000);
+  }
+  DeltaCountingMonitor* monitor = nullptr;
+  DeltaCountingFilter* filter = nullptr;
+  if (use_counters) {
+    monitor = routing.solver()->RevAlloc(
+        new DeltaCountingMonitor(routing.solver()));
+    routing.AddSearchMonitor(monitor);
+    filter = routing.solver()->RevAlloc(new DeltaCountingFilter(routing));
+    routing.AddLocalSearchFilter(filter);
+  }
+  const Assignment* const solution = routing.Solve();
+  CHECK(solution != nullptr);
+  RoutingResult result;
+  result.objective_value = solution->ObjectiveValue();
+  for (int i = 0; i < routing.Size(); ++i) {
+    result.nexts.push_back(solution->Value(routing.NextVar(i)));
+  }
+  Solver* const solver = routing.solver();
+  result.neighbors = solver->neighbors();
+  result.filtered_neighbors = solver->filtered_neighbors();
+  result.accepted_neighbors = solver->accepted_neighbors();
+  result.monitor_delta_elements =
+      monitor == nullptr ? 0 : monitor->num_delta_elements();
+  result.filter_delta_elements =
+      filter == nullptr ? 0 : filter->num_delta_elements();
+  return result;
+}
+
+void TestFlatDeltas() {
+  FLAGS_routing_first_solution = "PathCheapestArc";
+  FLAGS_routing_no_lns = true;
+  const int kNumNodes = 40;
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    const RandomInstance instance(kNumNodes, seed);
+    for (const bool use_gls : {false, true}) {
+      for (const bool use_counters : {false, true}) {
+        const RoutingResult expected =
+            SolveInstance(instance, kNumNodes, false, use_gls, use_counters);
+        const RoutingResult flat =
+            SolveInstance(instance, kNumNodes, true, use_gls, use_counters);
+        CHECK_EQ(expected.objective_value, flat.objective_value)
+            << "seed " << seed << " gls " << use_gls;
+        CHECK(expected.nexts == flat.nexts) << "seed " << seed << " gls "
+                                            << use_gls;
+        CHECK_EQ(expected.neighbors, flat.neighbors) << "seed " << seed;
+        CHECK_EQ(expected.filtered_neighbors, flat.filtered_neighbors)
+            << "seed " << seed;
+        CHECK_EQ(expected.accepted_neighbors, flat.accepted_neighbors)
+            << "seed " << seed;
+        CHECK_EQ(expected.monitor_delta_elements, flat.monitor_delta_elements)
+            << "seed " << seed;
+        CHECK_EQ(expected.filter_delta_elements, flat.filter_delta_elements)
+            << "seed " << seed;
+        if (use_counters) {
+          CHECK_GT(flat.monitor_delta_elements, 0) << "seed " << seed;
+          CHECK_GT(flat.filter_delta_elements, 0) << "seed " << seed;
+        }
+        LOG(INFO) << "seed " << seed << (use_gls ? ", gls" : "") << ": cost "
+                  << flat.objective_value << ", " << flat.neighbors
+                  << " neighbors";
+      }
+    }
+  }
+}
+
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::TestFlatDeltas();
+  return 0;
+}
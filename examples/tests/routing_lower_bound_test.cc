@@ -0,0 +1,113 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks that the lower bounds computed by RoutingModel are not greater than
+// the optimal tour length of small random TSPs, solved by enumeration. On
+// metric instances, the Held-Karp bound must also be at least half of the
+// optimum, as it is greater than the weight of a minimum spanning tree.
+
+#include <algorithm>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/commandlineflags.h"
+#include "base/integral_types.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "constraint_solver/routing.h"
+
+DECLARE_int32(routing_lower_bound_threads);
+
+DEFINE_int32(num_instances, 20, "Number of random instances of each size.");
+
+namespace operations_research {
+
+class RandomTsp {
+ public:
+  // Manhattan distances between random points if 'symmetric' is true,
+  // otherwise independent random costs for each arc.
+  RandomTsp(int num_nodes, bool symmetric, int seed)
+      : costs_(num_nodes, std::vector<int64>(num_nodes, 0)) {
+    ACMRandom random(seed);
+    std::vector<int64> x;
+    std::vector<int64> y;
+    for (int node = 0; node < num_nodes; ++node) {
+      x.push_back(random.Uniform(1000));
+      y.push_back(random.Uniform(1000));
+    }
+    for (int from = 0; from < num_nodes; ++from) {
+      for (int to = 0; to < num_nodes; ++to) {
+        if (from == to) continue;
+        costs_[from][to] = symmetric ? std::abs(x[from] - x[to]) +
+                                           std::abs(y[from] - y[to])
+                                     : random.Uniform(1000);
+      }
+    }
+  }
+  int64 Cost(RoutingModel::NodeIndex from, RoutingModel::NodeIndex to) const {
+    return costs_[from.value()][to.value()];
+  }
+  // Returns the length of the shortest tour starting and ending at node 0.
+  int64 OptimalTourLength() const {
+    std::vector<int> nodes;
+    for (int node = 1; node < costs_.size(); ++node) nodes.push_back(node);
+    int64 best = kint64max;
+    do {
+      int64 length = costs_[0][nodes.front()] + costs_[nodes.back()][0];
+      for (int i = 0; i + 1 < nodes.size(); ++i) {
+        length += costs_[nodes[i]][nodes[i + 1]];
+      }
+      best = std::min(best, length);
+    } while (std::next_permutation(nodes.begin(), nodes.end()));
+    return best;
+  }
+
+ private:
+  std::vector<std::vector<int64>> costs_;
+};
+
+void TestLowerBounds() {
+  for (int num_nodes = 3; num_nodes <= 9; ++num_nodes) {
+    for (const bool symmetric : {true, false}) {
+      for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+        const RandomTsp tsp(num_nodes, symmetric, seed);
+        const int64 optimum = tsp.OptimalTourLength();
+        for (const int num_threads : {1, 3}) {
+          FLAGS_routing_lower_bound_threads = num_threads;
+          RoutingModel routing(num_nodes, 1);
+          routing.SetDepot(RoutingModel::NodeIndex(0));
+          routing.SetArcCostEvaluatorOfAllVehicles(
+              NewPermanentCallback(&tsp, &RandomTsp::Cost));
+          routing.CloseModel();
+          const int64 bound = routing.ComputeLowerBound();
+          CHECK_LE(bound, optimum) << num_nodes << " nodes, seed " << seed;
+          if (symmetric) {
+            CHECK_GE(2 * bound, optimum) << num_nodes << " nodes, seed "
+                                         << seed;
+          }
+          CHECK_LE(routing.ComputeLinearAssignmentLowerBound(), optimum)
+              << num_nodes << " nodes, seed " << seed;
+        }
+      }
+    }
+    LOG(INFO) << "Checked the bounds of TSPs with " << num_nodes << " nodes.";
+  }
+}
+
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::TestLowerBounds();
+  return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks that the recently used clauses of the second tier survive the clause
+// database cleanups, and that they are deleted once unused. The deletions are
+// observed in the DRAT proof of the solver on a random UNSAT 3-SAT instance.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "base/commandlineflags.h"
+#include "base/file.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "sat/drat_writer.h"
+#include "sat/sat_base.h"
+#include "sat/sat_parameters.pb.h"
+#include "sat/sat_solver.h"
+
+DEFINE_int32(num_variables, 100, "Number of variables of the instance.");
+DEFINE_string(test_tmpdir, "/tmp", "Directory of the test files.");
+
+namespace operations_research {
+namespace sat {
+
+typedef std::vector<std::vector<Literal>> Clauses;
+
+// Returns random 3-clauses over distinct variables, with a ratio of clauses to
+// variables of 5 which gives an UNSAT instance.
+Clauses RandomClauses(int num_variables, MTRandom* random) {
+  Clauses clauses(5 * num_variables);
+  for (std::vector<Literal>& clause : clauses) {
+    while (clause.size() < 3) {
+      const VariableIndex var(random->Uniform(num_variables));
+      bool is_new = true;
+      for (const Literal literal : clause) is_new &= literal.Variable() != var;
+      if (is_new) clause.push_back(Literal(var, random->OneIn(2)));
+    }
+  }
+  return clauses;
+}
+
+// Returns the number of clauses deleted by the cleanups in the DRAT proof of
+// the given solve. The other deletions, done by the level-zero simplification,
+// are of clauses with a fixed variable, which always appears in the proof as a
+// unit clause before.
+int NumCleanupDeletions(const Clauses& clauses,
+                        const SatParameters& parameters) {
+  const std::string file_name =
+      FLAGS_test_tmpdir + "/sat_clause_cleanup_test.drat";
+  File* const file = File::OpenOrDie(file_name, "w");
+  {
+    DratWriter writer(file);
+    SatSolver solver;
+    solver.SetParameters(parameters);
+    solver.SetDratWriter(&writer);
+    solver.SetNumVariables(FLAGS_num_variables);
+    for (const std::vector<Literal>& clause : clauses) {
+      if (!solver.AddProblemClause(clause)) break;
+    }
+    CHECK_EQ(SatSolver::MODEL_UNSAT, solver.Solve());
+  }
+  CHECK(file->Close());
+  delete file;
+  std::string proof;
+  CHECK(file::GetContents(file_name, &proof, file::Defaults()).ok());
+  remove(file_name.c_str());
+
+  // Decode the binary DRAT proof, see drat_writer.h.
+  std::vector<bool> is_fixed(FLAGS_num_variables + 1, false);
+  int num_cleanup_deletions = 0;
+  int index = 0;
+  while (index < proof.size()) {
+    const char type = proof[index++];
+    CHECK(type == 'a' || type == 'd');
+    std::vector<int> variables;
+    while (true) {
+      uint32 encoded = 0;
+      int shift = 0;
+      uint8 byte;
+      do {
+        byte = static_cast<uint8>(proof[index++]);
+        encoded |= static_cast<uint32>(byte & 127) << shift;
+        shift += 7;
+      } while (byte & 128);
+      if (encoded == 0) break;
+      variables.push_back(encoded / 2);
+    }
+    if (type == 'a' && variables.size() == 1) is_fixed[variables[0]] = true;
+    if (type == 'd') {
+      bool has_fixed_variable = false;
+      for (const int var : variables) has_fixed_variable |= is_fixed[var];
+      if (!has_fixed_variable) ++num_cleanup_deletions;
+    }
+  }
+  return num_cleanup_deletions;
+}
+
+// Parameters with frequent cleanups that keep as few clauses as possible, and
+// with the given second tier.
+SatParameters CleanupParameters(int tier2_lbd_bound, int max_unused_conflicts) {
+  SatParameters parameters;
+  parameters.set_subsumption_during_conflict_analysis(false);
+  parameters.set_clause_cleanup_period(100);
+  parameters.set_clause_cleanup_target(1);
+  parameters.set_clause_cleanup_lbd_bound(2);
+  parameters.set_clause_cleanup_tier2_lbd_bound(tier2_lbd_bound);
+  parameters.set_clause_cleanup_tier2_max_unused_conflicts(
+      max_unused_conflicts);
+  return parameters;
+}
+
+void TestSecondTier() {
+  MTRandom random(0);
+  const Clauses clauses = RandomClauses(FLAGS_num_variables, &random);
+
+  // Without a second tier, the cleanups delete clauses.
+  const int num_deletions_without_tier2 =
+      NumCleanupDeletions(clauses, CleanupParameters(2, 0));
+  CHECK_GT(num_deletions_without_tier2, 0);
+
+  // All the clauses are in the second tier and never stop being recently used,
+  // so no cleanup deletes any of them.
+  CHECK_EQ(0, NumCleanupDeletions(clauses, CleanupParameters(1000, 1000000)));
+
+  // Once unused during 100 conflicts, the clauses can be deleted again.
+  const int num_deletions_with_expiry =
+      NumCleanupDeletions(clauses, CleanupParameters(1000, 100));
+  CHECK_GT(num_deletions_with_expiry, 0);
+  LOG(INFO) << num_deletions_without_tier2 << " deletions without tier 2, "
+            << num_deletions_with_expiry << " with tier-2 clauses unused "
+            << "during 100 conflicts.";
+}
+
+}  // namespace sat
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::sat::TestSecondTier();
+  return 0;
+}
@@ -0,0 +1,158 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves a sequence of random problems in one solver by adding and removing
+// clause groups between the solves. After each step, the result must agree
+// with a fresh solver given only the permanent clauses, the clauses of the
+// active groups and the assumptions, and the model must satisfy all of them.
+
+#include <vector>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "sat/sat_parameters.pb.h"
+#include "sat/sat_solver.h"
+
+DEFINE_int32(num_variables, 60, "Number of variables of each instance.");
+DEFINE_int32(num_instances, 50, "Number of random instances to solve.");
+DEFINE_int32(num_steps, 30, "Number of solves of each instance.");
+
+namespace operations_research {
+namespace sat {
+
+typedef std::vector<std::vector<Literal>> Clauses;
+
+Clauses RandomClauses(int num_variables, int num_clauses, MTRandom* random) {
+  Clauses clauses(num_clauses);
+  for (std::vector<Literal>& clause : clauses) {
+    for (int i = 0; i < 3; ++i) {
+      clause.push_back(Literal(VariableIndex(random->Uniform(num_variables)),
+                               random->OneIn(2)));
+    }
+  }
+  return clauses;
+}
+
+struct ClauseGroup {
+  Literal selector;
+  Clauses clauses;
+};
+
+bool IsSatisfied(const VariablesAssignment& assignment,
+                 const Clauses& clauses) {
+  for (const std::vector<Literal>& clause : clauses) {
+    bool is_satisfied = false;
+    for (const Literal literal : clause) {
+      is_satisfied |= assignment.LiteralIsTrue(literal);
+    }
+    if (!is_satisfied) return false;
+  }
+  return true;
+}
+
+// Returns true if the given clauses and assumptions are SAT.
+bool IsSatWithFreshSolver(int num_variables, const Clauses& clauses,
+                          const std::vector<Literal>& assumptions) {
+  SatSolver solver;
+  solver.SetNumVariables(num_variables);
+  for (const std::vector<Literal>& clause : clauses) {
+    if (!solver.AddProblemClause(clause)) return false;
+  }
+  for (const Literal literal : assumptions) {
+    if (!solver.AddUnitClause(literal)) return false;
+  }
+  return solver.Solve() == SatSolver::MODEL_SAT;
+}
+
+void TestAgainstFreshSolver(bool use_inprocessing) {
+  int num_sat = 0;
+  int num_unsat = 0;
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    MTRandom random(seed);
+    const int num_variables = FLAGS_num_variables;
+    SatParameters parameters;
+    parameters.set_use_inprocessing(use_inprocessing);
+    parameters.set_inprocessing_min_deterministic_time_between_rounds(0.001);
+    SatSolver solver;
+    solver.SetParameters(parameters);
+    solver.SetNumVariables(num_variables);
+
+    // The permanent clauses are easily SAT, each group brings the ratio of
+    // clauses to variables 0.8 higher, so that a few of them make it UNSAT.
+    const Clauses permanent =
+        RandomClauses(num_variables, 2 * num_variables, &random);
+    for (const std::vector<Literal>& clause : permanent) {
+      CHECK(solver.AddProblemClause(clause));
+    }
+    std::vector<ClauseGroup> groups;
+    for (int step = 0; step < FLAGS_num_steps; ++step) {
+      if (!groups.empty() && random.OneIn(2)) {
+        const int index = random.Uniform(groups.size());
+        solver.RemoveClauseGroup(groups[index].selector);
+        groups.erase(groups.begin() + index);
+      } else {
+        ClauseGroup group;
+        group.selector = solver.NewClauseGroup();
+        group.clauses =
+            RandomClauses(num_variables, 4 * num_variables / 5, &random);
+        for (const std::vector<Literal>& clause : group.clauses) {
+          CHECK(solver.AddClauseToGroup(group.selector, clause));
+        }
+        groups.push_back(group);
+      }
+      std::vector<Literal> assumptions;
+      if (random.OneIn(3)) {
+        assumptions.push_back(Literal(
+            VariableIndex(random.Uniform(num_variables)), random.OneIn(2)));
+      }
+
+      Clauses clauses = permanent;
+      for (const ClauseGroup& group : groups) {
+        clauses.insert(clauses.end(), group.clauses.begin(),
+                       group.clauses.end());
+      }
+      const bool is_sat =
+          IsSatWithFreshSolver(num_variables, clauses, assumptions);
+      const SatSolver::Status status = solver.SolveIncrementally(assumptions);
+      if (is_sat) {
+        CHECK_EQ(SatSolver::MODEL_SAT, status)
+            << "seed " << seed << ", step " << step;
+        CHECK(IsSatisfied(solver.Assignment(), clauses))
+            << "seed " << seed << ", step " << step;
+        for (const Literal literal : assumptions) {
+          CHECK(solver.Assignment().LiteralIsTrue(literal));
+        }
+        ++num_sat;
+      } else {
+        CHECK(status == SatSolver::ASSUMPTIONS_UNSAT ||
+              status == SatSolver::MODEL_UNSAT)
+            << "seed " << seed << ", step " << step << ": "
+            << SatStatusString(status);
+        ++num_unsat;
+      }
+    }
+  }
+  LOG(INFO) << "Inprocessing " << use_inprocessing << ": " << num_sat
+            << " SAT and " << num_unsat << " UNSAT solves.";
+}
+
+}  // namespace sat
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::sat::TestAgainstFreshSolver(false);
+  operations_research::sat::TestAgainstFreshSolver(true);
+  return 0;
+}
@@ -0,0 +1,110 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the binary DRAT proofs written by DratWriter, and by the SAT solver
+// on a small UNSAT instance, against hand-written byte streams.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "base/commandlineflags.h"
+#include "base/file.h"
+#include "base/logging.h"
+#include "sat/drat_writer.h"
+#include "sat/sat_base.h"
+#include "sat/sat_parameters.pb.h"
+#include "sat/sat_solver.h"
+
+DEFINE_string(test_tmpdir, "/tmp", "Directory of the test files.");
+
+namespace operations_research {
+namespace sat {
+
+std::string ReadProof(const std::string& file_name) {
+  std::string contents;
+  CHECK(file::GetContents(file_name, &contents, file::Defaults()).ok());
+  remove(file_name.c_str());
+  return contents;
+}
+
+void CheckSameBytes(const std::string& expected, const std::string& actual) {
+  CHECK_EQ(expected.size(), actual.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    CHECK_EQ(static_cast<int>(expected[i]), static_cast<int>(actual[i]))
+        << "byte " << i;
+  }
+}
+
+// A literal x is written as 2 * |x| + (x < 0) with 7 bits per byte, lowest
+// bits first, the high bit telling that more bytes follow.
+void TestEncoding() {
+  const std::string file_name = FLAGS_test_tmpdir + "/sat_drat_test.drat";
+  File* const file = File::OpenOrDie(file_name, "w");
+  {
+    DratWriter writer(file);
+    const std::vector<Literal> added = {Literal(1), Literal(-2), Literal(100)};
+    writer.AddClause(ClauseRef(added));
+    const std::vector<Literal> deleted = {Literal(-64), Literal(8192)};
+    writer.DeleteClause(ClauseRef(deleted));
+    writer.AddClause(ClauseRef());
+    CHECK_EQ(15, writer.NumBytes());
+  }
+  CHECK(file->Close());
+  delete file;
+  const char kExpected[] = {
+      'a', 0x02, 0x05, static_cast<char>(0xc8), 0x01, 0x00,
+      'd', static_cast<char>(0x81), 0x01, static_cast<char>(0x80),
+      static_cast<char>(0x80), 0x01, 0x00,
+      'a', 0x00};
+  CheckSameBytes(std::string(kExpected, sizeof(kExpected)),
+                 ReadProof(file_name));
+}
+
+// All the four clauses over x1 and x2. The first decision is not(x1), which
+// propagates x2 and not(x2) through the first two clauses. The conflict is
+// resolved into the unit clause x1, which at level zero propagates x2 and
+// not(x2) through the two other clauses: the model is UNSAT.
+void TestSolverProof() {
+  const std::string file_name = FLAGS_test_tmpdir + "/sat_drat_test.drat";
+  File* const file = File::OpenOrDie(file_name, "w");
+  {
+    DratWriter writer(file);
+    SatParameters parameters;
+    parameters.set_initial_polarity(SatParameters::POLARITY_FALSE);
+    SatSolver solver;
+    solver.SetParameters(parameters);
+    solver.SetDratWriter(&writer);
+    solver.SetNumVariables(2);
+    CHECK(solver.AddBinaryClause(Literal(1), Literal(2)));
+    CHECK(solver.AddBinaryClause(Literal(1), Literal(-2)));
+    CHECK(solver.AddBinaryClause(Literal(-1), Literal(2)));
+    CHECK(solver.AddBinaryClause(Literal(-1), Literal(-2)));
+    CHECK_EQ(SatSolver::MODEL_UNSAT, solver.Solve());
+  }
+  CHECK(file->Close());
+  delete file;
+  const char kExpected[] = {'a', 0x02, 0x00, 'a', 0x00};
+  CheckSameBytes(std::string(kExpected, sizeof(kExpected)),
+                 ReadProof(file_name));
+}
+
+}  // namespace sat
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::sat::TestEncoding();
+  operations_research::sat::TestSolverProof();
+  return 0;
+}
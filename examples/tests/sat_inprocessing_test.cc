@@ -0,0 +1,107 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves random 3-SAT instances around the satisfiability threshold with and
+// without inprocessing, and checks that all the runs agree and that the
+// returned models satisfy all the clauses.
+
+#include <vector>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "sat/sat_parameters.pb.h"
+#include "sat/sat_solver.h"
+
+DEFINE_int32(num_variables, 150, "Number of variables of each instance.");
+DEFINE_int32(num_instances, 200, "Number of random instances to solve.");
+
+namespace operations_research {
+namespace sat {
+
+typedef std::vector<std::vector<Literal>> Clauses;
+
+Clauses RandomClauses(int num_variables, MTRandom* random) {
+  // Ratios between 4.0 and 4.6 give a mix of sat and unsat instances.
+  const int num_clauses = num_variables * (40 + random->Uniform(7)) / 10;
+  Clauses clauses(num_clauses);
+  for (std::vector<Literal>& clause : clauses) {
+    for (int i = 0; i < 3; ++i) {
+      clause.push_back(Literal(VariableIndex(random->Uniform(num_variables)),
+                               random->OneIn(2)));
+    }
+  }
+  return clauses;
+}
+
+// Returns the solver status. If a model is found, it is checked against the
+// given clauses.
+SatSolver::Status Solve(int num_variables, const Clauses& clauses,
+                        bool use_inprocessing, bool use_bve) {
+  SatParameters parameters;
+  parameters.set_use_inprocessing(use_inprocessing);
+  parameters.set_inprocessing_use_bve(use_bve);
+
+  // Run an inprocessing round at almost every restart.
+  parameters.set_inprocessing_min_deterministic_time_between_rounds(0.001);
+  parameters.set_inprocessing_deterministic_time_ratio(1.0);
+  parameters.add_restart_algorithms(SatParameters::LUBY_RESTART);
+  parameters.set_luby_restart_period(5);
+  SatSolver solver;
+  solver.SetParameters(parameters);
+  solver.SetNumVariables(num_variables);
+  for (const std::vector<Literal>& clause : clauses) {
+    if (!solver.AddProblemClause(clause)) return SatSolver::MODEL_UNSAT;
+  }
+  const SatSolver::Status status = solver.Solve();
+  if (status == SatSolver::MODEL_SAT) {
+    const VariablesAssignment& assignment = solver.Assignment();
+    for (const std::vector<Literal>& clause : clauses) {
+      bool is_satisfied = false;
+      for (const Literal literal : clause) {
+        is_satisfied |= assignment.LiteralIsTrue(literal);
+      }
+      CHECK(is_satisfied) << "The model falsifies a clause.";
+    }
+  }
+  return status;
+}
+
+void TestInprocessing() {
+  int num_sat = 0;
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    MTRandom random(seed);
+    const Clauses clauses = RandomClauses(FLAGS_num_variables, &random);
+    const SatSolver::Status reference =
+        Solve(FLAGS_num_variables, clauses, /*use_inprocessing=*/false,
+              /*use_bve=*/false);
+    for (const bool use_bve : {false, true}) {
+      const SatSolver::Status status =
+          Solve(FLAGS_num_variables, clauses, /*use_inprocessing=*/true,
+                use_bve);
+      CHECK_EQ(reference, status) << "seed " << seed << " bve " << use_bve;
+    }
+    if (reference == SatSolver::MODEL_SAT) ++num_sat;
+  }
+  LOG(INFO) << "Solved " << FLAGS_num_instances << " instances, " << num_sat
+            << " of them satisfiable.";
+}
+
+}  // namespace sat
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::sat::TestInprocessing();
+  return 0;
+}
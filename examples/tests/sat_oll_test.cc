@@ -0,0 +1,143 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Solves small random weighted MaxSAT problems with SolveWithOLL(), with one
+// and several core extraction threads, and checks the result against the
+// optimum found by enumerating all the assignments. Some of the instances have
+// an infeasible hard part, which must be reported as MODEL_UNSAT.
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "base/commandlineflags.h"
+#include "base/integral_types.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "sat/boolean_problem.h"
+#include "sat/boolean_problem.pb.h"
+#include "sat/optimization.h"
+#include "sat/sat_parameters.pb.h"
+#include "sat/sat_solver.h"
+
+DEFINE_int32(num_variables, 12, "Number of variables of each instance.");
+DEFINE_int32(num_instances, 100, "Number of random instances to solve.");
+
+namespace operations_research {
+namespace sat {
+
+// Returns a problem whose hard part is made of random 3-clauses, and whose
+// objective gives a random weight to each variable. The number of clauses
+// goes from a mostly feasible to a mostly infeasible hard part.
+LinearBooleanProblem RandomProblem(int num_variables, MTRandom* random) {
+  LinearBooleanProblem problem;
+  problem.set_num_variables(num_variables);
+  const int num_clauses = num_variables * (30 + random->Uniform(50)) / 10;
+  for (int i = 0; i < num_clauses; ++i) {
+    // The variables of a clause must be distinct for the problem to be valid.
+    std::vector<int> variables;
+    while (variables.size() < 3) {
+      const int var = 1 + random->Uniform(num_variables);
+      if (std::find(variables.begin(), variables.end(), var) ==
+          variables.end()) {
+        variables.push_back(var);
+      }
+    }
+    LinearBooleanConstraint* constraint = problem.add_constraints();
+    for (const int var : variables) {
+      constraint->add_literals(random->OneIn(2) ? var : -var);
+      constraint->add_coefficients(1);
+    }
+    constraint->set_lower_bound(1);
+  }
+  LinearObjective* objective = problem.mutable_objective();
+  for (int var = 0; var < num_variables; ++var) {
+    objective->add_literals(var + 1);
+    objective->add_coefficients(1 + random->Uniform(20));
+  }
+  return problem;
+}
+
+// Same as IsAssignmentValid() for clauses, but without logging the violated
+// ones since most of the enumerated assignments violate some.
+bool SatisfiesAllClauses(const LinearBooleanProblem& problem,
+                         const std::vector<bool>& assignment) {
+  for (const LinearBooleanConstraint& constraint : problem.constraints()) {
+    bool is_satisfied = false;
+    for (const int literal : constraint.literals()) {
+      is_satisfied |= assignment[std::abs(literal) - 1] == (literal > 0);
+    }
+    if (!is_satisfied) return false;
+  }
+  return true;
+}
+
+// Returns the optimal objective value of the problem, or -1 if its hard part
+// is infeasible.
+int64 OptimalObjective(const LinearBooleanProblem& problem) {
+  const int num_variables = problem.num_variables();
+  int64 best = -1;
+  std::vector<bool> assignment(num_variables);
+  for (int mask = 0; mask < (1 << num_variables); ++mask) {
+    for (int var = 0; var < num_variables; ++var) {
+      assignment[var] = (mask >> var) & 1;
+    }
+    if (!SatisfiesAllClauses(problem, assignment)) continue;
+    const int64 objective = ComputeObjectiveValue(problem, assignment).value();
+    if (best == -1 || objective < best) best = objective;
+  }
+  return best;
+}
+
+void TestAgainstEnumeration() {
+  int num_unsat = 0;
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    MTRandom random(seed);
+    const LinearBooleanProblem problem =
+        RandomProblem(FLAGS_num_variables, &random);
+    const int64 optimum = OptimalObjective(problem);
+    if (optimum == -1) ++num_unsat;
+    for (const int num_threads : {1, 4}) {
+      SatParameters parameters;
+      parameters.set_max_sat_num_core_extraction_threads(num_threads);
+      SatSolver solver;
+      solver.SetParameters(parameters);
+      SatSolver::Status status = SatSolver::MODEL_UNSAT;
+      std::vector<bool> solution;
+      if (LoadBooleanProblem(problem, &solver)) {
+        status = SolveWithOLL(DEFAULT_LOG, problem, &solver, &solution);
+      }
+      if (optimum == -1) {
+        CHECK_EQ(SatSolver::MODEL_UNSAT, status)
+            << "seed " << seed << ", " << num_threads << " threads";
+        continue;
+      }
+      CHECK_EQ(SatSolver::MODEL_SAT, status)
+          << "seed " << seed << ", " << num_threads << " threads";
+      CHECK(IsAssignmentValid(problem, solution)) << "seed " << seed;
+      CHECK_EQ(optimum, ComputeObjectiveValue(problem, solution).value())
+          << "seed " << seed << ", " << num_threads << " threads";
+    }
+  }
+  LOG(INFO) << "Solved " << FLAGS_num_instances << " instances, " << num_unsat
+            << " of them with an infeasible hard part.";
+}
+
+}  // namespace sat
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::sat::TestAgainstEnumeration();
+  return 0;
+}
@@ -0,0 +1,376 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Writes random cnf, wcnf and opb files, plain and gzipped, and checks that
+// SatCnfReader and OpbReader load the same problem from both as the line by
+// line parsing with FileLines they used before. A cnf file with several
+// clauses per line, or a clause over several lines, must also give the same
+// problem.
+
+#include <stdio.h>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/commandlineflags.h"
+#include "base/integral_types.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "base/split.h"
+#include "base/stringprintf.h"
+#include "base/strtoint.h"
+#include "cpp/opb_reader.h"
+#include "cpp/sat_cnf_reader.h"
+#include "sat/boolean_problem.h"
+#include "sat/boolean_problem.pb.h"
+#include "sat/sat_solver.h"
+#include "util/filelineiter.h"
+#include "zlib.h"
+
+DEFINE_int32(num_instances, 20, "Number of random files of each format.");
+DEFINE_string(test_tmpdir, "/tmp", "Directory of the test files.");
+
+namespace operations_research {
+namespace sat {
+
+// The parsing of SatCnfReader::Load() with FileLines, where each line holds
+// exactly one clause. The wcnf soft clauses are converted in the same way.
+void LoadCnfWithFileLines(const std::string& filename,
+                          LinearBooleanProblem* problem) {
+  problem->Clear();
+  std::map<int, int64> positive_literal_to_weight;
+  int64 objective_offset = 0;
+  int num_variables = 0;
+  int num_slack_variables = 0;
+  bool is_wcnf = false;
+  int64 hard_weight = 0;
+  for (const std::string& line : FileLines(filename)) {
+    const std::vector<std::string> words =
+        strings::Split(line, " ", strings::SkipEmpty());
+    if (words.empty() || words[0] == "c") continue;
+    if (words[0] == "%") break;
+    if (words[0] == "p") {
+      num_variables = atoi32(words[2]);
+      is_wcnf = words[1] == "wcnf";
+      if (is_wcnf) hard_weight = atoi64(words[4]);
+      continue;
+    }
+    CHECK_EQ("0", words.back());
+    const int64 weight = is_wcnf ? atoi64(words[0]) : hard_weight;
+    std::vector<int> literals;
+    for (int i = is_wcnf ? 1 : 0; i + 1 < words.size(); ++i) {
+      literals.push_back(atoi32(words[i]));
+    }
+    if (weight != hard_weight && literals.size() == 1) {
+      const int literal = -literals[0];
+      if (literal > 0) {
+        positive_literal_to_weight[literal] += weight;
+      } else {
+        positive_literal_to_weight[-literal] -= weight;
+        objective_offset += weight;
+      }
+      continue;
+    }
+    LinearBooleanConstraint* constraint = problem->add_constraints();
+    constraint->set_lower_bound(1);
+    for (const int literal : literals) {
+      constraint->add_literals(literal);
+      constraint->add_coefficients(1);
+    }
+    if (weight == hard_weight) continue;
+    const int slack_literal = num_variables + ++num_slack_variables;
+    constraint->add_literals(slack_literal);
+    constraint->add_coefficients(1);
+    positive_literal_to_weight[slack_literal] += weight;
+    for (const int literal : literals) {
+      LinearBooleanConstraint* binary = problem->add_constraints();
+      binary->set_lower_bound(1);
+      binary->add_literals(-slack_literal);
+      binary->add_literals(-literal);
+      binary->add_coefficients(1);
+      binary->add_coefficients(1);
+    }
+  }
+  problem->set_original_num_variables(num_variables);
+  problem->set_num_variables(num_variables + num_slack_variables);
+  if (!positive_literal_to_weight.empty()) {
+    LinearObjective* objective = problem->mutable_objective();
+    for (const std::pair<int, int64> p : positive_literal_to_weight) {
+      if (p.second != 0) {
+        objective->add_literals(p.first);
+        objective->add_coefficients(p.second);
+      }
+    }
+    objective->set_offset(objective_offset);
+  }
+}
+
+// The parsing of OpbReader::Load() with FileLines.
+void LoadOpbWithFileLines(const std::string& filename,
+                          LinearBooleanProblem* problem) {
+  problem->Clear();
+  int num_variables = 0;
+  for (const std::string& line : FileLines(filename)) {
+    const std::vector<std::string> words =
+        strings::Split(line, " ", strings::SkipEmpty());
+    if (words.empty() || words[0][0] == '*') continue;
+    if (words[0] == "min:") {
+      LinearObjective* objective = problem->mutable_objective();
+      for (int i = 1; i < words.size(); ++i) {
+        if (words[i][0] == ';') continue;
+        if (words[i][0] == 'x') {
+          const int literal = atoi32(words[i].substr(1));
+          num_variables = std::max(num_variables, literal);
+          objective->add_literals(literal);
+        } else {
+          objective->add_coefficients(atoi64(words[i]));
+        }
+      }
+      continue;
+    }
+    LinearBooleanConstraint* constraint = problem->add_constraints();
+    for (int i = 0; i < words.size(); ++i) {
+      if (words[i] == ">=" || words[i] == "=") {
+        if (words[i] == "=") constraint->set_upper_bound(atoi64(words[i + 1]));
+        constraint->set_lower_bound(atoi64(words[i + 1]));
+        break;
+      }
+      if (words[i][0] == 'x') {
+        const int literal = atoi32(words[i].substr(1));
+        num_variables = std::max(num_variables, literal);
+        constraint->add_literals(literal);
+      } else {
+        constraint->add_coefficients(atoi64(words[i]));
+      }
+    }
+  }
+  problem->set_num_variables(num_variables);
+}
+
+void WriteFile(const std::string& file_name, const std::string& contents) {
+  FILE* const file = fopen(file_name.c_str(), "wb");
+  CHECK(file != nullptr) << file_name;
+  CHECK_EQ(contents.size(), fwrite(contents.data(), 1, contents.size(), file));
+  fclose(file);
+}
+
+void WriteGzipFile(const std::string& file_name, const std::string& contents) {
+  gzFile file = gzopen(file_name.c_str(), "wb");
+  CHECK(file != nullptr) << file_name;
+  CHECK_EQ(contents.size(), gzwrite(file, contents.data(), contents.size()));
+  gzclose(file);
+}
+
+// The name of a problem is its file name, which differs between the files.
+void CheckSameProblem(const LinearBooleanProblem& expected,
+                      const LinearBooleanProblem& actual,
+                      const std::string& message) {
+  LinearBooleanProblem a = expected;
+  LinearBooleanProblem b = actual;
+  a.clear_name();
+  b.clear_name();
+  CHECK(a.SerializeAsString() == b.SerializeAsString()) << message;
+}
+
+// Returns the clauses of a random cnf or wcnf file, one per element. A wcnf
+// clause starts with its weight, which is kHardWeight for a hard clause. The
+// cnf files are random 3-SAT instances, some SAT and some UNSAT.
+const int kHardWeight = 1000;
+std::vector<std::vector<int>> RandomClauses(int num_variables, bool is_wcnf,
+                                            MTRandom* random) {
+  std::vector<std::vector<int>> clauses(num_variables *
+                                        (35 + random->Uniform(20)) / 10);
+  for (std::vector<int>& clause : clauses) {
+    if (is_wcnf) {
+      clause.push_back(random->OneIn(2) ? kHardWeight
+                                        : 1 + random->Uniform(9));
+    }
+    const int size = is_wcnf ? 1 + random->Uniform(4) : 3;
+    std::vector<int> variables;
+    while (variables.size() < size) {
+      const int var = 1 + random->Uniform(num_variables);
+      if (std::find(variables.begin(), variables.end(), var) ==
+          variables.end()) {
+        variables.push_back(var);
+      }
+    }
+    for (const int var : variables) {
+      clause.push_back(random->OneIn(2) ? var : -var);
+    }
+  }
+  return clauses;
+}
+
+std::string CnfHeader(int num_variables, int num_clauses, bool is_wcnf) {
+  return is_wcnf ? StringPrintf("c random wcnf\np wcnf %d %d %d\n",
+                                num_variables, num_clauses, kHardWeight)
+                 : StringPrintf("c random cnf\np cnf %d %d\n", num_variables,
+                                num_clauses);
+}
+
+// One clause per line, as FileLines needs.
+std::string OneClausePerLine(int num_variables, bool is_wcnf,
+                             const std::vector<std::vector<int>>& clauses) {
+  std::string cnf = CnfHeader(num_variables, clauses.size(), is_wcnf);
+  for (const std::vector<int>& clause : clauses) {
+    for (const int value : clause) cnf += StringPrintf("%d ", value);
+    cnf += "0\n";
+  }
+  return cnf;
+}
+
+// The same clauses, with random line breaks, tabs and comment lines.
+std::string FreeLayout(int num_variables, bool is_wcnf,
+                       const std::vector<std::vector<int>>& clauses,
+                       MTRandom* random) {
+  std::string cnf = CnfHeader(num_variables, clauses.size(), is_wcnf);
+  for (const std::vector<int>& clause : clauses) {
+    for (const int value : clause) {
+      cnf += StringPrintf("%d", value);
+      cnf += random->OneIn(4) ? "\n" : random->OneIn(3) ? "\t" : " ";
+    }
+    cnf += "0";
+    if (random->OneIn(3)) {
+      cnf += "\nc a comment\n";
+    } else {
+      cnf += random->OneIn(2) ? "\n" : "  ";
+    }
+  }
+  return cnf;
+}
+
+std::string RandomOpb(int num_variables, MTRandom* random) {
+  std::string opb = "* random opb\nmin:";
+  for (int var = 1; var <= num_variables; ++var) {
+    if (random->OneIn(2)) {
+      opb += StringPrintf(" %+d x%d", 1 + random->Uniform(20), var);
+    }
+  }
+  opb += " ;\n";
+  for (int i = 0; i < 3 * num_variables; ++i) {
+    int64 sum = 0;
+    for (int j = 0; j < 2 + random->Uniform(4); ++j) {
+      const int coefficient = random->Uniform(11) - 5;
+      opb += StringPrintf("%+d x%d ", coefficient,
+                          1 + random->Uniform(num_variables));
+      sum += std::abs(coefficient);
+    }
+    opb += StringPrintf("%s %lld ;\n", random->OneIn(4) ? "=" : ">=",
+                        random->Uniform(sum + 1) - sum / 2);
+  }
+  return opb;
+}
+
+void TestCnf() {
+  int num_sat = 0;
+  const std::string file_name = FLAGS_test_tmpdir + "/sat_reader_test.cnf";
+  for (const bool is_wcnf : {false, true}) {
+    for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+      MTRandom random(seed);
+      const int num_variables = 10 + random.Uniform(100);
+      const std::vector<std::vector<int>> clauses =
+          RandomClauses(num_variables, is_wcnf, &random);
+      const std::string message =
+          StringPrintf("%s seed %d", is_wcnf ? "wcnf" : "cnf", seed);
+      WriteFile(file_name, OneClausePerLine(num_variables, is_wcnf, clauses));
+      LinearBooleanProblem expected;
+      LoadCnfWithFileLines(file_name, &expected);
+      CHECK_GT(expected.constraints_size(), 0);
+      SatCnfReader reader;
+      LinearBooleanProblem problem;
+      CHECK(reader.Load(file_name, &problem)) << message;
+      CheckSameProblem(expected, problem, message);
+
+      const std::string text =
+          FreeLayout(num_variables, is_wcnf, clauses, &random);
+      WriteFile(file_name, text);
+      CHECK(reader.Load(file_name, &problem)) << message;
+      CheckSameProblem(expected, problem, message + ", free layout");
+      WriteGzipFile(file_name + ".gz", text);
+      CHECK(reader.Load(file_name + ".gz", &problem)) << message;
+      CheckSameProblem(expected, problem, message + ", gzipped");
+
+      // Loading a pure SAT file directly into a solver must give the same
+      // result as loading its problem.
+      if (!is_wcnf) {
+        SatSolver solver;
+        SatSolver::Status status = SatSolver::MODEL_UNSAT;
+        if (LoadBooleanProblem(expected, &solver)) status = solver.Solve();
+        SatSolver direct_solver;
+        CHECK(reader.LoadIntoSolver(file_name + ".gz", &direct_solver,
+                                    &problem))
+            << message;
+        CHECK_EQ(num_variables, problem.num_variables());
+        if (!direct_solver.IsModelUnsat()) {
+          CHECK_EQ(status, direct_solver.Solve()) << message;
+        } else {
+          CHECK_EQ(SatSolver::MODEL_UNSAT, status) << message;
+        }
+        if (status == SatSolver::MODEL_SAT) ++num_sat;
+      }
+    }
+  }
+  LOG(INFO) << num_sat << " SAT cnf files out of " << FLAGS_num_instances;
+  remove(file_name.c_str());
+  remove((file_name + ".gz").c_str());
+}
+
+// A soft clause of weight 0 is skipped, and doesn't affect the next ones.
+void TestZeroWeightSoftClause() {
+  const std::string file_name = FLAGS_test_tmpdir + "/sat_reader_test.wcnf";
+  WriteFile(file_name,
+            "p wcnf 3 3 10\n0 1 2 0\n10 -1 3 0\n2 -2 -3 0\n");
+  SatCnfReader reader;
+  LinearBooleanProblem problem;
+  CHECK(reader.Load(file_name, &problem));
+  CHECK_EQ(4, problem.constraints_size());
+  CHECK_EQ(4, problem.num_variables());
+  CHECK_EQ(1, problem.objective().literals_size());
+  CHECK_EQ(4, problem.objective().literals(0));
+  CHECK_EQ(2, problem.objective().coefficients(0));
+  remove(file_name.c_str());
+}
+
+void TestOpb() {
+  const std::string file_name = FLAGS_test_tmpdir + "/sat_reader_test.opb";
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    MTRandom random(seed);
+    const std::string opb = RandomOpb(10 + random.Uniform(100), &random);
+    const std::string message = StringPrintf("opb seed %d", seed);
+    WriteFile(file_name, opb);
+    WriteGzipFile(file_name + ".gz", opb);
+    LinearBooleanProblem expected;
+    LoadOpbWithFileLines(file_name, &expected);
+    OpbReader reader;
+    LinearBooleanProblem problem;
+    CHECK(reader.Load(file_name, &problem)) << message;
+    CheckSameProblem(expected, problem, message);
+    CHECK(reader.Load(file_name + ".gz", &problem)) << message;
+    CheckSameProblem(expected, problem, message + ", gzipped");
+  }
+  remove(file_name.c_str());
+  remove((file_name + ".gz").c_str());
+}
+
+}  // namespace sat
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::sat::TestCnf();
+  operations_research::sat::TestZeroWeightSoftClause();
+  operations_research::sat::TestOpb();
+  return 0;
+}
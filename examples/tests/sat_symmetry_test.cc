@@ -0,0 +1,155 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Finds the symmetries of problems made of several copies of a random 3-SAT
+// formula. The generators must not depend on the number of threads of the
+// symmetry finder, and adding their lex-leader clauses must keep the problem
+// satisfiable if and only if it was before.
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/commandlineflags.h"
+#include "base/logging.h"
+#include "base/random.h"
+#include "algorithms/sparse_permutation.h"
+#include "sat/boolean_problem.h"
+#include "sat/boolean_problem.pb.h"
+#include "sat/sat_solver.h"
+
+DEFINE_int32(num_instances, 100, "Number of random instances to solve.");
+
+namespace operations_research {
+namespace sat {
+
+typedef std::vector<std::unique_ptr<SparsePermutation>> Generators;
+
+// Returns num_copies copies, over disjoint variables, of the same random
+// formula of 3-clauses over distinct variables.
+LinearBooleanProblem ReplicatedProblem(int num_copies, int num_variables,
+                                       int num_clauses, MTRandom* random) {
+  std::vector<std::vector<int>> clauses(num_clauses);
+  for (std::vector<int>& clause : clauses) {
+    while (clause.size() < 3) {
+      const int var = 1 + random->Uniform(num_variables);
+      bool is_new = true;
+      for (const int literal : clause) is_new &= std::abs(literal) != var;
+      if (is_new) clause.push_back(random->OneIn(2) ? var : -var);
+    }
+  }
+  LinearBooleanProblem problem;
+  problem.set_num_variables(num_copies * num_variables);
+  for (int copy = 0; copy < num_copies; ++copy) {
+    const int offset = copy * num_variables;
+    for (const std::vector<int>& clause : clauses) {
+      LinearBooleanConstraint* constraint = problem.add_constraints();
+      for (const int literal : clause) {
+        constraint->add_literals(literal > 0 ? literal + offset
+                                             : literal - offset);
+        constraint->add_coefficients(1);
+      }
+      constraint->set_lower_bound(1);
+    }
+  }
+  return problem;
+}
+
+std::vector<std::string> GeneratorStrings(const LinearBooleanProblem& problem,
+                                          double deterministic_time_limit,
+                                          int num_threads) {
+  Generators generators;
+  FindLinearBooleanProblemSymmetries(problem, deterministic_time_limit,
+                                     num_threads, &generators);
+  std::vector<std::string> strings;
+  for (const std::unique_ptr<SparsePermutation>& generator : generators) {
+    strings.push_back(generator->DebugString());
+  }
+  return strings;
+}
+
+// The literals of the large problem form a part of the symmetry graph that is
+// large enough to be refined in parallel. The search is also interrupted by a
+// deterministic time limit, at the same point whatever the number of threads.
+void TestSameGeneratorsWithThreads() {
+  MTRandom random(0);
+  const LinearBooleanProblem problem = ReplicatedProblem(350, 15, 60, &random);
+  for (const double limit :
+       {std::numeric_limits<double>::infinity(), 0.006}) {
+    const std::vector<std::string> expected =
+        GeneratorStrings(problem, limit, 1);
+    CHECK(!expected.empty());
+    CHECK(expected == GeneratorStrings(problem, limit, 4))
+        << "deterministic time limit " << limit;
+    LOG(INFO) << expected.size() << " generators with a deterministic time "
+              << "limit of " << limit;
+  }
+}
+
+// Returns true if the problem is SAT. The model is then checked against the
+// given original problem, on its variables.
+bool SolveAndCheck(const LinearBooleanProblem& problem,
+                   const LinearBooleanProblem& original_problem) {
+  SatSolver solver;
+  if (!LoadBooleanProblem(problem, &solver)) return false;
+  if (solver.Solve() != SatSolver::MODEL_SAT) return false;
+  std::vector<bool> solution;
+  ExtractAssignment(original_problem, solver, &solution);
+  CHECK(IsAssignmentValid(original_problem, solution));
+  return true;
+}
+
+void TestLexLeaderKeepsSatisfiability() {
+  int num_sat = 0;
+  int num_new_clauses = 0;
+  for (int seed = 0; seed < FLAGS_num_instances; ++seed) {
+    MTRandom random(seed);
+
+    // Ratios between 3.5 and 5.4 give a mix of sat and unsat instances.
+    const int num_variables = 12;
+    const LinearBooleanProblem problem = ReplicatedProblem(
+        2 + seed % 3, num_variables,
+        num_variables * (35 + random.Uniform(20)) / 10, &random);
+    Generators generators;
+    FindLinearBooleanProblemSymmetries(problem, &generators);
+    CHECK(!generators.empty()) << "seed " << seed;
+    const bool is_sat = SolveAndCheck(problem, problem);
+    if (is_sat) ++num_sat;
+    for (const int max_num_compared_variables : {1, 3, 1000}) {
+      LinearBooleanProblem lex_leader_problem = problem;
+      AddLexLeaderSymmetryBreakingClauses(
+          generators, max_num_compared_variables, &lex_leader_problem);
+      CHECK_GT(lex_leader_problem.constraints_size(),
+               problem.constraints_size());
+      num_new_clauses +=
+          lex_leader_problem.constraints_size() - problem.constraints_size();
+      CHECK_EQ(is_sat, SolveAndCheck(lex_leader_problem, problem))
+          << "seed " << seed << ", " << max_num_compared_variables
+          << " compared variables";
+    }
+  }
+  LOG(INFO) << num_sat << " SAT instances out of " << FLAGS_num_instances
+            << ", " << num_new_clauses << " lex-leader clauses.";
+}
+
+}  // namespace sat
+}  // namespace operations_research
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  operations_research::sat::TestSameGeneratorsWithThreads();
+  operations_research::sat::TestLexLeaderKeepsSatisfiability();
+  return 0;
+}
@@ -380,6 +380,19 @@ clean_cc:
 	-$(DEL) $(BIN_DIR)$Sfz2$E
 	-$(DEL) $(BIN_DIR)$Sparser_main$E
 	-$(DEL) $(BIN_DIR)$Ssat_runner$E
+	-$(DEL) $(BIN_DIR)$Ssat_inprocessing_test$E
+	-$(DEL) $(BIN_DIR)$Ssat_trail_reuse_test$E
+	-$(DEL) $(BIN_DIR)$Ssat_oll_test$E
+	-$(DEL) $(BIN_DIR)$Ssat_drat_test$E
+	-$(DEL) $(BIN_DIR)$Ssat_clause_group_test$E
+	-$(DEL) $(BIN_DIR)$Ssat_clause_cleanup_test$E
+	-$(DEL) $(BIN_DIR)$Ssat_symmetry_test$E
+	-$(DEL) $(BIN_DIR)$Ssat_reader_test$E
+	-$(DEL) $(BIN_DIR)$Sglop_pdhg_test$E
+	-$(DEL) $(BIN_DIR)$Sglop_block_decomposition_test$E
+	-$(DEL) $(BIN_DIR)$Smps_reader_test$E
+	-$(DEL) $(BIN_DIR)$Sglop_branch_and_bound_test$E
+	-$(DEL) $(BIN_DIR)$Sglop_warm_start_test$E
 	-$(DEL) $(CPBINARIES)
 	-$(DEL) $(LPBINARIES)
 	-$(DEL) $(GEN_DIR)$Sconstraint_solver$S*.pb.*
@@ -699,6 +712,7 @@ endif
 UTIL_LIB_OBJS=\
 	$(OBJ_DIR)/util/bitset.$O \
 	$(OBJ_DIR)/util/cached_log.$O \
+	$(OBJ_DIR)/util/file_contents.$O \
 	$(OBJ_DIR)/util/fp_utils.$O \
 	$(OBJ_DIR)/util/graph_export.$O \
 	$(OBJ_DIR)/util/piecewise_linear_function.$O \
@@ -714,6 +728,9 @@ $(OBJ_DIR)/util/bitset.$O:$(SRC_DIR)/util/bitset.cc
 $(OBJ_DIR)/util/cached_log.$O:$(SRC_DIR)/util/cached_log.cc
 	$(CCC) $(CFLAGS) -c $(SRC_DIR)/util/cached_log.cc $(OBJ_OUT)$(OBJ_DIR)$Sutil$Scached_log.$O
 
+$(OBJ_DIR)/util/file_contents.$O:$(SRC_DIR)/util/file_contents.cc
+	$(CCC) $(CFLAGS) -c $(SRC_DIR)/util/file_contents.cc $(OBJ_OUT)$(OBJ_DIR)$Sutil$Sfile_contents.$O
+
 $(OBJ_DIR)/util/fp_utils.$O:$(SRC_DIR)/util/fp_utils.cc
 	$(CCC) $(CFLAGS) -c $(SRC_DIR)/util/fp_utils.cc $(OBJ_OUT)$(OBJ_DIR)$Sutil$Sfp_utils.$O
 
@@ -999,6 +1016,7 @@ $(OBJ_DIR)/lp_data/sparse_column.$O:$(SRC_DIR)/lp_data/sparse_column.cc
 
 GLOP_LIB_OBJS= $(LP_DATA_OBJS) \
   $(OBJ_DIR)/glop/basis_representation.$O \
+  $(OBJ_DIR)/glop/branch_and_bound.$O \
   $(OBJ_DIR)/glop/dual_edge_norms.$O \
   $(OBJ_DIR)/glop/entering_variable.$O \
   $(OBJ_DIR)/glop/initial_basis.$O \
@@ -1007,6 +1025,7 @@ GLOP_LIB_OBJS= $(LP_DATA_OBJS) \
   $(OBJ_DIR)/glop/markowitz.$O \
   $(OBJ_DIR)/glop/parameters.pb.$O \
   $(OBJ_DIR)/glop/preprocessor.$O \
+  $(OBJ_DIR)/glop/primal_dual_hybrid_gradient.$O \
   $(OBJ_DIR)/glop/primal_edge_norms.$O \
   $(OBJ_DIR)/glop/proto_utils.$O \
   $(OBJ_DIR)/glop/reduced_costs.$O \
@@ -1027,6 +1046,9 @@ $(OBJ_DIR)/glop/parameters.pb.$O:$(GEN_DIR)/glop/parameters.pb.cc
 $(OBJ_DIR)/glop/basis_representation.$O:$(SRC_DIR)/glop/basis_representation.cc
 	 $(CCC) $(CFLAGS) -c $(SRC_DIR)$Sglop$Sbasis_representation.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop$Sbasis_representation.$O
 
+$(OBJ_DIR)/glop/branch_and_bound.$O:$(SRC_DIR)/glop/branch_and_bound.cc
+	 $(CCC) $(CFLAGS) -c $(SRC_DIR)$Sglop$Sbranch_and_bound.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop$Sbranch_and_bound.$O
+
 $(OBJ_DIR)/glop/dual_edge_norms.$O:$(SRC_DIR)/glop/dual_edge_norms.cc
 	 $(CCC) $(CFLAGS) -c $(SRC_DIR)$Sglop$Sdual_edge_norms.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop$Sdual_edge_norms.$O
 
@@ -1048,6 +1070,9 @@ $(OBJ_DIR)/glop/markowitz.$O:$(SRC_DIR)/glop/markowitz.cc
 $(OBJ_DIR)/glop/preprocessor.$O:$(SRC_DIR)/glop/preprocessor.cc
 	 $(CCC) $(CFLAGS) -c $(SRC_DIR)$Sglop$Spreprocessor.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop$Spreprocessor.$O
 
+$(OBJ_DIR)/glop/primal_dual_hybrid_gradient.$O:$(SRC_DIR)/glop/primal_dual_hybrid_gradient.cc
+	 $(CCC) $(CFLAGS) -c $(SRC_DIR)$Sglop$Sprimal_dual_hybrid_gradient.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop$Sprimal_dual_hybrid_gradient.$O
+
 $(OBJ_DIR)/glop/primal_edge_norms.$O:$(SRC_DIR)/glop/primal_edge_norms.cc
 	 $(CCC) $(CFLAGS) -c $(SRC_DIR)$Sglop$Sprimal_edge_norms.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop$Sprimal_edge_norms.$O
 
@@ -1420,6 +1445,24 @@ $(OBJ_DIR)/boolean_test.$O:$(EX_DIR)/tests/boolean_test.cc $(SRC_DIR)/constraint
 $(BIN_DIR)/boolean_test$E: $(DYNAMIC_CP_DEPS) $(OBJ_DIR)/boolean_test.$O
 	$(CCC) $(CFLAGS) $(OBJ_DIR)/boolean_test.$O $(DYNAMIC_CP_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Sboolean_test$E
 
+$(OBJ_DIR)/routing_batch_filtering_test.$O:$(EX_DIR)/tests/routing_batch_filtering_test.cc $(SRC_DIR)/constraint_solver/constraint_solver.h $(SRC_DIR)/constraint_solver/routing.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/routing_batch_filtering_test.cc $(OBJ_OUT)$(OBJ_DIR)$Srouting_batch_filtering_test.$O
+
+$(BIN_DIR)/routing_batch_filtering_test$E: $(DYNAMIC_ROUTING_DEPS) $(OBJ_DIR)/routing_batch_filtering_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/routing_batch_filtering_test.$O $(DYNAMIC_ROUTING_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Srouting_batch_filtering_test$E
+
+$(OBJ_DIR)/routing_flat_deltas_test.$O:$(EX_DIR)/tests/routing_flat_deltas_test.cc $(SRC_DIR)/constraint_solver/constraint_solver.h $(SRC_DIR)/constraint_solver/routing.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/routing_flat_deltas_test.cc $(OBJ_OUT)$(OBJ_DIR)$Srouting_flat_deltas_test.$O
+
+$(BIN_DIR)/routing_flat_deltas_test$E: $(DYNAMIC_ROUTING_DEPS) $(OBJ_DIR)/routing_flat_deltas_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/routing_flat_deltas_test.$O $(DYNAMIC_ROUTING_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Srouting_flat_deltas_test$E
+
+$(OBJ_DIR)/routing_lower_bound_test.$O:$(EX_DIR)/tests/routing_lower_bound_test.cc $(SRC_DIR)/constraint_solver/constraint_solver.h $(SRC_DIR)/constraint_solver/routing.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/routing_lower_bound_test.cc $(OBJ_OUT)$(OBJ_DIR)$Srouting_lower_bound_test.$O
+
+$(BIN_DIR)/routing_lower_bound_test$E: $(DYNAMIC_ROUTING_DEPS) $(OBJ_DIR)/routing_lower_bound_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/routing_lower_bound_test.$O $(DYNAMIC_ROUTING_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Srouting_lower_bound_test$E
+
 $(OBJ_DIR)/ls_api.$O:$(EX_DIR)/cpp/ls_api.cc $(SRC_DIR)/constraint_solver/constraint_solver.h
 	$(CCC) $(CFLAGS) -c $(EX_DIR)$Scpp/ls_api.cc $(OBJ_OUT)$(OBJ_DIR)$Sls_api.$O
 
@@ -1466,6 +1509,38 @@ $(OBJ_DIR)/integer_programming.$O: $(EX_DIR)/cpp/integer_programming.cc $(SRC_DI
 $(BIN_DIR)/integer_programming$E: $(DYNAMIC_LP_DEPS) $(OBJ_DIR)/integer_programming.$O
 	$(CCC) $(CFLAGS) $(OBJ_DIR)/integer_programming.$O $(DYNAMIC_LP_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Sinteger_programming$E
 
+# Glop tests.
+
+$(OBJ_DIR)/glop_pdhg_test.$O: $(EX_DIR)/tests/glop_pdhg_test.cc $(SRC_DIR)/glop/lp_solver.h $(GEN_DIR)/glop/parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/glop_pdhg_test.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop_pdhg_test.$O
+
+$(BIN_DIR)/glop_pdhg_test$E: $(DYNAMIC_LP_DEPS) $(OBJ_DIR)/glop_pdhg_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/glop_pdhg_test.$O $(DYNAMIC_LP_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Sglop_pdhg_test$E
+
+$(OBJ_DIR)/glop_block_decomposition_test.$O: $(EX_DIR)/tests/glop_block_decomposition_test.cc $(SRC_DIR)/glop/lp_solver.h $(GEN_DIR)/glop/parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/glop_block_decomposition_test.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop_block_decomposition_test.$O
+
+$(BIN_DIR)/glop_block_decomposition_test$E: $(DYNAMIC_LP_DEPS) $(OBJ_DIR)/glop_block_decomposition_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/glop_block_decomposition_test.$O $(DYNAMIC_LP_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Sglop_block_decomposition_test$E
+
+$(OBJ_DIR)/mps_reader_test.$O: $(EX_DIR)/tests/mps_reader_test.cc $(SRC_DIR)/lp_data/mps_reader.h $(SRC_DIR)/util/file_contents.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/mps_reader_test.cc $(OBJ_OUT)$(OBJ_DIR)$Smps_reader_test.$O
+
+$(BIN_DIR)/mps_reader_test$E: $(DYNAMIC_LP_DEPS) $(OBJ_DIR)/mps_reader_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/mps_reader_test.$O $(DYNAMIC_LP_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Smps_reader_test$E
+
+$(OBJ_DIR)/glop_branch_and_bound_test.$O: $(EX_DIR)/tests/glop_branch_and_bound_test.cc $(SRC_DIR)/glop/branch_and_bound.h $(GEN_DIR)/glop/parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/glop_branch_and_bound_test.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop_branch_and_bound_test.$O
+
+$(BIN_DIR)/glop_branch_and_bound_test$E: $(DYNAMIC_LP_DEPS) $(OBJ_DIR)/glop_branch_and_bound_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/glop_branch_and_bound_test.$O $(DYNAMIC_LP_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Sglop_branch_and_bound_test$E
+
+$(OBJ_DIR)/glop_warm_start_test.$O: $(EX_DIR)/tests/glop_warm_start_test.cc $(SRC_DIR)/glop/lp_solver.h $(GEN_DIR)/glop/parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests/glop_warm_start_test.cc $(OBJ_OUT)$(OBJ_DIR)$Sglop_warm_start_test.$O
+
+$(BIN_DIR)/glop_warm_start_test$E: $(DYNAMIC_LP_DEPS) $(OBJ_DIR)/glop_warm_start_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)/glop_warm_start_test.$O $(DYNAMIC_LP_LNK) $(DYNAMIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Sglop_warm_start_test$E
+
 # Sat solver
 
 sat: bin/sat_runner$E
@@ -1474,6 +1549,7 @@ SAT_LIB_OBJS = \
 	$(OBJ_DIR)/sat/boolean_problem.$O\
 	$(OBJ_DIR)/sat/boolean_problem.pb.$O \
 	$(OBJ_DIR)/sat/clause.$O\
+	$(OBJ_DIR)/sat/drat_writer.$O\
 	$(OBJ_DIR)/sat/encoding.$O\
 	$(OBJ_DIR)/sat/lp_utils.$O\
 	$(OBJ_DIR)/sat/optimization.$O\
@@ -1486,7 +1562,7 @@ SAT_LIB_OBJS = \
 
 satlibs: $(DYNAMIC_SAT_DEPS) $(STATIC_SAT_DEPS)
 
-$(OBJ_DIR)/sat/sat_solver.$O: $(SRC_DIR)/sat/sat_solver.cc $(SRC_DIR)/sat/sat_solver.h $(SRC_DIR)/sat/sat_base.h $(SRC_DIR)/sat/clause.h $(SRC_DIR)/sat/encoding.h $(SRC_DIR)/sat/unsat_proof.h $(GEN_DIR)/sat/sat_parameters.pb.h
+$(OBJ_DIR)/sat/sat_solver.$O: $(SRC_DIR)/sat/sat_solver.cc $(SRC_DIR)/sat/sat_solver.h $(SRC_DIR)/sat/sat_base.h $(SRC_DIR)/sat/clause.h $(SRC_DIR)/sat/drat_writer.h $(SRC_DIR)/sat/simplification.h $(SRC_DIR)/sat/encoding.h $(SRC_DIR)/sat/unsat_proof.h $(GEN_DIR)/sat/sat_parameters.pb.h
 	$(CCC) $(CFLAGS) -c $(SRC_DIR)/sat/sat_solver.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_solver.$O
 
 $(OBJ_DIR)/sat/lp_utils.$O: $(SRC_DIR)/sat/lp_utils.cc $(SRC_DIR)/sat/lp_utils.h $(SRC_DIR)/sat/sat_solver.h $(GEN_DIR)/sat/sat_parameters.pb.h $(GEN_DIR)/glop/parameters.pb.h
@@ -1509,6 +1585,9 @@ $(OBJ_DIR)/sat/boolean_problem.pb.$O: $(GEN_DIR)/sat/boolean_problem.pb.cc $(GEN
 $(OBJ_DIR)/sat/clause.$O: $(SRC_DIR)/sat/clause.cc $(SRC_DIR)/sat/sat_base.h $(SRC_DIR)/sat/clause.h
 	$(CCC) $(CFLAGS) -c $(SRC_DIR)/sat/clause.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Sclause.$O
 
+$(OBJ_DIR)/sat/drat_writer.$O: $(SRC_DIR)/sat/drat_writer.cc $(SRC_DIR)/sat/sat_base.h $(SRC_DIR)/sat/drat_writer.h
+	$(CCC) $(CFLAGS) -c $(SRC_DIR)/sat/drat_writer.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Sdrat_writer.$O
+
 $(OBJ_DIR)/sat/encoding.$O: $(SRC_DIR)/sat/encoding.cc $(SRC_DIR)/sat/sat_base.h $(SRC_DIR)/sat/encoding.h
 	$(CCC) $(CFLAGS) -c $(SRC_DIR)/sat/encoding.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Sencoding.$O
 
@@ -1540,12 +1619,60 @@ $(LIB_DIR)/$(LIBPREFIX)sat.$(STATIC_LIB_SUFFIX): $(SAT_LIB_OBJS)
 	$(STATIC_LINK_CMD) $(STATIC_LINK_PREFIX)$(LIB_DIR)$S$(LIBPREFIX)sat.$(STATIC_LIB_SUFFIX) $(SAT_LIB_OBJS)
 endif
 
-$(OBJ_DIR)/sat/sat_runner.$O:$(EX_DIR)/cpp/sat_runner.cc $(SRC_DIR)/sat/sat_solver.h $(EX_DIR)/cpp/opb_reader.h $(EX_DIR)/cpp/sat_cnf_reader.h $(GEN_DIR)/sat/sat_parameters.pb.h  $(GEN_DIR)/sat/boolean_problem.pb.h  $(SRC_DIR)/sat/boolean_problem.h  $(SRC_DIR)/sat/sat_base.h $(SRC_DIR)/sat/simplification.h
+$(OBJ_DIR)/sat/sat_runner.$O:$(EX_DIR)/cpp/sat_runner.cc $(SRC_DIR)/sat/sat_solver.h $(EX_DIR)/cpp/opb_reader.h $(EX_DIR)/cpp/sat_cnf_reader.h $(SRC_DIR)/util/file_contents.h $(GEN_DIR)/sat/sat_parameters.pb.h  $(GEN_DIR)/sat/boolean_problem.pb.h  $(SRC_DIR)/sat/boolean_problem.h  $(SRC_DIR)/sat/sat_base.h $(SRC_DIR)/sat/simplification.h
 	$(CCC) $(CFLAGS) -c $(EX_DIR)$Scpp$Ssat_runner.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_runner.$O
 
 $(BIN_DIR)/sat_runner$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_runner.$O
 	$(CCC) $(CFLAGS) $(FZ_STATIC) $(OBJ_DIR)$Ssat$Ssat_runner.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_runner$E
 
+$(OBJ_DIR)/sat/sat_inprocessing_test.$O:$(EX_DIR)/tests/sat_inprocessing_test.cc $(SRC_DIR)/sat/sat_solver.h $(GEN_DIR)/sat/sat_parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_inprocessing_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_inprocessing_test.$O
+
+$(BIN_DIR)/sat_inprocessing_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_inprocessing_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_inprocessing_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_inprocessing_test$E
+
+$(OBJ_DIR)/sat/sat_trail_reuse_test.$O:$(EX_DIR)/tests/sat_trail_reuse_test.cc $(SRC_DIR)/sat/sat_solver.h $(GEN_DIR)/sat/sat_parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_trail_reuse_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_trail_reuse_test.$O
+
+$(BIN_DIR)/sat_trail_reuse_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_trail_reuse_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_trail_reuse_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_trail_reuse_test$E
+
+$(OBJ_DIR)/sat/sat_oll_test.$O:$(EX_DIR)/tests/sat_oll_test.cc $(SRC_DIR)/sat/optimization.h $(GEN_DIR)/sat/sat_parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_oll_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_oll_test.$O
+
+$(BIN_DIR)/sat_oll_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_oll_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_oll_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_oll_test$E
+
+$(OBJ_DIR)/sat/sat_drat_test.$O:$(EX_DIR)/tests/sat_drat_test.cc $(SRC_DIR)/sat/drat_writer.h $(SRC_DIR)/sat/sat_solver.h $(GEN_DIR)/sat/sat_parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_drat_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_drat_test.$O
+
+$(BIN_DIR)/sat_drat_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_drat_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_drat_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_drat_test$E
+
+$(OBJ_DIR)/sat/sat_clause_group_test.$O:$(EX_DIR)/tests/sat_clause_group_test.cc $(SRC_DIR)/sat/sat_solver.h $(GEN_DIR)/sat/sat_parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_clause_group_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_clause_group_test.$O
+
+$(BIN_DIR)/sat_clause_group_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_clause_group_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_clause_group_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_clause_group_test$E
+
+$(OBJ_DIR)/sat/sat_clause_cleanup_test.$O:$(EX_DIR)/tests/sat_clause_cleanup_test.cc $(SRC_DIR)/sat/drat_writer.h $(SRC_DIR)/sat/sat_solver.h $(GEN_DIR)/sat/sat_parameters.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_clause_cleanup_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_clause_cleanup_test.$O
+
+$(BIN_DIR)/sat_clause_cleanup_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_clause_cleanup_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_clause_cleanup_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_clause_cleanup_test$E
+
+$(OBJ_DIR)/sat/sat_symmetry_test.$O:$(EX_DIR)/tests/sat_symmetry_test.cc $(SRC_DIR)/sat/boolean_problem.h $(GEN_DIR)/sat/boolean_problem.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_symmetry_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_symmetry_test.$O
+
+$(BIN_DIR)/sat_symmetry_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_symmetry_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_symmetry_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_symmetry_test$E
+
+$(OBJ_DIR)/sat/sat_reader_test.$O:$(EX_DIR)/tests/sat_reader_test.cc $(EX_DIR)/cpp/opb_reader.h $(EX_DIR)/cpp/sat_cnf_reader.h $(SRC_DIR)/util/file_contents.h $(GEN_DIR)/sat/boolean_problem.pb.h
+	$(CCC) $(CFLAGS) -c $(EX_DIR)$Stests$Ssat_reader_test.cc $(OBJ_OUT)$(OBJ_DIR)$Ssat$Ssat_reader_test.$O
+
+$(BIN_DIR)/sat_reader_test$E: $(STATIC_SAT_DEPS) $(OBJ_DIR)/sat/sat_reader_test.$O
+	$(CCC) $(CFLAGS) $(OBJ_DIR)$Ssat$Ssat_reader_test.$O $(STATIC_SAT_LNK) $(STATIC_LD_FLAGS) $(EXE_OUT)$(BIN_DIR)$Ssat_reader_test$E
+
 # Bop solver
 BOP_LIB_OBJS = \
 	$(OBJ_DIR)/bop/bop_base.$O\
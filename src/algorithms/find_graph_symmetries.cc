@@ -20,6 +20,8 @@
 #include "base/commandlineflags.h"
 #include "base/stringprintf.h"
 #include "base/join.h"
+#include "base/callback.h"
+#include "base/cleanup.h"
 #include "algorithms/dense_doubly_linked_list.h"
 #include "algorithms/dynamic_partition.h"
 #include "algorithms/dynamic_permutation.h"
@@ -36,6 +38,10 @@ DEFINE_bool(minimize_permutation_support_size, false,
 namespace operations_research {
 
 namespace {
+// Below this size, a part is refined sequentially even when several threads
+// are available: the work isn't worth the synchronization.
+const int kMinPartSizeForParallelRefinement = 10000;
+
 // Some routines used below.
 void SwapFrontAndBack(std::vector<int>* v) {
   DCHECK(!v->empty());
@@ -94,6 +100,9 @@ bool ListMapsToList(const List& l1, const List& l2,
 
 GraphSymmetryFinder::GraphSymmetryFinder(const Graph& graph, bool is_undirected)
     : graph_(graph),
+      num_inspected_arcs_(0),
+      num_reported_arcs_(0),
+      num_threads_(1),
       tmp_dynamic_permutation_(NumNodes()),
       tmp_node_mask_(NumNodes(), false),
       tmp_degree_(NumNodes(), 0),
@@ -143,8 +152,10 @@ bool GraphSymmetryFinder::IsGraphAutomorphism(
   for (const int base : permutation.AllMappingsSrc()) {
     const int image = permutation.ImageOf(base);
     if (image == base) continue;
+    num_inspected_arcs_ += graph_.OutDegree(base);
     if (!ListMapsToList(graph_[base], graph_[image], permutation,
                         &tmp_node_mask_)) {
+      UpdateDeterministicTime();
       return false;
     }
   }
@@ -154,32 +165,103 @@ bool GraphSymmetryFinder::IsGraphAutomorphism(
     for (const int base : permutation.AllMappingsSrc()) {
       const int image = permutation.ImageOf(base);
       if (image == base) continue;
+      num_inspected_arcs_ +=
+          reverse_adj_list_index_[base + 1] - reverse_adj_list_index_[base];
       if (!ListMapsToList(TailsOfIncomingArcsTo(base),
                           TailsOfIncomingArcsTo(image), permutation,
                           &tmp_node_mask_)) {
+        UpdateDeterministicTime();
         return false;
       }
     }
   }
+  UpdateDeterministicTime();
   return true;
 }
 
+void GraphSymmetryFinder::UpdateDeterministicTime() const {
+  time_limit_->AdvanceDeterministicTime(
+      1e-8 * (num_inspected_arcs_ - num_reported_arcs_));
+  num_reported_arcs_ = num_inspected_arcs_;
+}
+
 namespace {
 // Specialized subroutine, to avoid code duplication: see its call site
-// and its self-explanatory code.
+// and its self-explanatory code. Returns the number of nodes scanned.
 template <class T>
-inline void IncrementCounterForNonSingletons(const T& nodes,
-                                             const DynamicPartition& partition,
-                                             std::vector<int>* node_count,
-                                             std::vector<int>* nodes_seen) {
+inline int IncrementCounterForNonSingletons(const T& nodes,
+                                            const DynamicPartition& partition,
+                                            std::vector<int>* node_count,
+                                            std::vector<int>* nodes_seen) {
+  int num_scanned = 0;
   for (const int node : nodes) {
+    ++num_scanned;
     if (partition.ElementsInSamePartAs(node).size() == 1) continue;
     const int count = ++(*node_count)[node];
     if (count == 1) nodes_seen->push_back(node);
   }
+  return num_scanned;
 }
 }  // namespace
 
+void GraphSymmetryFinder::AggregateDegreesOfChunk(
+    const DynamicPartition* partition, int part_index, bool outgoing_adjacency,
+    int thread, Barrier* barrier) {
+  // The part is split in num_threads_ contiguous chunks of (almost) equal size.
+  const DynamicPartition::IterablePart part =
+      partition->ElementsInPart(part_index);
+  const int64 part_size = part.size();
+  const auto begin = part.begin() + part_size * thread / num_threads_;
+  const auto end = part.begin() + part_size * (thread + 1) / num_threads_;
+  std::vector<int>* const degree = &tmp_thread_degree_[thread];
+  std::vector<int>* const nodes_seen = &tmp_thread_nodes_seen_[thread];
+  int64 num_arcs = 0;
+  for (auto it = begin; it != end; ++it) {
+    if (outgoing_adjacency) {
+      num_arcs += IncrementCounterForNonSingletons(graph_[*it], *partition,
+                                                   degree, nodes_seen);
+    } else {
+      num_arcs += IncrementCounterForNonSingletons(
+          TailsOfIncomingArcsTo(*it), *partition, degree, nodes_seen);
+    }
+  }
+  tmp_thread_num_arcs_[thread] = num_arcs;
+  if (barrier->Block()) delete barrier;
+}
+
+void GraphSymmetryFinder::AggregateDegreesInParallel(
+    const DynamicPartition& partition, int part_index, bool outgoing_adjacency,
+    std::vector<int>* nodes_seen) {
+  if (tmp_thread_degree_.size() != num_threads_) {
+    tmp_thread_degree_.assign(num_threads_, std::vector<int>(NumNodes(), 0));
+    tmp_thread_nodes_seen_.assign(num_threads_, std::vector<int>());
+    tmp_thread_num_arcs_.assign(num_threads_, 0);
+  }
+  // The barrier waits for all the chunks. It is deleted by the last thread
+  // that leaves it, which may not be this one.
+  Barrier* const barrier = new Barrier(num_threads_ + 1);
+  for (int thread = 0; thread < num_threads_; ++thread) {
+    refinement_pool_->Add(
+        NewCallback(this, &GraphSymmetryFinder::AggregateDegreesOfChunk,
+                    &partition, part_index, outgoing_adjacency, thread,
+                    barrier));
+  }
+  if (barrier->Block()) delete barrier;
+
+  // Merge the chunks in order. Since the chunks are contiguous, the nodes are
+  // appended to "nodes_seen" in the same order as in the sequential version.
+  for (int thread = 0; thread < num_threads_; ++thread) {
+    std::vector<int>& thread_degree = tmp_thread_degree_[thread];
+    for (const int node : tmp_thread_nodes_seen_[thread]) {
+      if (tmp_degree_[node] == 0) nodes_seen->push_back(node);
+      tmp_degree_[node] += thread_degree[node];
+      thread_degree[node] = 0;  // To clean up after us.
+    }
+    tmp_thread_nodes_seen_[thread].clear();  // To clean up after us.
+    num_inspected_arcs_ += tmp_thread_num_arcs_[thread];
+  }
+}
+
 void GraphSymmetryFinder::RecursivelyRefinePartitionByAdjacency(
     int first_unrefined_part_index, DynamicPartition* partition) {
   // Rename, for readability of the code below.
@@ -206,17 +288,22 @@ void GraphSymmetryFinder::RecursivelyRefinePartitionByAdjacency(
     for (const bool outgoing_adjacency : adjacency_directions) {
       // Count the aggregated degree of all nodes, only looking at arcs that
       // come from/to the current part.
-      if (outgoing_adjacency) {
+      if (refinement_pool_ != nullptr &&
+          partition->SizeOfPart(part_index) >=
+              kMinPartSizeForParallelRefinement) {
+        AggregateDegreesInParallel(*partition, part_index, outgoing_adjacency,
+                                   &tmp_nodes_with_nonzero_degree);
+      } else if (outgoing_adjacency) {
         for (const int node : partition->ElementsInPart(part_index)) {
-          IncrementCounterForNonSingletons(graph_[node], *partition,
-                                           &tmp_degree_,
-                                           &tmp_nodes_with_nonzero_degree);
+          num_inspected_arcs_ += IncrementCounterForNonSingletons(
+              graph_[node], *partition, &tmp_degree_,
+              &tmp_nodes_with_nonzero_degree);
         }
       } else {
         for (const int node : partition->ElementsInPart(part_index)) {
-          IncrementCounterForNonSingletons(TailsOfIncomingArcsTo(node),
-                                           *partition, &tmp_degree_,
-                                           &tmp_nodes_with_nonzero_degree);
+          num_inspected_arcs_ += IncrementCounterForNonSingletons(
+              TailsOfIncomingArcsTo(node), *partition, &tmp_degree_,
+              &tmp_nodes_with_nonzero_degree);
         }
       }
       // Group the nodes by (nonzero) degree. Remember the maximum degree.
@@ -236,6 +323,7 @@ void GraphSymmetryFinder::RecursivelyRefinePartitionByAdjacency(
       }
     }
   }
+  UpdateDeterministicTime();
 }
 
 void GraphSymmetryFinder::DistinguishNodeInPartition(
@@ -349,8 +437,28 @@ util::Status GraphSymmetryFinder::FindSymmetries(
     double time_limit_seconds, std::vector<int>* node_equivalence_classes_io,
     std::vector<std::unique_ptr<SparsePermutation>>* generators,
     std::vector<int>* factorized_automorphism_group_size) {
+  return FindSymmetries(time_limit_seconds,
+                        std::numeric_limits<double>::infinity(),
+                        node_equivalence_classes_io, generators,
+                        factorized_automorphism_group_size);
+}
+
+util::Status GraphSymmetryFinder::FindSymmetries(
+    double time_limit_seconds, double deterministic_time_limit,
+    std::vector<int>* node_equivalence_classes_io,
+    std::vector<std::unique_ptr<SparsePermutation>>* generators,
+    std::vector<int>* factorized_automorphism_group_size) {
   // Initialization.
-  time_limit_.reset(new TimeLimit(time_limit_seconds));
+  time_limit_.reset(
+      new TimeLimit(time_limit_seconds, deterministic_time_limit));
+  num_inspected_arcs_ = 0;
+  num_reported_arcs_ = 0;
+  if (num_threads_ > 1) {
+    refinement_pool_.reset(new ThreadPool("RefinePartition", num_threads_));
+    refinement_pool_->StartWorkers();
+  }
+  auto delete_refinement_pool =
+      util::MakeCleanup([this]() { refinement_pool_.reset(); });
   IF_STATS_ENABLED(stats_.initialization_time.StartTimer());
   generators->clear();
   factorized_automorphism_group_size->clear();
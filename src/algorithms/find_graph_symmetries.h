@@ -34,6 +34,8 @@
 #include "util/stats.h"
 #include "util/time_limit.h"
 #include "base/status.h"
+#include "base/synchronization.h"
+#include "base/threadpool.h"
 
 namespace operations_research {
 
@@ -104,6 +106,25 @@ class GraphSymmetryFinder {
       std::vector<std::unique_ptr<SparsePermutation>>* generators,
       std::vector<int>* factorized_automorphism_group_size);
 
+  // Same as above, with an additional limit on the deterministic time, see
+  // deterministic_time(). Contrary to the wall time, this limit gives the same
+  // result on every run.
+  util::Status FindSymmetries(
+      double time_limit_seconds, double deterministic_time_limit,
+      std::vector<int>* node_equivalence_classes_io,
+      std::vector<std::unique_ptr<SparsePermutation>>* generators,
+      std::vector<int>* factorized_automorphism_group_size);
+
+  // Sets the number of threads used to refine the partition. The adjacency of
+  // the large parts is then aggregated in parallel. The output doesn't depend
+  // on the number of threads. The default is 1.
+  void SetNumThreads(int num_threads) { num_threads_ = num_threads; }
+
+  // An estimate of the work done so far, in the same unit as the
+  // deterministic time of the SAT solver. This is based on the number of arcs
+  // scanned by the partition refinement and by the automorphism checks.
+  double deterministic_time() const { return 1e-8 * num_inspected_arcs_; }
+
   // **** Methods below are public FOR TESTING ONLY. ****
 
   // Fully refine the partition of nodes, using the graph as symmetry breaker.
@@ -150,6 +171,31 @@ class GraphSymmetryFinder {
   // Deadline management. Populated upon FindSymmetries().
   mutable std::unique_ptr<TimeLimit> time_limit_;
 
+  // The work counter behind deterministic_time(), and the part of it that was
+  // already reported to time_limit_. See UpdateDeterministicTime().
+  mutable int64 num_inspected_arcs_;
+  mutable int64 num_reported_arcs_;
+  void UpdateDeterministicTime() const;
+
+  // Parallel partition refinement, see SetNumThreads(). Each thread aggregates
+  // the degrees of a contiguous chunk of the refined part in its own counters,
+  // which have the same resting state as tmp_degree_ and tmp_stack_ below.
+  // The chunks are then merged in order, which gives the exact same result as
+  // the sequential aggregation. The workers of refinement_pool_ are started
+  // once per FindSymmetries() call; without them, the refinement is always
+  // sequential.
+  int num_threads_;
+  std::unique_ptr<ThreadPool> refinement_pool_;
+  std::vector<std::vector<int>> tmp_thread_degree_;
+  std::vector<std::vector<int>> tmp_thread_nodes_seen_;
+  std::vector<int64> tmp_thread_num_arcs_;
+  void AggregateDegreesInParallel(const DynamicPartition& partition,
+                                  int part_index, bool outgoing_adjacency,
+                                  std::vector<int>* nodes_seen);
+  void AggregateDegreesOfChunk(const DynamicPartition* partition,
+                               int part_index, bool outgoing_adjacency,
+                               int thread, Barrier* barrier);
+
   // Internal search code used in FindSymmetries(), split out for readability:
   // find one permutation (if it exists) that maps root_node to root_image_node
   // and such that the image of "base_partition" by that permutation is equal to
@@ -39,6 +39,7 @@ struct Status {
       : error_code_(other.error_code_), error_message_(other.error_message_) {}
 
   bool ok() const { return error_code_ == OK; }
+  int error_code() const { return error_code_; }
 
   std::string ToString() const {
     if (ok()) return "OK";
@@ -300,7 +300,9 @@ void PortfolioOptimizer::CreateOptimizers(
   if (parameters.use_symmetry()) {
     VLOG(1) << "Finding symmetries of the problem.";
     std::vector<std::unique_ptr<SparsePermutation>> generators;
-    sat::FindLinearBooleanProblemSymmetries(problem, &generators);
+    sat::FindLinearBooleanProblemSymmetries(
+        problem, parameters.symmetry_max_deterministic_time(),
+        /*num_threads=*/1, &generators);
     std::unique_ptr<sat::SymmetryPropagator> propagator(
         new sat::SymmetryPropagator);
     for (int i = 0; i < generators.size(); ++i) {
@@ -571,7 +571,7 @@ void IntegralProblemConverter::ConvertAllConstraints(
     LinearBooleanProblem* boolean_problem) {
   // TODO(user): This is the way it's done in glop/proto_utils.cc but having
   //              to transpose looks unnecessary costly.
-  glop::SparseMatrix transpose;
+  glop::CompactSparseMatrix transpose;
   transpose.PopulateFromTranspose(linear_problem.GetSparseMatrix());
 
   double max_relative_error = 0.0;
@@ -584,7 +584,8 @@ void IntegralProblemConverter::ConvertAllConstraints(
     Fractional offset = 0.0;
     ITIVector<VariableIndex, Fractional> dense_weights(num_boolean_variables_,
                                                        0.0);
-    for (const SparseColumn::Entry e : transpose.column(RowToColIndex(row))) {
+    for (const glop::CompactSparseMatrix::ColumnView::Entry e :
+         transpose.column(RowToColIndex(row))) {
       // Cast in ColIndex due to the transpose.
       offset += AddWeightedIntegralVariable(RowToColIndex(e.row()),
                                             e.coefficient(), &dense_weights);
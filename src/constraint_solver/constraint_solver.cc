@@ -912,6 +912,7 @@ class Search {
   void NoMoreSolutions();
   bool LocalOptimum();
   bool AcceptDelta(Assignment* delta, Assignment* deltadelta);
+  bool UsesDeltas() const;
   void AcceptNeighbor();
   void PeriodicCheck();
   int ProgressPercent();
@@ -1226,6 +1227,13 @@ bool Search::AcceptDelta(Assignment* delta, Assignment* deltadelta) {
   return accept;
 }
 
+bool Search::UsesDeltas() const {
+  for (int index = 0; index < monitors_.size(); ++index) {
+    if (monitors_[index]->UsesDeltas()) return true;
+  }
+  return false;
+}
+
 void Search::AcceptNeighbor() {
   for (int index = 0; index < monitors_.size(); ++index) {
     monitors_[index]->AcceptNeighbor();
@@ -1265,6 +1273,8 @@ bool AcceptDelta(Search* const search, Assignment* delta,
   return search->AcceptDelta(delta, deltadelta);
 }
 
+bool MonitorsUseDeltas(Search* const search) { return search->UsesDeltas(); }
+
 void AcceptNeighbor(Search* const search) { search->AcceptNeighbor(); }
 
 namespace {
@@ -2821,6 +2831,8 @@ class Trace : public PropagationMonitor {
 
   ~Trace() override {}
 
+  bool UsesDeltas() const override { return false; }
+
   void BeginConstraintInitialPropagation(
       Constraint* const constraint) override {
     for (int i = 0; i < monitors_.size(); ++i) {
@@ -3671,6 +3671,13 @@ class SearchMonitor : public BaseObject {
   //
   virtual bool AcceptDelta(Assignment* delta, Assignment* deltadelta);
 
+  // Returns true if AcceptDelta() reads or modifies the deltas it is given.
+  // When no monitor of the search does, local search may pass empty deltas
+  // to AcceptDelta() instead of converting its own representation of the
+  // neighbors. Since any subclass may override AcceptDelta(), only the
+  // concrete classes which know they ignore the deltas return false.
+  virtual bool UsesDeltas() const { return true; }
+
   // After accepting a neighbor during local search.
   virtual void AcceptNeighbor();
 
@@ -4172,6 +4179,8 @@ class OptimizeVar : public SearchMonitor {
   void RefuteDecision(Decision* const d) override;
   bool AtSolution() override;
   bool AcceptSolution() override;
+  // Returns false for OptimizeVar itself, true for its subclasses.
+  bool UsesDeltas() const override;
   virtual std::string Print() const;
   std::string DebugString() const override;
   void Accept(ModelVisitor* const visitor) const override;
@@ -788,6 +788,129 @@ Demon* MakeDelayedConstraintDemon2(Solver* const s, T* const ct,
 
 // ---------- Local search operators ----------
 
+#if !defined(SWIG)
+// ----- Flat deltas -----
+
+// Compact representation of a neighbor on integer variables, as a list of
+// (variable, old value, new value) triples. It is an alternative to Assignment
+// for the deltas built by local search operators and checked by filters:
+// storage is reserved once for all the variables of an operator so building a
+// neighbor never allocates, and looking up a variable never builds a hash
+// table. Its read interface mirrors the one of Assignment and
+// Assignment::IntContainer, so that filters can be written once for both (see
+// IntVarLocalSearchFilter::AcceptFlat()).
+class IntVarFlatDelta {
+ public:
+  class Change {
+   public:
+    Change(IntVar* var, int64 old_value, int64 new_value, bool activated)
+        : var_(var),
+          old_value_(old_value),
+          new_value_(new_value),
+          activated_(activated) {}
+    IntVar* Var() const { return var_; }
+    int64 OldValue() const { return old_value_; }
+    int64 Value() const {
+      DCHECK(activated_);
+      return new_value_;
+    }
+    // As in Assignment, a deactivated variable is left unconstrained by the
+    // neighbor (Large Neighborhood Search).
+    bool Activated() const { return activated_; }
+    bool Bound() const { return activated_; }
+    int64 Min() const { return activated_ ? new_value_ : kint64min; }
+    int64 Max() const { return activated_ ? new_value_ : kint64max; }
+
+   private:
+    IntVar* var_;
+    int64 old_value_;
+    int64 new_value_;
+    bool activated_;
+  };
+
+  IntVarFlatDelta()
+      : objective_(nullptr),
+        objective_min_(kint64min),
+        objective_max_(kint64max) {}
+
+  void Reserve(int size) { changes_.reserve(size); }
+  void Clear() {
+    for (const Change& change : changes_) {
+      position_of_var_[change.Var()->index()] = -1;
+    }
+    changes_.clear();
+    objective_ = nullptr;
+    objective_min_ = kint64min;
+    objective_max_ = kint64max;
+  }
+  void Add(IntVar* var, int64 old_value, int64 new_value) {
+    SetPosition(var);
+    changes_.emplace_back(var, old_value, new_value, true);
+  }
+  void AddDeactivated(IntVar* var, int64 old_value) {
+    SetPosition(var);
+    changes_.emplace_back(var, old_value, old_value, false);
+  }
+
+  // Assignment::IntContainer interface.
+  const IntVarFlatDelta& IntVarContainer() const { return *this; }
+  bool Empty() const { return changes_.empty(); }
+  int Size() const { return changes_.size(); }
+  const Change& Element(int index) const { return changes_[index]; }
+  // Constant time lookups, through the index of the variable in the solver.
+  const Change* ElementPtrOrNull(const IntVar* const var) const {
+    const int var_index = var->index();
+    if (var_index >= position_of_var_.size()) return nullptr;
+    const int position = position_of_var_[var_index];
+    return position == -1 ? nullptr : &changes_[position];
+  }
+  const Change& Element(const IntVar* const var) const {
+    const Change* const change = ElementPtrOrNull(var);
+    DCHECK(change != nullptr) << "Unknown variable " << var->DebugString()
+                              << " in delta";
+    return *change;
+  }
+  bool Contains(const IntVar* const var) const {
+    return ElementPtrOrNull(var) != nullptr;
+  }
+
+  // Objective bounds of the neighbor, as set by search monitors on Assignment
+  // deltas.
+  IntVar* Objective() const { return objective_; }
+  int64 ObjectiveMin() const { return objective_min_; }
+  int64 ObjectiveMax() const { return objective_max_; }
+  void SetObjectiveRange(IntVar* objective, int64 min, int64 max) {
+    objective_ = objective;
+    objective_min_ = min;
+    objective_max_ = max;
+  }
+
+  // Adapter for code requiring Assignment deltas: clears 'assignment' and
+  // adds the changes of the delta to it. This goes through the hash table of
+  // the assignment, so it should only be called when an Assignment is really
+  // needed.
+  void ToAssignment(Assignment* assignment) const;
+
+ private:
+  void SetPosition(const IntVar* const var) {
+    const int var_index = var->index();
+    if (var_index >= position_of_var_.size()) {
+      position_of_var_.resize(var_index + 1, -1);
+    }
+    position_of_var_[var_index] = changes_.size();
+  }
+
+  std::vector<Change> changes_;
+  // Position in changes_ of each variable of the delta, indexed by
+  // IntVar::index(), -1 for the other variables. Only grows, and is reset
+  // by Clear() in time proportional to the size of the delta.
+  std::vector<int> position_of_var_;
+  IntVar* objective_;
+  int64 objective_min_;
+  int64 objective_max_;
+};
+#endif  // !defined(SWIG)
+
 // The base class for all local search operators.
 // A local search operator is an object which defines the neighborhood of a
 // solution; in other words, a neighborhood is the set of solutions which can
@@ -809,6 +932,18 @@ class LocalSearchOperator : public BaseObject {
   ~LocalSearchOperator() override {}
   virtual bool MakeNextNeighbor(Assignment* delta, Assignment* deltadelta) = 0;
   virtual void Start(const Assignment* assignment) = 0;
+#if !defined(SWIG)
+  // Operators which can build their neighbors as flat deltas return true here
+  // and implement MakeNextFlatNeighbor(), which must produce the same
+  // neighbors as MakeNextNeighbor(). This is decided by each concrete class,
+  // not inherited, since a subclass may override MakeNextNeighbor() only.
+  virtual bool HasFlatNeighbors() const { return false; }
+  virtual bool MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                                    IntVarFlatDelta* deltadelta) {
+    LOG(FATAL) << "Flat neighbors not supported by " << DebugString();
+    return false;
+  }
+#endif  // !defined(SWIG)
 };
 
 // ----- Base operator class for operators manipulating variables -----
@@ -1011,6 +1146,14 @@ class IntVarLocalSearchOperator
   // Therefore this method should not be overridden. Override MakeOneNeighbor()
   // instead.
   bool MakeNextNeighbor(Assignment* delta, Assignment* deltadelta) override;
+#if !defined(SWIG)
+  // Same as MakeNextNeighbor() for flat deltas. Operators overriding
+  // MakeOneNeighbor() only can return true from HasFlatNeighbors().
+  bool MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                            IntVarFlatDelta* deltadelta) override;
+  bool ApplyFlatChanges(IntVarFlatDelta* delta,
+                        IntVarFlatDelta* deltadelta) const;
+#endif  // !defined(SWIG)
 
  protected:
   // Creates a new neighbor. It returns false when the neighborhood is
@@ -1408,6 +1551,38 @@ class LocalSearchFilter : public BaseObject {
   virtual void Synchronize(const Assignment* assignment,
                            const Assignment* delta) = 0;
   virtual bool IsIncremental() const { return false; }
+
+#if !defined(SWIG)
+  // Filters which can check flat deltas directly return true here and
+  // implement AcceptFlat(), which must be equivalent to Accept(); other
+  // filters are given flat deltas converted to Assignment objects. Like
+  // LocalSearchOperator::HasFlatNeighbors(), this is decided by each concrete
+  // class.
+  virtual bool HasFlatAccept() const { return false; }
+  virtual bool AcceptFlat(const IntVarFlatDelta* delta,
+                          const IntVarFlatDelta* deltadelta) {
+    LOG(FATAL) << "Flat deltas not supported by " << DebugString();
+    return false;
+  }
+#endif  // !defined(SWIG)
+
+  // Returns the part of the objective value computed by the filter for the
+  // last delta it accepted, not including values injected by other filters.
+  // Used to rank neighbors when they are evaluated in batches.
+  virtual int64 GetAcceptedObjectiveValue() const { return 0LL; }
+
+  // Sets the objective value computed by the filters evaluated before this
+  // one on the next delta, for filters which add their own part of the
+  // objective to it.
+  virtual void InjectObjectiveValue(int64 objective_value) {}
+
+  // Returns a new filter, owned by the caller, which accepts the same deltas
+  // as this filter and can be used concurrently with it from another thread,
+  // or nullptr if the filter cannot be copied (the default). Copies must be
+  // synchronized separately and do not propagate objective values to other
+  // filters: the sum of the values accepted by the filters before them is
+  // passed to InjectObjectiveValue() instead.
+  virtual LocalSearchFilter* MakeThreadLocalCopy() const { return nullptr; }
 };
 
 // ----- IntVarLocalSearchFilter -----
@@ -1618,6 +1793,8 @@ class SearchLog : public SearchMonitor {
   void Maintain();
   void BeginInitialPropagation() override;
   void EndInitialPropagation() override;
+  // Returns false for SearchLog itself, true for its subclasses.
+  bool UsesDeltas() const override;
   std::string DebugString() const override;
 
  protected:
@@ -29,6 +29,8 @@
 #include "base/macros.h"
 #include "base/map_util.h"
 #include "base/hash.h"
+#include "base/synchronization.h"
+#include "base/threadpool.h"
 #include "constraint_solver/constraint_solver.h"
 #include "constraint_solver/constraint_solveri.h"
 #include "graph/hamiltonian_path.h"
@@ -38,12 +40,35 @@
 DEFINE_int32(cp_local_search_sync_frequency, 16,
              "Frequency of checks for better solutions in the solution pool.");
 
+DEFINE_int32(cp_local_search_batch_size, 1,
+             "Number of neighbors generated by local search operators before "
+             "being checked by filters as a batch; 1 disables batching.");
+
+DEFINE_int32(cp_local_search_batch_threads, 1,
+             "Number of threads checking batches of neighbors against copies "
+             "of the filters which support it; callbacks used by these filters "
+             "must then be thread-safe.");
+
+DEFINE_bool(cp_local_search_batch_best_improvement, false,
+            "If true, neighbors of a batch accepted by filters are tried by "
+            "increasing objective value as computed by filters, otherwise "
+            "they are tried in the order in which they were generated.");
+
+DEFINE_bool(cp_local_search_use_flat_deltas, false,
+            "If true and supported by the local search operator, neighbors "
+            "are built as flat deltas and passed as such to the filters "
+            "supporting them. Ignored when neighbors are checked in batches.");
+
 DEFINE_int32(cp_local_search_tsp_opt_size, 13,
              "Size of TSPs solved in the TSPOpt operator.");
 
 DEFINE_int32(cp_local_search_tsp_lns_size, 10,
              "Size of TSPs solved in the TSPLns operator.");
 
+DEFINE_int32(cp_local_search_tsp_threads, 1,
+             "Number of threads used to solve TSPs in the TSPOpt and TSPLns "
+             "operators.");
+
 DEFINE_bool(cp_use_empty_path_symmetry_breaker, true,
             "If true, equivalent empty paths are removed from the neighborhood "
             "of PathOperators");
@@ -61,6 +86,10 @@ bool LocalOptimumReached(Search* const search);
 bool AcceptDelta(Search* const search, Assignment* delta,
                  Assignment* deltadelta);
 
+// Returns true if a monitor of the search reads the deltas passed to
+// AcceptDelta() (see SearchMonitor::UsesDeltas()).
+bool MonitorsUseDeltas(Search* const search);
+
 // Notifies the search that a neighbor has been accepted by local search.
 void AcceptNeighbor(Search* const search);
 
@@ -83,9 +112,70 @@ bool IntVarLocalSearchOperator::MakeNextNeighbor(Assignment* delta,
   }
   return false;
 }
+
+bool IntVarLocalSearchOperator::MakeNextFlatNeighbor(
+    IntVarFlatDelta* delta, IntVarFlatDelta* deltadelta) {
+  CHECK(delta != nullptr);
+  delta->Reserve(Size());
+  deltadelta->Reserve(Size());
+  while (true) {
+    RevertChanges(true);
+
+    if (!MakeOneNeighbor()) {
+      return false;
+    }
+
+    if (ApplyFlatChanges(delta, deltadelta)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IntVarLocalSearchOperator::ApplyFlatChanges(
+    IntVarFlatDelta* delta, IntVarFlatDelta* deltadelta) const {
+  for (const int64 index : changes_.PositionsSetAtLeastOnce()) {
+    IntVar* const var = Var(index);
+    const int64 value = Value(index);
+    const int64 old_value = OldValue(index);
+    const bool in_deltadelta =
+        !cleared_ && delta_changes_[index] && IsIncremental();
+    if (!activated_[index]) {
+      if (in_deltadelta) {
+        deltadelta->AddDeactivated(var, old_value);
+      }
+      delta->AddDeactivated(var, old_value);
+    } else if (value != old_value || !SkipUnchanged(index)) {
+      if (in_deltadelta) {
+        deltadelta->Add(var, old_value, value);
+      }
+      delta->Add(var, old_value, value);
+    }
+  }
+  return true;
+}
+
 // TODO(user): Make this a pure virtual.
 bool IntVarLocalSearchOperator::MakeOneNeighbor() { return true; }
 
+// ----- Flat deltas -----
+
+void IntVarFlatDelta::ToAssignment(Assignment* assignment) const {
+  assignment->Clear();
+  for (const Change& change : changes_) {
+    IntVarElement* const element = assignment->FastAdd(change.Var());
+    if (change.Activated()) {
+      element->SetValue(change.Value());
+    } else {
+      element->Deactivate();
+    }
+  }
+  if (objective_ != nullptr) {
+    assignment->AddObjective(objective_);
+    assignment->SetObjectiveRange(objective_min_, objective_max_);
+  }
+}
+
 // ----- Base Large Neighborhood Search operator -----
 
 BaseLns::BaseLns(const std::vector<IntVar*>& vars)
@@ -669,6 +759,7 @@ class TwoOpt : public PathOperator {
         last_base_(-1),
         last_(-1) {}
   ~TwoOpt() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
   bool IsIncremental() const override { return true; }
 
@@ -740,6 +831,7 @@ class Relocate : public PathOperator {
     CHECK_GT(chain_length_, 0);
   }
   ~Relocate() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "Relocate"; }
@@ -786,6 +878,7 @@ class Exchange : public PathOperator {
            ResultCallback1<int, int64>* start_empty_path_class)
       : PathOperator(vars, secondary_vars, 2, start_empty_path_class) {}
   ~Exchange() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "Exchange"; }
@@ -827,6 +920,7 @@ class Cross : public PathOperator {
         ResultCallback1<int, int64>* start_empty_path_class)
       : PathOperator(vars, secondary_vars, 2, start_empty_path_class) {}
   ~Cross() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "Cross"; }
@@ -913,6 +1007,7 @@ class MakeActiveOperator : public BaseInactiveNodeToPathOperator {
       : BaseInactiveNodeToPathOperator(vars, secondary_vars, 1,
                                        start_empty_path_class) {}
   ~MakeActiveOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "MakeActiveOperator"; }
@@ -936,6 +1031,7 @@ class MakeActiveAndRelocate : public BaseInactiveNodeToPathOperator {
       : BaseInactiveNodeToPathOperator(vars, secondary_vars, 2,
                                        start_empty_path_class) {}
   ~MakeActiveAndRelocate() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override {
@@ -969,6 +1065,7 @@ class MakeInactiveOperator : public PathOperator {
                        ResultCallback1<int, int64>* start_empty_path_class)
       : PathOperator(vars, secondary_vars, 1, start_empty_path_class) {}
   ~MakeInactiveOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override {
     const int64 base = BaseNode(0);
     if (IsPathEnd(base)) {
@@ -996,6 +1093,7 @@ class MakeChainInactiveOperator : public PathOperator {
                             ResultCallback1<int, int64>* start_empty_path_class)
       : PathOperator(vars, secondary_vars, 2, start_empty_path_class) {}
   ~MakeChainInactiveOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override {
     return MakeChainInactive(BaseNode(0), BaseNode(1));
   }
@@ -1035,6 +1133,7 @@ class SwapActiveOperator : public BaseInactiveNodeToPathOperator {
       : BaseInactiveNodeToPathOperator(vars, secondary_vars, 1,
                                        start_empty_path_class) {}
   ~SwapActiveOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "SwapActiveOperator"; }
@@ -1070,6 +1169,7 @@ class ExtendedSwapActiveOperator : public BaseInactiveNodeToPathOperator {
       : BaseInactiveNodeToPathOperator(vars, secondary_vars, 2,
                                        start_empty_path_class) {}
   ~ExtendedSwapActiveOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "ExtendedSwapActiveOperator"; }
@@ -1093,6 +1193,50 @@ bool ExtendedSwapActiveOperator::MakeNeighbor() {
 
 // ----- TSP-based operators -----
 
+// Solves the TSPs of the TSP-based operators with HamiltonianPathSolver,
+// using 32-bit costs when the cost of any path fits in 32 bits, which halves
+// the memory used by the dynamic programming lattice.
+class TravelingSalesmanSolver {
+ public:
+  TravelingSalesmanSolver()
+      : solver_(std::vector<std::vector<int64>>()),
+        solver32_(cost32_) {
+    solver_.SetNumThreads(FLAGS_cp_local_search_tsp_threads);
+    solver32_.SetNumThreads(FLAGS_cp_local_search_tsp_threads);
+  }
+
+  // Stores in 'path' the shortest tour for 'cost', starting and ending at 0.
+  void TravelingSalesmanPath(const std::vector<std::vector<int64>>& cost,
+                             std::vector<PathNodeIndex>* path) {
+    if (PathCostsFitInt32(cost)) {
+      cost32_.resize(cost.size());
+      for (int i = 0; i < cost.size(); ++i) {
+        cost32_[i].assign(cost[i].begin(), cost[i].end());
+      }
+      solver32_.ChangeCostMatrix(cost32_);
+      solver32_.TravelingSalesmanPath(path);
+    } else {
+      solver_.ChangeCostMatrix(cost);
+      solver_.TravelingSalesmanPath(path);
+    }
+  }
+
+ private:
+  static bool PathCostsFitInt32(const std::vector<std::vector<int64>>& cost) {
+    const int64 max_cost = kint32max / std::max<int64>(1, cost.size());
+    for (const std::vector<int64>& row : cost) {
+      for (const int64 value : row) {
+        if (value > max_cost || value < -max_cost) return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<std::vector<int32>> cost32_;
+  HamiltonianPathSolver<int64> solver_;
+  HamiltonianPathSolver<int32> solver32_;
+};
+
 // Sliding TSP operator
 // Uses an exact dynamic programming algorithm to solve the TSP corresponding
 // to path sub-chains.
@@ -1105,13 +1249,14 @@ class TSPOpt : public PathOperator {
   TSPOpt(const std::vector<IntVar*>& vars, const std::vector<IntVar*>& secondary_vars,
          Solver::IndexEvaluator3 evaluator, int chain_length);
   ~TSPOpt() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "TSPOpt"; }
 
  private:
   std::vector<std::vector<int64> > cost_;
-  HamiltonianPathSolver<int64> hamiltonian_path_solver_;
+  TravelingSalesmanSolver tsp_solver_;
   Solver::IndexEvaluator3 evaluator_;
   const int chain_length_;
 };
@@ -1120,7 +1265,6 @@ TSPOpt::TSPOpt(const std::vector<IntVar*>& vars,
                const std::vector<IntVar*>& secondary_vars,
                Solver::IndexEvaluator3 evaluator, int chain_length)
     : PathOperator(vars, secondary_vars, 1, nullptr),
-      hamiltonian_path_solver_(cost_),
       evaluator_(evaluator),
       chain_length_(chain_length) {}
 
@@ -1147,9 +1291,8 @@ bool TSPOpt::MakeNeighbor() {
       cost_[i][j] = evaluator_(nodes[i], nodes[j], chain_path);
     }
   }
-  hamiltonian_path_solver_.ChangeCostMatrix(cost_);
   std::vector<PathNodeIndex> path;
-  hamiltonian_path_solver_.TravelingSalesmanPath(&path);
+  tsp_solver_.TravelingSalesmanPath(cost_, &path);
   CHECK_EQ(size + 1, path.size());
   for (int i = 0; i < size - 1; ++i) {
     SetNext(nodes[path[i]], nodes[path[i + 1]], chain_path);
@@ -1171,6 +1314,7 @@ class TSPLns : public PathOperator {
   TSPLns(const std::vector<IntVar*>& vars, const std::vector<IntVar*>& secondary_vars,
          Solver::IndexEvaluator3 evaluator, int tsp_size);
   ~TSPLns() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "TSPLns"; }
@@ -1180,7 +1324,7 @@ class TSPLns : public PathOperator {
 
  private:
   std::vector<std::vector<int64> > cost_;
-  HamiltonianPathSolver<int64> hamiltonian_path_solver_;
+  TravelingSalesmanSolver tsp_solver_;
   Solver::IndexEvaluator3 evaluator_;
   const int tsp_size_;
   ACMRandom rand_;
@@ -1190,7 +1334,6 @@ TSPLns::TSPLns(const std::vector<IntVar*>& vars,
                const std::vector<IntVar*>& secondary_vars,
                Solver::IndexEvaluator3 evaluator, int tsp_size)
     : PathOperator(vars, secondary_vars, 1, nullptr),
-      hamiltonian_path_solver_(cost_),
       evaluator_(std::move(evaluator)),
       tsp_size_(tsp_size),
       rand_(ACMRandom::HostnamePidTimeSeed()) {
@@ -1267,9 +1410,8 @@ bool TSPLns::MakeNeighbor() {
     cost_[i][i] = 0;
   }
   // Solve TSP and inject solution in delta (only if it leads to a new solution)
-  hamiltonian_path_solver_.ChangeCostMatrix(cost_);
   std::vector<PathNodeIndex> path;
-  hamiltonian_path_solver_.TravelingSalesmanPath(&path);
+  tsp_solver_.TravelingSalesmanPath(cost_, &path);
   bool nochange = true;
   for (int i = 0; i < path.size() - 1; ++i) {
     if (path[i] != i) {
@@ -1409,6 +1551,7 @@ class LinKernighan : public PathOperator {
                const std::vector<IntVar*>& secondary_vars,
                Solver::IndexEvaluator3 evaluator, bool topt);
   ~LinKernighan() override;
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "LinKernighan"; }
@@ -1555,6 +1698,7 @@ class PathLns : public PathOperator {
     CHECK_GE(chunk_size_, 0);
   }
   ~PathLns() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
   std::string DebugString() const override { return "PathLns"; }
@@ -1609,6 +1753,22 @@ void PathLns::DeactivateUnactives() {
   }
 }
 
+// ----- Forwarding of neighbors -----
+
+namespace {
+// Overloads used by operators wrapping other operators to share their code
+// between Assignment and flat deltas.
+bool MakeNextNeighborOf(LocalSearchOperator* const op, Assignment* delta,
+                        Assignment* deltadelta) {
+  return op->MakeNextNeighbor(delta, deltadelta);
+}
+
+bool MakeNextNeighborOf(LocalSearchOperator* const op, IntVarFlatDelta* delta,
+                        IntVarFlatDelta* deltadelta) {
+  return op->MakeNextFlatNeighbor(delta, deltadelta);
+}
+}  // namespace
+
 // ----- Limit the number of neighborhoods explored -----
 
 class NeighborhoodLimit : public LocalSearchOperator {
@@ -1625,16 +1785,28 @@ class NeighborhoodLimit : public LocalSearchOperator {
   }
 
   bool MakeNextNeighbor(Assignment* delta, Assignment* deltadelta) override {
+    return MakeNextLimitedNeighbor(delta, deltadelta);
+  }
+  bool HasFlatNeighbors() const override {
+    return operator_->HasFlatNeighbors();
+  }
+  bool MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                            IntVarFlatDelta* deltadelta) override {
+    return MakeNextLimitedNeighbor(delta, deltadelta);
+  }
+
+  std::string DebugString() const override { return "NeighborhoodLimit"; }
+
+ private:
+  template <class Delta>
+  bool MakeNextLimitedNeighbor(Delta* delta, Delta* deltadelta) {
     if (next_neighborhood_calls_ >= limit_) {
       return false;
     }
     ++next_neighborhood_calls_;
-    return operator_->MakeNextNeighbor(delta, deltadelta);
+    return MakeNextNeighborOf(operator_, delta, deltadelta);
   }
 
-  std::string DebugString() const override { return "NeighborhoodLimit"; }
-
- private:
   LocalSearchOperator* const operator_;
   const int64 limit_;
   int64 next_neighborhood_calls_;
@@ -1655,10 +1827,16 @@ class CompoundOperator : public LocalSearchOperator {
   ~CompoundOperator() override {}
   void Start(const Assignment* assignment) override;
   bool MakeNextNeighbor(Assignment* delta, Assignment* deltadelta) override;
+  bool HasFlatNeighbors() const override;
+  bool MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                            IntVarFlatDelta* deltadelta) override;
 
   std::string DebugString() const override { return "CompoundOperator"; }
 
  private:
+  template <class Delta>
+  bool MakeNextCompoundNeighbor(Delta* delta, Delta* deltadelta);
+
   class OperatorComparator {
    public:
     OperatorComparator(std::function<int64(int, int)> evaluator,
@@ -1726,6 +1904,26 @@ void CompoundOperator::Start(const Assignment* assignment) {
 
 bool CompoundOperator::MakeNextNeighbor(Assignment* delta,
                                         Assignment* deltadelta) {
+  return MakeNextCompoundNeighbor(delta, deltadelta);
+}
+
+bool CompoundOperator::HasFlatNeighbors() const {
+  for (int i = 0; i < size_; ++i) {
+    if (!operators_[i]->HasFlatNeighbors()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CompoundOperator::MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                                            IntVarFlatDelta* deltadelta) {
+  return MakeNextCompoundNeighbor(delta, deltadelta);
+}
+
+template <class Delta>
+bool CompoundOperator::MakeNextCompoundNeighbor(Delta* delta,
+                                                Delta* deltadelta) {
   if (size_ > 0) {
     do {
       // TODO(user): keep copy of delta in case MakeNextNeighbor
@@ -1735,7 +1933,7 @@ bool CompoundOperator::MakeNextNeighbor(Assignment* delta,
         operators_[operator_index]->Start(start_assignment_);
         started_.Set(operator_index);
       }
-      if (operators_[operator_index]->MakeNextNeighbor(delta, deltadelta)) {
+      if (MakeNextNeighborOf(operators_[operator_index], delta, deltadelta)) {
         return true;
       }
       ++index_;
@@ -1795,13 +1993,21 @@ class RandomCompoundOperator : public LocalSearchOperator {
   ~RandomCompoundOperator() override {}
   void Start(const Assignment* assignment) override;
   bool MakeNextNeighbor(Assignment* delta, Assignment* deltadelta) override;
+  bool HasFlatNeighbors() const override;
+  bool MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                            IntVarFlatDelta* deltadelta) override;
 
   std::string DebugString() const override { return "RandomCompoundOperator"; }
 
  private:
+  template <class Delta>
+  bool MakeNextRandomNeighbor(Delta* delta, Delta* deltadelta);
+
   const int size_;
   ACMRandom rand_;
   std::unique_ptr<LocalSearchOperator* []> operators_;
+  // Operator order of the current call, kept to avoid reallocating it.
+  std::vector<int> indices_;
 };
 
 void RandomCompoundOperator::Start(const Assignment* assignment) {
@@ -1814,7 +2020,8 @@ RandomCompoundOperator::RandomCompoundOperator(
     const std::vector<LocalSearchOperator*>& operators)
     : size_(operators.size()),
       rand_(ACMRandom::HostnamePidTimeSeed()),
-      operators_(new LocalSearchOperator*[size_]) {
+      operators_(new LocalSearchOperator*[size_]),
+      indices_(size_) {
   for (int i = 0; i < size_; ++i) {
     operators_[i] = operators[i];
   }
@@ -1824,7 +2031,8 @@ RandomCompoundOperator::RandomCompoundOperator(
     const std::vector<LocalSearchOperator*>& operators, int32 seed)
     : size_(operators.size()),
       rand_(seed),
-      operators_(new LocalSearchOperator*[size_]) {
+      operators_(new LocalSearchOperator*[size_]),
+      indices_(size_) {
   for (int i = 0; i < size_; ++i) {
     operators_[i] = operators[i];
   }
@@ -1832,13 +2040,34 @@ RandomCompoundOperator::RandomCompoundOperator(
 
 bool RandomCompoundOperator::MakeNextNeighbor(Assignment* delta,
                                               Assignment* deltadelta) {
-  std::vector<int> indices(size_);
+  return MakeNextRandomNeighbor(delta, deltadelta);
+}
+
+bool RandomCompoundOperator::HasFlatNeighbors() const {
   for (int i = 0; i < size_; ++i) {
-    indices[i] = i;
+    if (!operators_[i]->HasFlatNeighbors()) {
+      return false;
+    }
   }
-  std::random_shuffle(indices.begin(), indices.end(), rand_);
+  return true;
+}
+
+bool RandomCompoundOperator::MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                                                  IntVarFlatDelta* deltadelta) {
+  return MakeNextRandomNeighbor(delta, deltadelta);
+}
+
+template <class Delta>
+bool RandomCompoundOperator::MakeNextRandomNeighbor(Delta* delta,
+                                                    Delta* deltadelta) {
+  // Shuffling the identity permutation at each call keeps the sequence of
+  // operators identical for a given seed.
   for (int i = 0; i < size_; ++i) {
-    if (operators_[indices[i]]->MakeNextNeighbor(delta, deltadelta)) {
+    indices_[i] = i;
+  }
+  std::random_shuffle(indices_.begin(), indices_.end(), rand_);
+  for (int i = 0; i < size_; ++i) {
+    if (MakeNextNeighborOf(operators_[indices_[i]], delta, deltadelta)) {
       return true;
     }
   }
@@ -2105,19 +2334,33 @@ class VariableDomainFilter : public LocalSearchFilter {
  public:
   VariableDomainFilter() {}
   ~VariableDomainFilter() override {}
-  bool Accept(const Assignment* delta, const Assignment* deltadelta) override;
+  bool Accept(const Assignment* delta, const Assignment* deltadelta) override {
+    return AcceptDelta(delta);
+  }
+  bool HasFlatAccept() const override { return true; }
+  bool AcceptFlat(const IntVarFlatDelta* delta,
+                  const IntVarFlatDelta* deltadelta) override {
+    return AcceptDelta(delta);
+  }
   void Synchronize(const Assignment* assignment,
                    const Assignment* delta) override {}
+  LocalSearchFilter* MakeThreadLocalCopy() const override {
+    return new VariableDomainFilter();
+  }
 
   std::string DebugString() const override { return "VariableDomainFilter"; }
+
+ private:
+  template <class Delta>
+  bool AcceptDelta(const Delta* delta);
 };
 
-bool VariableDomainFilter::Accept(const Assignment* delta,
-                                  const Assignment* deltadelta) {
-  const Assignment::IntContainer& container = delta->IntVarContainer();
+template <class Delta>
+bool VariableDomainFilter::AcceptDelta(const Delta* delta) {
+  const auto& container = delta->IntVarContainer();
   const int size = container.Size();
   for (int i = 0; i < size; ++i) {
-    const IntVarElement& element = container.Element(i);
+    const auto& element = container.Element(i);
     if (element.Activated() && !element.Var()->Contains(element.Value())) {
       return false;
     }
@@ -2228,6 +2471,40 @@ class ObjectiveFilter : public IntVarLocalSearchFilter {
     delete[] delta_cache_;
   }
   bool Accept(const Assignment* delta, const Assignment* deltadelta) override {
+    return AcceptDelta(delta, deltadelta);
+  }
+  bool HasFlatAccept() const override { return true; }
+  bool AcceptFlat(const IntVarFlatDelta* delta,
+                  const IntVarFlatDelta* deltadelta) override {
+    return AcceptDelta(delta, deltadelta);
+  }
+  virtual int64 SynchronizedElementValue(int64 index) = 0;
+  virtual bool EvaluateElementValue(const Assignment::IntContainer& container,
+                                    int index, int* container_index,
+                                    int64* obj_value) = 0;
+  virtual bool EvaluateElementValue(const IntVarFlatDelta& container,
+                                    int index, int* container_index,
+                                    int64* obj_value) = 0;
+  bool IsIncremental() const override { return true; }
+  int64 GetAcceptedObjectiveValue() const override { return old_delta_value_; }
+
+  std::string DebugString() const override { return "ObjectiveFilter"; }
+
+ protected:
+  const int primary_vars_size_;
+  int64* const cache_;
+  int64* const delta_cache_;
+  Solver::ObjectiveWatcher delta_objective_callback_;
+  const IntVar* const objective_;
+  Solver::LocalSearchFilterBound filter_enum_;
+  Operator op_;
+  int64 old_value_;
+  int64 old_delta_value_;
+  bool incremental_;
+
+ private:
+  template <class Delta>
+  bool AcceptDelta(const Delta* delta, const Delta* deltadelta) {
     if (delta == nullptr) {
       return false;
     }
@@ -2275,27 +2552,6 @@ class ObjectiveFilter : public IntVarLocalSearchFilter {
       }
     }
   }
-  virtual int64 SynchronizedElementValue(int64 index) = 0;
-  virtual bool EvaluateElementValue(const Assignment::IntContainer& container,
-                                    int index, int* container_index,
-                                    int64* obj_value) = 0;
-  bool IsIncremental() const override { return true; }
-
-  std::string DebugString() const override { return "ObjectiveFilter"; }
-
- protected:
-  const int primary_vars_size_;
-  int64* const cache_;
-  int64* const delta_cache_;
-  Solver::ObjectiveWatcher delta_objective_callback_;
-  const IntVar* const objective_;
-  Solver::LocalSearchFilterBound filter_enum_;
-  Operator op_;
-  int64 old_value_;
-  int64 old_delta_value_;
-  bool incremental_;
-
- private:
   void OnSynchronize(const Assignment* delta) override {
     op_.Init();
     for (int i = 0; i < primary_vars_size_; ++i) {
@@ -2311,14 +2567,15 @@ class ObjectiveFilter : public IntVarLocalSearchFilter {
       delta_objective_callback_(op_.value());
     }
   }
-  int64 Evaluate(const Assignment* delta, int64 current_value,
+  template <class Delta>
+  int64 Evaluate(const Delta* delta, int64 current_value,
                  const int64* const out_values, bool cache_delta_values) {
     if (current_value == kint64max) return current_value;
     op_.set_value(current_value);
-    const Assignment::IntContainer& container = delta->IntVarContainer();
+    const auto& container = delta->IntVarContainer();
     const int size = container.Size();
     for (int i = 0; i < size; ++i) {
-      const IntVarElement& new_element = container.Element(i);
+      const auto& new_element = container.Element(i);
       IntVar* const var = new_element.Var();
       int64 index = -1;
       if (FindIndex(var, &index) && index < primary_vars_size_) {
@@ -2356,7 +2613,20 @@ class BinaryObjectiveFilter : public ObjectiveFilter<Operator> {
   bool EvaluateElementValue(const Assignment::IntContainer& container,
                             int index, int* container_index,
                             int64* obj_value) override {
-    const IntVarElement& element = container.Element(*container_index);
+    return EvaluateContainerElementValue(container, index, container_index,
+                                         obj_value);
+  }
+  bool EvaluateElementValue(const IntVarFlatDelta& container, int index,
+                            int* container_index, int64* obj_value) override {
+    return EvaluateContainerElementValue(container, index, container_index,
+                                         obj_value);
+  }
+
+ private:
+  template <class Container>
+  bool EvaluateContainerElementValue(const Container& container, int index,
+                                     int* container_index, int64* obj_value) {
+    const auto& element = container.Element(*container_index);
     if (element.Activated()) {
       *obj_value = value_evaluator_(index, element.Value());
       return true;
@@ -2370,7 +2640,6 @@ class BinaryObjectiveFilter : public ObjectiveFilter<Operator> {
     return false;
   }
 
- private:
   Solver::IndexEvaluator2 value_evaluator_;
 };
 
@@ -2402,9 +2671,22 @@ class TernaryObjectiveFilter : public ObjectiveFilter<Operator> {
   bool EvaluateElementValue(const Assignment::IntContainer& container,
                             int index, int* container_index,
                             int64* obj_value) override {
+    return EvaluateContainerElementValue(container, index, container_index,
+                                         obj_value);
+  }
+  bool EvaluateElementValue(const IntVarFlatDelta& container, int index,
+                            int* container_index, int64* obj_value) override {
+    return EvaluateContainerElementValue(container, index, container_index,
+                                         obj_value);
+  }
+
+ private:
+  template <class Container>
+  bool EvaluateContainerElementValue(const Container& container, int index,
+                                     int* container_index, int64* obj_value) {
     DCHECK_LT(index, secondary_vars_offset_);
     *obj_value = 0LL;
-    const IntVarElement& element = container.Element(*container_index);
+    const auto& element = container.Element(*container_index);
     const IntVar* secondary_var =
         IntVarLocalSearchFilter::Var(index + secondary_vars_offset_);
     if (element.Activated()) {
@@ -2430,7 +2712,6 @@ class TernaryObjectiveFilter : public ObjectiveFilter<Operator> {
     return false;
   }
 
- private:
   int secondary_vars_offset_;
   Solver::IndexEvaluator3 value_evaluator_;
 };
@@ -2534,9 +2815,39 @@ class FindOneNeighbor : public DecisionBuilder {
   std::string DebugString() const override { return "FindOneNeighbor"; }
 
  private:
-  bool FilterAccept(const Assignment* delta, const Assignment* deltadelta);
+  // A neighbor generated as part of a batch, along with the result of its
+  // evaluation by the filters.
+  struct BatchNeighbor {
+    std::unique_ptr<Assignment> delta;
+    bool accepted;
+    int64 objective_value;
+  };
+
+  bool FilterAccept(Assignment* delta, Assignment* deltadelta);
+  bool FilterAccept(LocalSearchFilter* const filter, Assignment* delta,
+                    Assignment* deltadelta);
+  // Builds the next neighbor, as a flat delta if flat deltas are used, in
+  // which case 'delta' and 'deltadelta' are left empty until
+  // BuildAssignmentDeltas() is called.
+  bool MakeNextNeighbor(Assignment* delta, Assignment* deltadelta);
+  // Copies the flat deltas of the current neighbor to 'delta' and
+  // 'deltadelta', if not already done. Only called when a search monitor, a
+  // filter without flat support, or the restoration of the neighbor needs
+  // them.
+  void BuildAssignmentDeltas(Assignment* delta, Assignment* deltadelta);
   void SynchronizeAll();
   void SynchronizeFilters(const Assignment* assignment);
+  // Generates a batch of neighbors accepted by the search and filters them;
+  // the ones accepted by all filters are stored in pending_neighbors_ in the
+  // order in which they must be tried. Returns false if no neighbor could be
+  // generated.
+  bool GenerateAndFilterBatch(Solver* const solver, Assignment* deltadelta);
+  // Sets up thread-local filter copies and the thread pool evaluating them.
+  void InitializeBatchWorkers();
+  // Thread pool tasks; 'barrier' is used to wait for all workers to be done.
+  void EvaluateBatchSlice(int worker, Barrier* barrier);
+  void SynchronizeThreadLocalFilters(int worker, Barrier* barrier);
+  void RunOnAllWorkers(void (FindOneNeighbor::*task)(int, Barrier*));
 
   Assignment* const assignment_;
   std::unique_ptr<Assignment> reference_assignment_;
@@ -2547,6 +2858,27 @@ class FindOneNeighbor : public DecisionBuilder {
   const SearchLimit* const original_limit_;
   bool neighbor_found_;
   std::vector<LocalSearchFilter*> filters_;
+  // See FLAGS_cp_local_search_use_flat_deltas.
+  const bool use_flat_deltas_;
+  IntVarFlatDelta flat_delta_;
+  IntVarFlatDelta flat_deltadelta_;
+  bool assignment_deltas_built_;
+  // Batched neighbor evaluation, see FLAGS_cp_local_search_batch_size.
+  const int batch_size_;
+  const int num_batch_workers_;
+  std::vector<BatchNeighbor> batch_;
+  int batch_fill_;
+  std::vector<int> pending_neighbors_;
+  int next_pending_neighbor_;
+  bool operator_exhausted_;
+  std::unique_ptr<Assignment> empty_deltadelta_;
+  // Filters evaluated on the search thread, and thread-local copies of the
+  // other filters, one set per worker thread.
+  std::vector<LocalSearchFilter*> search_thread_filters_;
+  std::vector<std::vector<std::unique_ptr<LocalSearchFilter>>>
+      thread_local_filters_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  const Assignment* synchronized_assignment_;
 };
 
 // reference_assignment_ is used to keep track of the last assignment on which
@@ -2566,7 +2898,17 @@ FindOneNeighbor::FindOneNeighbor(Assignment* const assignment,
       limit_(nullptr),
       original_limit_(limit),
       neighbor_found_(false),
-      filters_(filters) {
+      filters_(filters),
+      use_flat_deltas_(FLAGS_cp_local_search_use_flat_deltas &&
+                       FLAGS_cp_local_search_batch_size <= 1 &&
+                       ls_operator->HasFlatNeighbors()),
+      assignment_deltas_built_(false),
+      batch_size_(std::max(1, FLAGS_cp_local_search_batch_size)),
+      num_batch_workers_(std::max(1, FLAGS_cp_local_search_batch_threads)),
+      batch_fill_(0),
+      next_pending_neighbor_(0),
+      operator_exhausted_(false),
+      synchronized_assignment_(nullptr) {
   CHECK(nullptr != assignment);
   CHECK(nullptr != ls_operator);
 
@@ -2577,6 +2919,17 @@ FindOneNeighbor::FindOneNeighbor(Assignment* const assignment,
   } else {
     limit_ = limit->MakeClone();
   }
+  if (batch_size_ > 1) {
+    Solver* const solver = assignment_->solver();
+    batch_.resize(batch_size_);
+    for (BatchNeighbor& neighbor : batch_) {
+      neighbor.delta.reset(new Assignment(solver));
+      neighbor.accepted = false;
+      neighbor.objective_value = 0;
+    }
+    empty_deltadelta_.reset(new Assignment(solver));
+    search_thread_filters_ = filters_;
+  }
 }
 
 Decision* FindOneNeighbor::Next(Solver* const solver) {
@@ -2609,6 +2962,8 @@ Decision* FindOneNeighbor::Next(Solver* const solver) {
     }
     Assignment* delta = solver->MakeAssignment();
     Assignment* deltadelta = solver->MakeAssignment();
+    const bool monitors_use_deltas =
+        use_flat_deltas_ && MonitorsUseDeltas(solver->ParentSearch());
     while (true) {
       delta->Clear();
       deltadelta->Clear();
@@ -2620,19 +2975,48 @@ Decision* FindOneNeighbor::Next(Solver* const solver) {
         SynchronizeAll();
       }
 
-      if (!limit_->Check() &&
-          ls_operator_->MakeNextNeighbor(delta, deltadelta)) {
+      if (batch_size_ > 1) {
+        if (!limit_->Check() &&
+            (next_pending_neighbor_ < pending_neighbors_.size() ||
+             GenerateAndFilterBatch(solver, deltadelta))) {
+          if (next_pending_neighbor_ < pending_neighbors_.size()) {
+            const Assignment* const neighbor =
+                batch_[pending_neighbors_[next_pending_neighbor_++]]
+                    .delta.get();
+            assignment_copy->Copy(reference_assignment_.get());
+            assignment_copy->Copy(neighbor);
+            if (solver->SolveAndCommit(restore)) {
+              solver->accepted_neighbors_ += 1;
+              assignment_->Store();
+              neighbor_found_ = true;
+              // The remaining neighbors are moves from the reference
+              // assignment this neighbor replaces.
+              pending_neighbors_.clear();
+              next_pending_neighbor_ = 0;
+              return nullptr;
+            }
+          }
+          continue;
+        }
+      } else if (!limit_->Check() && MakeNextNeighbor(delta, deltadelta)) {
         solver->neighbors_ += 1;
         // All filters must be called for incrementality reasons.
         // Empty deltas must also be sent to incremental filters; can be needed
         // to resync filters on non-incremental (empty) moves.
         // TODO(user): Don't call both if no filter is incremental and one
         // of them returned false.
+        if (monitors_use_deltas) BuildAssignmentDeltas(delta, deltadelta);
         const bool mh_filter =
             AcceptDelta(solver->ParentSearch(), delta, deltadelta);
+        if (use_flat_deltas_ && delta->HasObjective()) {
+          flat_delta_.SetObjectiveRange(delta->Objective(),
+                                        delta->ObjectiveMin(),
+                                        delta->ObjectiveMax());
+        }
         const bool move_filter = FilterAccept(delta, deltadelta);
         if (mh_filter && move_filter) {
           solver->filtered_neighbors_ += 1;
+          if (use_flat_deltas_) BuildAssignmentDeltas(delta, deltadelta);
           assignment_copy->Copy(reference_assignment_.get());
           assignment_copy->Copy(delta);
           if (solver->SolveAndCommit(restore)) {
@@ -2642,17 +3026,17 @@ Decision* FindOneNeighbor::Next(Solver* const solver) {
             return nullptr;
           }
         }
+        continue;
+      }
+      if (neighbor_found_) {
+        AcceptNeighbor(solver->ParentSearch());
+        // Keeping the code in case a performance problem forces us to
+        // use the old code with a zero test on pool_.
+        //          reference_assignment_->Copy(assignment_);
+        pool_->RegisterNewSolution(assignment_);
+        SynchronizeAll();
       } else {
-        if (neighbor_found_) {
-          AcceptNeighbor(solver->ParentSearch());
-          // Keeping the code in case a performance problem forces us to
-          // use the old code with a zero test on pool_.
-          //          reference_assignment_->Copy(assignment_);
-          pool_->RegisterNewSolution(assignment_);
-          SynchronizeAll();
-        } else {
-          break;
-        }
+        break;
       }
     }
   }
@@ -2660,31 +3044,196 @@ Decision* FindOneNeighbor::Next(Solver* const solver) {
   return nullptr;
 }
 
-bool FindOneNeighbor::FilterAccept(const Assignment* delta,
-                                   const Assignment* deltadelta) {
+bool FindOneNeighbor::FilterAccept(Assignment* delta,
+                                   Assignment* deltadelta) {
   bool ok = true;
   for (int i = 0; i < filters_.size(); ++i) {
     if (filters_[i]->IsIncremental()) {
-      ok = filters_[i]->Accept(delta, deltadelta) && ok;
+      ok = FilterAccept(filters_[i], delta, deltadelta) && ok;
     } else {
-      ok = ok && filters_[i]->Accept(delta, deltadelta);
+      ok = ok && FilterAccept(filters_[i], delta, deltadelta);
     }
   }
   return ok;
 }
 
+bool FindOneNeighbor::FilterAccept(LocalSearchFilter* const filter,
+                                   Assignment* delta, Assignment* deltadelta) {
+  if (use_flat_deltas_) {
+    if (filter->HasFlatAccept()) {
+      return filter->AcceptFlat(&flat_delta_, &flat_deltadelta_);
+    }
+    BuildAssignmentDeltas(delta, deltadelta);
+  }
+  return filter->Accept(delta, deltadelta);
+}
+
+bool FindOneNeighbor::MakeNextNeighbor(Assignment* delta,
+                                       Assignment* deltadelta) {
+  if (!use_flat_deltas_) {
+    return ls_operator_->MakeNextNeighbor(delta, deltadelta);
+  }
+  flat_delta_.Clear();
+  flat_deltadelta_.Clear();
+  assignment_deltas_built_ = false;
+  return ls_operator_->MakeNextFlatNeighbor(&flat_delta_, &flat_deltadelta_);
+}
+
+void FindOneNeighbor::BuildAssignmentDeltas(Assignment* delta,
+                                            Assignment* deltadelta) {
+  DCHECK(use_flat_deltas_);
+  if (assignment_deltas_built_) return;
+  flat_delta_.ToAssignment(delta);
+  flat_deltadelta_.ToAssignment(deltadelta);
+  assignment_deltas_built_ = true;
+}
+
 void FindOneNeighbor::SynchronizeAll() {
   pool_->GetNextSolution(reference_assignment_.get());
   neighbor_found_ = false;
   limit_->Init();
   ls_operator_->Start(reference_assignment_.get());
   SynchronizeFilters(reference_assignment_.get());
+  // Neighbors of the previous reference assignment are now meaningless.
+  pending_neighbors_.clear();
+  next_pending_neighbor_ = 0;
+  operator_exhausted_ = false;
 }
 
 void FindOneNeighbor::SynchronizeFilters(const Assignment* assignment) {
   for (int i = 0; i < filters_.size(); ++i) {
     filters_[i]->Synchronize(assignment, nullptr);
   }
+  if (thread_pool_ != nullptr) {
+    synchronized_assignment_ = assignment;
+    RunOnAllWorkers(&FindOneNeighbor::SynchronizeThreadLocalFilters);
+  }
+}
+
+// Neighbors are generated sequentially since operators and search monitors
+// are not thread-safe; each of them is then checked by filters with an empty
+// deltadelta as neighbors of a batch are not necessarily evaluated in the order
+// in which they were generated.
+bool FindOneNeighbor::GenerateAndFilterBatch(Solver* const solver,
+                                             Assignment* deltadelta) {
+  pending_neighbors_.clear();
+  next_pending_neighbor_ = 0;
+  batch_fill_ = 0;
+  int num_generated = 0;
+  while (batch_fill_ < batch_size_ && !operator_exhausted_ &&
+         !limit_->Check()) {
+    Assignment* const delta = batch_[batch_fill_].delta.get();
+    delta->Clear();
+    deltadelta->Clear();
+    if (!ls_operator_->MakeNextNeighbor(delta, deltadelta)) {
+      operator_exhausted_ = true;
+      break;
+    }
+    solver->neighbors_ += 1;
+    ++num_generated;
+    if (AcceptDelta(solver->ParentSearch(), delta, deltadelta)) {
+      ++batch_fill_;
+    }
+  }
+  if (batch_fill_ == 0) return num_generated > 0;
+  if (num_batch_workers_ > 1 && thread_pool_ == nullptr) {
+    InitializeBatchWorkers();
+  }
+  // The filters evaluated on the search thread come first: this includes the
+  // objective filter, of which the value is then injected in the thread-local
+  // copies of the filters following it.
+  for (int i = 0; i < batch_fill_; ++i) {
+    BatchNeighbor* const neighbor = &batch_[i];
+    neighbor->accepted = true;
+    neighbor->objective_value = 0;
+    for (LocalSearchFilter* const filter : search_thread_filters_) {
+      if (!filter->Accept(neighbor->delta.get(), empty_deltadelta_.get())) {
+        neighbor->accepted = false;
+        break;
+      }
+      neighbor->objective_value = CapAdd(neighbor->objective_value,
+                                         filter->GetAcceptedObjectiveValue());
+    }
+  }
+  if (thread_pool_ != nullptr) {
+    RunOnAllWorkers(&FindOneNeighbor::EvaluateBatchSlice);
+  }
+  for (int i = 0; i < batch_fill_; ++i) {
+    if (batch_[i].accepted) {
+      solver->filtered_neighbors_ += 1;
+      pending_neighbors_.push_back(i);
+    }
+  }
+  if (FLAGS_cp_local_search_batch_best_improvement) {
+    std::stable_sort(pending_neighbors_.begin(), pending_neighbors_.end(),
+                     [this](int a, int b) {
+      return batch_[a].objective_value < batch_[b].objective_value;
+    });
+  }
+  return true;
+}
+
+void FindOneNeighbor::InitializeBatchWorkers() {
+  std::vector<LocalSearchFilter*> search_thread_filters;
+  thread_local_filters_.resize(num_batch_workers_);
+  for (LocalSearchFilter* const filter : filters_) {
+    std::unique_ptr<LocalSearchFilter> copy(filter->MakeThreadLocalCopy());
+    if (copy == nullptr) {
+      search_thread_filters.push_back(filter);
+      continue;
+    }
+    thread_local_filters_[0].push_back(std::move(copy));
+    for (int worker = 1; worker < num_batch_workers_; ++worker) {
+      thread_local_filters_[worker].emplace_back(filter->MakeThreadLocalCopy());
+    }
+  }
+  if (search_thread_filters.size() == filters_.size()) {
+    // No filter can be evaluated concurrently.
+    thread_local_filters_.clear();
+    return;
+  }
+  search_thread_filters_.swap(search_thread_filters);
+  thread_pool_.reset(new ThreadPool("LocalSearchFilters", num_batch_workers_));
+  thread_pool_->StartWorkers();
+  synchronized_assignment_ = reference_assignment_.get();
+  RunOnAllWorkers(&FindOneNeighbor::SynchronizeThreadLocalFilters);
+}
+
+void FindOneNeighbor::RunOnAllWorkers(
+    void (FindOneNeighbor::*task)(int, Barrier*)) {
+  // The last thread leaving the barrier deletes it.
+  Barrier* const barrier = new Barrier(num_batch_workers_ + 1);
+  for (int worker = 0; worker < num_batch_workers_; ++worker) {
+    thread_pool_->Add(NewCallback(this, task, worker, barrier));
+  }
+  if (barrier->Block()) delete barrier;
+}
+
+void FindOneNeighbor::EvaluateBatchSlice(int worker, Barrier* barrier) {
+  for (int i = worker; i < batch_fill_; i += num_batch_workers_) {
+    BatchNeighbor* const neighbor = &batch_[i];
+    if (!neighbor->accepted) continue;
+    for (const std::unique_ptr<LocalSearchFilter>& filter :
+         thread_local_filters_[worker]) {
+      filter->InjectObjectiveValue(neighbor->objective_value);
+      if (!filter->Accept(neighbor->delta.get(), empty_deltadelta_.get())) {
+        neighbor->accepted = false;
+        break;
+      }
+      neighbor->objective_value = CapAdd(neighbor->objective_value,
+                                         filter->GetAcceptedObjectiveValue());
+    }
+  }
+  if (barrier->Block()) delete barrier;
+}
+
+void FindOneNeighbor::SynchronizeThreadLocalFilters(int worker,
+                                                    Barrier* barrier) {
+  for (const std::unique_ptr<LocalSearchFilter>& filter :
+       thread_local_filters_[worker]) {
+    filter->Synchronize(synchronized_assignment_, nullptr);
+  }
+  if (barrier->Block()) delete barrier;
 }
 
 // ---------- Local Search Phase Parameters ----------
@@ -21,6 +21,7 @@
 #include "base/hash.h"
 #include <map>
 #include <memory>
+#include <queue>
 
 #include "base/callback.h"
 #include "base/casts.h"
@@ -28,9 +29,11 @@
 #include "base/integral_types.h"
 #include "base/logging.h"
 #include "base/map_util.h"
+#include "base/mutex.h"
 #include "base/stl_util.h"
 #include "base/thorough_hash.h"
 #include "base/hash.h"
+#include "base/threadpool.h"
 #include "graph/linear_assignment.h"
 #include "util/saturated_arithmetic.h"
 
@@ -117,6 +120,10 @@ DEFINE_int64(savings_filter_neighbors, 0,
              "Use filter which filters the pair of orders considered in "
              "Savings first solution heuristic by limiting the number "
              "of neighbors considered for each node.");
+DEFINE_int32(savings_threads, 1,
+             "Number of threads used to compute the savings of the filtered "
+             "Savings first solution heuristic; arc cost callbacks must then "
+             "be thread-safe.");
 DEFINE_int64(savings_filter_radius, 0,
              "Use filter which filters the pair of orders considered in "
              "Savings first solution heuristic by limiting the distance "
@@ -144,6 +151,19 @@ DEFINE_bool(routing_check_compact_assignment, true,
 DEFINE_bool(routing_fingerprint_arc_cost_evaluators, true,
             "Compare arc-cost evaluators using the fingerprint of their "
             "corresponding matrix instead of evaluator addresses.");
+DEFINE_int32(routing_lower_bound_candidates, 10,
+             "Number of cheapest arcs leaving each node kept in the candidate "
+             "graph on which the Held-Karp lower bound is optimized; 0 keeps "
+             "all arcs.");
+DEFINE_int32(routing_lower_bound_iterations, 10000,
+             "Maximum number of subgradient iterations when computing the "
+             "Held-Karp lower bound.");
+DEFINE_int32(routing_lower_bound_threads, 1,
+             "Number of threads used to compute the Held-Karp lower bound; "
+             "arc cost callbacks must then be thread-safe.");
+DEFINE_bool(routing_trace_lower_bound, false,
+            "Routing: computes a lower bound when closing the model and logs "
+            "the optimality gap of each solution found.");
 
 #if defined(_MSC_VER)
 namespace stdext {
@@ -313,6 +333,7 @@ class MakeRelocateNeighborsOperator : public PathOperator {
     prevs_.resize(max_next + 1, -1);
   }
   ~MakeRelocateNeighborsOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override {
     const int64 before_chain = BaseNode(0);
     if (IsPathEnd(before_chain)) {
@@ -437,8 +458,11 @@ class MakePairActiveOperator : public PathOperator {
         inactive_pair_(0),
         pairs_(pairs) {}
   ~MakePairActiveOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   std::string DebugString() const override { return "MakePairActive"; }
   bool MakeNextNeighbor(Assignment* delta, Assignment* deltadelta) override;
+  bool MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                            IntVarFlatDelta* deltadelta) override;
   bool MakeNeighbor() override;
 
  protected:
@@ -461,6 +485,15 @@ class MakePairActiveOperator : public PathOperator {
 
  private:
   void OnNodeInitialization() override;
+  template <class Delta>
+  bool MakeNextPairNeighbor(Delta* delta, Delta* deltadelta);
+  bool MakeNextPathNeighbor(Assignment* delta, Assignment* deltadelta) {
+    return PathOperator::MakeNextNeighbor(delta, deltadelta);
+  }
+  bool MakeNextPathNeighbor(IntVarFlatDelta* delta,
+                            IntVarFlatDelta* deltadelta) {
+    return PathOperator::MakeNextFlatNeighbor(delta, deltadelta);
+  }
 
   int inactive_pair_;
   RoutingModel::NodePairs pairs_;
@@ -478,10 +511,21 @@ void MakePairActiveOperator::OnNodeInitialization() {
 
 bool MakePairActiveOperator::MakeNextNeighbor(Assignment* delta,
                                               Assignment* deltadelta) {
+  return MakeNextPairNeighbor(delta, deltadelta);
+}
+
+bool MakePairActiveOperator::MakeNextFlatNeighbor(IntVarFlatDelta* delta,
+                                                  IntVarFlatDelta* deltadelta) {
+  return MakeNextPairNeighbor(delta, deltadelta);
+}
+
+template <class Delta>
+bool MakePairActiveOperator::MakeNextPairNeighbor(Delta* delta,
+                                                  Delta* deltadelta) {
   while (inactive_pair_ < pairs_.size()) {
     if (!IsInactive(pairs_[inactive_pair_].first) ||
         !IsInactive(pairs_[inactive_pair_].second) ||
-        !PathOperator::MakeNextNeighbor(delta, deltadelta)) {
+        !MakeNextPathNeighbor(delta, deltadelta)) {
       ResetPosition();
       ++inactive_pair_;
     } else {
@@ -544,6 +588,7 @@ class PairRelocateOperator : public PathOperator {
     }
   }
   ~PairRelocateOperator() override {}
+  bool HasFlatNeighbors() const override { return true; }
   bool MakeNeighbor() override;
 
  protected:
@@ -637,7 +682,10 @@ class RoutingCache : public RoutingModel::NodeEvaluator2 {
     // checks if it has been run with these parameters before, and
     // returns previous result if so, or runs underlaying callback and
     // stores its result.
-    // Not MT-safe.
+    // The lock makes this MT-safe, since the thread-local copies of the local
+    // search filters may run it concurrently (see
+    // FLAGS_cp_local_search_batch_threads).
+    MutexLock lock(&mutex_);
     if (cached_[i][j]) {
       return cache_[i][j];
     } else {
@@ -654,6 +702,7 @@ class RoutingCache : public RoutingModel::NodeEvaluator2 {
   ITIVector<RoutingModel::NodeIndex, ITIVector<RoutingModel::NodeIndex, int64>>
       cache_;
   RoutingModel::NodeEvaluator2* const callback_;
+  Mutex mutex_;
 };
 
 // Evaluators
@@ -2740,6 +2789,432 @@ const Assignment* RoutingModel::Solve(const Assignment* assignment) {
   }
 }
 
+// ----- Held-Karp lower bound -----
+
+namespace {
+// Computes the Held-Karp lower bound of a symmetric traveling salesman problem:
+// the maximum over node penalties pi of the cost of a minimum 1-tree (a
+// spanning tree on all nodes but a root node, plus the two cheapest edges
+// incident to the root) for edge costs c(i, j) + pi[i] + pi[j], minus
+// 2 * sum(pi). Penalties are optimized by subgradient ascent on a sparse
+// candidate graph made of the cheapest arcs leaving each node. The 1-tree of
+// the best penalties found is then computed on the complete graph, which
+// makes the result a valid bound whatever the candidate graph, in linear
+// memory.
+class HeldKarpBound {
+ public:
+  // 'arc_cost(tail, head)' returns the cost of the arc from tail to head, or
+  // kint64max if the arc is forbidden; the cost of an edge is the cost of its
+  // cheapest arc.
+  HeldKarpBound(int num_nodes, int root,
+                std::function<int64(int, int)> arc_cost)
+      : num_nodes_(num_nodes), root_(root), arc_cost_(std::move(arc_cost)) {}
+
+  // Computes the bound. With more than one thread, the candidate graph is
+  // built in parallel (arc costs of different tails being computed
+  // concurrently) and independent subgradient ascents with different step
+  // sizes are run in parallel.
+  int64 Compute(int num_candidates, int max_iterations, int num_threads);
+
+ private:
+  struct AscentResult {
+    double bound;
+    std::vector<double> penalties;
+  };
+
+  int64 EdgeCost(int i, int j) const {
+    return std::min(arc_cost_(i, j), arc_cost_(j, i));
+  }
+  void BuildCandidateGraph(int num_candidates, int num_threads);
+  // Stores the 'num_candidates' cheapest arcs leaving each node in
+  // [first_tail, last_tail) in nearest_arcs_.
+  void ComputeNearestArcs(int first_tail, int last_tail, int num_candidates);
+  // Return the penalized cost of a minimum 1-tree of the candidate graph
+  // (respectively of the complete graph), or -infinity if there is none.
+  // SparseOneTree() also returns the degrees of the nodes in the 1-tree.
+  double SparseOneTree(const std::vector<double>& penalties,
+                       std::vector<int>* degrees) const;
+  double CompleteOneTree(const std::vector<double>& penalties) const;
+  // Subgradient ascent, with the step size rules of the LKH heuristic;
+  // 'step_factor' scales the initial step.
+  void Ascent(double step_factor, int max_iterations,
+              AscentResult* result) const;
+
+  const int num_nodes_;
+  const int root_;
+  std::function<int64(int, int)> arc_cost_;
+  std::vector<std::vector<std::pair<int64, int>>> nearest_arcs_;
+  // Candidate graph as adjacency lists; the neighbors of node i are in
+  // [adjacency_start_[i], adjacency_start_[i + 1]).
+  std::vector<int> adjacency_start_;
+  std::vector<int> adjacency_heads_;
+  std::vector<int64> adjacency_costs_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeldKarpBound);
+};
+
+const double kNoOneTree = -std::numeric_limits<double>::infinity();
+
+int64 HeldKarpBound::Compute(int num_candidates, int max_iterations,
+                             int num_threads) {
+  if (num_nodes_ < 3) {
+    return 0;
+  }
+  int candidates = num_candidates <= 0
+                       ? num_nodes_ - 1
+                       : std::min(num_candidates, num_nodes_ - 1);
+  std::vector<int> degrees(num_nodes_);
+  const std::vector<double> no_penalties(num_nodes_, 0.0);
+  // Growing the candidate graph until it contains a 1-tree.
+  while (true) {
+    BuildCandidateGraph(candidates, num_threads);
+    if (SparseOneTree(no_penalties, &degrees) != kNoOneTree ||
+        candidates == num_nodes_ - 1) {
+      break;
+    }
+    candidates = std::min(2 * candidates, num_nodes_ - 1);
+  }
+  const int num_ascents = std::max(1, num_threads);
+  std::vector<AscentResult> results(num_ascents);
+  // Step factors are 1, 2, 1/2, 4, 1/4...
+  std::vector<double> step_factors(num_ascents, 1.0);
+  for (int i = 1; i < num_ascents; ++i) {
+    step_factors[i] = i % 2 == 1 ? 2 * step_factors[std::max(0, i - 2)]
+                                 : step_factors[i - 2] / 2;
+  }
+  if (num_ascents == 1) {
+    Ascent(step_factors[0], max_iterations, &results[0]);
+  } else {
+    ThreadPool pool("HeldKarpBound", num_ascents);
+    pool.StartWorkers();
+    for (int i = 0; i < num_ascents; ++i) {
+      pool.Add(NewCallback(this, &HeldKarpBound::Ascent, step_factors[i],
+                           max_iterations, &results[i]));
+    }
+  }
+  const AscentResult* best = &results[0];
+  for (const AscentResult& result : results) {
+    if (result.bound > best->bound) {
+      best = &result;
+    }
+  }
+  const double bound = CompleteOneTree(best->bound != kNoOneTree
+                                           ? best->penalties
+                                           : no_penalties);
+  if (bound == kNoOneTree) {
+    return 0;
+  }
+  // Costs being integral, the bound can be rounded up, with a tolerance for
+  // rounding errors.
+  return static_cast<int64>(
+      std::ceil(bound - 1e-9 * std::max(1.0, std::abs(bound))));
+}
+
+void HeldKarpBound::BuildCandidateGraph(int num_candidates, int num_threads) {
+  nearest_arcs_.assign(num_nodes_, std::vector<std::pair<int64, int>>());
+  if (num_threads <= 1) {
+    ComputeNearestArcs(0, num_nodes_, num_candidates);
+  } else {
+    ThreadPool pool("HeldKarpCandidates", num_threads);
+    pool.StartWorkers();
+    const int chunk_size = (num_nodes_ + num_threads - 1) / num_threads;
+    for (int first = 0; first < num_nodes_; first += chunk_size) {
+      pool.Add(NewCallback(this, &HeldKarpBound::ComputeNearestArcs, first,
+                           std::min(first + chunk_size, num_nodes_),
+                           num_candidates));
+    }
+  }
+  // Edges are collected as (min node, max node, cost) and merged. All edges
+  // incident to the root are added to make sure it has two neighbors.
+  std::vector<std::pair<std::pair<int, int>, int64>> edges;
+  for (int tail = 0; tail < num_nodes_; ++tail) {
+    for (const std::pair<int64, int>& arc : nearest_arcs_[tail]) {
+      edges.push_back(std::make_pair(
+          std::make_pair(std::min(tail, arc.second), std::max(tail, arc.second)),
+          arc.first));
+    }
+  }
+  nearest_arcs_.clear();
+  for (int node = 0; node < num_nodes_; ++node) {
+    if (node != root_) {
+      const int64 cost = EdgeCost(root_, node);
+      if (cost != kint64max) {
+        edges.push_back(std::make_pair(
+            std::make_pair(std::min(root_, node), std::max(root_, node)),
+            cost));
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  adjacency_start_.assign(num_nodes_ + 1, 0);
+  int num_edges = 0;
+  for (int i = 0; i < edges.size(); ++i) {
+    // Keeping the cheapest arc of each edge, which comes first.
+    if (i > 0 && edges[i].first == edges[num_edges - 1].first) continue;
+    edges[num_edges++] = edges[i];
+    ++adjacency_start_[edges[i].first.first + 1];
+    ++adjacency_start_[edges[i].first.second + 1];
+  }
+  edges.resize(num_edges);
+  for (int node = 0; node < num_nodes_; ++node) {
+    adjacency_start_[node + 1] += adjacency_start_[node];
+  }
+  adjacency_heads_.resize(2 * num_edges);
+  adjacency_costs_.resize(2 * num_edges);
+  std::vector<int> next_position(adjacency_start_.begin(),
+                                 adjacency_start_.end() - 1);
+  for (const std::pair<std::pair<int, int>, int64>& edge : edges) {
+    const int first = edge.first.first;
+    const int second = edge.first.second;
+    adjacency_heads_[next_position[first]] = second;
+    adjacency_costs_[next_position[first]++] = edge.second;
+    adjacency_heads_[next_position[second]] = first;
+    adjacency_costs_[next_position[second]++] = edge.second;
+  }
+}
+
+void HeldKarpBound::ComputeNearestArcs(int first_tail, int last_tail,
+                                       int num_candidates) {
+  std::vector<std::pair<int64, int>> arcs;
+  arcs.reserve(num_nodes_);
+  for (int tail = first_tail; tail < last_tail; ++tail) {
+    arcs.clear();
+    for (int head = 0; head < num_nodes_; ++head) {
+      if (head == tail) continue;
+      const int64 cost = arc_cost_(tail, head);
+      if (cost != kint64max) {
+        arcs.push_back(std::make_pair(cost, head));
+      }
+    }
+    if (arcs.size() > num_candidates) {
+      std::nth_element(arcs.begin(), arcs.begin() + num_candidates - 1,
+                       arcs.end());
+      arcs.resize(num_candidates);
+    }
+    nearest_arcs_[tail] = arcs;
+  }
+}
+
+double HeldKarpBound::SparseOneTree(const std::vector<double>& penalties,
+                                    std::vector<int>* degrees) const {
+  // Prim's algorithm on all nodes but the root.
+  typedef std::pair<double, int> KeyAndNode;
+  std::priority_queue<KeyAndNode, std::vector<KeyAndNode>,
+                      std::greater<KeyAndNode>> queue;
+  std::vector<double> keys(num_nodes_, std::numeric_limits<double>::infinity());
+  std::vector<int> parents(num_nodes_, -1);
+  std::vector<bool> in_tree(num_nodes_, false);
+  degrees->assign(num_nodes_, 0);
+  double cost = 0;
+  int tree_size = 0;
+  const int first_node = root_ == 0 ? 1 : 0;
+  keys[first_node] = 0;
+  queue.push(std::make_pair(0.0, first_node));
+  while (!queue.empty()) {
+    const KeyAndNode top = queue.top();
+    queue.pop();
+    const int node = top.second;
+    if (in_tree[node] || top.first > keys[node]) continue;
+    in_tree[node] = true;
+    ++tree_size;
+    cost += top.first;
+    if (parents[node] != -1) {
+      ++(*degrees)[node];
+      ++(*degrees)[parents[node]];
+    }
+    for (int i = adjacency_start_[node]; i < adjacency_start_[node + 1]; ++i) {
+      const int head = adjacency_heads_[i];
+      if (head == root_ || in_tree[head]) continue;
+      const double key = adjacency_costs_[i] + penalties[node] + penalties[head];
+      if (key < keys[head]) {
+        keys[head] = key;
+        parents[head] = node;
+        queue.push(std::make_pair(key, head));
+      }
+    }
+  }
+  if (tree_size != num_nodes_ - 1) {
+    return kNoOneTree;
+  }
+  // Connecting the root with its two cheapest edges.
+  int first_neighbor = -1;
+  int second_neighbor = -1;
+  double first_key = std::numeric_limits<double>::infinity();
+  double second_key = first_key;
+  for (int i = adjacency_start_[root_]; i < adjacency_start_[root_ + 1]; ++i) {
+    const int head = adjacency_heads_[i];
+    const double key = adjacency_costs_[i] + penalties[root_] + penalties[head];
+    if (key < first_key) {
+      second_key = first_key;
+      second_neighbor = first_neighbor;
+      first_key = key;
+      first_neighbor = head;
+    } else if (key < second_key) {
+      second_key = key;
+      second_neighbor = head;
+    }
+  }
+  if (second_neighbor == -1) {
+    return kNoOneTree;
+  }
+  (*degrees)[root_] = 2;
+  ++(*degrees)[first_neighbor];
+  ++(*degrees)[second_neighbor];
+  cost += first_key + second_key;
+  for (const double penalty : penalties) {
+    cost -= 2 * penalty;
+  }
+  return cost;
+}
+
+double HeldKarpBound::CompleteOneTree(
+    const std::vector<double>& penalties) const {
+  // Prim's algorithm in O(num_nodes^2) on all nodes but the root.
+  const double kInfinity = std::numeric_limits<double>::infinity();
+  std::vector<double> keys(num_nodes_, kInfinity);
+  std::vector<bool> in_tree(num_nodes_, false);
+  in_tree[root_] = true;
+  double cost = 0;
+  int node = root_ == 0 ? 1 : 0;
+  for (int tree_size = 1; tree_size < num_nodes_; ++tree_size) {
+    in_tree[node] = true;
+    int next_node = -1;
+    double next_key = kInfinity;
+    for (int head = 0; head < num_nodes_; ++head) {
+      if (in_tree[head]) continue;
+      const int64 edge_cost = EdgeCost(node, head);
+      if (edge_cost != kint64max) {
+        keys[head] = std::min(keys[head],
+                              edge_cost + penalties[node] + penalties[head]);
+      }
+      if (keys[head] < next_key) {
+        next_key = keys[head];
+        next_node = head;
+      }
+    }
+    if (tree_size < num_nodes_ - 1) {
+      if (next_node == -1) {
+        return kNoOneTree;
+      }
+      cost += next_key;
+      node = next_node;
+    }
+  }
+  double first_key = kInfinity;
+  double second_key = kInfinity;
+  for (int head = 0; head < num_nodes_; ++head) {
+    if (head == root_) continue;
+    const int64 edge_cost = EdgeCost(root_, head);
+    if (edge_cost == kint64max) continue;
+    const double key = edge_cost + penalties[root_] + penalties[head];
+    if (key < first_key) {
+      second_key = first_key;
+      first_key = key;
+    } else if (key < second_key) {
+      second_key = key;
+    }
+  }
+  if (second_key == kInfinity) {
+    return kNoOneTree;
+  }
+  cost += first_key + second_key;
+  for (const double penalty : penalties) {
+    cost -= 2 * penalty;
+  }
+  return cost;
+}
+
+void HeldKarpBound::Ascent(double step_factor, int max_iterations,
+                           AscentResult* result) const {
+  std::vector<double> penalties(num_nodes_, 0.0);
+  std::vector<int> degrees(num_nodes_);
+  std::vector<int> last_subgradient(num_nodes_, 0);
+  double value = SparseOneTree(penalties, &degrees);
+  result->bound = value;
+  result->penalties = penalties;
+  if (value == kNoOneTree) {
+    return;
+  }
+  double step =
+      step_factor * 0.01 * std::max(1.0, std::abs(value)) / num_nodes_;
+  const double min_step = 1e-3 * step;
+  int period = std::max(num_nodes_ / 2, 100);
+  bool initial_phase = true;
+  int iterations = 0;
+  while (iterations < max_iterations && period > 0 && step >= min_step) {
+    for (int p = 0; p < period && iterations < max_iterations;
+         ++p, ++iterations) {
+      bool is_tour = true;
+      for (int node = 0; node < num_nodes_; ++node) {
+        const int subgradient = degrees[node] - 2;
+        if (subgradient != 0) is_tour = false;
+        penalties[node] +=
+            step * (0.7 * subgradient + 0.3 * last_subgradient[node]);
+        last_subgradient[node] = subgradient;
+      }
+      // The 1-tree is an optimal tour of the candidate graph.
+      if (is_tour) return;
+      value = SparseOneTree(penalties, &degrees);
+      if (value == kNoOneTree) return;
+      if (value > result->bound) {
+        result->bound = value;
+        result->penalties = penalties;
+        if (initial_phase) {
+          step *= 2;
+        }
+        if (p == period - 1) {
+          period *= 2;
+        }
+      } else if (initial_phase && p > period / 2) {
+        initial_phase = false;
+        p = 0;
+        step *= 0.75;
+      }
+    }
+    initial_phase = false;
+    period /= 2;
+    step /= 2;
+  }
+}
+}  // namespace
+
+// Computes the Held-Karp lower bound of the traveling salesman problem
+// obtained by chaining routes with zero-cost arcs from each end node to each
+// start node; any solution of the routing problem maps to a tour of the same
+// cost. Arcs are those allowed by the domains of next variables; asymmetric
+// costs are relaxed to the cost of the cheapest direction of each edge.
+int64 RoutingModel::ComputeLowerBound() {
+  if (!closed_) {
+    LOG(WARNING) << "Non-closed model not supported.";
+    return 0;
+  }
+  if (!CostsAreHomogeneousAcrossVehicles()) {
+    LOG(WARNING) << "Non-homogeneous vehicle costs not supported";
+    return 0;
+  }
+  if (disjunctions_.size() > 0) {
+    LOG(WARNING)
+        << "Node disjunction constraints or optional nodes not supported.";
+    return 0;
+  }
+  const int num_nodes = Size() + vehicles_;
+  // The first end node is used as root of the 1-trees.
+  HeldKarpBound bound(num_nodes, Size(), [this](int tail, int head) -> int64 {
+    if (IsEnd(tail)) {
+      return IsStart(head) ? 0 : kint64max;
+    }
+    // Given there are no disjunction constraints, a node cannot point to
+    // itself.
+    if (head == tail || !nexts_[tail]->Contains(head)) {
+      return kint64max;
+    }
+    return GetHomogeneousCost(tail, head);
+  });
+  return bound.Compute(FLAGS_routing_lower_bound_candidates,
+                       FLAGS_routing_lower_bound_iterations,
+                       FLAGS_routing_lower_bound_threads);
+}
+
 // Computing a lower bound to the cost of a vehicle routing problem solving a
 // a linear assignment problem (minimum-cost perfect bipartite matching).
 // A bipartite graph is created with left nodes representing the nodes of the
@@ -2750,7 +3225,7 @@ const Assignment* RoutingModel::Solve(const Assignment* assignment) {
 // This is a lower bound given the solution to assignment problem does not
 // necessarily produce a (set of) closed route(s) from a starting node to an
 // ending node.
-int64 RoutingModel::ComputeLowerBound() {
+int64 RoutingModel::ComputeLinearAssignmentLowerBound() {
   if (!closed_) {
     LOG(WARNING) << "Non-closed model not supported.";
     return 0;
@@ -4082,7 +4557,7 @@ void RoutingModel::CreateFirstSolutionDecisionBuilders() {
   if (FLAGS_routing_use_filtered_first_solutions) {
     first_solution_filtered_decision_builders_[ROUTING_SAVINGS] =
         solver_->RevAlloc(new SavingsFilteredDecisionBuilder(
-            this, FLAGS_savings_filter_neighbors,
+            this, FLAGS_savings_filter_neighbors, FLAGS_savings_threads,
             GetOrCreateFeasibilityFilters()));
     first_solution_decision_builders_[ROUTING_SAVINGS] = solver_->Try(
         first_solution_filtered_decision_builders_[ROUTING_SAVINGS],
@@ -4233,7 +4708,37 @@ void RoutingModel::SetupAssignmentCollector() {
   monitors_.push_back(collect_assignments_);
 }
 
+namespace {
+// Logs the cost of each solution found along with its gap to a lower bound.
+class LowerBoundGapLog : public SearchMonitor {
+ public:
+  LowerBoundGapLog(Solver* const solver, IntVar* const cost, int64 lower_bound)
+      : SearchMonitor(solver), cost_(cost), lower_bound_(lower_bound) {}
+  ~LowerBoundGapLog() override {}
+  bool UsesDeltas() const override { return false; }
+  bool AtSolution() override {
+    const int64 cost = cost_->Min();
+    const double gap =
+        cost == 0 ? 0.0 : 100.0 * (cost - lower_bound_) / std::abs(cost);
+    LOG(INFO) << "Solution cost: " << cost << ", lower bound: " << lower_bound_
+              << ", gap: " << gap << "%";
+    return false;
+  }
+  std::string DebugString() const override { return "LowerBoundGapLog"; }
+
+ private:
+  IntVar* const cost_;
+  const int64 lower_bound_;
+};
+}  // namespace
+
 void RoutingModel::SetupTrace() {
+  if (FLAGS_routing_trace_lower_bound) {
+    const int64 lower_bound = ComputeLowerBound();
+    LOG(INFO) << "Lower bound: " << lower_bound;
+    monitors_.push_back(solver_->RevAlloc(
+        new LowerBoundGapLog(solver_.get(), cost_, lower_bound)));
+  }
   if (FLAGS_routing_trace) {
     const int kLogPeriod = 10000;
     SearchMonitor* trace = solver_->MakeSearchLog(kLogPeriod, cost_);
@@ -526,6 +526,10 @@ class RoutingModel {
   // a time dimension).
   // Setting the value of fix_start_cumul_to_zero to true will force the "cumul"
   // variable of the start node of all vehicles to be equal to 0.
+  // When neighbors are filtered by several threads (see
+  // FLAGS_cp_local_search_batch_threads), the evaluators of the dimensions are
+  // called concurrently and must be thread-safe; the cache of callbacks (see
+  // RoutingParameters::cache_callbacks) is.
 
   // Creates a dimension where the transit variable is constrained to be
   // equal to evaluator(i, next(i)); 'slack_max' is the upper bound of the
@@ -782,13 +786,20 @@ class RoutingModel {
   const Assignment* SolveWithParameters(
       const RoutingSearchParameters& parameters,
       const Assignment* assignment);
-  // Computes a lower bound to the routing problem solving a linear assignment
-  // problem. The routing model must be closed before calling this method.
+  // Computes a lower bound to the routing problem using the Held-Karp bound of
+  // the traveling salesman problem obtained by chaining routes; subgradient
+  // optimization is done on a sparse candidate graph and memory is linear in
+  // the number of nodes (see the routing_lower_bound_* flags).
+  // The routing model must be closed before calling this method.
   // Note that problems with node disjunction constraints (including optional
   // nodes) and non-homogenous costs are not supported (the method returns 0 in
   // these cases).
   // TODO(user): Add support for non-homogeneous costs and disjunctions.
   int64 ComputeLowerBound();
+  // Same as ComputeLowerBound(), solving a linear assignment problem instead;
+  // can be tighter on strongly asymmetric costs, but memory is quadratic in
+  // the number of nodes.
+  int64 ComputeLinearAssignmentLowerBound();
   // Returns the current status of the routing model.
   Status status() const { return status_; }
   // Applies a lock chain to the next search. 'locks' represents an ordered
@@ -1931,11 +1942,18 @@ class ComparatorCheapestAdditionFilteredDecisionBuilder
 // route.
 // Cost is based on the arc cost function of the routing model and cost classes
 // are taken into account.
+// Savings are never all materialized: for each node and cost class only a
+// small batch of its best savings is kept, the next batch being computed when
+// the current one is exhausted. This keeps memory linear in the number of
+// nodes and lets the initial batches be computed in parallel.
 class SavingsFilteredDecisionBuilder : public RoutingFilteredDecisionBuilder {
  public:
   // If savings_neighbors > 0 then for each node only its 'saving_neighbors'
   // neighbors leading to the smallest arc costs are considered.
+  // The first batches of savings are computed using 'num_threads' threads, in
+  // which case arc cost callbacks must be thread-safe.
   SavingsFilteredDecisionBuilder(RoutingModel* model, int64 saving_neighbors,
+                                 int num_threads,
                                  const std::vector<LocalSearchFilter*>& filters);
   ~SavingsFilteredDecisionBuilder() override {}
   bool BuildSolution() override;
@@ -1943,17 +1961,65 @@ class SavingsFilteredDecisionBuilder : public RoutingFilteredDecisionBuilder {
  private:
   typedef std::pair</*saving*/ int64, /*saving index*/ int64> Saving;
 
-  // Computes saving values for all node pairs and vehicle cost classes. The
-  // saving index attached to each saving value is an index used to
-  // store and recover the node pair to which the value is linked (cf. the
-  // index conversion methods below).
-  std::vector<Saving> ComputeSavings() const;
+  // Savings of a cost class either leaving a node (outgoing) or reaching it
+  // (incoming), enumerated by batches in increasing order.
+  struct SavingsStream {
+    SavingsStream()
+        : cost_class(0), node(0), outgoing(true), next(0), last_batch(true) {}
+    int cost_class;
+    int node;
+    bool outgoing;
+    // Current batch of savings and position of the next saving in the batch.
+    std::vector<Saving> savings;
+    int next;
+    // True if no saving follows the current batch.
+    bool last_batch;
+  };
+
+  // Computes the costs needed to evaluate savings and the first batch of
+  // outgoing savings of each node.
+  void InitializeSavings();
+  // Computes the first batch of outgoing savings of nodes in
+  // [first_node, last_node) for a cost class; used as a thread task.
+  void ComputeFirstSavingsBatches(int cost_class, int first_node,
+                                  int last_node);
+  // Resets 'stream' to the first savings of a node.
+  void InitializeSavingsStream(int cost_class, int node, bool outgoing,
+                               SavingsStream* stream);
+  // Recomputes the batch of 'stream' with the savings following its last
+  // saving.
+  void ComputeNextSavingsBatch(SavingsStream* stream);
+  // Keeps the smallest savings of 'candidates' in the batch of 'stream'.
+  void SelectSavingsBatch(std::vector<Saving>* candidates,
+                          SavingsStream* stream) const;
+  // Sets 'saving' to the next saving of 'stream' whose nodes are both free,
+  // computing a new batch if needed; returns false if there is none.
+  bool PeekSaving(SavingsStream* stream, Saving* saving);
+  // Sets 'saving' to the best remaining saving over all nodes and cost
+  // classes whose nodes are both free; returns false if there is none.
+  bool NextSaving(Saving* saving);
+  // Returns true if 'node' can be part of a saving.
+  bool IsFreeNode(int node) const {
+    return !Contains(node) && !model()->IsStart(node) && !model()->IsEnd(node);
+  }
+  // Returns true if 'after_node' is among the neighbors of 'before_node'
+  // considered for a cost class; 'cost' is the cost of the arc between them.
+  bool IsSavingNeighbor(int cost_class, int before_node, int after_node,
+                        int64 cost) const {
+    return neighbor_thresholds_.empty() ||
+           std::make_pair(cost, static_cast<int64>(after_node)) <=
+               neighbor_thresholds_[cost_class * Size() + before_node];
+  }
   // Builds a saving from a saving value, a cost class and two nodes.
   Saving BuildSaving(int64 saving, int cost_class, int before_node,
                      int after_node) const {
     return std::make_pair(
         saving, cost_class * size_squared_ + before_node * Size() + after_node);
   }
+  // Builds the saving of the arc between two nodes for a cost class, given
+  // the cost of the arc.
+  Saving BuildArcSaving(int cost_class, int before_node, int after_node,
+                        int64 cost) const;
   // Returns the cost class from a saving.
   int64 GetCostClassFromSaving(const Saving& saving) const {
     return saving.second / size_squared_;
@@ -1970,7 +2036,21 @@ class SavingsFilteredDecisionBuilder : public RoutingFilteredDecisionBuilder {
   int64 GetSavingValue(const Saving& saving) const { return saving.first; }
 
   const int64 saving_neighbors_;
+  const int num_threads_;
   int64 size_squared_;
+  // Indexed by cost_class * Size() + node: the costs of the arcs from the
+  // start of a route of the class to the node and from the node to the end of
+  // the route, and the (cost, node) pair of the farthest neighbor considered
+  // for the node (empty if all neighbors are considered).
+  std::vector<int64> start_costs_;
+  std::vector<int64> end_costs_;
+  std::vector<std::pair<int64, int64>> neighbor_thresholds_;
+  // True for the cost classes of which routes can still be started.
+  std::vector<bool> active_cost_classes_;
+  // Outgoing savings of each node, by cost_class * Size() + node, and heap of
+  // the lower bounds of their next savings, used to merge them.
+  std::vector<SavingsStream> streams_;
+  std::vector<std::pair<Saving, int>> stream_heap_;
 };
 
 // Routing filters
@@ -1980,7 +2060,7 @@ class RoutingLocalSearchFilter : public IntVarLocalSearchFilter {
   RoutingLocalSearchFilter(const std::vector<IntVar*>& nexts,
                            std::function<void(int64)> objective_callback);
   ~RoutingLocalSearchFilter() override {}
-  virtual void InjectObjectiveValue(int64 objective_value);
+  void InjectObjectiveValue(int64 objective_value) override;
 
  protected:
   bool CanPropagateObjectiveValue() const {
@@ -2002,6 +2082,10 @@ class BasePathFilter : public RoutingLocalSearchFilter {
                  std::function<void(int64)> objective_callback);
   ~BasePathFilter() override {}
   bool Accept(const Assignment* delta, const Assignment* deltadelta) override;
+  // Subclasses which do not override Accept() can return true from
+  // HasFlatAccept().
+  bool AcceptFlat(const IntVarFlatDelta* delta,
+                  const IntVarFlatDelta* deltadelta) override;
   void OnSynchronize(const Assignment* delta) override;
 
  protected:
@@ -2024,6 +2108,8 @@ class BasePathFilter : public RoutingLocalSearchFilter {
   virtual bool AcceptPath(int64 path_start, int64 chain_start,
                           int64 chain_end) = 0;
   virtual bool FinalizeAcceptPath() { return true; }
+  template <class Delta>
+  bool AcceptDelta(const Delta* delta);
   // Detects path starts, used to track which node belongs to which path.
   void ComputePathStarts(std::vector<int64>* path_starts,
                          std::vector<int>* index_to_path);
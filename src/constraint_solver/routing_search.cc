@@ -16,10 +16,13 @@
 // and local search filters.
 // TODO(user): Move all existing routing search code here.
 
+#include <algorithm>
+#include <functional>
 #include <map>
 #include <set>
 #include "base/small_map.h"
 #include "base/small_ordered_set.h"
+#include "base/threadpool.h"
 #include "constraint_solver/routing.h"
 #include "util/bitset.h"
 #include "util/saturated_arithmetic.h"
@@ -63,17 +66,36 @@ class NodeDisjunctionFilter : public RoutingLocalSearchFilter {
       : RoutingLocalSearchFilter(routing_model.Nexts(), objective_callback),
         routing_model_(routing_model),
         active_per_disjunction_(routing_model.GetNumberOfDisjunctions(), 0),
-        penalty_value_(0) {}
+        penalty_value_(0),
+        accepted_penalty_value_(0) {}
 
   bool Accept(const Assignment* delta, const Assignment* deltadelta) override {
+    return AcceptDelta(delta);
+  }
+  bool HasFlatAccept() const override { return true; }
+  bool AcceptFlat(const IntVarFlatDelta* delta,
+                  const IntVarFlatDelta* deltadelta) override {
+    return AcceptDelta(delta);
+  }
+  std::string DebugString() const override { return "NodeDisjunctionFilter"; }
+  int64 GetAcceptedObjectiveValue() const override {
+    return accepted_penalty_value_;
+  }
+  LocalSearchFilter* MakeThreadLocalCopy() const override {
+    return new NodeDisjunctionFilter(routing_model_, nullptr);
+  }
+
+ private:
+  template <class Delta>
+  bool AcceptDelta(const Delta* delta) {
     const int64 kUnassigned = -1;
-    const Assignment::IntContainer& container = delta->IntVarContainer();
+    const auto& container = delta->IntVarContainer();
     const int delta_size = container.Size();
     small_map<std::map<RoutingModel::DisjunctionIndex, int>>
         disjunction_active_deltas;
     bool lns_detected = false;
     for (int i = 0; i < delta_size; ++i) {
-      const IntVarElement& new_element = container.Element(i);
+      const auto& new_element = container.Element(i);
       IntVar* const var = new_element.Var();
       int64 index = kUnassigned;
       if (FindIndex(var, &index) && IsVarSynced(index)) {
@@ -94,8 +116,7 @@ class NodeDisjunctionFilter : public RoutingLocalSearchFilter {
         }
       }
     }
-    int64 new_objective_value =
-        CapAdd(injected_objective_value_, penalty_value_);
+    int64 new_penalty_value = penalty_value_;
     for (const std::pair<RoutingModel::DisjunctionIndex, int>
              disjunction_active_delta : disjunction_active_deltas) {
       const int active_nodes =
@@ -113,13 +134,16 @@ class NodeDisjunctionFilter : public RoutingLocalSearchFilter {
             PropagateObjectiveValue(0);
             return false;
           } else {
-            new_objective_value = CapAdd(new_objective_value, penalty);
+            new_penalty_value = CapAdd(new_penalty_value, penalty);
           }
         } else if (disjunction_active_delta.second > 0) {
-          new_objective_value = CapSub(new_objective_value, penalty);
+          new_penalty_value = CapSub(new_penalty_value, penalty);
         }
       }
     }
+    accepted_penalty_value_ = new_penalty_value;
+    const int64 new_objective_value =
+        CapAdd(injected_objective_value_, new_penalty_value);
     PropagateObjectiveValue(new_objective_value);
     if (lns_detected) {
       return true;
@@ -129,8 +153,6 @@ class NodeDisjunctionFilter : public RoutingLocalSearchFilter {
       return new_objective_value <= cost_var->Max();
     }
   }
-  std::string DebugString() const override { return "NodeDisjunctionFilter"; }
-
  private:
   void OnSynchronize(const Assignment* delta) override {
     penalty_value_ = 0;
@@ -158,6 +180,7 @@ class NodeDisjunctionFilter : public RoutingLocalSearchFilter {
   const RoutingModel& routing_model_;
   ITIVector<RoutingModel::DisjunctionIndex, int> active_per_disjunction_;
   int64 penalty_value_;
+  int64 accepted_penalty_value_;
 };
 }  // namespace
 
@@ -183,12 +206,22 @@ BasePathFilter::BasePathFilter(const std::vector<IntVar*>& nexts,
 
 bool BasePathFilter::Accept(const Assignment* delta,
                             const Assignment* deltadelta) {
+  return AcceptDelta(delta);
+}
+
+bool BasePathFilter::AcceptFlat(const IntVarFlatDelta* delta,
+                                const IntVarFlatDelta* deltadelta) {
+  return AcceptDelta(delta);
+}
+
+template <class Delta>
+bool BasePathFilter::AcceptDelta(const Delta* delta) {
   PropagateObjectiveValue(injected_objective_value_);
   for (const int touched : delta_touched_) {
     new_nexts_[touched] = kUnassigned;
   }
   delta_touched_.clear();
-  const Assignment::IntContainer& container = delta->IntVarContainer();
+  const auto& container = delta->IntVarContainer();
   const int delta_size = container.Size();
   delta_touched_.reserve(delta_size);
   // Determining touched paths and touched nodes (a node is touched if it
@@ -197,7 +230,7 @@ bool BasePathFilter::Accept(const Assignment* delta,
   touched_paths_.SparseClearAll();
   touched_path_nodes_.SparseClearAll();
   for (int i = 0; i < delta_size; ++i) {
-    const IntVarElement& new_element = container.Element(i);
+    const auto& new_element = container.Element(i);
     IntVar* const var = new_element.Var();
     int64 index = kUnassigned;
     if (FindIndex(var, &index)) {
@@ -396,15 +429,21 @@ class ChainCumulFilter : public BasePathFilter {
                    const RoutingDimension& dimension,
                    Solver::ObjectiveWatcher objective_callback);
   ~ChainCumulFilter() override {}
+  bool HasFlatAccept() const override { return true; }
   std::string DebugString() const override {
     return "ChainCumulFilter(" + name_ + ")";
   }
+  LocalSearchFilter* MakeThreadLocalCopy() const override {
+    return new ChainCumulFilter(routing_model_, dimension_, nullptr);
+  }
 
  private:
   void OnSynchronizePathFromStart(int64 start) override;
   bool AcceptPath(int64 path_start, int64 chain_start,
                   int64 chain_end) override;
 
+  const RoutingModel& routing_model_;
+  const RoutingDimension& dimension_;
   const std::vector<IntVar*> cumuls_;
   std::vector<int64> start_to_vehicle_;
   std::vector<int64> start_to_end_;
@@ -423,6 +462,8 @@ ChainCumulFilter::ChainCumulFilter(const RoutingModel& routing_model,
                                    Solver::ObjectiveWatcher objective_callback)
     : BasePathFilter(routing_model.Nexts(), dimension.cumuls().size(),
                      objective_callback),
+      routing_model_(routing_model),
+      dimension_(dimension),
       cumuls_(dimension.cumuls()),
       evaluators_(routing_model.vehicles(), nullptr),
       capacity_evaluator_(dimension.capacity_evaluator()),
@@ -511,9 +552,16 @@ class PathCumulFilter : public BasePathFilter {
                   const RoutingDimension& dimension,
                   Solver::ObjectiveWatcher objective_callback);
   ~PathCumulFilter() override {}
+  bool HasFlatAccept() const override { return true; }
   std::string DebugString() const override {
     return "PathCumulFilter(" + name_ + ")";
   }
+  int64 GetAcceptedObjectiveValue() const override {
+    return accepted_objective_value_;
+  }
+  LocalSearchFilter* MakeThreadLocalCopy() const override {
+    return new PathCumulFilter(routing_model_, dimension_, nullptr);
+  }
 
  private:
   // This structure stores the "best" path cumul value for a solution, the path
@@ -611,6 +659,8 @@ class PathCumulFilter : public BasePathFilter {
   int64 ComputePathMaxStartFromEndCumul(const PathTransits& path_transits,
                                         int path, int end_cumul) const;
 
+  const RoutingModel& routing_model_;
+  const RoutingDimension& dimension_;
   const std::vector<IntVar*> cumuls_;
   const std::vector<IntVar*> slacks_;
   std::vector<int64> start_to_vehicle_;
@@ -622,6 +672,8 @@ class PathCumulFilter : public BasePathFilter {
   // by the index of the start node of the path.
   hash_map<int64, int64> current_cumul_cost_values_;
   int64 cumul_cost_delta_;
+  // Cost computed for the last accepted delta, excluding injected costs.
+  int64 accepted_objective_value_;
   const int64 global_span_cost_coefficient_;
   std::vector<SoftBound> cumul_soft_bounds_;
   std::vector<SoftBound> cumul_soft_lower_bounds_;
@@ -650,6 +702,8 @@ PathCumulFilter::PathCumulFilter(const RoutingModel& routing_model,
                                  Solver::ObjectiveWatcher objective_callback)
     : BasePathFilter(routing_model.Nexts(), dimension.cumuls().size(),
                      objective_callback),
+      routing_model_(routing_model),
+      dimension_(dimension),
       cumuls_(dimension.cumuls()),
       slacks_(dimension.slacks()),
       evaluators_(routing_model.vehicles(), nullptr),
@@ -658,6 +712,7 @@ PathCumulFilter::PathCumulFilter(const RoutingModel& routing_model,
       total_current_cumul_cost_value_(0),
       current_cumul_cost_values_(),
       cumul_cost_delta_(0),
+      accepted_objective_value_(0),
       global_span_cost_coefficient_(dimension.global_span_cost_coefficient()),
       vehicle_span_cost_coefficients_(
           dimension.vehicle_span_cost_coefficients()),
@@ -935,6 +990,7 @@ bool PathCumulFilter::FinalizeAcceptPath() {
     delta_paths_.clear();
     delta_path_transits_.Clear();
     lns_detected_ = false;
+    accepted_objective_value_ = 0;
     PropagateObjectiveValue(injected_objective_value_);
     return true;
   }
@@ -994,11 +1050,12 @@ bool PathCumulFilter::FinalizeAcceptPath() {
   delta_paths_.clear();
   delta_path_transits_.Clear();
   lns_detected_ = false;
+  accepted_objective_value_ =
+      CapAdd(cumul_cost_delta_, CapProd(global_span_cost_coefficient_,
+                                        CapSub(new_max_end, new_min_start)));
   // Filtering on objective value, including the injected part of it.
   const int64 new_objective_value =
-      CapAdd(CapAdd(injected_objective_value_, cumul_cost_delta_),
-             CapProd(global_span_cost_coefficient_,
-                     CapSub(new_max_end, new_min_start)));
+      CapAdd(injected_objective_value_, accepted_objective_value_);
   PropagateObjectiveValue(new_objective_value);
   // Only compare to max as a cost lower bound is computed.
   return new_objective_value <= cost_var_->Max();
@@ -1079,6 +1136,7 @@ class NodePrecedenceFilter : public BasePathFilter {
   NodePrecedenceFilter(const std::vector<IntVar*>& nexts, int next_domain_size,
                        const RoutingModel::NodePairs& pairs);
   ~NodePrecedenceFilter() override {}
+  bool HasFlatAccept() const override { return true; }
   bool AcceptPath(int64 path_start, int64 chain_start,
                   int64 chain_end) override;
   std::string DebugString() const override { return "NodePrecedenceFilter"; }
@@ -1151,12 +1209,18 @@ class VehicleVarFilter : public BasePathFilter {
  public:
   explicit VehicleVarFilter(const RoutingModel& routing_model);
   ~VehicleVarFilter() override {}
+  bool HasFlatAccept() const override { return true; }
   bool Accept(const Assignment* delta, const Assignment* deltadelta) override;
+  bool AcceptFlat(const IntVarFlatDelta* delta,
+                  const IntVarFlatDelta* deltadelta) override;
   bool AcceptPath(int64 path_start, int64 chain_start,
                   int64 chain_end) override;
   std::string DebugString() const override { return "VehicleVariableFilter"; }
 
  private:
+  template <class Delta>
+  bool AllVehicleVarsUnconstrained(const Delta* delta) const;
+
   std::vector<int64> start_to_vehicle_;
   std::vector<IntVar*> vehicle_vars_;
   const int64 unconstrained_vehicle_var_domain_size_;
@@ -1176,7 +1240,19 @@ VehicleVarFilter::VehicleVarFilter(const RoutingModel& routing_model)
 // Avoid filtering if variable domains are unconstrained.
 bool VehicleVarFilter::Accept(const Assignment* delta,
                               const Assignment* deltadelta) {
-  const Assignment::IntContainer& container = delta->IntVarContainer();
+  return AllVehicleVarsUnconstrained(delta) ||
+         BasePathFilter::Accept(delta, deltadelta);
+}
+
+bool VehicleVarFilter::AcceptFlat(const IntVarFlatDelta* delta,
+                                  const IntVarFlatDelta* deltadelta) {
+  return AllVehicleVarsUnconstrained(delta) ||
+         BasePathFilter::AcceptFlat(delta, deltadelta);
+}
+
+template <class Delta>
+bool VehicleVarFilter::AllVehicleVarsUnconstrained(const Delta* delta) const {
+  const auto& container = delta->IntVarContainer();
   const int size = container.Size();
   bool all_unconstrained = true;
   for (int i = 0; i < size; ++i) {
@@ -1196,8 +1272,7 @@ bool VehicleVarFilter::Accept(const Assignment* delta,
       }
     }
   }
-  if (all_unconstrained) return true;
-  return BasePathFilter::Accept(delta, deltadelta);
+  return all_unconstrained;
 }
 
 bool VehicleVarFilter::AcceptPath(int64 path_start, int64 chain_start,
@@ -2362,11 +2437,17 @@ void ComparatorCheapestAdditionFilteredDecisionBuilder::SortPossibleNexts(
 
 // SavingsFilteredDecisionBuilder
 
+namespace {
+// Maximum number of savings of a node kept in memory at any time.
+const int kSavingsBatchSize = 32;
+}  // namespace
+
 SavingsFilteredDecisionBuilder::SavingsFilteredDecisionBuilder(
-    RoutingModel* model, int64 saving_neighbors,
+    RoutingModel* model, int64 saving_neighbors, int num_threads,
     const std::vector<LocalSearchFilter*>& filters)
     : RoutingFilteredDecisionBuilder(model, filters),
       saving_neighbors_(saving_neighbors),
+      num_threads_(num_threads),
       size_squared_(0) {}
 
 bool SavingsFilteredDecisionBuilder::BuildSolution() {
@@ -2375,23 +2456,15 @@ bool SavingsFilteredDecisionBuilder::BuildSolution() {
   }
   const int size = model()->Size();
   size_squared_ = size * size;
-  std::vector<Saving> savings = ComputeSavings();
-  // Store savings for each incoming and outgoing node and by cost class. This
-  // is necessary to quickly extend partial chains without scanning all savings.
-  const int cost_classes = model()->GetCostClassesCount();
-  std::vector<std::vector<int>> in_savings(size * cost_classes);
-  std::vector<std::vector<int>> out_savings(size * cost_classes);
-  for (int i = 0; i < savings.size(); ++i) {
-    const Saving& saving = savings[i];
-    const int cost_class_offset = GetCostClassFromSaving(saving) * size;
-    const int before_node = GetBeforeNodeFromSaving(saving);
-    in_savings[cost_class_offset + before_node].push_back(i);
-    const int after_node = GetAfterNodeFromSaving(saving);
-    out_savings[cost_class_offset + after_node].push_back(i);
-  }
+  InitializeSavings();
   // Build routes from savings.
   std::vector<bool> closed(model()->vehicles(), false);
-  for (const Saving& saving : savings) {
+  // Savings used to extend partial routes after their last node (in_savings)
+  // and before their first node (out_savings).
+  SavingsStream in_savings;
+  SavingsStream out_savings;
+  Saving saving;
+  while (NextSaving(&saving)) {
     // First find the best saving to start a new route.
     const int cost_class = GetCostClassFromSaving(saving);
     int vehicle = -1;
@@ -2402,117 +2475,268 @@ bool SavingsFilteredDecisionBuilder::BuildSolution() {
         break;
       }
     }
-    if (vehicle == -1) continue;
+    if (vehicle == -1) {
+      active_cost_classes_[cost_class] = false;
+      continue;
+    }
+    // Both nodes are free (cf. NextSaving()).
     int before_node = GetBeforeNodeFromSaving(saving);
     int after_node = GetAfterNodeFromSaving(saving);
-    if (!Contains(before_node) && !Contains(after_node)) {
-      const int64 start = model()->Start(vehicle);
-      const int64 end = model()->End(vehicle);
-      SetValue(start, before_node);
-      SetValue(before_node, after_node);
-      SetValue(after_node, end);
-      if (Commit()) {
-        // Then extend the route from both ends of the partial route.
-        closed[vehicle] = true;
-        int in_index = 0;
-        int out_index = 0;
-        const int saving_offset = cost_class * size;
-        while (in_index < in_savings[saving_offset + after_node].size() &&
-               out_index < out_savings[saving_offset + before_node].size()) {
-          const Saving& in_saving =
-              savings[in_savings[saving_offset + after_node][in_index]];
-          const Saving& out_saving =
-              savings[out_savings[saving_offset + before_node][out_index]];
-          if (GetSavingValue(in_saving) < GetSavingValue(out_saving)) {
-            // Extending after after_node
-            const int after_after_node = GetAfterNodeFromSaving(in_saving);
-            if (!Contains(after_after_node)) {
-              SetValue(after_node, after_after_node);
-              SetValue(after_after_node, end);
-              if (Commit()) {
-                in_index = 0;
-                after_node = after_after_node;
-              } else {
-                ++in_index;
-              }
-            } else {
-              ++in_index;
-            }
+    const int64 start = model()->Start(vehicle);
+    const int64 end = model()->End(vehicle);
+    SetValue(start, before_node);
+    SetValue(before_node, after_node);
+    SetValue(after_node, end);
+    if (Commit()) {
+      // Then extend the route from both ends of the partial route.
+      closed[vehicle] = true;
+      InitializeSavingsStream(cost_class, after_node, true, &in_savings);
+      InitializeSavingsStream(cost_class, before_node, false, &out_savings);
+      Saving in_saving;
+      Saving out_saving;
+      while (true) {
+        const bool has_in_saving = PeekSaving(&in_savings, &in_saving);
+        const bool has_out_saving = PeekSaving(&out_savings, &out_saving);
+        if (!has_in_saving && !has_out_saving) break;
+        if (has_in_saving &&
+            (!has_out_saving ||
+             GetSavingValue(in_saving) < GetSavingValue(out_saving))) {
+          // Extending after after_node
+          const int after_after_node = GetAfterNodeFromSaving(in_saving);
+          SetValue(after_node, after_after_node);
+          SetValue(after_after_node, end);
+          if (Commit()) {
+            after_node = after_after_node;
+            InitializeSavingsStream(cost_class, after_node, true, &in_savings);
           } else {
-            // Extending before before_node
-            const int before_before_node = GetBeforeNodeFromSaving(out_saving);
-            if (!Contains(before_before_node)) {
-              SetValue(start, before_before_node);
-              SetValue(before_before_node, before_node);
-              if (Commit()) {
-                out_index = 0;
-                before_node = before_before_node;
-              } else {
-                ++out_index;
-              }
-            } else {
-              ++out_index;
-            }
+            ++in_savings.next;
+          }
+        } else {
+          // Extending before before_node
+          const int before_before_node = GetBeforeNodeFromSaving(out_saving);
+          SetValue(start, before_before_node);
+          SetValue(before_before_node, before_node);
+          if (Commit()) {
+            before_node = before_before_node;
+            InitializeSavingsStream(cost_class, before_node, false,
+                                    &out_savings);
+          } else {
+            ++out_savings.next;
           }
         }
       }
     }
   }
+  std::vector<SavingsStream>().swap(streams_);
+  std::vector<std::pair<Saving, int>>().swap(stream_heap_);
   MakeUnassignedNodesUnperformed();
   return Commit();
 }
 
-std::vector<SavingsFilteredDecisionBuilder::Saving>
-SavingsFilteredDecisionBuilder::ComputeSavings() const {
-  const int size = model()->Size();
-  const int64 saving_neighbors =
-      saving_neighbors_ <= 0 ? size : saving_neighbors_;
+SavingsFilteredDecisionBuilder::Saving
+SavingsFilteredDecisionBuilder::BuildArcSaving(int cost_class, int before_node,
+                                               int after_node,
+                                               int64 cost) const {
+  const int offset = cost_class * Size();
+  const int64 saving = CapSub(CapAdd(end_costs_[offset + before_node],
+                                     start_costs_[offset + after_node]),
+                              cost);
+  return BuildSaving(-saving, cost_class, before_node, after_node);
+}
+
+void SavingsFilteredDecisionBuilder::InitializeSavings() {
+  const int size = Size();
   const int num_cost_classes = model()->GetCostClassesCount();
-  std::vector<Saving> savings;
-  savings.reserve(num_cost_classes * size * saving_neighbors);
-  std::vector<bool> class_covered(num_cost_classes, false);
+  active_cost_classes_.assign(num_cost_classes, false);
+  start_costs_.assign(num_cost_classes * size, 0);
+  end_costs_.assign(num_cost_classes * size, 0);
+  neighbor_thresholds_.clear();
+  if (saving_neighbors_ > 0 && saving_neighbors_ < size) {
+    neighbor_thresholds_.assign(num_cost_classes * size,
+                                std::make_pair(kint64max, kint64max));
+  }
+  streams_.assign(num_cost_classes * size, SavingsStream());
+  stream_heap_.clear();
   for (int vehicle = 0; vehicle < model()->vehicles(); ++vehicle) {
     const int64 cost_class =
         model()->GetCostClassIndexOfVehicle(vehicle).value();
-    if (!class_covered[cost_class]) {
-      class_covered[cost_class] = true;
-      const int64 start = model()->Start(vehicle);
-      const int64 end = model()->End(vehicle);
-      for (int before_node = 0; before_node < size; ++before_node) {
-        if (!Contains(before_node) && !model()->IsEnd(before_node) &&
-            !model()->IsStart(before_node)) {
-          const int64 in_saving =
-              model()->GetArcCostForClass(before_node, end, cost_class);
-          std::vector<std::pair</*cost*/ int64, /*node*/ int64>> costed_after_nodes;
-          costed_after_nodes.reserve(size);
-          for (int after_node = 0; after_node < size; ++after_node) {
-            if (after_node != before_node && !Contains(after_node) &&
-                !model()->IsEnd(after_node) && !model()->IsStart(after_node)) {
-              costed_after_nodes.push_back(
-                  std::make_pair(model()->GetArcCostForClass(
-                                     before_node, after_node, cost_class),
-                                 after_node));
-            }
-          }
-          if (saving_neighbors < size) {
-            std::nth_element(costed_after_nodes.begin(),
-                             costed_after_nodes.begin() + saving_neighbors,
-                             costed_after_nodes.end());
-            costed_after_nodes.resize(saving_neighbors);
-          }
-          for (const auto& after_node : costed_after_nodes) {
-            const int64 saving = CapSub(
-                CapAdd(in_saving, model()->GetArcCostForClass(
-                                      start, after_node.second, cost_class)),
-                after_node.first);
-            savings.push_back(BuildSaving(-saving, cost_class, before_node,
-                                          after_node.second));
-          }
-        }
+    if (active_cost_classes_[cost_class]) continue;
+    active_cost_classes_[cost_class] = true;
+    const int64 start = model()->Start(vehicle);
+    const int64 end = model()->End(vehicle);
+    const int offset = cost_class * size;
+    // Costs from the start are computed here and not in the threads as they
+    // all use the cost cache of the start.
+    for (int node = 0; node < size; ++node) {
+      if (IsFreeNode(node)) {
+        start_costs_[offset + node] =
+            model()->GetArcCostForClass(start, node, cost_class);
+        end_costs_[offset + node] =
+            model()->GetArcCostForClass(node, end, cost_class);
+      }
+    }
+    if (num_threads_ <= 1) {
+      ComputeFirstSavingsBatches(cost_class, 0, size);
+    } else {
+      // Each thread only computes costs of arcs leaving its own nodes, which
+      // are cached separately.
+      ThreadPool pool("SavingsBatches", num_threads_);
+      pool.StartWorkers();
+      const int chunk_size = (size + num_threads_ - 1) / num_threads_;
+      for (int first = 0; first < size; first += chunk_size) {
+        pool.Add(NewCallback(
+            this, &SavingsFilteredDecisionBuilder::ComputeFirstSavingsBatches,
+            static_cast<int>(cost_class), first,
+            std::min(first + chunk_size, size)));
+      }
+    }
+  }
+  for (int i = 0; i < streams_.size(); ++i) {
+    if (!streams_[i].savings.empty()) {
+      stream_heap_.push_back(std::make_pair(streams_[i].savings[0], i));
+    }
+  }
+  std::make_heap(stream_heap_.begin(), stream_heap_.end(),
+                 std::greater<std::pair<Saving, int>>());
+}
+
+void SavingsFilteredDecisionBuilder::ComputeFirstSavingsBatches(
+    int cost_class, int first_node, int last_node) {
+  const int size = Size();
+  std::vector<std::pair</*cost*/ int64, /*node*/ int64>> costed_after_nodes;
+  costed_after_nodes.reserve(size);
+  std::vector<Saving> candidates;
+  candidates.reserve(size);
+  for (int before_node = first_node; before_node < last_node; ++before_node) {
+    if (!IsFreeNode(before_node)) continue;
+    costed_after_nodes.clear();
+    for (int after_node = 0; after_node < size; ++after_node) {
+      if (after_node != before_node && IsFreeNode(after_node)) {
+        costed_after_nodes.push_back(std::make_pair(
+            model()->GetArcCostForClass(before_node, after_node, cost_class),
+            after_node));
+      }
+    }
+    const int index = cost_class * size + before_node;
+    if (!neighbor_thresholds_.empty() &&
+        saving_neighbors_ < costed_after_nodes.size()) {
+      std::nth_element(costed_after_nodes.begin(),
+                       costed_after_nodes.begin() + saving_neighbors_ - 1,
+                       costed_after_nodes.end());
+      neighbor_thresholds_[index] = costed_after_nodes[saving_neighbors_ - 1];
+      costed_after_nodes.resize(saving_neighbors_);
+    }
+    candidates.clear();
+    for (const std::pair<int64, int64>& after_node : costed_after_nodes) {
+      candidates.push_back(BuildArcSaving(cost_class, before_node,
+                                          after_node.second, after_node.first));
+    }
+    SavingsStream* const stream = &streams_[index];
+    stream->cost_class = cost_class;
+    stream->node = before_node;
+    stream->outgoing = true;
+    SelectSavingsBatch(&candidates, stream);
+  }
+}
+
+void SavingsFilteredDecisionBuilder::InitializeSavingsStream(
+    int cost_class, int node, bool outgoing, SavingsStream* stream) {
+  stream->cost_class = cost_class;
+  stream->node = node;
+  stream->outgoing = outgoing;
+  stream->savings.clear();
+  ComputeNextSavingsBatch(stream);
+}
+
+void SavingsFilteredDecisionBuilder::ComputeNextSavingsBatch(
+    SavingsStream* stream) {
+  const bool has_last_saving = !stream->savings.empty();
+  const Saving last_saving =
+      has_last_saving ? stream->savings.back() : Saving(0, 0);
+  std::vector<Saving> candidates;
+  for (int other_node = 0; other_node < Size(); ++other_node) {
+    if (other_node == stream->node || !IsFreeNode(other_node)) continue;
+    const int before_node = stream->outgoing ? stream->node : other_node;
+    const int after_node = stream->outgoing ? other_node : stream->node;
+    const int64 cost = model()->GetArcCostForClass(before_node, after_node,
+                                                   stream->cost_class);
+    if (!IsSavingNeighbor(stream->cost_class, before_node, after_node, cost)) {
+      continue;
+    }
+    const Saving saving =
+        BuildArcSaving(stream->cost_class, before_node, after_node, cost);
+    if (!has_last_saving || last_saving < saving) {
+      candidates.push_back(saving);
+    }
+  }
+  SelectSavingsBatch(&candidates, stream);
+}
+
+void SavingsFilteredDecisionBuilder::SelectSavingsBatch(
+    std::vector<Saving>* candidates, SavingsStream* stream) const {
+  stream->last_batch = candidates->size() <= kSavingsBatchSize;
+  if (!stream->last_batch) {
+    std::nth_element(candidates->begin(),
+                     candidates->begin() + kSavingsBatchSize,
+                     candidates->end());
+    candidates->resize(kSavingsBatchSize);
+  }
+  std::sort(candidates->begin(), candidates->end());
+  stream->savings.assign(candidates->begin(), candidates->end());
+  stream->next = 0;
+}
+
+bool SavingsFilteredDecisionBuilder::PeekSaving(SavingsStream* stream,
+                                                Saving* saving) {
+  while (true) {
+    while (stream->next < stream->savings.size()) {
+      const Saving& next_saving = stream->savings[stream->next];
+      const int other_node = stream->outgoing
+                                 ? GetAfterNodeFromSaving(next_saving)
+                                 : GetBeforeNodeFromSaving(next_saving);
+      if (!Contains(other_node)) {
+        *saving = next_saving;
+        return true;
       }
+      ++stream->next;
     }
+    if (stream->last_batch) return false;
+    ComputeNextSavingsBatch(stream);
   }
-  std::sort(savings.begin(), savings.end());
-  return savings;
+}
+
+bool SavingsFilteredDecisionBuilder::NextSaving(Saving* saving) {
+  const std::greater<std::pair<Saving, int>> comparator;
+  while (!stream_heap_.empty()) {
+    std::pop_heap(stream_heap_.begin(), stream_heap_.end(), comparator);
+    const std::pair<Saving, int> top = stream_heap_.back();
+    stream_heap_.pop_back();
+    SavingsStream* const stream = &streams_[top.second];
+    if (!active_cost_classes_[stream->cost_class] || Contains(stream->node) ||
+        !PeekSaving(stream, saving)) {
+      // No saving of the stream can be used anymore.
+      std::vector<Saving>().swap(stream->savings);
+      continue;
+    }
+    if (top.first < *saving) {
+      // The saving in the heap was only a lower bound of the next saving of
+      // the stream.
+      stream_heap_.push_back(std::make_pair(*saving, top.second));
+      std::push_heap(stream_heap_.begin(), stream_heap_.end(), comparator);
+      continue;
+    }
+    ++stream->next;
+    if (stream->next < stream->savings.size() || !stream->last_batch) {
+      // The saving just returned is a lower bound of the next saving of the
+      // stream when its batch is exhausted.
+      const Saving& lower_bound = stream->next < stream->savings.size()
+                                      ? stream->savings[stream->next]
+                                      : *saving;
+      stream_heap_.push_back(std::make_pair(lower_bound, top.second));
+      std::push_heap(stream_heap_.begin(), stream_heap_.end(), comparator);
+    }
+    return true;
+  }
+  return false;
 }
 }  // namespace operations_research
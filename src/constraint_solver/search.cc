@@ -18,6 +18,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -72,6 +73,11 @@ SearchLog::SearchLog(Solver* const s, OptimizeVar* const obj, IntVar* const var,
 
 SearchLog::~SearchLog() {}
 
+// Subclasses may override AcceptDelta().
+bool SearchLog::UsesDeltas() const {
+  return typeid(*this) != typeid(SearchLog);
+}
+
 std::string SearchLog::DebugString() const { return "SearchLog"; }
 
 void SearchLog::EnterSearch() {
@@ -297,6 +303,7 @@ class SearchTrace : public SearchMonitor {
   SearchTrace(Solver* const s, const std::string& prefix)
       : SearchMonitor(s), prefix_(prefix) {}
   ~SearchTrace() override {}
+  bool UsesDeltas() const override { return false; }
 
   void EnterSearch() override {
     LOG(INFO) << prefix_ << " EnterSearch(" << solver()->SolveDepth() << ")";
@@ -2249,6 +2256,7 @@ class FirstSolutionCollector : public SolutionCollector {
   FirstSolutionCollector(Solver* const s, const Assignment* const a);
   explicit FirstSolutionCollector(Solver* const s);
   ~FirstSolutionCollector() override;
+  bool UsesDeltas() const override { return false; }
   void EnterSearch() override;
   bool AtSolution() override;
   std::string DebugString() const override;
@@ -2306,6 +2314,7 @@ class LastSolutionCollector : public SolutionCollector {
   LastSolutionCollector(Solver* const s, const Assignment* const a);
   explicit LastSolutionCollector(Solver* const s);
   ~LastSolutionCollector() override;
+  bool UsesDeltas() const override { return false; }
   bool AtSolution() override;
   std::string DebugString() const override;
 };
@@ -2352,6 +2361,7 @@ class BestValueSolutionCollector : public SolutionCollector {
                              bool maximize);
   BestValueSolutionCollector(Solver* const s, bool maximize);
   ~BestValueSolutionCollector() override {}
+  bool UsesDeltas() const override { return false; }
   void EnterSearch() override;
   bool AtSolution() override;
   std::string DebugString() const override;
@@ -2423,6 +2433,7 @@ class AllSolutionCollector : public SolutionCollector {
   AllSolutionCollector(Solver* const s, const Assignment* const a);
   explicit AllSolutionCollector(Solver* const s);
   ~AllSolutionCollector() override;
+  bool UsesDeltas() const override { return false; }
   bool AtSolution() override;
   std::string DebugString() const override;
 };
@@ -2512,6 +2523,11 @@ bool OptimizeVar::AcceptSolution() {
   }
 }
 
+// Subclasses may override AcceptDelta().
+bool OptimizeVar::UsesDeltas() const {
+  return typeid(*this) != typeid(OptimizeVar);
+}
+
 bool OptimizeVar::AtSolution() {
   int64 val = var_->Value();
   if (maximize_) {
@@ -2577,6 +2593,7 @@ class WeightedOptimizeVar : public OptimizeVar {
   }
 
   ~WeightedOptimizeVar() override {}
+  bool UsesDeltas() const override { return false; }
   std::string Print() const override;
 
  private:
@@ -2708,6 +2725,7 @@ class TabuSearch : public Metaheuristic {
              const std::vector<IntVar*>& vars, int64 keep_tenure,
              int64 forbid_tenure, double tabu_factor);
   ~TabuSearch() override {}
+  bool UsesDeltas() const override { return false; }
   void EnterSearch() override;
   void ApplyDecision(Decision* d) override;
   bool AtSolution() override;
@@ -2894,6 +2912,7 @@ class SimulatedAnnealing : public Metaheuristic {
   SimulatedAnnealing(Solver* const s, bool maximize, IntVar* objective,
                      int64 step, int64 initial_temperature);
   ~SimulatedAnnealing() override {}
+  bool UsesDeltas() const override { return false; }
   void EnterSearch() override;
   void ApplyDecision(Decision* d) override;
   bool AtSolution() override;
@@ -3574,6 +3593,7 @@ class RegularLimit : public SearchLimit {
   RegularLimit(Solver* const s, int64 time, int64 branches, int64 failures,
                int64 solutions, bool smart_time_check, bool cumulative);
   ~RegularLimit() override;
+  bool UsesDeltas() const override { return false; }
   void Copy(const SearchLimit* const limit) override;
   SearchLimit* MakeClone() const override;
   bool Check() override;
@@ -3802,6 +3822,7 @@ class ORLimit : public SearchLimit {
         << "not the other.";
   }
 
+  bool UsesDeltas() const override { return false; }
   bool Check() override {
     // Check being non-const, there may be side effects. So we always call both
     // checks.
@@ -3870,6 +3891,7 @@ namespace {
 class CustomLimit : public SearchLimit {
  public:
   CustomLimit(Solver* const s, std::function<bool()> limiter);
+  bool UsesDeltas() const override { return false; }
   bool Check() override;
   void Init() override;
   void Copy(const SearchLimit* const limit) override;
@@ -4151,6 +4173,7 @@ class LubyRestart : public SearchMonitor {
   }
 
   ~LubyRestart() override {}
+  bool UsesDeltas() const override { return false; }
 
   void BeginFail() override {
     if (++current_fails_ >= next_step_) {
@@ -4187,6 +4210,7 @@ class ConstantRestart : public SearchMonitor {
   }
 
   ~ConstantRestart() override {}
+  bool UsesDeltas() const override { return false; }
 
   void BeginFail() override {
     if (++current_fails_ >= frequency_) {
@@ -4240,6 +4264,7 @@ class SymmetryManager : public SearchMonitor {
   }
 
   ~SymmetryManager() override {}
+  bool UsesDeltas() const override { return false; }
 
   void EndNextDecision(DecisionBuilder* const db, Decision* const d) override {
     if (d) {
@@ -0,0 +1,627 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "glop/branch_and_bound.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/callback.h"
+#include "base/logging.h"
+#include "base/threadpool.h"
+
+namespace operations_research {
+namespace glop {
+
+namespace {
+// Gains below this value are considered equal when computing the product score
+// of a branching candidate, so that a zero gain in one direction does not hide
+// the gain in the other direction.
+const Fractional kMinScoreGain = 1e-6;
+
+Fractional ProductScore(Fractional down_gain, Fractional up_gain) {
+  return std::max(down_gain, kMinScoreGain) * std::max(up_gain, kMinScoreGain);
+}
+}  // namespace
+
+BranchAndBoundSolver::BranchAndBoundSolver()
+    : parameters_(),
+      lp_parameters_(),
+      lp_(nullptr),
+      objective_sign_(1.0),
+      time_limit_(nullptr),
+      num_active_workers_(0),
+      stop_search_(false),
+      search_interrupted_(false),
+      root_status_(ProblemStatus::INIT),
+      next_sequence_number_(0),
+      discarded_bound_(kInfinity),
+      num_failed_nodes_(0),
+      has_solution_(false),
+      incumbent_objective_(kInfinity),
+      best_bound_(-kInfinity),
+      num_nodes_(0),
+      num_iterations_(0),
+      deterministic_time_(0.0) {}
+
+BranchAndBoundSolver::~BranchAndBoundSolver() {}
+
+void BranchAndBoundSolver::SetParameters(const GlopParameters& parameters) {
+  parameters_ = parameters;
+}
+
+ProblemStatus BranchAndBoundSolver::Solve(const LinearProgram& lp) {
+  std::unique_ptr<TimeLimit> time_limit =
+      TimeLimit::FromParameters(parameters_);
+  return SolveWithTimeLimit(lp, time_limit.get());
+}
+
+ProblemStatus BranchAndBoundSolver::SolveWithTimeLimit(const LinearProgram& lp,
+                                                       TimeLimit* time_limit) {
+  if (time_limit == nullptr) {
+    LOG(DFATAL) << "SolveWithTimeLimit() called with a nullptr time_limit.";
+    return ProblemStatus::ABNORMAL;
+  }
+  if (!lp.IsCleanedUp() || !lp.IsValid()) {
+    LOG(DFATAL) << "The given linear program is invalid or not cleaned up.";
+    return ProblemStatus::INVALID_PROBLEM;
+  }
+
+  // Resets the state of the search.
+  lp_ = &lp;
+  objective_sign_ = lp.IsMaximizationProblem() ? -1.0 : 1.0;
+  time_limit_ = time_limit;
+  open_nodes_.clear();
+  num_active_workers_ = 0;
+  stop_search_ = false;
+  search_interrupted_ = false;
+  root_status_ = ProblemStatus::INIT;
+  next_sequence_number_ = 0;
+  const ColIndex num_cols = lp.num_variables();
+  down_pseudo_costs_.assign(num_cols.value(), PseudoCost());
+  up_pseudo_costs_.assign(num_cols.value(), PseudoCost());
+  down_average_ = PseudoCost();
+  up_average_ = PseudoCost();
+  discarded_bound_ = kInfinity;
+  num_failed_nodes_ = 0;
+  has_solution_ = false;
+  incumbent_objective_ = kInfinity;
+  solution_.assign(num_cols, 0.0);
+  best_bound_ = -kInfinity;
+  num_nodes_ = 0;
+  num_iterations_ = 0;
+  deterministic_time_ = 0.0;
+
+  // The node LPs are solved with the dual simplex, and must keep the same
+  // dimensions for their bases to be reused (see LPSolver::GetState()).
+  lp_parameters_ = parameters_;
+  lp_parameters_.set_use_dual_simplex(true);
+  lp_parameters_.set_use_preprocessing(false);
+  lp_parameters_.set_use_block_decomposition(false);
+  lp_parameters_.set_use_pdhg(false);
+
+  // Rounds the bounds of the integer variables.
+  integer_cols_ = lp.IntegerVariablesList();
+  root_lower_bounds_ = lp.variable_lower_bounds();
+  root_upper_bounds_ = lp.variable_upper_bounds();
+  const Fractional tolerance = parameters_.mip_integrality_tolerance();
+  for (const ColIndex col : integer_cols_) {
+    root_lower_bounds_[col] = std::ceil(root_lower_bounds_[col] - tolerance);
+    root_upper_bounds_[col] = std::floor(root_upper_bounds_[col] + tolerance);
+    if (root_lower_bounds_[col] > root_upper_bounds_[col]) {
+      VLOG(1) << "Integer variable " << lp.GetVariableName(col)
+              << " has no integer value within its bounds.";
+      best_bound_ = kInfinity;
+      return ProblemStatus::PRIMAL_INFEASIBLE;
+    }
+  }
+
+  const int num_threads = std::max(1, parameters_.mip_num_threads());
+  std::vector<std::unique_ptr<Worker>> workers(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers[i].reset(new Worker());
+    workers[i]->lp.PopulateFromLinearProgram(lp);
+    for (const ColIndex col : integer_cols_) {
+      workers[i]->lp.SetVariableBounds(col, root_lower_bounds_[col],
+                                       root_upper_bounds_[col]);
+    }
+  }
+
+  {
+    MutexLock lock(&mutex_);
+    PushNode(std::unique_ptr<Node>(new Node()));
+  }
+  if (num_threads == 1) {
+    RunWorker(workers[0].get());
+  } else {
+    // The pool waits for all the workers to return when it is destroyed.
+    ThreadPool pool("BranchAndBound", num_threads);
+    pool.StartWorkers();
+    for (int i = 0; i < num_threads; ++i) {
+      pool.Add(NewCallback(this, &BranchAndBoundSolver::RunWorker,
+                           workers[i].get()));
+    }
+  }
+
+  if (root_status_ != ProblemStatus::INIT) return root_status_;
+
+  // The best bound is the smallest bound of the nodes that were not proven to
+  // contain no better solution than the incumbent.
+  best_bound_ = std::min(discarded_bound_, incumbent_objective_);
+  for (const std::unique_ptr<Node>& node : open_nodes_) {
+    best_bound_ = std::min(best_bound_, node->lp_bound);
+  }
+  open_nodes_.clear();
+  VLOG(1) << "Branch and bound done: " << num_nodes_ << " nodes, "
+          << num_iterations_ << " simplex iterations, objective "
+          << GetObjectiveValue() << ", bound " << GetBestBound() << ".";
+  if (num_failed_nodes_ > 0) {
+    LOG(WARNING) << num_failed_nodes_ << " node LPs could not be solved.";
+  }
+  if (has_solution_) {
+    return search_interrupted_ || num_failed_nodes_ > 0
+               ? ProblemStatus::PRIMAL_FEASIBLE
+               : ProblemStatus::OPTIMAL;
+  }
+  if (search_interrupted_) return ProblemStatus::INIT;
+  return num_failed_nodes_ > 0 ? ProblemStatus::ABNORMAL
+                               : ProblemStatus::PRIMAL_INFEASIBLE;
+}
+
+Fractional BranchAndBoundSolver::GetObjectiveValue() const {
+  return objective_sign_ * incumbent_objective_;
+}
+
+Fractional BranchAndBoundSolver::GetBestBound() const {
+  return objective_sign_ * best_bound_;
+}
+
+bool BranchAndBoundSolver::NodeComesAfter(const Node& a, const Node& b) const {
+  if (parameters_.mip_node_selection() == GlopParameters::DEPTH_FIRST) {
+    if (a.depth != b.depth) return a.depth < b.depth;
+    if (a.lp_bound != b.lp_bound) return a.lp_bound > b.lp_bound;
+  } else {
+    if (a.lp_bound != b.lp_bound) return a.lp_bound > b.lp_bound;
+    if (a.depth != b.depth) return a.depth < b.depth;
+  }
+  return a.sequence_number < b.sequence_number;
+}
+
+void BranchAndBoundSolver::PushNode(std::unique_ptr<Node> node) {
+  node->sequence_number = next_sequence_number_++;
+  open_nodes_.push_back(std::move(node));
+  std::push_heap(open_nodes_.begin(), open_nodes_.end(),
+                 [this](const std::unique_ptr<Node>& a,
+                        const std::unique_ptr<Node>& b) {
+    return NodeComesAfter(*a, *b);
+  });
+}
+
+std::unique_ptr<BranchAndBoundSolver::Node> BranchAndBoundSolver::PopNode() {
+  DCHECK(!open_nodes_.empty());
+  std::pop_heap(open_nodes_.begin(), open_nodes_.end(),
+                [this](const std::unique_ptr<Node>& a,
+                       const std::unique_ptr<Node>& b) {
+    return NodeComesAfter(*a, *b);
+  });
+  std::unique_ptr<Node> node = std::move(open_nodes_.back());
+  open_nodes_.pop_back();
+  return node;
+}
+
+void BranchAndBoundSolver::RunWorker(Worker* worker) {
+  while (true) {
+    std::unique_ptr<Node> node;
+    {
+      MutexLock lock(&mutex_);
+      while (!stop_search_) {
+        if (LimitReached()) {
+          stop_search_ = true;
+          search_interrupted_ = true;
+          break;
+        }
+        if (!open_nodes_.empty()) {
+          node = PopNode();
+          if (node->lp_bound < Cutoff()) break;
+          DiscardNodeBound(node->lp_bound);
+          node.reset();
+          continue;
+        }
+
+        // The search is over when no node is open and no node is being
+        // processed, otherwise we wait for the children of the active nodes.
+        if (num_active_workers_ == 0) break;
+        condition_.Wait(&mutex_);
+      }
+      if (node == nullptr) {
+        condition_.SignalAll();
+        return;
+      }
+      ++num_active_workers_;
+      ++num_nodes_;
+    }
+    ProcessNode(worker, node.get());
+    {
+      MutexLock lock(&mutex_);
+      --num_active_workers_;
+      condition_.SignalAll();
+    }
+  }
+}
+
+void BranchAndBoundSolver::ProcessNode(Worker* worker, Node* node) {
+  SetNodeBounds(*node, worker);
+  Fractional objective;
+  const LpOutcome outcome = SolveLp(worker, node->basis, -1, &objective);
+  switch (outcome) {
+    case LpOutcome::SOLVED:
+      break;
+    case LpOutcome::INFEASIBLE:
+      return;
+    case LpOutcome::CUTOFF: {
+      MutexLock lock(&mutex_);
+      DiscardNodeBound(objective);
+      return;
+    }
+    case LpOutcome::UNBOUNDED:
+      if (node->depth == 0) {
+        // The LP relaxation is unbounded, so the problem is either unbounded
+        // or infeasible.
+        MutexLock lock(&mutex_);
+        root_status_ = worker->lp_status;
+        stop_search_ = true;
+        return;
+      }
+      FALLTHROUGH_INTENDED;
+    case LpOutcome::FAILED: {
+      // The node is lost, except when the time limit was reached: it is then
+      // counted as an open node in the best bound.
+      MutexLock lock(&mutex_);
+      if (!time_limit_->LimitReached()) ++num_failed_nodes_;
+      DiscardNodeBound(node->lp_bound);
+      return;
+    }
+  }
+
+  // Note that the LP solution is copied since the strong branching solves
+  // overwrite it.
+  const DenseRow values = worker->lp_solver.variable_values();
+  std::vector<ColIndex> fractional_cols;
+  const Fractional tolerance = parameters_.mip_integrality_tolerance();
+  for (const ColIndex col : integer_cols_) {
+    if (std::abs(values[col] - std::round(values[col])) > tolerance) {
+      fractional_cols.push_back(col);
+    }
+  }
+  {
+    MutexLock lock(&mutex_);
+    if (node->branching_col != kInvalidCol) {
+      UpdatePseudoCost(node->branching_col, node->branched_up,
+                       node->branching_distance,
+                       objective - node->parent_objective);
+    }
+    if (objective >= Cutoff()) {
+      DiscardNodeBound(objective);
+      return;
+    }
+    if (fractional_cols.empty()) {
+      if (objective < incumbent_objective_) {
+        has_solution_ = true;
+        incumbent_objective_ = objective;
+        solution_ = values;
+        for (const ColIndex col : integer_cols_) {
+          solution_[col] = std::round(solution_[col]);
+        }
+        VLOG(1) << "New solution with objective " << GetObjectiveValue()
+                << " at node " << num_nodes_ << ".";
+      }
+      return;
+    }
+  }
+
+  const BasisState node_basis = worker->lp_solver.GetState();
+  Fractional down_objective;
+  Fractional up_objective;
+  const ColIndex col = ChooseBranchingVariable(
+      worker, *node, node_basis, objective, values, fractional_cols,
+      &down_objective, &up_objective);
+  if (col == kInvalidCol) {
+    // Strong branching proved that both children can be pruned.
+    return;
+  }
+
+  // Creates the children. The one in the direction of the closest integer is
+  // pushed last so that it is explored first among equivalent nodes.
+  const Fractional value = values[col];
+  const Fractional lower_bound = worker->lp.variable_lower_bounds()[col];
+  const Fractional upper_bound = worker->lp.variable_upper_bounds()[col];
+  const bool up_first = value - std::floor(value) > 0.5;
+  MutexLock lock(&mutex_);
+  for (const bool up : {!up_first, up_first}) {
+    const Fractional child_objective = up ? up_objective : down_objective;
+    if (child_objective >= Cutoff()) {
+      DiscardNodeBound(child_objective);
+      continue;
+    }
+    std::unique_ptr<Node> child(new Node());
+    child->bound_changes.reserve(node->bound_changes.size() + 1);
+    child->bound_changes = node->bound_changes;
+    if (up) {
+      child->bound_changes.push_back(
+          BoundChange(col, std::ceil(value), upper_bound));
+      child->branching_distance = std::ceil(value) - value;
+    } else {
+      child->bound_changes.push_back(
+          BoundChange(col, lower_bound, std::floor(value)));
+      child->branching_distance = value - std::floor(value);
+    }
+    child->lp_bound = std::max(objective, child_objective);
+    child->parent_objective = objective;
+    child->depth = node->depth + 1;
+    child->basis = node_basis;
+    child->branching_col = col;
+    child->branched_up = up;
+    PushNode(std::move(child));
+  }
+}
+
+void BranchAndBoundSolver::SetNodeBounds(const Node& node,
+                                         Worker* worker) const {
+  for (const ColIndex col : worker->modified_cols) {
+    worker->lp.SetVariableBounds(col, root_lower_bounds_[col],
+                                 root_upper_bounds_[col]);
+  }
+  worker->modified_cols.clear();
+  for (const BoundChange& change : node.bound_changes) {
+    worker->lp.SetVariableBounds(change.col, change.lower_bound,
+                                 change.upper_bound);
+    worker->modified_cols.push_back(change.col);
+  }
+}
+
+BranchAndBoundSolver::LpOutcome BranchAndBoundSolver::SolveLp(
+    Worker* worker, const BasisState& basis, int64 max_iterations,
+    Fractional* objective) {
+  Fractional cutoff;
+  double time_left;
+  double deterministic_time_left;
+  {
+    MutexLock lock(&mutex_);
+    cutoff = Cutoff();
+    time_left = time_limit_->GetTimeLeft();
+    deterministic_time_left = time_limit_->GetDeterministicTimeLeft();
+  }
+
+  // The dual simplex stops as soon as its objective, which is a lower bound of
+  // the LP objective, exceeds the cutoff.
+  GlopParameters parameters = lp_parameters_;
+  parameters.set_max_number_of_iterations(max_iterations);
+  if (cutoff < kInfinity) {
+    if (objective_sign_ > 0.0) {
+      parameters.set_objective_upper_limit(cutoff);
+    } else {
+      parameters.set_objective_lower_limit(-cutoff);
+    }
+  }
+  worker->lp_solver.SetParameters(parameters);
+
+  // If the solve fails from the given basis, it is retried from scratch.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    if (attempt > 0) {
+      worker->lp_solver.Clear();
+    } else if (!basis.IsEmpty()) {
+      worker->lp_solver.LoadStateForNextSolve(basis);
+    }
+    TimeLimit lp_time_limit(time_left, deterministic_time_left);
+    worker->lp_status =
+        worker->lp_solver.SolveWithTimeLimit(worker->lp, &lp_time_limit);
+    *objective = objective_sign_ * worker->lp_solver.GetObjectiveValue();
+    {
+      MutexLock lock(&mutex_);
+      num_iterations_ += worker->lp_solver.GetNumberOfSimplexIterations();
+      const double lp_deterministic_time =
+          lp_time_limit.GetElapsedDeterministicTime();
+      deterministic_time_ += lp_deterministic_time;
+      time_limit_->AdvanceDeterministicTime(lp_deterministic_time);
+    }
+    switch (worker->lp_status) {
+      case ProblemStatus::OPTIMAL:
+        return LpOutcome::SOLVED;
+      case ProblemStatus::PRIMAL_INFEASIBLE:  // PASS_THROUGH_INTENDED
+      case ProblemStatus::DUAL_UNBOUNDED:
+        return LpOutcome::INFEASIBLE;
+      case ProblemStatus::PRIMAL_UNBOUNDED:  // PASS_THROUGH_INTENDED
+      case ProblemStatus::DUAL_INFEASIBLE:   // PASS_THROUGH_INTENDED
+      case ProblemStatus::INFEASIBLE_OR_UNBOUNDED:
+        return LpOutcome::UNBOUNDED;
+      case ProblemStatus::DUAL_FEASIBLE:
+        // The dual simplex stopped on a dual feasible basis, whose objective
+        // is thus a lower bound of the LP objective. This happens when the
+        // objective limit or the iteration limit is reached.
+        if (*objective >= cutoff) return LpOutcome::CUTOFF;
+        if (max_iterations >= 0 &&
+            worker->lp_solver.GetNumberOfSimplexIterations() >=
+                max_iterations) {
+          return LpOutcome::SOLVED;
+        }
+        break;
+      default:
+        break;
+    }
+    if (lp_time_limit.LimitReached()) break;
+    VLOG(1) << "Node LP failed with status " << worker->lp_status;
+  }
+  return LpOutcome::FAILED;
+}
+
+ColIndex BranchAndBoundSolver::ChooseBranchingVariable(
+    Worker* worker, const Node& node, const BasisState& node_basis,
+    Fractional node_objective, const DenseRow& values,
+    const std::vector<ColIndex>& fractional_cols, Fractional* down_objective,
+    Fractional* up_objective) {
+  // Scores all the candidates with their pseudo-costs.
+  struct Candidate {
+    ColIndex col;
+    Fractional score;
+    bool is_reliable;
+  };
+  std::vector<Candidate> candidates;
+  {
+    MutexLock lock(&mutex_);
+    const int threshold = parameters_.mip_reliability_threshold();
+    for (const ColIndex col : fractional_cols) {
+      const Fractional down_distance = values[col] - std::floor(values[col]);
+      const Fractional up_distance = std::ceil(values[col]) - values[col];
+      Candidate candidate;
+      candidate.col = col;
+      candidate.score =
+          ProductScore(EstimateGain(col, false, down_distance),
+                       EstimateGain(col, true, up_distance));
+      candidate.is_reliable =
+          std::min(down_pseudo_costs_[col.value()].count,
+                   up_pseudo_costs_[col.value()].count) >= threshold;
+      candidates.push_back(candidate);
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Candidate& a, const Candidate& b) {
+    return a.score > b.score;
+  });
+
+  // Evaluates the most promising unreliable candidates with strong branching.
+  // Their strong branching score replaces their pseudo-cost score.
+  ColIndex best_col = kInvalidCol;
+  Fractional best_score = -1.0;
+  *down_objective = node_objective;
+  *up_objective = node_objective;
+  int num_strong_branchings = 0;
+  for (const Candidate& candidate : candidates) {
+    const ColIndex col = candidate.col;
+    if (candidate.is_reliable ||
+        num_strong_branchings >=
+            parameters_.mip_max_strong_branching_candidates()) {
+      if (candidate.score > best_score) {
+        best_col = col;
+        best_score = candidate.score;
+        *down_objective = node_objective;
+        *up_objective = node_objective;
+      }
+      continue;
+    }
+    ++num_strong_branchings;
+    const Fractional value = values[col];
+    const Fractional lower_bound = worker->lp.variable_lower_bounds()[col];
+    const Fractional upper_bound = worker->lp.variable_upper_bounds()[col];
+    Fractional child_objectives[2];
+    for (const bool up : {false, true}) {
+      if (up) {
+        worker->lp.SetVariableBounds(col, std::ceil(value), upper_bound);
+      } else {
+        worker->lp.SetVariableBounds(col, lower_bound, std::floor(value));
+      }
+      Fractional child_objective;
+      const LpOutcome outcome =
+          SolveLp(worker, node_basis,
+                  parameters_.mip_strong_branching_max_iterations(),
+                  &child_objective);
+      switch (outcome) {
+        case LpOutcome::SOLVED: {
+          child_objective = std::max(child_objective, node_objective);
+          const Fractional distance =
+              up ? std::ceil(value) - value : value - std::floor(value);
+          MutexLock lock(&mutex_);
+          UpdatePseudoCost(col, up, distance, child_objective - node_objective);
+          break;
+        }
+        case LpOutcome::INFEASIBLE:  // PASS_THROUGH_INTENDED
+        case LpOutcome::CUTOFF:
+          child_objective = kInfinity;
+          break;
+        case LpOutcome::UNBOUNDED:  // PASS_THROUGH_INTENDED
+        case LpOutcome::FAILED:
+          child_objective = node_objective;
+          break;
+      }
+      child_objectives[up] = child_objective;
+    }
+    worker->lp.SetVariableBounds(col, lower_bound, upper_bound);
+
+    if (child_objectives[0] == kInfinity && child_objectives[1] == kInfinity) {
+      // Both children can be pruned, and thus this node too.
+      MutexLock lock(&mutex_);
+      DiscardNodeBound(Cutoff());
+      return kInvalidCol;
+    }
+    const Fractional score = ProductScore(child_objectives[0] - node_objective,
+                                          child_objectives[1] - node_objective);
+    if (score > best_score) {
+      best_col = col;
+      best_score = score;
+      *down_objective = child_objectives[0];
+      *up_objective = child_objectives[1];
+    }
+
+    // Branching on a variable with an infeasible child is as good as it gets,
+    // since this only leaves one child to explore.
+    if (score == kInfinity) break;
+  }
+  return best_col;
+}
+
+Fractional BranchAndBoundSolver::EstimateGain(ColIndex col, bool up,
+                                              Fractional distance) const {
+  const PseudoCost& pseudo_cost =
+      up ? up_pseudo_costs_[col.value()] : down_pseudo_costs_[col.value()];
+  if (pseudo_cost.count > 0) {
+    return distance * pseudo_cost.sum / pseudo_cost.count;
+  }
+
+  // Uninitialized pseudo-costs use the average of the initialized ones.
+  const PseudoCost& average = up ? up_average_ : down_average_;
+  if (average.count > 0) return distance * average.sum / average.count;
+  return distance;
+}
+
+void BranchAndBoundSolver::UpdatePseudoCost(ColIndex col, bool up,
+                                            Fractional distance,
+                                            Fractional gain) {
+  if (distance <= parameters_.mip_integrality_tolerance()) return;
+  const Fractional unit_gain = std::max(0.0, gain) / distance;
+  PseudoCost* pseudo_cost =
+      up ? &up_pseudo_costs_[col.value()] : &down_pseudo_costs_[col.value()];
+  pseudo_cost->sum += unit_gain;
+  ++pseudo_cost->count;
+  PseudoCost* average = up ? &up_average_ : &down_average_;
+  average->sum += unit_gain;
+  ++average->count;
+}
+
+Fractional BranchAndBoundSolver::Cutoff() const {
+  if (!has_solution_) return kInfinity;
+  return incumbent_objective_ -
+         std::max(parameters_.mip_absolute_gap(),
+                  parameters_.mip_relative_gap() *
+                      std::abs(incumbent_objective_));
+}
+
+void BranchAndBoundSolver::DiscardNodeBound(Fractional bound) {
+  discarded_bound_ = std::min(discarded_bound_, bound);
+}
+
+bool BranchAndBoundSolver::LimitReached() {
+  const int64 max_nodes = parameters_.mip_max_number_of_nodes();
+  return time_limit_->LimitReached() || (max_nodes >= 0 && num_nodes_ >= max_nodes);
+}
+
+}  // namespace glop
+}  // namespace operations_research
@@ -0,0 +1,267 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// An LP-based branch and bound for mixed integer programs, built on LPSolver.
+// It is meant for modest problems when no other MIP solver is available: there
+// is no presolve, no cutting planes and no primal heuristic apart from the LP
+// solutions that happen to be integer.
+//
+// Each node of the search tree is the list of the bound changes made on the
+// integer variables since the root, together with the basis of its parent.
+// The node LP is solved with the dual simplex, warm-started from this basis
+// which stays dual feasible since only bounds changed. The incumbent objective
+// is used as an objective limit, so that the dual simplex stops as soon as the
+// node can be pruned.
+//
+// Branching uses reliability branching: the fractional variables are scored by
+// their pseudo-costs, i.e. the average objective degradation per unit change
+// observed when branching on them. The candidates whose pseudo-costs are not
+// reliable yet are evaluated with strong branching instead, which also
+// initializes their pseudo-costs.
+//
+// T. Achterberg, T. Koch, A. Martin, "Branching rules revisited", Operations
+// Research Letters 33 (2005), 42-54.
+//
+// The open nodes are kept in a pool shared by mip_num_threads workers, each
+// with its own copy of the problem and its own LPSolver.
+
+#ifndef OR_TOOLS_GLOP_BRANCH_AND_BOUND_H_
+#define OR_TOOLS_GLOP_BRANCH_AND_BOUND_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/integral_types.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "glop/lp_solver.h"
+#include "glop/parameters.pb.h"
+#include "glop/revised_simplex.h"
+#include "lp_data/lp_data.h"
+#include "lp_data/lp_types.h"
+#include "util/time_limit.h"
+
+namespace operations_research {
+namespace glop {
+
+class BranchAndBoundSolver {
+ public:
+  BranchAndBoundSolver();
+  ~BranchAndBoundSolver();
+
+  // Sets or gets the parameters. The mip_* parameters control the search, and
+  // the other ones are used to solve the node LPs.
+  void SetParameters(const GlopParameters& parameters);
+  const GlopParameters& GetParameters() const { return parameters_; }
+
+  // Solves the given problem, whose integer variables are the ones marked with
+  // LinearProgram::SetVariableIntegrality(). The returned status is:
+  // - OPTIMAL if a solution was found and proven optimal within the gap.
+  // - PRIMAL_FEASIBLE if a solution was found, but the search was interrupted
+  //   by a limit or some node LPs could not be solved.
+  // - PRIMAL_INFEASIBLE if the problem was proven infeasible.
+  // - INIT if the search was interrupted before finding a solution.
+  // - The status of the root LP if it is unbounded (PRIMAL_UNBOUNDED,
+  //   DUAL_INFEASIBLE or INFEASIBLE_OR_UNBOUNDED), or if it is invalid.
+  // - ABNORMAL if no solution was found and some node LPs could not be solved.
+  ProblemStatus Solve(const LinearProgram& lp) MUST_USE_RESULT;
+  ProblemStatus SolveWithTimeLimit(const LinearProgram& lp,
+                                   TimeLimit* time_limit) MUST_USE_RESULT;
+
+  // Getters to retrieve the information computed by the last Solve(). The
+  // objective value and the variable values are the ones of the best solution
+  // found, and are only meaningful if one was found. The best bound is a bound
+  // on the optimal objective value. Both include the objective offset and
+  // scaling factor of the problem.
+  Fractional GetObjectiveValue() const;
+  Fractional GetBestBound() const;
+  const DenseRow& variable_values() const { return solution_; }
+  int64 GetNumberOfNodes() const { return num_nodes_; }
+  int64 GetNumberOfSimplexIterations() const { return num_iterations_; }
+  double DeterministicTime() const { return deterministic_time_; }
+
+ private:
+  // A bound change made by the branching on a variable.
+  struct BoundChange {
+    BoundChange(ColIndex c, Fractional lb, Fractional ub)
+        : col(c), lower_bound(lb), upper_bound(ub) {}
+    ColIndex col;
+    Fractional lower_bound;
+    Fractional upper_bound;
+  };
+
+  // A node of the search tree. Its bounds are the root bounds modified by
+  // bound_changes, in order.
+  struct Node {
+    Node()
+        : lp_bound(-kInfinity),
+          depth(0),
+          sequence_number(0),
+          branching_col(kInvalidCol),
+          branching_distance(0.0),
+          parent_objective(0.0),
+          branched_up(false) {}
+
+    std::vector<BoundChange> bound_changes;
+
+    // A lower bound on the objective of this node, from its parent LP. The
+    // objectives inside this class are always minimized (see
+    // objective_sign_).
+    Fractional lp_bound;
+    int depth;
+
+    // Used to break the ties in the node selection. The nodes created last
+    // have the largest numbers.
+    int64 sequence_number;
+
+    // The basis of the parent LP, used to warm-start the node LP.
+    BasisState basis;
+
+    // The branching that created this node, used to update the pseudo-costs
+    // once the node LP is solved. The distance is the one between the parent
+    // LP value of the variable and its new bound.
+    ColIndex branching_col;
+    Fractional branching_distance;
+    Fractional parent_objective;
+    bool branched_up;
+  };
+
+  // The data owned by each thread.
+  struct Worker {
+    Worker() : lp_status(ProblemStatus::INIT) {}
+    LinearProgram lp;
+    LPSolver lp_solver;
+
+    // The status of the last LP solved by lp_solver.
+    ProblemStatus lp_status;
+
+    // The columns whose bounds differ from the root bounds in lp.
+    std::vector<ColIndex> modified_cols;
+  };
+
+  // The pseudo-costs of a variable in one direction.
+  struct PseudoCost {
+    PseudoCost() : sum(0.0), count(0) {}
+    Fractional sum;
+    int count;
+  };
+
+  // The result of the LP of a node or of a strong branching child, with an
+  // objective that is minimized.
+  enum class LpOutcome { SOLVED, INFEASIBLE, CUTOFF, UNBOUNDED, FAILED };
+
+  // Returns true if node a should be explored after node b.
+  bool NodeComesAfter(const Node& a, const Node& b) const;
+  void PushNode(std::unique_ptr<Node> node) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  std::unique_ptr<Node> PopNode() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Takes the open nodes one by one and processes them until the search is
+  // over.
+  void RunWorker(Worker* worker);
+
+  // Solves the LP of the given node and either prunes it, records its solution
+  // as the new incumbent, or branches and pushes its children.
+  void ProcessNode(Worker* worker, Node* node);
+
+  // Changes the bounds of the problem of the worker to the node ones.
+  void SetNodeBounds(const Node& node, Worker* worker) const;
+
+  // Solves the current problem of the worker, warm-started from the given
+  // basis, with at most max_iterations simplex iterations (if non-negative).
+  // The objective is only meaningful when the outcome is SOLVED.
+  LpOutcome SolveLp(Worker* worker, const BasisState& basis,
+                    int64 max_iterations, Fractional* objective);
+
+  // Chooses the variable to branch on among the given fractional columns,
+  // using the pseudo-costs and strong branching. The objectives of the two
+  // children are set to the strong branching bounds (or to kInfinity if a
+  // child was found infeasible), and to node_objective otherwise.
+  ColIndex ChooseBranchingVariable(Worker* worker, const Node& node,
+                                   const BasisState& node_basis,
+                                   Fractional node_objective,
+                                   const DenseRow& values,
+                                   const std::vector<ColIndex>& fractional_cols,
+                                   Fractional* down_objective,
+                                   Fractional* up_objective);
+
+  // Returns the estimated objective degradation for moving the given column by
+  // distance in the given direction.
+  Fractional EstimateGain(ColIndex col, bool up, Fractional distance) const
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void UpdatePseudoCost(ColIndex col, bool up, Fractional distance,
+                        Fractional gain) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns the objective below which a node can still improve the incumbent.
+  Fractional Cutoff() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Records the bound of a node that is discarded without being explored
+  // although it may contain solutions better than the incumbent (within the
+  // gap, or because its LP could not be solved).
+  void DiscardNodeBound(Fractional bound) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns true if the search must stop because of a limit.
+  bool LimitReached() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Parameters of the search, and of the node LPs.
+  GlopParameters parameters_;
+  GlopParameters lp_parameters_;
+
+  // The problem given to Solve(), with its integer variables bounds rounded.
+  const LinearProgram* lp_;
+  std::vector<ColIndex> integer_cols_;
+  DenseRow root_lower_bounds_;
+  DenseRow root_upper_bounds_;
+
+  // 1.0 for a minimization problem, -1.0 for a maximization problem. All the
+  // objectives manipulated by this class are multiplied by this sign so that
+  // they are minimized.
+  Fractional objective_sign_;
+
+  // The shared state of the search.
+  Mutex mutex_;
+  CondVar condition_;
+  TimeLimit* time_limit_ GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<Node>> open_nodes_ GUARDED_BY(mutex_);
+  int num_active_workers_ GUARDED_BY(mutex_);
+  bool stop_search_ GUARDED_BY(mutex_);
+  bool search_interrupted_ GUARDED_BY(mutex_);
+  ProblemStatus root_status_ GUARDED_BY(mutex_);
+  int64 next_sequence_number_ GUARDED_BY(mutex_);
+  std::vector<PseudoCost> down_pseudo_costs_ GUARDED_BY(mutex_);
+  std::vector<PseudoCost> up_pseudo_costs_ GUARDED_BY(mutex_);
+
+  // The pseudo-costs of all the variables together, used to initialize the
+  // ones of the variables that were never branched on.
+  PseudoCost down_average_ GUARDED_BY(mutex_);
+  PseudoCost up_average_ GUARDED_BY(mutex_);
+
+  // The smallest bound of the discarded nodes, see DiscardNodeBound().
+  Fractional discarded_bound_ GUARDED_BY(mutex_);
+  int64 num_failed_nodes_ GUARDED_BY(mutex_);
+
+  // The best solution found so far, and the statistics of the search.
+  bool has_solution_ GUARDED_BY(mutex_);
+  Fractional incumbent_objective_ GUARDED_BY(mutex_);
+  DenseRow solution_ GUARDED_BY(mutex_);
+  Fractional best_bound_;
+  int64 num_nodes_ GUARDED_BY(mutex_);
+  int64 num_iterations_ GUARDED_BY(mutex_);
+  double deterministic_time_ GUARDED_BY(mutex_);
+
+  DISALLOW_COPY_AND_ASSIGN(BranchAndBoundSolver);
+};
+
+}  // namespace glop
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_GLOP_BRANCH_AND_BOUND_H_
@@ -14,6 +14,8 @@
 
 #include "glop/entering_variable.h"
 
+#include <algorithm>
+#include <functional>
 #include <queue>
 
 #include "base/timer.h"
@@ -41,12 +43,25 @@ EnteringVariable::EnteringVariable(const VariablesInfo& variables_info,
       primal_edge_norms_(primal_edge_norms),
       parameters_(),
       rule_(GlopParameters::DANTZIG),
-      unused_columns_() {}
+      unused_columns_(),
+      partial_pricing_start_(0),
+      num_calls_since_refresh_(0) {}
 
 Status EnteringVariable::PrimalChooseEnteringColumn(ColIndex* entering_col) {
   SCOPED_TIME_STAT(&stats_);
   RETURN_ERROR_IF_NULL(entering_col);
 
+  switch (parameters_.primal_pricing_scope()) {
+    case GlopParameters::PARTIAL_PRICING:
+      PartialChooseEnteringColumn(entering_col);
+      return Status::OK;
+    case GlopParameters::MULTIPLE_PRICING:
+      MultipleChooseEnteringColumn(entering_col);
+      return Status::OK;
+    case GlopParameters::FULL_PRICING:
+      break;
+  }
+
   // For better redability of the templated function calls below.
   const bool kNormalize = true;
   const bool kNested = true;
@@ -134,12 +149,14 @@ Status EnteringVariable::DualChooseEnteringColumn(
   std::vector<ColWithRatio> breakpoints;
   breakpoints.reserve(update_row.GetNonZeroPositions().size());
   const Fractional threshold = parameters_.ratio_test_zero_threshold();
+  const bool use_bound_flipping = parameters_.use_bound_flipping_ratio_test();
   const DenseBitRow& can_decrease = variables_info_.GetCanDecreaseBitRow();
   const DenseBitRow& can_increase = variables_info_.GetCanIncreaseBitRow();
 
   // Harris ratio test. See below for more explanation. Here this is used to
   // prune the first pass by not enqueueing ColWithRatio for columns that have
-  // a ratio greater than the current harris_ratio.
+  // a ratio greater than the current harris_ratio. The boxed columns are never
+  // pruned when they can be flipped since the step can go past them.
   const VariableTypeRow& variable_type = variables_info_.GetTypeRow();
   const Fractional harris_tolerance =
       parameters_.harris_tolerance_ratio() *
@@ -152,11 +169,14 @@ Status EnteringVariable::DualChooseEnteringColumn(
     // (its update coeff is sign(cost_variation) * 1.0).
     const Fractional coeff = (cost_variation > 0.0) ? update_coefficient[col]
                                                     : -update_coefficient[col];
+    const bool can_be_pruned =
+        !use_bound_flipping ||
+        variable_type[col] != VariableType::UPPER_AND_LOWER_BOUNDED;
 
     // In this case, at some point the reduced cost will be positive if not
     // already, and the column will be dual-infeasible.
     if (can_decrease.IsSet(col) && coeff > threshold) {
-      if (variable_type[col] != VariableType::UPPER_AND_LOWER_BOUNDED) {
+      if (can_be_pruned) {
         if (-reduced_costs[col] > harris_ratio * coeff) continue;
         harris_ratio =
             std::min(harris_ratio, (-reduced_costs[col] + harris_tolerance) / coeff);
@@ -169,7 +189,7 @@ Status EnteringVariable::DualChooseEnteringColumn(
     // In this case, at some point the reduced cost will be negative if not
     // already, and the column will be dual-infeasible.
     if (can_increase.IsSet(col) && coeff < -threshold) {
-      if (variable_type[col] != VariableType::UPPER_AND_LOWER_BOUNDED) {
+      if (can_be_pruned) {
         if (reduced_costs[col] > harris_ratio * -coeff) continue;
         harris_ratio =
             std::min(harris_ratio, (reduced_costs[col] + harris_tolerance) / -coeff);
@@ -184,52 +204,38 @@ Status EnteringVariable::DualChooseEnteringColumn(
   // I. Maros, "A generalized dual phase-2 simplex algorithm", European Journal
   // of Operational Research, 149(1):1-16, 2003.
   // We use directly make_heap() to avoid a copy of breakpoints, benchmark shows
-  // that it is slightly faster.
+  // that it is slightly faster. The popped breakpoints are kept at the end of
+  // the vector, after the first heap_size elements that still form the heap.
   std::make_heap(breakpoints.begin(), breakpoints.end());
+  int heap_size = breakpoints.size();
 
-  // Harris ratio test. Since we process the breakpoints by increasing ratio, we
-  // do not need a two-pass algorithm as described in the literature. Each time
-  // we process a new breakpoint, we update the harris_ratio of all the
-  // processed breakpoints. For the first new breakpoint with a ratio greater
-  // than the current harris_ratio we know that:
-  // - All the unprocessed breakpoints will have a ratio greater too, so they
-  //   will not contribute to the minimum Harris ratio.
-  // - We thus have the actual harris_ratio.
-  // - We have processed all breakpoints with a ratio smaller than it.
-  harris_ratio = std::numeric_limits<Fractional>::max();
-
-  *entering_col = kInvalidCol;
-  bound_flip_candidates->clear();
-  Fractional best_coeff = -1.0;
+  // Bound flipping ratio test with Harris tolerance, see Algorithm 7 in
+  // A. Koberstein, "The dual simplex method, techniques for a fast and stable
+  // implementation", PhD thesis, Paderborn, 2005.
+  //
+  // The breakpoints are processed by groups. Each group contains all the
+  // remaining breakpoints with a ratio smaller than the Harris ratio of the
+  // remaining breakpoints. Since we process them by increasing ratio, we do
+  // not need a two-pass algorithm to compute this Harris ratio: for the first
+  // breakpoint with a ratio greater than the current harris_ratio, we know that
+  // all the unprocessed breakpoints will have a ratio greater too, so they will
+  // not contribute to the minimum.
+  //
+  // If all the columns of a group are boxed, we can just switch their bounds
+  // and go past the group. But we need to see if the entering row still
+  // improves the objective: the slope of the dual objective, which is the
+  // primal infeasibility |cost_variation| of the leaving variable, decreases
+  // by |upper_bound - lower_bound| times |coeff| for each flip. See also
+  // http://www.mpi-inf.mpg.de/conferences/adfocs-03/Slides/Bixby_2.pdf
   Fractional variation_magnitude = fabs(cost_variation);
-  equivalent_entering_choices_.clear();
-  while (!breakpoints.empty()) {
-    const ColWithRatio top = breakpoints.front();
-    if (top.ratio > harris_ratio) break;
-
-    // If the column is boxed, we can just switch its bounds and
-    // ignore the breakpoint! But we need to see if the entering row still
-    // improve the objective. This is called the bound flipping ratio test in
-    // the literature. See for instance:
-    // http://www.mpi-inf.mpg.de/conferences/adfocs-03/Slides/Bixby_2.pdf
-    //
-    // For each bound flip, |cost_variation| decreases by
-    // |upper_bound - lower_bound| times |coeff|.
-    //
-    // Note that the actual flipping will be done afterwards by
-    // MakeBoxedVariableDualFeasible() in revised_simplex.cc.
-    bool variable_can_flip = false;
-    if (variable_type[top.col] == VariableType::UPPER_AND_LOWER_BOUNDED) {
-      variation_magnitude -=
-          variables_info_.GetBoundDifference(top.col) * top.coeff_magnitude;
-      if (variation_magnitude > threshold) {
-        variable_can_flip = true;
-        bound_flip_candidates->push_back(top.col);
-      }
-    }
-
-    // Update harris_ratio (only if the variable cannot flip).
-    if (!variable_can_flip) {
+  int flippable_end = heap_size;
+  while (heap_size > 0) {
+    Fractional slope_decrease = 0.0;
+    bool group_can_flip = use_bound_flipping;
+    harris_ratio = std::numeric_limits<Fractional>::max();
+    while (heap_size > 0) {
+      const ColWithRatio& top = breakpoints.front();
+      if (top.ratio > harris_ratio) break;
       harris_ratio =
           std::min(harris_ratio, top.ratio + harris_tolerance / top.coeff_magnitude);
 
@@ -238,31 +244,73 @@ Status EnteringVariable::DualChooseEnteringColumn(
       // position to enter the basis. This is quite important because its helps
       // in the choice of a stable pivot.
       harris_ratio = std::max(harris_ratio, 0.0);
-    }
 
-    // TODO(user): We want to maximize both the ratio (objective improvement)
-    // and the coeff_magnitude (stable pivot), so we have to make some
-    // trade-offs.
-    if (top.coeff_magnitude >= best_coeff) {
-      if (top.coeff_magnitude == best_coeff && top.ratio == *step) {
-        DCHECK_NE(*entering_col, kInvalidCol);
-        equivalent_entering_choices_.push_back(top.col);
+      if (variable_type[top.col] == VariableType::UPPER_AND_LOWER_BOUNDED) {
+        slope_decrease +=
+            variables_info_.GetBoundDifference(top.col) * top.coeff_magnitude;
       } else {
-        equivalent_entering_choices_.clear();
-        best_coeff = top.coeff_magnitude;
-        *entering_col = top.col;
-
-        // Note that the step is not directly used, so it is okay to leave it
-        // negative.
-        *step = top.ratio;
+        group_can_flip = false;
       }
+
+      // This is the same as doing a pop() on a priority_queue, except that the
+      // top element is kept at position heap_size - 1.
+      std::pop_heap(breakpoints.begin(), breakpoints.begin() + heap_size);
+      --heap_size;
     }
+    if (!group_can_flip ||
+        variation_magnitude - slope_decrease <= threshold) {
+      break;
+    }
+    variation_magnitude -= slope_decrease;
+    flippable_end = heap_size;
+  }
 
-    // Remove the top breakpoint and maintain the heap structure.
-    // This is the same as doing a pop() on a priority_queue.
-    std::pop_heap(breakpoints.begin(), breakpoints.end());
-    breakpoints.pop_back();
+  // If all the breakpoints can be flipped, the leaving variable stays
+  // primal-infeasible whatever the step and the dual is unbounded along this
+  // row. Otherwise, the entering column is chosen among all the processed
+  // breakpoints, stored from the last position of the vector down to
+  // heap_size.
+  //
+  // Note that we do not restrict the choice to the last group like the
+  // textbook version: a larger pivot before the last group gives a more stable
+  // basis and, on our benchmarks, fewer iterations overall.
+  //
+  // TODO(user): We want to maximize both the ratio (objective improvement)
+  // and the coeff_magnitude (stable pivot), so we have to make some
+  // trade-offs.
+  *entering_col = kInvalidCol;
+  bound_flip_candidates->clear();
+  equivalent_entering_choices_.clear();
+  if (heap_size == 0 && flippable_end == 0) return Status::OK;
+  Fractional best_coeff = -1.0;
+  for (int i = breakpoints.size() - 1; i >= heap_size; --i) {
+    const ColWithRatio& candidate = breakpoints[i];
+    if (candidate.coeff_magnitude < best_coeff) continue;
+    if (candidate.coeff_magnitude == best_coeff && candidate.ratio == *step) {
+      DCHECK_NE(*entering_col, kInvalidCol);
+      equivalent_entering_choices_.push_back(candidate.col);
+    } else {
+      equivalent_entering_choices_.clear();
+      best_coeff = candidate.coeff_magnitude;
+      *entering_col = candidate.col;
+
+      // Note that the step is not directly used, so it is okay to leave it
+      // negative.
+      *step = candidate.ratio;
+    }
+  }
+
+  // The columns of the flippable groups with a ratio smaller than the step
+  // must be flipped since their reduced costs will change sign. The actual
+  // flipping is done afterwards by the caller. Since these columns form a
+  // subset of the flippable groups, the leaving variable stays
+  // primal-infeasible after the flips.
+  for (int i = breakpoints.size() - 1; i >= flippable_end; --i) {
+    if (breakpoints[i].ratio < *step) {
+      bound_flip_candidates->push_back(breakpoints[i].col);
+    }
   }
+  IF_STATS_ENABLED(stats_.num_bound_flips.Add(bound_flip_candidates->size()));
 
   // Break the ties randomly.
   if (!equivalent_entering_choices_.empty()) {
@@ -409,6 +457,10 @@ void EnteringVariable::SetParameters(const GlopParameters& parameters) {
 
 void EnteringVariable::SetPricingRule(GlopParameters::PricingRule rule) {
   rule_ = rule;
+
+  // This is called at the beginning of each phase, when the objective changes.
+  pricing_candidates_.clear();
+  pricing_candidate_squared_norms_.clear();
 }
 
 DenseBitRow* EnteringVariable::ResetUnusedColumns() {
@@ -511,5 +563,133 @@ void EnteringVariable::NormalizedChooseEnteringColumn(ColIndex* entering_col) {
   }
 }
 
+void EnteringVariable::PartialChooseEnteringColumn(ColIndex* entering_col) {
+  DCHECK(reduced_costs_->IsPartialPricingEnabled());
+  const bool normalize = parameters_.normalize_using_column_norm();
+  DenseRow dummy;
+  const DenseRow& matrix_column_norms =
+      normalize ? primal_edge_norms_->GetMatrixColumnNorms() : dummy;
+  const DenseBitRow& is_relevant = variables_info_.GetIsRelevantBitRow();
+  const ColIndex num_cols = variables_info_.GetNumberOfColumns();
+  const ColIndex segment_size(
+      std::max(1, parameters_.partial_pricing_segment_size()));
+  SCOPED_TIME_STAT(&stats_);
+
+  // Scan the segments starting where the last call stopped, until one of them
+  // contains a candidate or all the columns were scanned once.
+  Fractional best_price(0.0);
+  *entering_col = kInvalidCol;
+  ColIndex col =
+      partial_pricing_start_ < num_cols ? partial_pricing_start_ : ColIndex(0);
+  ColIndex num_scanned(0);
+  while (num_scanned < num_cols && *entering_col == kInvalidCol) {
+    const ColIndex segment_end =
+        std::min(num_cols, col + std::min(segment_size, num_cols - num_scanned));
+    num_scanned += segment_end - col;
+    for (; col < segment_end; ++col) {
+      if (!is_relevant.IsSet(col)) continue;
+      const Fractional reduced_cost = reduced_costs_->ComputeReducedCost(col);
+      if (!reduced_costs_->IsValidPrimalEnteringCandidate(col)) continue;
+      const Fractional squared_norm =
+          normalize ? Square(matrix_column_norms[col]) : 1.0;
+      if (Square(reduced_cost) > best_price * squared_norm) {
+        best_price = Square(reduced_cost) / squared_norm;
+        *entering_col = col;
+      }
+    }
+    if (col == num_cols) col = ColIndex(0);
+  }
+  partial_pricing_start_ = col;
+}
+
+void EnteringVariable::MultipleChooseEnteringColumn(ColIndex* entering_col) {
+  DCHECK(reduced_costs_->IsPartialPricingEnabled());
+  bool refreshed = false;
+  if (pricing_candidates_.empty() ||
+      num_calls_since_refresh_ >= parameters_.multiple_pricing_refresh_period()) {
+    RefreshPricingCandidates();
+    refreshed = true;
+  }
+  ++num_calls_since_refresh_;
+  ChooseAmongPricingCandidates(entering_col);
+
+  // If none of the candidates is still attractive, we need a full scan to
+  // know if there are other candidates.
+  if (*entering_col == kInvalidCol && !refreshed) {
+    RefreshPricingCandidates();
+    ChooseAmongPricingCandidates(entering_col);
+  }
+}
+
+void EnteringVariable::RefreshPricingCandidates() {
+  const bool normalize = parameters_.normalize_using_column_norm();
+  DenseRow dummy;
+  const DenseRow& matrix_column_norms =
+      normalize ? primal_edge_norms_->GetMatrixColumnNorms() : dummy;
+  const int num_candidates =
+      std::max(1, parameters_.multiple_pricing_num_candidates());
+  SCOPED_TIME_STAT(&stats_);
+
+  // Min-heap on the normalized price of the best candidates found so far. The
+  // edge norms being too expensive to compute for all the columns, this scan
+  // never uses them.
+  typedef std::pair<Fractional, ColIndex> PriceAndCol;
+  std::vector<PriceAndCol> best_candidates;
+  best_candidates.reserve(num_candidates);
+  for (const ColIndex col : variables_info_.GetIsRelevantBitRow()) {
+    const Fractional reduced_cost = reduced_costs_->ComputeReducedCost(col);
+    if (!reduced_costs_->IsValidPrimalEnteringCandidate(col)) continue;
+    const Fractional price =
+        normalize ? Square(reduced_cost / matrix_column_norms[col])
+                  : Square(reduced_cost);
+    if (best_candidates.size() < static_cast<size_t>(num_candidates)) {
+      best_candidates.push_back(PriceAndCol(price, col));
+      std::push_heap(best_candidates.begin(), best_candidates.end(),
+                     std::greater<PriceAndCol>());
+    } else if (price > best_candidates.front().first) {
+      std::pop_heap(best_candidates.begin(), best_candidates.end(),
+                    std::greater<PriceAndCol>());
+      best_candidates.back() = PriceAndCol(price, col);
+      std::push_heap(best_candidates.begin(), best_candidates.end(),
+                     std::greater<PriceAndCol>());
+    }
+  }
+
+  // With the STEEPEST_EDGE and DEVEX rules, the exact edge norms are computed
+  // for the candidates only. They are not updated until the next refresh.
+  pricing_candidates_.clear();
+  pricing_candidate_squared_norms_.clear();
+  for (const PriceAndCol& candidate : best_candidates) {
+    const ColIndex col = candidate.second;
+    pricing_candidates_.push_back(col);
+    if (rule_ != GlopParameters::DANTZIG) {
+      pricing_candidate_squared_norms_.push_back(
+          primal_edge_norms_->ComputeEdgeSquaredNorm(col));
+    } else {
+      pricing_candidate_squared_norms_.push_back(
+          normalize ? Square(matrix_column_norms[col]) : 1.0);
+    }
+  }
+  num_calls_since_refresh_ = 0;
+}
+
+void EnteringVariable::ChooseAmongPricingCandidates(ColIndex* entering_col) {
+  SCOPED_TIME_STAT(&stats_);
+  const DenseBitRow& is_relevant = variables_info_.GetIsRelevantBitRow();
+  Fractional best_price(0.0);
+  *entering_col = kInvalidCol;
+  for (int i = 0; i < pricing_candidates_.size(); ++i) {
+    const ColIndex col = pricing_candidates_[i];
+    if (!is_relevant.IsSet(col)) continue;
+    const Fractional reduced_cost = reduced_costs_->ComputeReducedCost(col);
+    if (!reduced_costs_->IsValidPrimalEnteringCandidate(col)) continue;
+    const Fractional squared_norm = pricing_candidate_squared_norms_[i];
+    if (Square(reduced_cost) > best_price * squared_norm) {
+      best_price = Square(reduced_cost) / squared_norm;
+      *entering_col = col;
+    }
+  }
+}
+
 }  // namespace glop
 }  // namespace operations_research
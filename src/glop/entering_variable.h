@@ -69,6 +69,11 @@ class EnteringVariable {
   // cost_variation. Computes the smallest step that keeps the dual feasibility
   // for all the columns. The pivot is the coefficient of the "update" vector at
   // the entering column index.
+  //
+  // If use_bound_flipping_ratio_test is true, the step may go past the
+  // breakpoints of boxed columns. These columns are returned in
+  // bound_flip_candidates and must be flipped to their other bound by the
+  // caller before the primal step is computed.
   Status DualChooseEnteringColumn(const UpdateRow& update_row,
                                   Fractional cost_variation,
                                   std::vector<ColIndex>* bound_flip_candidates,
@@ -111,6 +116,18 @@ class EnteringVariable {
   template <bool use_steepest_edge>
   void NormalizedChooseEnteringColumn(ColIndex* entering_col);
 
+  // Partial and multiple pricing, see GlopParameters::PrimalPricingScope.
+  // The reduced costs are computed on demand by ReducedCosts.
+  void PartialChooseEnteringColumn(ColIndex* entering_col);
+  void MultipleChooseEnteringColumn(ColIndex* entering_col);
+
+  // Scans all the columns and keeps the best ones in pricing_candidates_.
+  void RefreshPricingCandidates();
+
+  // Chooses the best column of pricing_candidates_, or kInvalidCol if none of
+  // them is an entering candidate anymore.
+  void ChooseAmongPricingCandidates(ColIndex* entering_col);
+
   // Problem data that should be updated from outside.
   const VariablesInfo& variables_info_;
 
@@ -126,8 +143,10 @@ class EnteringVariable {
   struct Stats : public StatsGroup {
     Stats()
         : StatsGroup("EnteringVariable"),
-          num_perfect_ties("num_perfect_ties", this) {}
+          num_perfect_ties("num_perfect_ties", this),
+          num_bound_flips("num_bound_flips", this) {}
     IntegerDistribution num_perfect_ties;
+    IntegerDistribution num_bound_flips;
   };
   Stats stats_;
 
@@ -142,6 +161,16 @@ class EnteringVariable {
   // anyway.
   std::vector<ColIndex> equivalent_entering_choices_;
 
+  // Where the next scan of PartialChooseEnteringColumn() starts.
+  ColIndex partial_pricing_start_;
+
+  // The candidate list of MultipleChooseEnteringColumn() with the squared
+  // norms used to normalize their reduced costs, and the number of calls since
+  // it was last refreshed.
+  std::vector<ColIndex> pricing_candidates_;
+  std::vector<Fractional> pricing_candidate_squared_norms_;
+  int num_calls_since_refresh_;
+
   DISALLOW_COPY_AND_ASSIGN(EnteringVariable);
 };
 
@@ -21,11 +21,14 @@
 #include "base/commandlineflags.h"
 #include "base/integral_types.h"
 #include "base/timer.h"
+#include "base/callback.h"
+#include "base/threadpool.h"
 
 #include "base/join.h"
 #include "base/strutil.h"
 #include "glop/preprocessor.h"
 #include "glop/proto_utils.h"
+#include "glop/revised_simplex.h"
 #include "glop/status.h"
 #include "lp_data/lp_types.h"
 #include "lp_data/lp_utils.h"
@@ -99,7 +102,11 @@ void DumpLinearProgramIfRequiredByFlags(const LinearProgram& linear_program,
 // LPSolver
 // --------------------------------------------------------
 
-LPSolver::LPSolver() : num_solves_(0) {}
+LPSolver::LPSolver()
+    : num_revised_simplex_iterations_(0),
+      block_deterministic_time_(0.0),
+      num_pdhg_iterations_(0),
+      num_solves_(0) {}
 
 void LPSolver::SetParameters(const GlopParameters& parameters) {
   parameters_ = parameters;
@@ -121,6 +128,8 @@ ProblemStatus LPSolver::SolveWithTimeLimit(const LinearProgram& lp,
   }
   ++num_solves_;
   num_revised_simplex_iterations_ = 0;
+  block_deterministic_time_ = 0.0;
+  num_pdhg_iterations_ = 0;
 #ifndef ANDROID_JNI
   DumpLinearProgramIfRequiredByFlags(lp, num_solves_);
 #endif
@@ -157,9 +166,35 @@ ProblemStatus LPSolver::SolveWithTimeLimit(const LinearProgram& lp,
   VLOG(1) << "Objective stats: " << lp.GetObjectiveStatsString();
   current_linear_program_.PopulateFromLinearProgram(lp);
 
+  // A basis given by SetInitialBasis() is only used if it matches the problem.
+  bool use_initial_basis = false;
+  if (!initial_variable_statuses_.empty() ||
+      !initial_constraint_statuses_.empty()) {
+    use_initial_basis =
+        initial_variable_statuses_.size() == lp.num_variables() &&
+        initial_constraint_statuses_.size() == lp.num_constraints();
+    if (!use_initial_basis) {
+      LOG(WARNING) << "Ignoring the initial basis whose dimensions do not "
+                   << "match the problem.";
+    }
+  }
+
   // Preprocess.
   MainLpPreprocessor preprocessor;
-  preprocessor.SetParameters(parameters_);
+  if (use_initial_basis) {
+    GlopParameters preprocessor_parameters = parameters_;
+    preprocessor_parameters.set_use_preprocessing(false);
+    preprocessor.SetParameters(preprocessor_parameters);
+  } else if (parameters_.use_pdhg()) {
+    // Dualizing the problem does not help the PDHG, whose iterations only
+    // depend on the number of entries, and the postsolve of the dual needs a
+    // basic solution.
+    GlopParameters preprocessor_parameters = parameters_;
+    preprocessor_parameters.set_solve_dual_problem(GlopParameters::NEVER_DO);
+    preprocessor.SetParameters(preprocessor_parameters);
+  } else {
+    preprocessor.SetParameters(parameters_);
+  }
 
   const bool postsolve_is_needed = preprocessor.Run(&current_linear_program_,
                                                     time_limit);
@@ -170,7 +205,15 @@ ProblemStatus LPSolver::SolveWithTimeLimit(const LinearProgram& lp,
                            current_linear_program_.num_variables());
   solution.status = preprocessor.status();
 
-  RunRevisedSimplexIfNeeded(&solution, time_limit);
+  if (use_initial_basis) {
+    LoadInitialBasis(lp);
+    RunRevisedSimplexIfNeeded(&solution, time_limit);
+  } else if (parameters_.use_pdhg()) {
+    RunPrimalDualHybridGradientIfNeeded(&solution, time_limit);
+  } else if (!parameters_.use_block_decomposition() ||
+             !RunBlockDecompositionIfNeeded(&solution, time_limit)) {
+    RunRevisedSimplexIfNeeded(&solution, time_limit);
+  }
 
   if (postsolve_is_needed) preprocessor.RecoverSolution(&solution);
   return LoadAndVerifySolution(lp, solution);
@@ -179,9 +222,61 @@ ProblemStatus LPSolver::SolveWithTimeLimit(const LinearProgram& lp,
 void LPSolver::Clear() {
   ResizeSolution(RowIndex(0), ColIndex(0));
   revised_simplex_.reset(nullptr);
+  pdhg_.reset(nullptr);
+  initial_variable_statuses_.clear();
+  initial_constraint_statuses_.clear();
+}
+
+const BasisState& LPSolver::GetState() const {
+  static const BasisState* const kEmptyState = new BasisState();
+  return revised_simplex_ == nullptr ? *kEmptyState
+                                     : revised_simplex_->GetState();
+}
+
+void LPSolver::LoadStateForNextSolve(const BasisState& state) {
+  if (revised_simplex_ == nullptr) {
+    revised_simplex_.reset(new RevisedSimplex());
+  }
+  revised_simplex_->LoadStateForNextSolve(state);
+}
+
+void LPSolver::SetInitialBasis(
+    const VariableStatusRow& variable_statuses,
+    const ConstraintStatusColumn& constraint_statuses) {
+  initial_variable_statuses_ = variable_statuses;
+  initial_constraint_statuses_ = constraint_statuses;
 }
 
 namespace {
+// Returns the state of the revised simplex corresponding to the given
+// statuses. Note that the slack variable of a constraint is at its upper bound
+// when the constraint is at its lower bound.
+BasisState ComputeBasisState(const VariableStatusRow& variable_statuses,
+                             const ConstraintStatusColumn& constraint_statuses) {
+  BasisState state;
+  state.num_rows = constraint_statuses.size();
+  state.num_cols = variable_statuses.size();
+  state.statuses = variable_statuses;
+  for (RowIndex row(0); row < constraint_statuses.size(); ++row) {
+    switch (constraint_statuses[row]) {
+      case ConstraintStatus::AT_LOWER_BOUND:
+        state.statuses.push_back(VariableStatus::AT_UPPER_BOUND);
+        break;
+      case ConstraintStatus::AT_UPPER_BOUND:
+        state.statuses.push_back(VariableStatus::AT_LOWER_BOUND);
+        break;
+      case ConstraintStatus::FIXED_VALUE:
+        state.statuses.push_back(VariableStatus::FIXED_VALUE);
+        break;
+      case ConstraintStatus::FREE:  // PASS_THROUGH_INTENDED
+      case ConstraintStatus::BASIC:
+        state.statuses.push_back(VariableStatus::BASIC);
+        break;
+    }
+  }
+  return state;
+}
+
 // Computes the "real" problem objective from the one without offset nor
 // scaling.
 Fractional ProblemObjectiveValue(const LinearProgram& lp, Fractional value) {
@@ -193,6 +288,77 @@ Fractional ProblemObjectiveValue(const LinearProgram& lp, Fractional value) {
 Fractional AllowedError(Fractional tolerance, Fractional value) {
   return tolerance * std::max(1.0, std::abs(value));
 }
+
+// Copies the solution found by the given revised simplex.
+void PopulateSolutionFromRevisedSimplex(const RevisedSimplex& revised_simplex,
+                                        ProblemSolution* solution) {
+  solution->status = revised_simplex.GetProblemStatus();
+
+  const ColIndex num_cols = revised_simplex.GetProblemNumCols();
+  DCHECK_EQ(solution->primal_values.size(), num_cols);
+  for (ColIndex col(0); col < num_cols; ++col) {
+    solution->primal_values[col] = revised_simplex.GetVariableValue(col);
+    solution->variable_statuses[col] = revised_simplex.GetVariableStatus(col);
+  }
+
+  const RowIndex num_rows = revised_simplex.GetProblemNumRows();
+  DCHECK_EQ(solution->dual_values.size(), num_rows);
+  for (RowIndex row(0); row < num_rows; ++row) {
+    solution->dual_values[row] = revised_simplex.GetDualValue(row);
+    solution->constraint_statuses[row] =
+        revised_simplex.GetConstraintStatus(row);
+  }
+}
+
+// Returns the status of a problem made of independent blocks with the given
+// statuses. A proof on one block (an infeasibility, or a dual infeasibility)
+// holds for the whole problem, but the whole problem is only optimal or
+// unbounded if all the other blocks were solved to optimality.
+ProblemStatus CombineIndependentBlockStatuses(
+    const std::vector<ProblemStatus>& statuses) {
+  bool abnormal = false;
+  bool primal_infeasible = false;
+  bool infeasible_or_unbounded = false;
+  bool dual_infeasible = false;
+  bool primal_unbounded = false;
+  bool interrupted = false;
+  for (const ProblemStatus status : statuses) {
+    switch (status) {
+      case ProblemStatus::OPTIMAL:
+        break;
+      case ProblemStatus::PRIMAL_INFEASIBLE:  // PASS_THROUGH_INTENDED
+      case ProblemStatus::DUAL_UNBOUNDED:
+        primal_infeasible = true;
+        break;
+      case ProblemStatus::INFEASIBLE_OR_UNBOUNDED:
+        infeasible_or_unbounded = true;
+        break;
+      case ProblemStatus::DUAL_INFEASIBLE:
+        dual_infeasible = true;
+        break;
+      case ProblemStatus::PRIMAL_UNBOUNDED:
+        primal_unbounded = true;
+        break;
+      case ProblemStatus::ABNORMAL:  // PASS_THROUGH_INTENDED
+      case ProblemStatus::INVALID_PROBLEM:
+        abnormal = true;
+        break;
+      default:
+        interrupted = true;
+        break;
+    }
+  }
+  if (abnormal) return ProblemStatus::ABNORMAL;
+  if (primal_infeasible) return ProblemStatus::PRIMAL_INFEASIBLE;
+  if (infeasible_or_unbounded) return ProblemStatus::INFEASIBLE_OR_UNBOUNDED;
+  if (dual_infeasible) return ProblemStatus::DUAL_INFEASIBLE;
+  if (interrupted) {
+    return primal_unbounded ? ProblemStatus::DUAL_INFEASIBLE
+                            : ProblemStatus::INIT;
+  }
+  if (primal_unbounded) return ProblemStatus::PRIMAL_UNBOUNDED;
+  return ProblemStatus::OPTIMAL;
+}
 }  // namespace
 
 // TODO(user): Try to also check the precision of an INFEASIBLE or UNBOUNDED
@@ -392,10 +558,16 @@ int LPSolver::GetNumberOfSimplexIterations() const {
   return num_revised_simplex_iterations_;
 }
 
+int64 LPSolver::GetNumberOfPdhgIterations() const {
+  return num_pdhg_iterations_;
+}
+
 
 double LPSolver::DeterministicTime() const {
-  return revised_simplex_ == nullptr ? 0.0
-                                     : revised_simplex_->DeterministicTime();
+  return block_deterministic_time_ +
+         (revised_simplex_ == nullptr ? 0.0
+                                      : revised_simplex_->DeterministicTime()) +
+         (pdhg_ == nullptr ? 0.0 : pdhg_->DeterministicTime());
 }
 
 void LPSolver::MovePrimalValuesWithinBounds(const LinearProgram& lp) {
@@ -461,27 +633,154 @@ void LPSolver::RunRevisedSimplexIfNeeded(ProblemSolution* solution,
   revised_simplex_->SetParameters(parameters_);
   if (revised_simplex_->Solve(current_linear_program_, time_limit).ok()) {
     num_revised_simplex_iterations_ = revised_simplex_->GetNumberOfIterations();
-    solution->status = revised_simplex_->GetProblemStatus();
+    PopulateSolutionFromRevisedSimplex(*revised_simplex_, solution);
+  } else {
+    VLOG(1) << "Error during the revised simplex algorithm.";
+    solution->status = ProblemStatus::ABNORMAL;
+  }
+}
 
-    const ColIndex num_cols = revised_simplex_->GetProblemNumCols();
-    DCHECK_EQ(solution->primal_values.size(), num_cols);
-    for (ColIndex col(0); col < num_cols; ++col) {
-      solution->primal_values[col] = revised_simplex_->GetVariableValue(col);
-      solution->variable_statuses[col] =
-          revised_simplex_->GetVariableStatus(col);
+bool LPSolver::RunBlockDecompositionIfNeeded(ProblemSolution* solution,
+                                             TimeLimit* time_limit) {
+  if (solution->status != ProblemStatus::INIT) return false;
+  LPDecomposer decomposer;
+  decomposer.Decompose(&current_linear_program_);
+  const int num_blocks = decomposer.GetNumberOfProblems();
+  if (num_blocks <= 1) return false;
+  VLOG(1) << "Solving " << num_blocks << " independent blocks.";
+
+  std::vector<BlockSolve> block_solves(num_blocks);
+  Mutex time_limit_mutex;
+  const int num_threads = parameters_.num_block_decomposition_threads();
+  if (num_threads <= 1) {
+    for (int block = 0; block < num_blocks; ++block) {
+      SolveBlock(&decomposer, block, time_limit, &time_limit_mutex,
+                 &block_solves[block]);
     }
-
-    const RowIndex num_rows = revised_simplex_->GetProblemNumRows();
-    DCHECK_EQ(solution->dual_values.size(), num_rows);
-    for (RowIndex row(0); row < num_rows; ++row) {
-      solution->dual_values[row] = revised_simplex_->GetDualValue(row);
-      solution->constraint_statuses[row] =
-          revised_simplex_->GetConstraintStatus(row);
+  } else {
+    // The pool waits for all the blocks to be solved when it is destroyed.
+    ThreadPool pool("LPSolverBlocks", std::min(num_threads, num_blocks));
+    pool.StartWorkers();
+    for (int block = 0; block < num_blocks; ++block) {
+      pool.Add(NewCallback(this, &LPSolver::SolveBlock, &decomposer, block,
+                           time_limit, &time_limit_mutex,
+                           &block_solves[block]));
     }
+  }
+  current_linear_program_.ClearTransposeMatrix();
+
+  std::vector<ProblemSolution> block_solutions;
+  std::vector<ProblemStatus> block_statuses;
+  for (BlockSolve& block_solve : block_solves) {
+    num_revised_simplex_iterations_ += block_solve.num_iterations;
+    block_deterministic_time_ += block_solve.deterministic_time;
+    block_statuses.push_back(block_solve.solution.status);
+    block_solutions.push_back(ProblemSolution(RowIndex(0), ColIndex(0)));
+    std::swap(block_solutions.back(), block_solve.solution);
+  }
+  decomposer.AggregateSolutions(block_solutions, solution);
+  solution->status = CombineIndependentBlockStatuses(block_statuses);
+  return true;
+}
+
+void LPSolver::SolveBlock(LPDecomposer* decomposer, int block,
+                          TimeLimit* time_limit, Mutex* time_limit_mutex,
+                          BlockSolve* block_solve) const {
+  // The nested limit gets the time left when the block starts, and it sees
+  // the external Boolean of the given limit. Its deterministic time is added
+  // to the given limit when it is destroyed.
+  std::unique_ptr<NestedTimeLimit> block_time_limit;
+  {
+    MutexLock lock(time_limit_mutex);
+    block_time_limit.reset(
+        new NestedTimeLimit(time_limit, kInfinity, kInfinity));
+  }
+  LinearProgram lp;
+  decomposer->ExtractLocalProblem(block, &lp);
+  lp.CleanUp();
+  ProblemSolution* const solution = &block_solve->solution;
+  *solution = ProblemSolution(lp.num_constraints(), lp.num_variables());
+  RevisedSimplex revised_simplex;
+  revised_simplex.SetParameters(parameters_);
+  if (revised_simplex.Solve(lp, block_time_limit->GetTimeLimit()).ok()) {
+    PopulateSolutionFromRevisedSimplex(revised_simplex, solution);
   } else {
-    VLOG(1) << "Error during the revised simplex algorithm.";
+    VLOG(1) << "Error during the revised simplex algorithm on block " << block;
     solution->status = ProblemStatus::ABNORMAL;
   }
+  block_solve->num_iterations = revised_simplex.GetNumberOfIterations();
+  block_solve->deterministic_time = revised_simplex.DeterministicTime();
+  MutexLock lock(time_limit_mutex);
+  block_time_limit.reset(nullptr);
+}
+
+void LPSolver::RunPrimalDualHybridGradientIfNeeded(ProblemSolution* solution,
+                                                   TimeLimit* time_limit) {
+  // The PDHG uses its own copy of the matrix and of its transpose.
+  current_linear_program_.ClearTransposeMatrix();
+  if (solution->status != ProblemStatus::INIT) return;
+  if (pdhg_ == nullptr) {
+    pdhg_.reset(new PrimalDualHybridGradient());
+  }
+  pdhg_->SetParameters(parameters_);
+  if (!pdhg_->Solve(current_linear_program_, time_limit).ok()) {
+    VLOG(1) << "Error during the PDHG algorithm.";
+    solution->status = ProblemStatus::ABNORMAL;
+    return;
+  }
+  num_pdhg_iterations_ = pdhg_->GetNumberOfIterations();
+  const ColIndex num_cols = current_linear_program_.num_variables();
+  for (ColIndex col(0); col < num_cols; ++col) {
+    solution->primal_values[col] = pdhg_->GetVariableValue(col);
+    solution->variable_statuses[col] = pdhg_->GetVariableStatus(col);
+  }
+  const RowIndex num_rows = current_linear_program_.num_constraints();
+  for (RowIndex row(0); row < num_rows; ++row) {
+    solution->dual_values[row] = pdhg_->GetDualValue(row);
+    solution->constraint_statuses[row] = pdhg_->GetConstraintStatus(row);
+  }
+  if (!parameters_.pdhg_crossover()) {
+    solution->status = pdhg_->GetProblemStatus();
+    return;
+  }
+
+  // Crossover: the variables strictly inside their bounds and the constraints
+  // with a zero dual value are guessed to be basic. The revised simplex
+  // completes or truncates the basis if it does not have the right size.
+  LoadStateForNextSolve(ComputeBasisState(solution->variable_statuses,
+                                           solution->constraint_statuses));
+  RunRevisedSimplexIfNeeded(solution, time_limit);
+}
+
+void LPSolver::LoadInitialBasis(const LinearProgram& lp) {
+  // SingletonColumnSignPreprocessor changes the sign of the singleton columns
+  // with a negative coefficient, which swaps their bounds. The scaling does
+  // not change the signs.
+  VariableStatusRow variable_statuses;
+  variable_statuses.swap(initial_variable_statuses_);
+  for (ColIndex col(0); col < lp.num_variables(); ++col) {
+    const SparseColumn& column = lp.GetSparseColumn(col);
+    if (column.num_entries() != 1) continue;
+    const SparseColumn& preprocessed_column =
+        current_linear_program_.GetSparseColumn(col);
+    if ((column.GetFirstCoefficient() > 0.0) ==
+        (preprocessed_column.GetFirstCoefficient() > 0.0)) {
+      continue;
+    }
+    if (variable_statuses[col] == VariableStatus::AT_LOWER_BOUND) {
+      variable_statuses[col] = VariableStatus::AT_UPPER_BOUND;
+    } else if (variable_statuses[col] == VariableStatus::AT_UPPER_BOUND) {
+      variable_statuses[col] = VariableStatus::AT_LOWER_BOUND;
+    }
+  }
+  ConstraintStatusColumn constraint_statuses;
+  constraint_statuses.swap(initial_constraint_statuses_);
+  LoadStateForNextSolve(
+      ComputeBasisState(variable_statuses, constraint_statuses));
+}
+
+bool LPSolver::SolutionIsBasic() const {
+  return !parameters_.use_pdhg() || parameters_.pdhg_crossover();
 }
 
 
@@ -610,7 +909,7 @@ bool LPSolver::IsProblemSolutionConsistent(
 
   // TODO(user): We could check in debug mode (because it will be costly) that
   // the basis is actually factorizable.
-  if (num_basic_variables != num_rows) {
+  if (SolutionIsBasic() && num_basic_variables != num_rows) {
     VLOG(1) << "Wrong number of basic variables: " << num_basic_variables;
     return false;
   }
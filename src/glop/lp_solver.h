@@ -16,9 +16,13 @@
 
 #include <memory>
 
+#include "base/mutex.h"
 #include "glop/parameters.pb.h"
 #include "glop/preprocessor.h"
+#include "glop/primal_dual_hybrid_gradient.h"
+#include "glop/revised_simplex.h"
 #include "lp_data/lp_data.h"
+#include "lp_data/lp_decomposer.h"
 #include "lp_data/lp_types.h"
 #include "util/time_limit.h"
 
@@ -63,6 +67,26 @@ class LPSolver {
   // result, assuming that no time limit was specified.
   void Clear();
 
+  // Returns the basis of the last Solve(), or uses the given one to warm-start
+  // the next Solve(). Note that this is the basis of the problem solved by the
+  // revised simplex, i.e. after preprocessing. It can thus only be reused on
+  // problems that are preprocessed the same way, for instance problems that
+  // only differ by their bounds and that are solved with use_preprocessing()
+  // false, like the node problems of a branch and bound.
+  const BasisState& GetState() const;
+  void LoadStateForNextSolve(const BasisState& state);
+
+  // Uses the given basis to warm-start the next Solve(). Unlike the state
+  // above, it is expressed in terms of the problem given to Solve(), like
+  // variable_statuses() and constraint_statuses(), so it can come from a solve
+  // of a slightly different problem, possibly in another process (see
+  // MPSolver::LoadLpBasisFromProto()). Since a basis can not be mapped
+  // through the presolve, the next Solve() runs without it, as if
+  // use_preprocessing() were false, and without block decomposition or PDHG.
+  // The basis is ignored if its dimensions do not match the problem.
+  void SetInitialBasis(const VariableStatusRow& variable_statuses,
+                       const ConstraintStatusColumn& constraint_statuses);
+
   // This loads a given solution and computes related quantities so that the
   // getters below will refer to it.
   //
@@ -121,6 +145,10 @@ class LPSolver {
   // Returns the number of simplex iterations used by the last Solve().
   int GetNumberOfSimplexIterations() const;
 
+  // Returns the number of PDHG iterations used by the last Solve(). This is
+  // zero unless the use_pdhg parameter is true.
+  int64 GetNumberOfPdhgIterations() const;
+
 
   // Returns the "deterministic time" since the creation of the solver. Note
   // That this time is only increased when some operations take place in this
@@ -144,11 +172,53 @@ class LPSolver {
   void MovePrimalValuesWithinBounds(const LinearProgram& lp);
   void MoveDualValuesWithinBounds(const LinearProgram& lp);
 
+  // Converts the basis given to SetInitialBasis() to a state of the revised
+  // simplex on current_linear_program_, which is lp after the preprocessors
+  // that do not change the problem dimensions, and loads it.
+  void LoadInitialBasis(const LinearProgram& lp);
+
   // Runs the revised simplex algorithm if needed (i.e. if the program was not
   // already solved by the preprocessors).
   void RunRevisedSimplexIfNeeded(ProblemSolution* solution,
                                  TimeLimit* time_limit);
 
+  // Runs the PDHG algorithm instead of the revised simplex if the program was
+  // not already solved by the preprocessors. If the pdhg_crossover parameter is
+  // true, the revised simplex is then run, warm-started from a basis guessed
+  // from the PDHG solution.
+  void RunPrimalDualHybridGradientIfNeeded(ProblemSolution* solution,
+                                           TimeLimit* time_limit);
+
+  // If the preprocessed problem is made of several independent blocks, solves
+  // each of them with its own revised simplex, using
+  // num_block_decomposition_threads threads, and aggregates their solutions.
+  // Returns false without doing anything if there is only one block, in which
+  // case RunRevisedSimplexIfNeeded() should be used instead.
+  bool RunBlockDecompositionIfNeeded(ProblemSolution* solution,
+                                     TimeLimit* time_limit);
+
+  // The output of SolveBlock().
+  struct BlockSolve {
+    BlockSolve()
+        : solution(RowIndex(0), ColIndex(0)),
+          num_iterations(0),
+          deterministic_time(0.0) {}
+    ProblemSolution solution;
+    int num_iterations;
+    double deterministic_time;
+  };
+
+  // Extracts the given block from the decomposer and solves it. This can be
+  // called concurrently on different blocks. Since a TimeLimit can not be
+  // shared between threads, each block gets its own, nested in the given one
+  // when the block starts; time_limit_mutex protects the given time limit.
+  void SolveBlock(LPDecomposer* decomposer, int block, TimeLimit* time_limit,
+                  Mutex* time_limit_mutex, BlockSolve* block_solve) const;
+
+  // Returns true if the solutions returned by Solve() are basic, which is
+  // always the case except when the PDHG is used without crossover.
+  bool SolutionIsBasic() const;
+
 
   // Checks that the returned solution values and statuses are consistent.
   // Returns true if this is the case. See the code for the exact check
@@ -228,9 +298,23 @@ class LPSolver {
   // The revised simplex solver.
   std::unique_ptr<RevisedSimplex> revised_simplex_;
 
-  // The number of revised simplex iterations used by the last Solve().
+  // The basis given to SetInitialBasis(), cleared by the next Solve().
+  VariableStatusRow initial_variable_statuses_;
+  ConstraintStatusColumn initial_constraint_statuses_;
+
+  // The number of revised simplex iterations used by the last Solve(). With
+  // use_block_decomposition, this is the sum over all the blocks.
   int num_revised_simplex_iterations_;
 
+  // The deterministic time spent in the blocks solved by
+  // RunBlockDecompositionIfNeeded() during the last Solve().
+  double block_deterministic_time_;
+
+  // The PDHG solver, only created if the use_pdhg parameter is true, and the
+  // number of iterations it used during the last Solve().
+  std::unique_ptr<PrimalDualHybridGradient> pdhg_;
+  int64 num_pdhg_iterations_;
+
 
   // The current ProblemSolution.
   // TODO(user): use a ProblemSolution directly?
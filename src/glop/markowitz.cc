@@ -74,12 +74,15 @@ Status Markowitz::ComputeRowAndColumnPermutation(const MatrixView& basis_matrix,
     // Singular matrix? No pivot will be selected if a column has no entries. If
     // a column has some entries, then we are sure that a pivot will be selected
     // but its magnitude can be really close to zero. In both cases, we
-    // report the singularity of the matrix.
+    // report the singularity of the matrix. It is only logged as an error by
+    // ComputeLU(), since a singular set of columns is expected by the clients
+    // that look for a maximum set of independent columns.
     if (pivot_row == kInvalidRow || pivot_col == kInvalidCol ||
         fabs(pivot_coefficient) <= singularity_threshold) {
-      RETURN_AND_LOG_ERROR(Status::ERROR_LU,
-                           StringPrintf("The matrix is singular! pivot = %E",
-                                        pivot_coefficient));
+      const std::string error_message =
+          StringPrintf("The matrix is singular! pivot = %E", pivot_coefficient);
+      VLOG(1) << GetErrorCodeString(Status::ERROR_LU) << ": " << error_message;
+      return Status(Status::ERROR_LU, error_message);
     }
     DCHECK_EQ((*row_perm)[pivot_row], kInvalidRow);
     DCHECK_EQ((*col_perm)[pivot_col], kInvalidCol);
@@ -144,8 +147,13 @@ Status Markowitz::ComputeLU(const MatrixView& basis_matrix,
   // and lower_ will always stay empty at the end of this function.
   lower_.Swap(lower);
   upper_.Swap(upper);
-  RETURN_IF_ERROR(
-      ComputeRowAndColumnPermutation(basis_matrix, row_perm, col_perm));
+  const Status status =
+      ComputeRowAndColumnPermutation(basis_matrix, row_perm, col_perm);
+  if (!status.ok()) {
+    LOG(ERROR) << GetErrorCodeString(status.error_code()) << ": "
+               << status.error_message();
+    return status;
+  }
   SCOPED_TIME_STAT(&stats_);
   lower_.ApplyRowPermutationToNonDiagonalEntries(*row_perm);
   upper_.ApplyRowPermutationToNonDiagonalEntries(*row_perm);
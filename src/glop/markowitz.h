@@ -240,11 +240,14 @@ class Markowitz {
   // may be faster than computing the full L and U at the same time but the
   // current implementation is not optimized for this.
   //
-  // It behaves the same as ComputeLU() for singular matrices.
+  // It behaves the same as ComputeLU() for singular matrices, except that the
+  // singularity is only logged with VLOG(1).
   //
   // This function also works with a non-square matrix. It will return a set of
-  // independent columns of maximum size. If all the given columns are
-  // independent, the returned Status will be OK.
+  // independent columns. If all the given columns are independent, the
+  // returned Status will be OK. Otherwise, note that the elimination stops at
+  // the first singular pivot, so some of the columns that are not in the
+  // returned set may still be independent from it.
   Status ComputeRowAndColumnPermutation(
       const MatrixView& basis_matrix, RowPermutation* row_perm,
       ColumnPermutation* col_perm) MUST_USE_RESULT;
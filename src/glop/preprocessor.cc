@@ -14,7 +14,10 @@
 
 #include "glop/preprocessor.h"
 
+#include <functional>
+
 #include "base/stringprintf.h"
+#include "base/threadpool.h"
 #include "glop/revised_simplex.h"
 #include "glop/status.h"
 #include "lp_data/lp_utils.h"
@@ -32,6 +35,27 @@ std::string IntervalString(Fractional lb, Fractional ub) {
 #if defined(_MSC_VER)
 double trunc(double d) { return d > 0 ? floor(d) : ceil(d); }
 #endif
+
+void CallOnRowRange(const std::function<void(RowIndex, RowIndex)>* compute,
+                    RowIndex begin, RowIndex end) {
+  (*compute)(begin, end);
+}
+
+// Calls compute(begin, end) on consecutive ranges of rows that partition
+// [0, num_rows), in parallel on num_threads threads. The ranges must be
+// independent, i.e. compute() must only write data indexed by the rows of its
+// range.
+void RunOnRowRanges(RowIndex num_rows, int num_threads,
+                    const std::function<void(RowIndex, RowIndex)>& compute) {
+  num_threads = std::max(1, std::min(num_threads, num_rows.value()));
+  ThreadPool pool("Presolve", num_threads);
+  pool.StartWorkers();
+  for (int i = 0; i < num_threads; ++i) {
+    pool.Add(NewCallback(&CallOnRowRange, &compute,
+                         RowIndex(num_rows.value() * i / num_threads),
+                         RowIndex(num_rows.value() * (i + 1) / num_threads)));
+  }
+}
 }  // namespace
 
 // --------------------------------------------------------
@@ -432,7 +456,8 @@ bool ProportionalColumnPreprocessor::Run(LinearProgram* lp,
                                          TimeLimit* time_limit) {
   RETURN_VALUE_IF_NULL(lp, false);
   ColMapping mapping = FindProportionalColumns(
-      lp->GetSparseMatrix(), parameters_.preprocessor_zero_tolerance());
+      lp->GetSparseMatrix(), parameters_.preprocessor_zero_tolerance(),
+      parameters_.num_presolve_threads());
 
   // Compute some statistics and make each class representative point to itself
   // in the mapping. Also store the columns that are proportional to at least
@@ -803,7 +828,8 @@ bool ProportionalRowPreprocessor::Run(LinearProgram* lp,
   // itself for the loop below. TODO(user): Already return such a mapping from
   // FindProportionalColumns()?
   ColMapping mapping = FindProportionalColumns(
-      transpose, parameters_.preprocessor_zero_tolerance());
+      transpose, parameters_.preprocessor_zero_tolerance(),
+      parameters_.num_presolve_threads());
   DenseBooleanColumn is_a_representative(num_rows, false);
   int num_proportional_rows = 0;
   for (RowIndex row(0); row < num_rows; ++row) {
@@ -1059,21 +1085,37 @@ bool ForcingAndImpliedFreeConstraintPreprocessor::Run(LinearProgram* lp,
   DenseColumn implied_upper_bounds(num_rows, 0);
   const ColIndex num_cols = lp->num_variables();
   StrictITIVector<RowIndex, int> row_degree(num_rows, 0);
-  for (ColIndex col(0); col < num_cols; ++col) {
+  const auto add_entry = [&](RowIndex row, ColIndex col, Fractional coeff) {
     const Fractional lower = lp->variable_lower_bounds()[col];
     const Fractional upper = lp->variable_upper_bounds()[col];
-    for (const SparseColumn::Entry e : lp->GetSparseColumn(col)) {
-      const RowIndex row = e.row();
-      const Fractional coeff = e.coefficient();
-      if (coeff > 0.0) {
-        implied_lower_bounds[row] += lower * coeff;
-        implied_upper_bounds[row] += upper * coeff;
-      } else {
-        implied_lower_bounds[row] += upper * coeff;
-        implied_upper_bounds[row] += lower * coeff;
+    if (coeff > 0.0) {
+      implied_lower_bounds[row] += lower * coeff;
+      implied_upper_bounds[row] += upper * coeff;
+    } else {
+      implied_lower_bounds[row] += upper * coeff;
+      implied_upper_bounds[row] += lower * coeff;
+    }
+    ++row_degree[row];
+  };
+  if (parameters_.num_presolve_threads() <= 1) {
+    for (ColIndex col(0); col < num_cols; ++col) {
+      for (const SparseColumn::Entry e : lp->GetSparseColumn(col)) {
+        add_entry(e.row(), col, e.coefficient());
       }
-      ++row_degree[row];
     }
+  } else {
+    // The rows of the transpose are sorted by column, so the entries of a row
+    // are added in the same order as in the sequential loop above.
+    const SparseMatrix& transpose = lp->GetTransposeSparseMatrix();
+    RunOnRowRanges(num_rows, parameters_.num_presolve_threads(),
+                   [&](RowIndex begin, RowIndex end) {
+      for (RowIndex row(begin); row < end; ++row) {
+        for (const SparseColumn::Entry e :
+             transpose.column(RowToColIndex(row))) {
+          add_entry(row, RowToColIndex(e.row()), e.coefficient());
+        }
+      }
+    });
   }
 
   // Note that the ScalingPreprocessor is currently executed last, so here the
@@ -1226,14 +1268,15 @@ void ForcingAndImpliedFreeConstraintPreprocessor::RecoverSolution(
   //    reduced cost of 0.0. This column becomes VariableStatus::BASIC, and the
   //    constraint status is changed to ConstraintStatus::AT_LOWER_BOUND,
   //    ConstraintStatus::AT_UPPER_BOUND or ConstraintStatus::FIXED_VALUE.
-  SparseMatrix transpose;
+  CompactSparseMatrix transpose;
   transpose.PopulateFromTranspose(deleted_columns_);
   const RowIndex num_rows = solution->dual_values.size();
   for (RowIndex row(0); row < num_rows; ++row) {
     if (row_deletion_helper_.IsRowMarked(row)) {
       Fractional new_dual_value = 0.0;
       ColIndex new_basic_column = kInvalidCol;
-      for (const SparseColumn::Entry e : transpose.column(RowToColIndex(row))) {
+      for (const CompactSparseMatrix::ColumnView::Entry e :
+           transpose.column(RowToColIndex(row))) {
         const ColIndex col = RowToColIndex(e.row());
         if (last_deleted_row[col] != row) continue;
         const Fractional scalar_product =
@@ -1295,16 +1338,32 @@ bool ImpliedFreePreprocessor::Run(LinearProgram* lp, TimeLimit* time_limit) {
   ITIVector<RowIndex, SumWithPositiveInfiniteAndOneMissing> ub_sums(size);
 
   // Initialize the sums by adding all the bounds of the variables.
-  for (ColIndex col(0); col < num_cols; ++col) {
-    const Fractional lower_bound = lp->variable_lower_bounds()[col];
-    const Fractional upper_bound = lp->variable_upper_bounds()[col];
-    for (const SparseColumn::Entry e : lp->GetSparseColumn(col)) {
-      Fractional entry_lb = e.coefficient() * lower_bound;
-      Fractional entry_ub = e.coefficient() * upper_bound;
-      if (e.coefficient() < 0.0) std::swap(entry_lb, entry_ub);
-      lb_sums[e.row()].Add(entry_lb);
-      ub_sums[e.row()].Add(entry_ub);
+  const auto add_entry = [&](RowIndex row, ColIndex col, Fractional coeff) {
+    Fractional entry_lb = coeff * lp->variable_lower_bounds()[col];
+    Fractional entry_ub = coeff * lp->variable_upper_bounds()[col];
+    if (coeff < 0.0) std::swap(entry_lb, entry_ub);
+    lb_sums[row].Add(entry_lb);
+    ub_sums[row].Add(entry_ub);
+  };
+  if (parameters_.num_presolve_threads() <= 1) {
+    for (ColIndex col(0); col < num_cols; ++col) {
+      for (const SparseColumn::Entry e : lp->GetSparseColumn(col)) {
+        add_entry(e.row(), col, e.coefficient());
+      }
     }
+  } else {
+    // Same as ForcingAndImpliedFreeConstraintPreprocessor: the sums of each
+    // row are computed on the transpose in the sequential order.
+    const SparseMatrix& transpose = lp->GetTransposeSparseMatrix();
+    RunOnRowRanges(num_rows, parameters_.num_presolve_threads(),
+                   [&](RowIndex begin, RowIndex end) {
+      for (RowIndex row(begin); row < end; ++row) {
+        for (const SparseColumn::Entry e :
+             transpose.column(RowToColIndex(row))) {
+          add_entry(row, RowToColIndex(e.row()), e.coefficient());
+        }
+      }
+    });
   }
 
   // The inequality
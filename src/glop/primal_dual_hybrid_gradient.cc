@@ -0,0 +1,609 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "glop/primal_dual_hybrid_gradient.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/callback.h"
+#include "base/logging.h"
+
+namespace operations_research {
+namespace glop {
+
+namespace {
+
+// Restart criteria, as ratios between the KKT error of the restart candidate
+// and the one at the last restart: a restart is performed if the error was
+// divided enough, or if it decreased and stopped improving. A restart is
+// also forced if the last one is too old compared to the total number of
+// iterations.
+const Fractional kSufficientRestartReduction = 0.2;
+const Fractional kNecessaryRestartReduction = 0.8;
+const Fractional kArtificialRestartRatio = 0.36;
+
+// Smoothing of the primal weight updates, in [0, 1]: 0 means that the weight
+// is never updated.
+const Fractional kPrimalWeightSmoothing = 0.5;
+
+// A difference of iterates is considered as an unbounded ray if its
+// violations are smaller than this factor times the objective improvement
+// along it.
+const Fractional kInfeasibilityTolerance = 1e-8;
+
+// Maximum number of step sizes tried by a single TakeAdaptiveStep(). Each
+// rejected step size is replaced by one smaller than its stability limit, so
+// this is only reached on numerical troubles.
+const int kMaxStepSizeTrials = 100;
+
+Fractional Clamp(Fractional value, Fractional lower_bound,
+                 Fractional upper_bound) {
+  return std::min(std::max(value, lower_bound), upper_bound);
+}
+
+// Returns the amount by which value violates [lower_bound, upper_bound].
+Fractional Violation(Fractional value, Fractional lower_bound,
+                     Fractional upper_bound) {
+  return std::max(std::max(lower_bound - value, value - upper_bound), 0.0);
+}
+
+}  // namespace
+
+PrimalDualHybridGradient::PrimalDualHybridGradient()
+    : parameters_(),
+      num_threads_(1),
+      optimization_sign_(1.0),
+      objective_norm_(0.0),
+      bounds_norm_(0.0),
+      weight_sum_(0.0),
+      step_size_(0.0),
+      primal_weight_(1.0),
+      restart_kkt_error_(0.0),
+      last_candidate_kkt_error_(0.0),
+      num_iterations_(0),
+      iterations_since_restart_(0),
+      num_operations_(0),
+      last_deterministic_time_(0.0),
+      problem_status_(ProblemStatus::INIT) {}
+
+void PrimalDualHybridGradient::SetParameters(
+    const GlopParameters& parameters) {
+  parameters_ = parameters;
+  num_threads_ = std::max(1, parameters_.num_pdhg_threads());
+}
+
+Fractional PrimalDualHybridGradient::KktError::Norm() const {
+  const Fractional gap = primal_objective - dual_objective;
+  return std::sqrt(primal_residual * primal_residual +
+                   dual_residual * dual_residual + gap * gap);
+}
+
+Status PrimalDualHybridGradient::Solve(const LinearProgram& lp,
+                                       TimeLimit* time_limit) {
+  RETURN_ERROR_IF_NULL(time_limit);
+  if (num_threads_ > 1) {
+    thread_pool_.reset(new ThreadPool("PDHG", num_threads_));
+    thread_pool_->StartWorkers();
+  }
+  Initialize(lp);
+  VLOG(1) << "------ PDHG, " << matrix_.num_rows() << " rows, "
+          << matrix_.num_cols() << " columns, " << matrix_.num_entries()
+          << " entries.";
+  const int64 max_iterations = parameters_.max_number_of_iterations();
+  const int check_frequency =
+      std::max(1, parameters_.pdhg_restart_check_frequency());
+  last_deterministic_time_ = DeterministicTime();
+  Status status;
+  while (true) {
+    if (IsTimeLimitReached(time_limit) ||
+        (max_iterations >= 0 && num_iterations_ >= max_iterations)) {
+      VLOG(1) << "PDHG stopped by a limit after " << num_iterations_
+              << " iterations.";
+      break;
+    }
+    const int64 num_iterations = num_iterations_;
+    status = TakeAdaptiveStep(time_limit);
+    if (!status.ok()) break;
+
+    // No step was taken if the time limit was reached during the step.
+    if (num_iterations_ == num_iterations) continue;
+    if (num_iterations_ % check_frequency == 0 &&
+        CheckTerminationAndRestart()) {
+      break;
+    }
+  }
+  thread_pool_.reset(nullptr);
+  VLOG(1) << "PDHG status: " << GetProblemStatusString(problem_status_)
+          << ", iterations: " << num_iterations_;
+  return status;
+}
+
+bool PrimalDualHybridGradient::IsTimeLimitReached(TimeLimit* time_limit) {
+  const double deterministic_time = DeterministicTime();
+  time_limit->AdvanceDeterministicTime(deterministic_time -
+                                       last_deterministic_time_);
+  last_deterministic_time_ = deterministic_time;
+  return time_limit->LimitReached();
+}
+
+void PrimalDualHybridGradient::Initialize(const LinearProgram& lp) {
+  matrix_.PopulateFromMatrixView(MatrixView(lp.GetSparseMatrix()));
+  transposed_matrix_.PopulateFromTranspose(matrix_);
+  const ColIndex num_cols = matrix_.num_cols();
+  const RowIndex num_rows = matrix_.num_rows();
+
+  // The algorithm minimizes; the dual values are converted back by
+  // GetDualValue().
+  optimization_sign_ = lp.IsMaximizationProblem() ? -1.0 : 1.0;
+  objective_.resize(num_cols, 0.0);
+  Fractional squared_objective_norm = 0.0;
+  for (ColIndex col(0); col < num_cols; ++col) {
+    objective_[col] = optimization_sign_ * lp.objective_coefficients()[col];
+    squared_objective_norm += objective_[col] * objective_[col];
+  }
+  objective_norm_ = std::sqrt(squared_objective_norm);
+  lower_bounds_ = lp.variable_lower_bounds();
+  upper_bounds_ = lp.variable_upper_bounds();
+  constraint_lower_bounds_ = lp.constraint_lower_bounds();
+  constraint_upper_bounds_ = lp.constraint_upper_bounds();
+
+  // The norm of the rhs is computed with the finite bound of largest
+  // magnitude of each row.
+  Fractional squared_bounds_norm = 0.0;
+  for (RowIndex row(0); row < num_rows; ++row) {
+    Fractional bound = 0.0;
+    if (IsFinite(constraint_lower_bounds_[row])) {
+      bound = std::abs(constraint_lower_bounds_[row]);
+    }
+    if (IsFinite(constraint_upper_bounds_[row])) {
+      bound = std::max(bound, std::abs(constraint_upper_bounds_[row]));
+    }
+    squared_bounds_norm += bound * bound;
+  }
+  bounds_norm_ = std::sqrt(squared_bounds_norm);
+
+  // The initial step size is 1 / ||A||_inf, which is usually too small and
+  // is quickly increased by TakeAdaptiveStep().
+  Fractional max_magnitude = 0.0;
+  for (ColIndex col(0); col < num_cols; ++col) {
+    for (const EntryIndex i : matrix_.Column(col)) {
+      max_magnitude =
+          std::max(max_magnitude, std::abs(matrix_.EntryCoefficient(i)));
+    }
+  }
+  step_size_ = max_magnitude > 0.0 ? 1.0 / max_magnitude : 1.0;
+  primal_weight_ = objective_norm_ > 0.0 && bounds_norm_ > 0.0
+                       ? objective_norm_ / bounds_norm_
+                       : 1.0;
+
+  x_.resize(num_cols, 0.0);
+  for (ColIndex col(0); col < num_cols; ++col) {
+    x_[col] = Clamp(0.0, lower_bounds_[col], upper_bounds_[col]);
+  }
+  y_.assign(num_rows, 0.0);
+  ax_.resize(num_rows, 0.0);
+  aty_.resize(num_cols, 0.0);
+  ComputeProduct(x_, &ax_);
+  ComputeTransposeProduct(y_, &aty_);
+  candidate_x_.resize(num_cols, 0.0);
+  candidate_y_.resize(num_rows, 0.0);
+  candidate_ax_.resize(num_rows, 0.0);
+  candidate_aty_.resize(num_cols, 0.0);
+
+  num_iterations_ = 0;
+  problem_status_ = ProblemStatus::INIT;
+  restart_x_ = x_;
+  restart_y_ = y_;
+  restart_ax_ = ax_;
+  restart_aty_ = aty_;
+  x_sum_.assign(num_cols, 0.0);
+  y_sum_.assign(num_rows, 0.0);
+  ax_sum_.assign(num_rows, 0.0);
+  aty_sum_.assign(num_cols, 0.0);
+  weight_sum_ = 0.0;
+  iterations_since_restart_ = 0;
+  restart_kkt_error_ = ComputeKktError(x_, y_, ax_, aty_).Norm();
+  last_candidate_kkt_error_ = restart_kkt_error_;
+}
+
+void PrimalDualHybridGradient::ComputeProduct(const DenseRow& x,
+                                              DenseColumn* result) {
+  if (thread_pool_ == nullptr) {
+    ComputeProductSlice(0, &x, result, nullptr);
+  } else {
+    // The last thread leaving the barrier deletes it.
+    Barrier* const barrier = new Barrier(num_threads_ + 1);
+    for (int slice = 0; slice < num_threads_; ++slice) {
+      thread_pool_->Add(
+          NewCallback(this, &PrimalDualHybridGradient::ComputeProductSlice,
+                      slice, &x, result, barrier));
+    }
+    if (barrier->Block()) delete barrier;
+  }
+  num_operations_ += matrix_.num_entries().value();
+}
+
+void PrimalDualHybridGradient::ComputeTransposeProduct(const DenseColumn& y,
+                                                       DenseRow* result) {
+  if (thread_pool_ == nullptr) {
+    ComputeTransposeProductSlice(0, &y, result, nullptr);
+  } else {
+    Barrier* const barrier = new Barrier(num_threads_ + 1);
+    for (int slice = 0; slice < num_threads_; ++slice) {
+      thread_pool_->Add(NewCallback(
+          this, &PrimalDualHybridGradient::ComputeTransposeProductSlice, slice,
+          &y, result, barrier));
+    }
+    if (barrier->Block()) delete barrier;
+  }
+  num_operations_ += matrix_.num_entries().value();
+}
+
+void PrimalDualHybridGradient::ComputeProductSlice(int slice,
+                                                   const DenseRow* x,
+                                                   DenseColumn* result,
+                                                   Barrier* barrier) {
+  const int64 num_rows = matrix_.num_rows().value();
+  const int num_slices = barrier == nullptr ? 1 : num_threads_;
+  const int end = num_rows * (slice + 1) / num_slices;
+  for (int i = num_rows * slice / num_slices; i < end; ++i) {
+    Fractional sum = 0.0;
+    for (const EntryIndex e : transposed_matrix_.Column(ColIndex(i))) {
+      sum += transposed_matrix_.EntryCoefficient(e) *
+             (*x)[RowToColIndex(transposed_matrix_.EntryRow(e))];
+    }
+    (*result)[RowIndex(i)] = sum;
+  }
+  if (barrier != nullptr && barrier->Block()) delete barrier;
+}
+
+void PrimalDualHybridGradient::ComputeTransposeProductSlice(
+    int slice, const DenseColumn* y, DenseRow* result, Barrier* barrier) {
+  const int64 num_cols = matrix_.num_cols().value();
+  const int num_slices = barrier == nullptr ? 1 : num_threads_;
+  const int end = num_cols * (slice + 1) / num_slices;
+  for (int j = num_cols * slice / num_slices; j < end; ++j) {
+    Fractional sum = 0.0;
+    for (const EntryIndex e : matrix_.Column(ColIndex(j))) {
+      sum += matrix_.EntryCoefficient(e) * (*y)[matrix_.EntryRow(e)];
+    }
+    (*result)[ColIndex(j)] = sum;
+  }
+  if (barrier != nullptr && barrier->Block()) delete barrier;
+}
+
+Status PrimalDualHybridGradient::TakeAdaptiveStep(TimeLimit* time_limit) {
+  const ColIndex num_cols = matrix_.num_cols();
+  const RowIndex num_rows = matrix_.num_rows();
+  for (int trial = 0; trial < kMaxStepSizeTrials; ++trial) {
+    if (trial > 0 && IsTimeLimitReached(time_limit)) return Status::OK;
+    const Fractional tau = step_size_ / primal_weight_;
+    const Fractional sigma = step_size_ * primal_weight_;
+    for (ColIndex col(0); col < num_cols; ++col) {
+      candidate_x_[col] = Clamp(x_[col] - tau * (objective_[col] - aty_[col]),
+                                lower_bounds_[col], upper_bounds_[col]);
+    }
+    ComputeProduct(candidate_x_, &candidate_ax_);
+
+    // The dual update, where A.(2x' - x) is computed from the products, is
+    // y' = sigma.(proj(v) - v) with v = A.(2x' - x) - y / sigma.
+    for (RowIndex row(0); row < num_rows; ++row) {
+      const Fractional v =
+          2.0 * candidate_ax_[row] - ax_[row] - y_[row] / sigma;
+      candidate_y_[row] =
+          sigma * (Clamp(v, constraint_lower_bounds_[row],
+                         constraint_upper_bounds_[row]) -
+                   v);
+    }
+    ComputeTransposeProduct(candidate_y_, &candidate_aty_);
+
+    // The step is stable if it is smaller than the ratio between the
+    // movement of the iterates and their interaction through A.
+    Fractional squared_primal_movement = 0.0;
+    for (ColIndex col(0); col < num_cols; ++col) {
+      const Fractional delta = candidate_x_[col] - x_[col];
+      squared_primal_movement += delta * delta;
+    }
+    Fractional squared_dual_movement = 0.0;
+    Fractional interaction = 0.0;
+    for (RowIndex row(0); row < num_rows; ++row) {
+      const Fractional delta = candidate_y_[row] - y_[row];
+      squared_dual_movement += delta * delta;
+      interaction += delta * (candidate_ax_[row] - ax_[row]);
+    }
+    const Fractional movement =
+        0.5 * primal_weight_ * squared_primal_movement +
+        0.5 * squared_dual_movement / primal_weight_;
+    interaction = std::abs(interaction);
+    if (std::isnan(movement) || std::isnan(interaction) ||
+        !IsFinite(step_size_)) {
+      return Status(Status::ERROR_NUMERICAL,
+                    "The PDHG iterates are not finite.");
+    }
+    const Fractional step_limit =
+        interaction > 0.0 ? movement / interaction : kInfinity;
+    const Fractional k = static_cast<Fractional>(num_iterations_ + 2);
+    const Fractional step_size = step_size_;
+    step_size_ = std::min((1.0 - std::pow(k, -0.3)) * step_limit,
+                          (1.0 + std::pow(k, -0.6)) * step_size_);
+    if (step_size <= step_limit) {
+      for (ColIndex col(0); col < num_cols; ++col) {
+        x_sum_[col] += step_size * candidate_x_[col];
+        aty_sum_[col] += step_size * candidate_aty_[col];
+      }
+      for (RowIndex row(0); row < num_rows; ++row) {
+        y_sum_[row] += step_size * candidate_y_[row];
+        ax_sum_[row] += step_size * candidate_ax_[row];
+      }
+      weight_sum_ += step_size;
+      x_.swap(candidate_x_);
+      y_.swap(candidate_y_);
+      ax_.swap(candidate_ax_);
+      aty_.swap(candidate_aty_);
+      ++num_iterations_;
+      ++iterations_since_restart_;
+      return Status::OK;
+    }
+  }
+  return Status(Status::ERROR_NUMERICAL,
+                "No stable PDHG step size was found.");
+}
+
+PrimalDualHybridGradient::KktError PrimalDualHybridGradient::ComputeKktError(
+    const DenseRow& x, const DenseColumn& y, const DenseColumn& ax,
+    const DenseRow& aty) const {
+  KktError error;
+  Fractional squared_primal_residual = 0.0;
+  const RowIndex num_rows = matrix_.num_rows();
+  for (RowIndex row(0); row < num_rows; ++row) {
+    const Fractional violation = Violation(
+        ax[row], constraint_lower_bounds_[row], constraint_upper_bounds_[row]);
+    squared_primal_residual += violation * violation;
+
+    // Note that the dual update guarantees that y[row] > 0 only if the lower
+    // bound is finite, and y[row] < 0 only if the upper bound is.
+    if (y[row] > 0.0) {
+      error.dual_objective += y[row] * constraint_lower_bounds_[row];
+    } else if (y[row] < 0.0) {
+      error.dual_objective += y[row] * constraint_upper_bounds_[row];
+    }
+  }
+  Fractional squared_dual_residual = 0.0;
+  const ColIndex num_cols = matrix_.num_cols();
+  for (ColIndex col(0); col < num_cols; ++col) {
+    error.primal_objective += objective_[col] * x[col];
+    const Fractional reduced_cost = objective_[col] - aty[col];
+    if (reduced_cost > 0.0) {
+      if (IsFinite(lower_bounds_[col])) {
+        error.dual_objective += reduced_cost * lower_bounds_[col];
+      } else {
+        squared_dual_residual += reduced_cost * reduced_cost;
+      }
+    } else if (reduced_cost < 0.0) {
+      if (IsFinite(upper_bounds_[col])) {
+        error.dual_objective += reduced_cost * upper_bounds_[col];
+      } else {
+        squared_dual_residual += reduced_cost * reduced_cost;
+      }
+    }
+  }
+  error.primal_residual = std::sqrt(squared_primal_residual);
+  error.dual_residual = std::sqrt(squared_dual_residual);
+  return error;
+}
+
+bool PrimalDualHybridGradient::IsConverged(const KktError& error) const {
+  const Fractional tolerance = parameters_.pdhg_relative_tolerance();
+  return error.primal_residual <= tolerance * (1.0 + bounds_norm_) &&
+         error.dual_residual <= tolerance * (1.0 + objective_norm_) &&
+         std::abs(error.primal_objective - error.dual_objective) <=
+             tolerance * (1.0 + std::abs(error.primal_objective) +
+                          std::abs(error.dual_objective));
+}
+
+bool PrimalDualHybridGradient::DetectInfeasibility() {
+  // Dual ray: a direction dy such that y + t.dy stays dual feasible and the
+  // dual objective increases without bound with t, which proves that the
+  // primal is infeasible.
+  Fractional ray_objective = 0.0;
+  Fractional max_violation = 0.0;
+  const RowIndex num_rows = matrix_.num_rows();
+  for (RowIndex row(0); row < num_rows; ++row) {
+    const Fractional dy = y_[row] - restart_y_[row];
+    const Fractional bound = dy > 0.0 ? constraint_lower_bounds_[row]
+                                      : constraint_upper_bounds_[row];
+    if (dy == 0.0) continue;
+    if (IsFinite(bound)) {
+      ray_objective += dy * bound;
+    } else {
+      max_violation = std::max(max_violation, std::abs(dy));
+    }
+  }
+  const ColIndex num_cols = matrix_.num_cols();
+  for (ColIndex col(0); col < num_cols; ++col) {
+    const Fractional reduced_cost = restart_aty_[col] - aty_[col];
+    const Fractional bound =
+        reduced_cost > 0.0 ? lower_bounds_[col] : upper_bounds_[col];
+    if (reduced_cost == 0.0) continue;
+    if (IsFinite(bound)) {
+      ray_objective += reduced_cost * bound;
+    } else {
+      max_violation = std::max(max_violation, std::abs(reduced_cost));
+    }
+  }
+  if (ray_objective > 0.0 &&
+      max_violation <= kInfeasibilityTolerance * ray_objective) {
+    VLOG(1) << "PDHG found an approximate dual unbounded ray.";
+    problem_status_ = ProblemStatus::PRIMAL_INFEASIBLE;
+    return true;
+  }
+
+  // Primal ray: a direction dx such that x + t.dx stays primal feasible and
+  // the objective decreases without bound with t, which proves that the dual
+  // is infeasible.
+  ray_objective = 0.0;
+  max_violation = 0.0;
+  for (ColIndex col(0); col < num_cols; ++col) {
+    const Fractional dx = x_[col] - restart_x_[col];
+    ray_objective += objective_[col] * dx;
+    if (IsFinite(lower_bounds_[col])) {
+      max_violation = std::max(max_violation, -dx);
+    }
+    if (IsFinite(upper_bounds_[col])) {
+      max_violation = std::max(max_violation, dx);
+    }
+  }
+  for (RowIndex row(0); row < num_rows; ++row) {
+    const Fractional adx = ax_[row] - restart_ax_[row];
+    if (IsFinite(constraint_lower_bounds_[row])) {
+      max_violation = std::max(max_violation, -adx);
+    }
+    if (IsFinite(constraint_upper_bounds_[row])) {
+      max_violation = std::max(max_violation, adx);
+    }
+  }
+  if (ray_objective < 0.0 &&
+      max_violation <= -kInfeasibilityTolerance * ray_objective) {
+    VLOG(1) << "PDHG found an approximate primal unbounded ray.";
+    problem_status_ = ProblemStatus::DUAL_INFEASIBLE;
+    return true;
+  }
+  return false;
+}
+
+void PrimalDualHybridGradient::ComputeAverage() {
+  DCHECK_GT(weight_sum_, 0.0);
+  const ColIndex num_cols = matrix_.num_cols();
+  for (ColIndex col(0); col < num_cols; ++col) {
+    candidate_x_[col] = x_sum_[col] / weight_sum_;
+    candidate_aty_[col] = aty_sum_[col] / weight_sum_;
+  }
+  const RowIndex num_rows = matrix_.num_rows();
+  for (RowIndex row(0); row < num_rows; ++row) {
+    candidate_y_[row] = y_sum_[row] / weight_sum_;
+    candidate_ax_[row] = ax_sum_[row] / weight_sum_;
+  }
+}
+
+bool PrimalDualHybridGradient::CheckTerminationAndRestart() {
+  const KktError current_error = ComputeKktError(x_, y_, ax_, aty_);
+  if (IsConverged(current_error)) {
+    problem_status_ = ProblemStatus::OPTIMAL;
+    return true;
+  }
+  ComputeAverage();
+  const KktError average_error =
+      ComputeKktError(candidate_x_, candidate_y_, candidate_ax_,
+                      candidate_aty_);
+  const bool use_average = average_error.Norm() < current_error.Norm();
+  if (use_average) {
+    x_.swap(candidate_x_);
+    y_.swap(candidate_y_);
+    ax_.swap(candidate_ax_);
+    aty_.swap(candidate_aty_);
+    if (IsConverged(average_error)) {
+      problem_status_ = ProblemStatus::OPTIMAL;
+      return true;
+    }
+  }
+  if (DetectInfeasibility()) return true;
+  const Fractional candidate_error =
+      use_average ? average_error.Norm() : current_error.Norm();
+  const bool restart =
+      candidate_error <= kSufficientRestartReduction * restart_kkt_error_ ||
+      (candidate_error <= kNecessaryRestartReduction * restart_kkt_error_ &&
+       candidate_error > last_candidate_kkt_error_) ||
+      iterations_since_restart_ >= kArtificialRestartRatio * num_iterations_;
+  if (restart) {
+    VLOG(2) << "PDHG restart at iteration " << num_iterations_
+            << (use_average ? " from the average" : "")
+            << ", KKT error: " << candidate_error
+            << ", step size: " << step_size_
+            << ", primal weight: " << primal_weight_;
+    Restart();
+    restart_kkt_error_ = candidate_error;
+  } else if (use_average) {
+    // The average was only borrowed to be evaluated.
+    x_.swap(candidate_x_);
+    y_.swap(candidate_y_);
+    ax_.swap(candidate_ax_);
+    aty_.swap(candidate_aty_);
+  }
+  last_candidate_kkt_error_ = candidate_error;
+  return false;
+}
+
+void PrimalDualHybridGradient::Restart() {
+  Fractional squared_primal_distance = 0.0;
+  const ColIndex num_cols = matrix_.num_cols();
+  for (ColIndex col(0); col < num_cols; ++col) {
+    const Fractional delta = x_[col] - restart_x_[col];
+    squared_primal_distance += delta * delta;
+  }
+  Fractional squared_dual_distance = 0.0;
+  const RowIndex num_rows = matrix_.num_rows();
+  for (RowIndex row(0); row < num_rows; ++row) {
+    const Fractional delta = y_[row] - restart_y_[row];
+    squared_dual_distance += delta * delta;
+  }
+  const Fractional kMinDistance = 1e-10;
+  if (squared_primal_distance > kMinDistance * kMinDistance &&
+      squared_dual_distance > kMinDistance * kMinDistance) {
+    const Fractional ratio =
+        std::sqrt(squared_dual_distance / squared_primal_distance);
+    primal_weight_ = std::exp(kPrimalWeightSmoothing * std::log(ratio) +
+                              (1.0 - kPrimalWeightSmoothing) *
+                                  std::log(primal_weight_));
+  }
+  restart_x_ = x_;
+  restart_y_ = y_;
+  restart_ax_ = ax_;
+  restart_aty_ = aty_;
+  x_sum_.assign(num_cols, 0.0);
+  y_sum_.assign(num_rows, 0.0);
+  ax_sum_.assign(num_rows, 0.0);
+  aty_sum_.assign(num_cols, 0.0);
+  weight_sum_ = 0.0;
+  iterations_since_restart_ = 0;
+}
+
+VariableStatus PrimalDualHybridGradient::GetVariableStatus(
+    ColIndex col) const {
+  const Fractional value = x_[col];
+  const Fractional lower_bound = lower_bounds_[col];
+  const Fractional upper_bound = upper_bounds_[col];
+  if (lower_bound == upper_bound) return VariableStatus::FIXED_VALUE;
+  if (value == lower_bound) return VariableStatus::AT_LOWER_BOUND;
+  if (value == upper_bound) return VariableStatus::AT_UPPER_BOUND;
+  if (lower_bound == -kInfinity && upper_bound == kInfinity && value == 0.0) {
+    return VariableStatus::FREE;
+  }
+  return VariableStatus::BASIC;
+}
+
+ConstraintStatus PrimalDualHybridGradient::GetConstraintStatus(
+    RowIndex row) const {
+  const Fractional lower_bound = constraint_lower_bounds_[row];
+  const Fractional upper_bound = constraint_upper_bounds_[row];
+  if (lower_bound == upper_bound) return ConstraintStatus::FIXED_VALUE;
+  if (y_[row] > 0.0) return ConstraintStatus::AT_LOWER_BOUND;
+  if (y_[row] < 0.0) return ConstraintStatus::AT_UPPER_BOUND;
+  if (lower_bound == -kInfinity && upper_bound == kInfinity) {
+    return ConstraintStatus::FREE;
+  }
+  return ConstraintStatus::BASIC;
+}
+
+}  // namespace glop
+}  // namespace operations_research
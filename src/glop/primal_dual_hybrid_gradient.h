@@ -0,0 +1,227 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Primal-dual hybrid gradient (PDHG) method for linear programming.
+//
+// Given a linear program
+//   min c.x  s.t.  cl <= A.x <= cu,  l <= x <= u,
+// the PDHG looks for a saddle point of its Lagrangian by alternating projected
+// gradient steps on the primal and on the dual variables:
+//   x' = proj_[l, u](x - tau.(c - y.A))
+//   y' = y - sigma.A.(2x' - x) + sigma.proj_[cl, cu](A.(2x' - x) - y / sigma)
+// Each iteration only needs one product with A and one with its transpose, so
+// the memory usage is linear in the size of the problem and the products are
+// easy to parallelize. The price to pay is a slow convergence: the returned
+// solutions are of moderate accuracy and are in general not basic.
+//
+// A. Chambolle, T. Pock, "A first-order primal-dual algorithm for convex
+// problems with applications to imaging", Journal of Mathematical Imaging and
+// Vision 40 (2011), 120-145.
+//
+// To converge faster in practice, this implementation:
+// - Adapts the step size at each iteration to the largest one which is locally
+//   stable, rather than using 1 / ||A||.
+// - Balances the primal and dual step sizes with a primal weight w
+//   (tau = step / w, sigma = step * w) updated at each restart.
+// - Restarts from the average of the iterates (or from the current iterate)
+//   when the KKT error decreased enough since the last restart.
+// - Relies on the problem being scaled beforehand (this is done by the
+//   ScalingPreprocessor through a SparseMatrixScaler), which acts as a diagonal
+//   preconditioner.
+
+#ifndef OR_TOOLS_GLOP_PRIMAL_DUAL_HYBRID_GRADIENT_H_
+#define OR_TOOLS_GLOP_PRIMAL_DUAL_HYBRID_GRADIENT_H_
+
+#include <memory>
+
+#include "base/integral_types.h"
+#include "base/macros.h"
+#include "base/synchronization.h"
+#include "base/threadpool.h"
+#include "glop/parameters.pb.h"
+#include "glop/status.h"
+#include "lp_data/lp_data.h"
+#include "lp_data/lp_types.h"
+#include "lp_data/sparse.h"
+#include "util/time_limit.h"
+
+namespace operations_research {
+namespace glop {
+
+class PrimalDualHybridGradient {
+ public:
+  PrimalDualHybridGradient();
+
+  // Sets or gets the algorithm parameters to be used on the next Solve().
+  void SetParameters(const GlopParameters& parameters);
+  const GlopParameters& GetParameters() const { return parameters_; }
+
+  // Solves the given linear program. The result can be retrieved with the
+  // getters below. Unlike the simplex, nothing is reused from one call to the
+  // next. Returns an error if the iterates could not be kept finite, which
+  // happens when the problem data is too badly scaled.
+  Status Solve(const LinearProgram& lp, TimeLimit* time_limit) MUST_USE_RESULT;
+
+  // Getters to retrieve the information computed by the last Solve(). The
+  // status is OPTIMAL if the solution is within the pdhg_relative_tolerance,
+  // PRIMAL_INFEASIBLE or DUAL_INFEASIBLE if an approximate infeasibility
+  // certificate was found, and INIT if a limit was reached first.
+  //
+  // The variable statuses are derived from the variable values: a variable is
+  // at a bound only if its value is exactly this bound, and BASIC otherwise.
+  // The constraint statuses are derived from the sign of the dual values. The
+  // number of BASIC variables and constraints is thus in general not the
+  // number of rows.
+  ProblemStatus GetProblemStatus() const { return problem_status_; }
+  int64 GetNumberOfIterations() const { return num_iterations_; }
+  Fractional GetVariableValue(ColIndex col) const { return x_[col]; }
+  Fractional GetDualValue(RowIndex row) const {
+    return optimization_sign_ * y_[row];
+  }
+  VariableStatus GetVariableStatus(ColIndex col) const;
+  ConstraintStatus GetConstraintStatus(RowIndex row) const;
+  double DeterministicTime() const {
+    return DeterministicTimeForFpOperations(num_operations_);
+  }
+
+ private:
+  // The quantities from which the termination criteria are derived.
+  struct KktError {
+    KktError()
+        : primal_residual(0.0),
+          dual_residual(0.0),
+          primal_objective(0.0),
+          dual_objective(0.0) {}
+
+    // Returns a single measure of the error, used to decide restarts.
+    Fractional Norm() const;
+
+    // Euclidean norms of the violation of the constraint bounds by A.x and of
+    // the violation of the reduced cost signs by c - y.A.
+    Fractional primal_residual;
+    Fractional dual_residual;
+    Fractional primal_objective;
+    Fractional dual_objective;
+  };
+
+  // Copies the problem data and initializes the iterates.
+  void Initialize(const LinearProgram& lp);
+
+  // Advances the time limit by the deterministic time spent since the last
+  // call and returns true if it is reached.
+  bool IsTimeLimitReached(TimeLimit* time_limit);
+
+  // Computes A.x (resp. y.A) in result, using num_threads_ threads. Each
+  // thread computes a contiguous slice of the result, so the result does not
+  // depend on the number of threads.
+  void ComputeProduct(const DenseRow& x, DenseColumn* result);
+  void ComputeTransposeProduct(const DenseColumn& y, DenseRow* result);
+  void ComputeProductSlice(int slice, const DenseRow* x, DenseColumn* result,
+                           Barrier* barrier);
+  void ComputeTransposeProductSlice(int slice, const DenseColumn* y,
+                                    DenseRow* result, Barrier* barrier);
+
+  // Performs one PDHG iteration from (x_, y_), trying smaller step sizes
+  // until one is accepted. The averages are updated accordingly. Returns
+  // without taking a step if the time limit is reached first, and an error if
+  // no step size could be found.
+  Status TakeAdaptiveStep(TimeLimit* time_limit) MUST_USE_RESULT;
+
+  // Computes the KKT error of the given point; ax and aty must be A.x and y.A.
+  KktError ComputeKktError(const DenseRow& x, const DenseColumn& y,
+                           const DenseColumn& ax, const DenseRow& aty) const;
+
+  // Returns true if the given KKT error is within the tolerance.
+  bool IsConverged(const KktError& error) const;
+
+  // Checks whether the difference between the current point and the last
+  // restart point is an approximate primal (resp. dual) unbounded ray, and
+  // sets problem_status_ to DUAL_INFEASIBLE (resp. PRIMAL_INFEASIBLE) if so.
+  bool DetectInfeasibility();
+
+  // Computes the weighted average of the iterates since the last restart in
+  // the candidate vectors.
+  void ComputeAverage();
+
+  // Evaluates the termination and restart criteria. Returns true if the
+  // algorithm must stop.
+  bool CheckTerminationAndRestart();
+
+  // Restarts from the current point and updates the primal weight from the
+  // distance traveled since the last restart.
+  void Restart();
+
+  GlopParameters parameters_;
+
+  // The workers computing the matrix-vector products, only created during
+  // Solve() when num_threads_ > 1.
+  int num_threads_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // The problem, with an objective to minimize. A.x is computed with the
+  // transpose of the matrix: row i of A is the column ColIndex(i) of
+  // transposed_matrix_.
+  CompactSparseMatrix matrix_;
+  CompactSparseMatrix transposed_matrix_;
+  DenseRow objective_;
+  DenseRow lower_bounds_;
+  DenseRow upper_bounds_;
+  DenseColumn constraint_lower_bounds_;
+  DenseColumn constraint_upper_bounds_;
+  Fractional optimization_sign_;
+  Fractional objective_norm_;
+  Fractional bounds_norm_;
+
+  // The current iterate, with the corresponding products A.x and y.A.
+  DenseRow x_;
+  DenseColumn y_;
+  DenseColumn ax_;
+  DenseRow aty_;
+
+  // The candidate iterate of TakeAdaptiveStep(). These vectors are also used
+  // to compute the average of the iterates.
+  DenseRow candidate_x_;
+  DenseColumn candidate_y_;
+  DenseColumn candidate_ax_;
+  DenseRow candidate_aty_;
+
+  // Sums of the iterates since the last restart, weighted by the step sizes.
+  DenseRow x_sum_;
+  DenseColumn y_sum_;
+  DenseColumn ax_sum_;
+  DenseRow aty_sum_;
+  Fractional weight_sum_;
+
+  // The point of the last restart.
+  DenseRow restart_x_;
+  DenseColumn restart_y_;
+  DenseColumn restart_ax_;
+  DenseRow restart_aty_;
+
+  Fractional step_size_;
+  Fractional primal_weight_;
+  Fractional restart_kkt_error_;
+  Fractional last_candidate_kkt_error_;
+  int64 num_iterations_;
+  int64 iterations_since_restart_;
+  int64 num_operations_;
+  double last_deterministic_time_;
+  ProblemStatus problem_status_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrimalDualHybridGradient);
+};
+
+}  // namespace glop
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_GLOP_PRIMAL_DUAL_HYBRID_GRADIENT_H_
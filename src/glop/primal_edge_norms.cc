@@ -65,6 +65,17 @@ const DenseRow& PrimalEdgeNorms::GetMatrixColumnNorms() {
   return matrix_column_norms_;
 }
 
+Fractional PrimalEdgeNorms::ComputeEdgeSquaredNorm(ColIndex col) {
+  SCOPED_TIME_STAT(&stats_);
+  num_operations_ += matrix_.column(col).num_entries().value();
+  if (basis_factorization_.IsRefactorized()) {
+    return 1.0 + basis_factorization_.RightSolveSquaredNorm(matrix_.column(col));
+  }
+  matrix_.column(col).CopyToDenseVector(matrix_.num_rows(), &right_inverse_);
+  basis_factorization_.RightSolve(&right_inverse_);
+  return 1.0 + SquaredNorm(right_inverse_);
+}
+
 void PrimalEdgeNorms::TestEnteringEdgeNormPrecision(
     ColIndex entering_col, ScatteredColumnReference direction) {
   if (!recompute_edge_squared_norms_) {
@@ -86,6 +86,11 @@ class PrimalEdgeNorms {
   // Note that this is currently not cleared by Clear().
   const DenseRow& GetMatrixColumnNorms();
 
+  // Computes from scratch the squared norm of the edge of the given column.
+  // This is used by the multiple pricing of EnteringVariable, which only needs
+  // the norms of a few columns and does not call GetEdgeSquaredNorms().
+  Fractional ComputeEdgeSquaredNorm(ColIndex col);
+
   // Compares the current entering edge norm with its precise version (using the
   // direction that wasn't avaible before) and triggers a full recomputation if
   // the precision is not good enough (see recompute_edges_norm_threshold in
@@ -198,6 +203,9 @@ class PrimalEdgeNorms {
   DenseRow direction_left_inverse_;
   ColIndexVector direction_left_inverse_non_zeros_;
 
+  // Right inverse of a column, used by ComputeEdgeSquaredNorm().
+  DenseColumn right_inverse_;
+
   // Used by DeterministicTime().
   int64 num_operations_;
 
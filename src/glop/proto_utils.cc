@@ -33,14 +33,15 @@ void LinearProgramToMPModelProto(const LinearProgram& input,
   }
   // We need the matrix transpose because a LinearProgram stores the data
   // column-wise but the MPModelProto uses a row-wise format.
-  SparseMatrix transpose;
+  CompactSparseMatrix transpose;
   transpose.PopulateFromTranspose(input.GetSparseMatrix());
   for (RowIndex row(0); row < input.num_constraints(); ++row) {
     MPConstraintProto* constraint = output->add_constraint();
     constraint->set_lower_bound(input.constraint_lower_bounds()[row]);
     constraint->set_upper_bound(input.constraint_upper_bounds()[row]);
     constraint->set_name(input.GetConstraintName(row));
-    for (const SparseColumn::Entry e : transpose.column(RowToColIndex(row))) {
+    for (const CompactSparseMatrix::ColumnView::Entry e :
+         transpose.column(RowToColIndex(row))) {
       constraint->add_var_index(e.row().value());
       constraint->add_coefficient(e.coefficient());
     }
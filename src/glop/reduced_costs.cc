@@ -40,6 +40,9 @@ ReducedCosts::ReducedCosts(const CompactSparseMatrix& matrix,
       recompute_reduced_costs_(true),
       are_reduced_costs_precise_(false),
       are_reduced_costs_recomputed_(false),
+      partial_pricing_(false),
+      reduced_cost_stamps_(),
+      dual_values_stamp_(0),
       basic_objective_(),
       reduced_costs_(),
       basic_objective_left_inverse_(),
@@ -66,7 +69,17 @@ bool ReducedCosts::TestEnteringReducedCostPrecision(
   // Update the reduced cost of the entering variable with the precise version.
   reduced_costs_[entering_col] = precise_reduced_cost;
   *reduced_cost = precise_reduced_cost;
-  if (are_dual_infeasible_positions_maintained_) {
+  if (partial_pricing_) {
+    // This makes sure that the column will not be priced again with the
+    // current dual values if it is rejected below.
+    reduced_cost_stamps_[entering_col] = dual_values_stamp_;
+    if (!IsValidPrimalEnteringCandidate(entering_col)) {
+      if (!are_reduced_costs_precise_) {
+        MakeReducedCostsPrecise();
+      }
+      return false;
+    }
+  } else if (are_dual_infeasible_positions_maintained_) {
     is_dual_infeasible_.Set(entering_col,
                             IsValidPrimalEnteringCandidate(entering_col));
 
@@ -110,6 +123,10 @@ Fractional ReducedCosts::ComputeMaximumDualResidual() const {
   DCHECK(!recompute_reduced_costs_);
   if (recompute_reduced_costs_) return 0.0;
 
+  // With partial pricing, the reduced costs of the slack columns are not
+  // maintained and the dual values are always recomputed from scratch.
+  if (partial_pricing_) return 0.0;
+
   // The current reduced costs of the slack columns are the opposite of the dual
   // values. Note that they are updated by UpdateBeforeBasisPivot().
   const RowIndex num_rows = matrix_.num_rows();
@@ -173,6 +190,19 @@ void ReducedCosts::UpdateBeforeBasisPivot(ColIndex entering_col,
   DCHECK(!variables_info_.GetIsBasicBitRow().IsSet(entering_col));
   DCHECK(variables_info_.GetIsBasicBitRow().IsSet(leaving_col));
 
+  if (partial_pricing_) {
+    // The other reduced costs will be computed from the new dual values when
+    // needed. Note that the entering reduced cost was just priced. Only the
+    // left inverse of the unit row is needed, by the basis update.
+    update_row->ComputeUnitRowLeftInverse(leaving_row);
+    reduced_costs_[leaving_col] =
+        reduced_costs_[entering_col] / -direction[leaving_row];
+    reduced_costs_[entering_col] = 0.0;
+    are_reduced_costs_precise_ = false;
+    are_reduced_costs_recomputed_ = false;
+    UpdateBasicObjective(entering_col, leaving_row);
+    return;
+  }
   if (are_dual_infeasible_positions_maintained_) {
     is_dual_infeasible_.Clear(entering_col);
   }
@@ -190,7 +220,7 @@ void ReducedCosts::UpdateBeforeBasisPivot(ColIndex entering_col,
 
 void ReducedCosts::SetAndDebugCheckThatColumnIsDualFeasible(ColIndex col) {
   SCOPED_TIME_STAT(&stats_);
-  is_dual_infeasible_.Clear(col);
+  if (!partial_pricing_) is_dual_infeasible_.Clear(col);
   DCHECK(!IsValidPrimalEnteringCandidate(col));
 }
 
@@ -210,7 +240,7 @@ void ReducedCosts::ResetForNewObjective() {
   SCOPED_TIME_STAT(&stats_);
   recompute_basic_objective_ = true;
   recompute_basic_objective_left_inverse_ = true;
-  recompute_reduced_costs_ = true;
+  recompute_reduced_costs_ = !partial_pricing_;
   are_reduced_costs_precise_ = false;
 }
 
@@ -225,7 +255,7 @@ void ReducedCosts::MakeReducedCostsPrecise() {
   if (are_reduced_costs_precise_) return;
   must_refactorize_basis_ = true;
   recompute_basic_objective_left_inverse_ = true;
-  recompute_reduced_costs_ = true;
+  recompute_reduced_costs_ = !partial_pricing_;
 }
 
 void ReducedCosts::ShiftCost(ColIndex col) {
@@ -244,10 +274,46 @@ void ReducedCosts::ClearAndRemoveCostShifts() {
   objective_perturbation_.assign(matrix_.num_cols(), 0.0);
   recompute_basic_objective_ = true;
   recompute_basic_objective_left_inverse_ = true;
-  recompute_reduced_costs_ = true;
+  recompute_reduced_costs_ = !partial_pricing_;
   are_reduced_costs_precise_ = false;
 }
 
+void ReducedCosts::SetPartialPricing(bool enable) {
+  SCOPED_TIME_STAT(&stats_);
+  if (partial_pricing_ == enable) return;
+  partial_pricing_ = enable;
+  if (partial_pricing_) {
+    const ColIndex num_cols = matrix_.num_cols();
+    reduced_costs_.resize(num_cols, 0.0);
+    objective_perturbation_.resize(num_cols, 0.0);
+    reduced_cost_stamps_.assign(num_cols, -1);
+    ++dual_values_stamp_;
+    recompute_reduced_costs_ = false;
+    if (dual_feasibility_tolerance_ == 0.0) {
+      dual_feasibility_tolerance_ = parameters_.dual_feasibility_tolerance();
+    }
+  } else {
+    // Recompute all the reduced costs right away so that the functions that
+    // look at all of them, like ComputeMaximumDualInfeasibility(), are valid.
+    recompute_reduced_costs_ = true;
+    RecomputeReducedCostsAndPrimalEnteringCandidatesIfNeeded();
+  }
+}
+
+Fractional ReducedCosts::ComputeReducedCost(ColIndex col) {
+  DCHECK(partial_pricing_);
+  if (recompute_basic_objective_left_inverse_) {
+    ComputeBasicObjectiveLeftInverse();
+  }
+  if (reduced_cost_stamps_[col] != dual_values_stamp_) {
+    reduced_cost_stamps_[col] = dual_values_stamp_;
+    reduced_costs_[col] =
+        objective_[col] + objective_perturbation_[col] -
+        matrix_.ColumnScalarProduct(col, basic_objective_left_inverse_);
+  }
+  return reduced_costs_[col];
+}
+
 void ReducedCosts::MaintainDualInfeasiblePositions(bool maintain) {
   are_dual_infeasible_positions_maintained_ = maintain;
   if (are_dual_infeasible_positions_maintained_ && !recompute_reduced_costs_) {
@@ -271,7 +337,7 @@ void ReducedCosts::RecomputeReducedCostsAndPrimalEnteringCandidatesIfNeeded() {
   if (basis_factorization_.IsRefactorized()) {
     must_refactorize_basis_ = false;
   }
-  if (recompute_reduced_costs_) {
+  if (recompute_reduced_costs_ && !partial_pricing_) {
     ComputeReducedCosts();
     if (are_dual_infeasible_positions_maintained_) {
       ResetDualInfeasibilityBitSet();
@@ -372,6 +438,13 @@ void ReducedCosts::ComputeBasicObjectiveLeftInverse() {
   basic_objective_left_inverse_ = basic_objective_;
   basis_factorization_.LeftSolve(&basic_objective_left_inverse_);
   recompute_basic_objective_left_inverse_ = false;
+  if (partial_pricing_) {
+    // In this mode, the precision of the reduced costs is the one of the dual
+    // values.
+    ++dual_values_stamp_;
+    are_reduced_costs_precise_ = basis_factorization_.IsRefactorized();
+    if (are_reduced_costs_precise_) must_refactorize_basis_ = false;
+  }
   IF_STATS_ENABLED(stats_.basic_objective_left_inverse_density.Add(
       Density(basic_objective_left_inverse_)));
 
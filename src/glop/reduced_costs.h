@@ -139,6 +139,22 @@ class ReducedCosts {
   // Invalidates the data that depends on the order of the column in basis_.
   void UpdateDataOnBasisPermutation();
 
+  // Enables or disables the partial pricing mode of the primal simplex. In
+  // this mode, the reduced costs are not updated at each basis pivot. Only the
+  // dual values are kept up to date, and the reduced cost of a column is
+  // computed from them when the pricing needs it with ComputeReducedCost().
+  // GetReducedCosts() is then only valid for the columns priced since the
+  // last change of the dual values. Disabling this mode triggers a
+  // recomputation of all the reduced costs.
+  void SetPartialPricing(bool enable);
+  bool IsPartialPricingEnabled() const { return partial_pricing_; }
+
+  // Only valid in the partial pricing mode. Returns the reduced cost of the
+  // given column, computed from the current dual values if it is not already
+  // known. IsValidPrimalEnteringCandidate() can be called on this column
+  // afterwards.
+  Fractional ComputeReducedCost(ColIndex col);
+
   // Returns the current reduced costs. If AreReducedCostsPrecise() is true,
   // then for basic columns, this gives the error between 'c_B' and 'y.B' and
   // for non-basic columns, this is the classic reduced cost. If it is false,
@@ -233,6 +249,13 @@ class ReducedCosts {
   bool are_reduced_costs_precise_;
   bool are_reduced_costs_recomputed_;
 
+  // See SetPartialPricing(). In this mode, reduced_costs_[col] is up to date
+  // if and only if reduced_cost_stamps_[col] is equal to dual_values_stamp_,
+  // which is incremented each time the dual values are recomputed.
+  bool partial_pricing_;
+  StrictITIVector<ColIndex, int64> reduced_cost_stamps_;
+  int64 dual_values_stamp_;
+
   // Values of the objective on the columns of the basis. The order is given by
   // the basis_ mapping. It is usually denoted as 'c_B' in the literature .
   DenseRow basic_objective_;
@@ -27,6 +27,7 @@
 #include "base/logging.h"
 #include "base/stringprintf.h"
 #include "glop/initial_basis.h"
+#include "glop/markowitz.h"
 #include "glop/parameters.pb.h"
 #include "lp_data/lp_data.h"
 #include "lp_data/lp_print_utils.h"
@@ -906,6 +907,97 @@ Status RevisedSimplex::CreateInitialBasis() {
   return InitializeFirstBasis(basis);
 }
 
+void RevisedSimplex::RepairBasisWithSlacks(RowToColMapping* basis) {
+  SCOPED_TIME_STAT(&function_stats_);
+  MatrixView basis_matrix;
+  basis_matrix.PopulateFromBasis(matrix_with_slack_, *basis);
+
+  // The permutations give a set of independent columns, and the rows that are
+  // not covered by these columns.
+  Markowitz markowitz;
+  markowitz.SetParameters(parameters_);
+  RowPermutation row_perm;
+  ColumnPermutation col_perm;
+  if (markowitz.ComputeRowAndColumnPermutation(basis_matrix, &row_perm,
+                                               &col_perm).ok() &&
+      basis->size() == num_rows_) {
+    return;
+  }
+
+  // The independent columns completed by the slack columns of the uncovered
+  // rows form a non-singular basis.
+  const RowToColMapping candidates = *basis;
+  DenseBooleanRow is_basic(num_cols_, false);
+  std::vector<ColIndex> singular_candidates;
+  basis->clear();
+  for (RowIndex i(0); i < candidates.size(); ++i) {
+    const ColIndex col = candidates[i];
+    if (col_perm[RowToColIndex(i)] == kInvalidCol) {
+      singular_candidates.push_back(col);
+    } else {
+      basis->push_back(col);
+      is_basic[col] = true;
+    }
+  }
+  DenseBooleanColumn is_added_slack(num_rows_, false);
+  for (RowIndex row(0); row < num_rows_; ++row) {
+    if (row_perm[row] == kInvalidRow) {
+      is_added_slack[basis->size()] = true;
+      basis->push_back(SlackColIndex(row));
+      is_basic[SlackColIndex(row)] = true;
+    }
+  }
+
+  // The elimination stops at the first singular pivot, so the candidates it
+  // did not reach may still be independent. Such a candidate replaces one of
+  // the added slack columns, which is possible if its coordinate on this
+  // column in the current basis is large enough. Since the span of the basis
+  // only grows, a candidate that can not be added now never can.
+  const Fractional threshold = parameters_.lu_factorization_pivot_threshold();
+  bool needs_factorization = true;
+  bool is_factorized = false;
+  int num_removed = 0;
+  DenseColumn coordinates;
+  for (const ColIndex col : singular_candidates) {
+    if (is_basic[col]) continue;
+    if (needs_factorization) {
+      basis_matrix.PopulateFromBasis(matrix_with_slack_, *basis);
+      is_factorized = test_lu_.ComputeFactorization(basis_matrix).ok();
+      needs_factorization = false;
+    }
+    RowIndex best_position = kInvalidRow;
+    if (is_factorized) {
+      test_lu_.SparseRightSolve(matrix_with_slack_.column(col), num_rows_,
+                                &coordinates);
+      Fractional best_magnitude = threshold * InfinityNorm(coordinates);
+      for (RowIndex i(0); i < num_rows_; ++i) {
+        if (is_added_slack[i] && fabs(coordinates[i]) > best_magnitude) {
+          best_position = i;
+          best_magnitude = fabs(coordinates[i]);
+        }
+      }
+    }
+    if (best_position == kInvalidRow) {
+      variables_info_.Update(col, ComputeDefaultVariableStatus(col));
+      ++num_removed;
+      continue;
+    }
+    const ColIndex slack_col = (*basis)[best_position];
+    is_basic[slack_col] = false;
+    variables_info_.Update(slack_col, ComputeDefaultVariableStatus(slack_col));
+    (*basis)[best_position] = col;
+    is_basic[col] = true;
+    is_added_slack[best_position] = false;
+    needs_factorization = true;
+  }
+  int num_slacks = 0;
+  for (RowIndex i(0); i < num_rows_; ++i) {
+    if (is_added_slack[i]) ++num_slacks;
+  }
+  VLOG(1) << "Repaired the basis: " << num_removed << " dependent columns "
+          << "removed, " << num_slacks << " slack columns added.";
+}
+
 Status RevisedSimplex::InitializeFirstBasis(const RowToColMapping& basis) {
   basis_ = basis;
 
@@ -923,7 +1015,11 @@ Status RevisedSimplex::InitializeFirstBasis(const RowToColMapping& basis) {
   DCHECK(BasisIsConsistent());
 
   variable_values_.RecomputeBasicVariableValues();
-  const Fractional tolerance = parameters_.primal_feasibility_tolerance();
+  // The residual is relative to the magnitude of the values since a basis
+  // provided externally can be far from the optimal one.
+  const Fractional tolerance =
+      parameters_.primal_feasibility_tolerance() *
+      std::max(1.0, InfinityNorm(variable_values_.GetDenseRow()));
   DCHECK_LE(variable_values_.ComputeMaximumPrimalResidual(), tolerance);
   return Status::OK;
 }
@@ -979,15 +1075,11 @@ Status RevisedSimplex::Initialize(const LinearProgram& lp) {
       // If an external basis has been provided we need to perform more work,
       // e.g., factorize and validate it.
       InitializeVariableStatusesForWarmStart(solution_state_);
-      basis_.assign(num_rows_, kInvalidCol);
-      RowIndex row(0);
+      basis_.clear();
       for (ColIndex col : variables_info_.GetIsBasicBitRow()) {
-        basis_[row] = col;
-        ++row;
+        basis_.push_back(col);
       }
-      // TODO(user): If the basis is incomplete, we could complete it with
-      // better slack variables than is done by InitializeFirstBasis() by
-      // using a partial LU decomposition (see markowitz.h).
+      RepairBasisWithSlacks(&basis_);
       if (InitializeFirstBasis(basis_).ok()) {
         primal_edge_norms_.Clear();
         dual_edge_norms_.Clear();
@@ -1950,6 +2042,25 @@ void RevisedSimplex::MakeBoxedVariableDualFeasible(
   }
 }
 
+void RevisedSimplex::FlipBoxedVariables(const std::vector<ColIndex>& cols) {
+  SCOPED_TIME_STAT(&function_stats_);
+  const VariableStatusRow& variable_status = variables_info_.GetStatusRow();
+  for (const ColIndex col : cols) {
+    DCHECK_EQ(VariableType::UPPER_AND_LOWER_BOUNDED,
+              variables_info_.GetTypeRow()[col]);
+    if (variable_status[col] == VariableStatus::AT_LOWER_BOUND) {
+      variables_info_.Update(col, VariableStatus::AT_UPPER_BOUND);
+    } else {
+      DCHECK_EQ(VariableStatus::AT_UPPER_BOUND, variable_status[col]);
+      variables_info_.Update(col, VariableStatus::AT_LOWER_BOUND);
+    }
+  }
+
+  // This updates the basic variable values with a single right solve.
+  variable_values_.UpdateGivenNonBasicVariables(cols,
+                                                /*update_basic_values=*/true);
+}
+
 Fractional RevisedSimplex::ComputeStepToMoveBasicVariableToBound(
     RowIndex leaving_row, Fractional target_bound) {
   SCOPED_TIME_STAT(&function_stats_);
@@ -2053,6 +2164,7 @@ bool RevisedSimplex::NeedsBasisRefactorization(bool refactorize) {
     if (dual_edge_norms_.NeedsBasisRefactorization()) return true;
   } else {
     if (pricing_rule == GlopParameters::STEEPEST_EDGE &&
+        parameters_.primal_pricing_scope() == GlopParameters::FULL_PRICING &&
         primal_edge_norms_.NeedsBasisRefactorization()) {
       return true;
     }
@@ -2090,6 +2202,17 @@ Status RevisedSimplex::Minimize(TimeLimit* time_limit) {
   RETURN_ERROR_IF_NULL(time_limit);
   Cleanup update_deterministic_time_on_return(
       [this, time_limit]() { AdvanceDeterministicTime(time_limit); });
+
+  // With partial or multiple pricing, the reduced costs are only computed for
+  // the columns looked at by EnteringVariable, and the primal edge norms are
+  // never updated. They are all recomputed on return.
+  const bool partial_pricing =
+      parameters_.primal_pricing_scope() != GlopParameters::FULL_PRICING;
+  if (partial_pricing) primal_edge_norms_.Clear();
+  reduced_costs_.SetPartialPricing(partial_pricing);
+  Cleanup disable_partial_pricing_on_return([this, partial_pricing]() {
+    if (partial_pricing) reduced_costs_.SetPartialPricing(false);
+  });
   num_consecutive_degenerate_iterations_ = 0;
   DisplayIterationInfo();
   bool refactorize = false;
@@ -2436,14 +2559,9 @@ Status RevisedSimplex::DualMinimize(TimeLimit* time_limit) {
       // Updates from the previous iteration that can be skipped if we
       // recompute everything (see other case above).
       if (!feasibility_phase_) {
-        // Make sure the boxed variables are dual-feasible before choosing the
-        // leaving variable row.
-        MakeBoxedVariableDualFeasible(bound_flip_candidates,
-                                      /*update_basic_values=*/true);
-        bound_flip_candidates.clear();
-
         // The direction_non_zero_ contains the positions for which the basic
-        // variable value was changed during the previous iterations.
+        // variable value was changed during the previous iterations. The
+        // positions changed by the bound flips are already up to date.
         variable_values_.UpdatePrimalInfeasibilityInformation(
             direction_non_zero_);
       }
@@ -2561,6 +2679,12 @@ Status RevisedSimplex::DualMinimize(TimeLimit* time_limit) {
     if (feasibility_phase_) {
       DualPhaseIUpdatePrice(leaving_row, entering_col);
     } else {
+      // The leaving variable value depends on the bound flips, so they must
+      // be done before the primal step is computed.
+      if (!bound_flip_candidates.empty()) {
+        FlipBoxedVariables(bound_flip_candidates);
+        bound_flip_candidates.clear();
+      }
       primal_step =
           ComputeStepToMoveBasicVariableToBound(leaving_row, target_bound);
       variable_values_.UpdateOnPivoting(
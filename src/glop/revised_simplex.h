@@ -325,6 +325,13 @@ class RevisedSimplex {
   // basis and tries to apply some heuristics to replace fixed variables.
   Status CreateInitialBasis() MUST_USE_RESULT;
 
+  // Replaces the columns of the given basis that are linearly dependent on the
+  // others by nonbasic columns, and completes the basis with slack columns so
+  // that it has num_rows_ columns and can be factorized. This is used to repair
+  // an externally provided basis that does not match the problem, for instance
+  // because some rows or columns were added or removed.
+  void RepairBasisWithSlacks(RowToColMapping* basis);
+
   // Sets the initial basis to the given columns, try to factorize it and
   // recompute the basic variable values.
   Status InitializeFirstBasis(const RowToColMapping& initial_basis)
@@ -465,14 +472,17 @@ class RevisedSimplex {
   // correct bound according to their reduced costs. This is called
   // Dual feasibility correction in the literature.
   //
-  // Note that this function is also used as a part of the bound flipping ratio
-  // test by flipping the boxed dual-infeasible variables at each iteration.
-  //
   // If update_basic_values is true, the basic variable values are updated.
   template <typename BoxedVariableCols>
   void MakeBoxedVariableDualFeasible(const BoxedVariableCols& cols,
                                      bool update_basic_values);
 
+  // Moves the given non-basic boxed variables to their other bound and updates
+  // the basic variable values. This is the second part of the bound flipping
+  // ratio test of the dual simplex, see
+  // EnteringVariable::DualChooseEnteringColumn().
+  void FlipBoxedVariables(const std::vector<ColIndex>& cols);
+
   // Computes the step needed to move the leaving_row basic variable to the
   // given target bound.
   Fractional ComputeStepToMoveBasicVariableToBound(RowIndex leaving_row,
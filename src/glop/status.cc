@@ -36,6 +36,8 @@ std::string GetErrorCodeString(Status::ErrorCode error_code) {
       return "ERROR_BOUND";
     case Status::ERROR_NULL:
       return "ERROR_NULL";
+    case Status::ERROR_NUMERICAL:
+      return "ERROR_NUMERICAL";
   }
   // Fallback. We don't use "default:" so the compiler will return an error
   // if we forgot one enum case above.
@@ -38,6 +38,9 @@ class Status {
     // A pointer argument was NULL when it shouldn't be.
     ERROR_NULL = 3,
 
+    // An iterative algorithm produced values that are not finite.
+    ERROR_NUMERICAL = 4,
+
   };
 
   // Creates a "successful" status.
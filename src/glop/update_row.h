@@ -69,6 +69,12 @@ class UpdateRow {
   // Sets to zero the coefficient for column col.
   void IgnoreUpdatePosition(ColIndex col);
 
+  // Computes the left inverse of the given unit row, and stores it in
+  // unit_row_left_inverse_ and unit_row_left_inverse_non_zeros_. This is
+  // called by ComputeUpdateRow(), but can also be called alone when only the
+  // left inverse is needed (it is also used to update the basis factorization).
+  void ComputeUnitRowLeftInverse(RowIndex leaving_row);
+
   // Sets the algorithm parameters.
   void SetParameters(const GlopParameters& parameters);
 
@@ -89,10 +95,6 @@ class UpdateRow {
   }
 
  private:
-  // Computes the left inverse of the given unit row, and stores it in
-  // unit_row_left_inverse_ and unit_row_left_inverse_non_zeros_.
-  void ComputeUnitRowLeftInverse(RowIndex leaving_row);
-
   // ComputeUpdateRow() does the common work and call one of these functions
   // depending on the situation.
   void ComputeUpdatesRowWise();
@@ -33,6 +33,7 @@
 #endif
 
 #include "base/hash.h"
+#include "glop/branch_and_bound.h"
 #include "glop/lp_solver.h"
 #include "glop/parameters.pb.h"
 #include "linear_solver/linear_solver.h"
@@ -74,6 +75,41 @@ MPSolver::ResultStatus TranslateProblemStatus(glop::ProblemStatus status) {
   return MPSolver::ABNORMAL;
 }
 
+glop::VariableStatus MPSolverToGlopVariableStatus(MPSolver::BasisStatus status) {
+  switch (status) {
+    case MPSolver::FREE:
+      return glop::VariableStatus::FREE;
+    case MPSolver::AT_LOWER_BOUND:
+      return glop::VariableStatus::AT_LOWER_BOUND;
+    case MPSolver::AT_UPPER_BOUND:
+      return glop::VariableStatus::AT_UPPER_BOUND;
+    case MPSolver::FIXED_VALUE:
+      return glop::VariableStatus::FIXED_VALUE;
+    case MPSolver::BASIC:
+      return glop::VariableStatus::BASIC;
+  }
+  LOG(DFATAL) << "Unknown basis status: " << status;
+  return glop::VariableStatus::FREE;
+}
+
+glop::ConstraintStatus MPSolverToGlopConstraintStatus(
+    MPSolver::BasisStatus status) {
+  switch (status) {
+    case MPSolver::FREE:
+      return glop::ConstraintStatus::FREE;
+    case MPSolver::AT_LOWER_BOUND:
+      return glop::ConstraintStatus::AT_LOWER_BOUND;
+    case MPSolver::AT_UPPER_BOUND:
+      return glop::ConstraintStatus::AT_UPPER_BOUND;
+    case MPSolver::FIXED_VALUE:
+      return glop::ConstraintStatus::FIXED_VALUE;
+    case MPSolver::BASIC:
+      return glop::ConstraintStatus::BASIC;
+  }
+  LOG(DFATAL) << "Unknown basis status: " << status;
+  return glop::ConstraintStatus::FREE;
+}
+
 MPSolver::BasisStatus TranslateVariableStatus(glop::VariableStatus status) {
   switch (status) {
     case glop::VariableStatus::FREE:
@@ -111,7 +147,7 @@ MPSolver::BasisStatus TranslateConstraintStatus(glop::ConstraintStatus status) {
 
 class GLOPInterface : public MPSolverInterface {
  public:
-  explicit GLOPInterface(MPSolver* const solver);
+  GLOPInterface(MPSolver* const solver, bool mip);
   ~GLOPInterface() override;
 
   // ----- Solve -----
@@ -141,6 +177,9 @@ class GLOPInterface : public MPSolverInterface {
   double best_objective_bound() const override;
   MPSolver::BasisStatus row_status(int constraint_index) const override;
   MPSolver::BasisStatus column_status(int variable_index) const override;
+  void SetStartingLpBasis(
+      const std::vector<MPSolver::BasisStatus>& variable_statuses,
+      const std::vector<MPSolver::BasisStatus>& constraint_statuses) override;
 
   // ----- Misc -----
   bool IsContinuous() const override;
@@ -166,18 +205,34 @@ class GLOPInterface : public MPSolverInterface {
  private:
   void NonIncrementalChange();
 
+  // Solves a problem with integer variables with the branch and bound solver
+  // of Glop. The basis statuses, reduced costs and dual values are then not
+  // available.
+  MPSolver::ResultStatus SolveMip(TimeLimit* time_limit);
+
   glop::LinearProgram linear_program_;
   glop::LPSolver lp_solver_;
+  glop::BranchAndBoundSolver branch_and_bound_;
+  const bool mip_;
+  double best_objective_bound_;
   std::vector<MPSolver::BasisStatus> column_status_;
   std::vector<MPSolver::BasisStatus> row_status_;
+
+  // The basis given to SetStartingLpBasis(), passed to lp_solver_ by the next
+  // Solve().
+  glop::VariableStatusRow starting_variable_statuses_;
+  glop::ConstraintStatusColumn starting_constraint_statuses_;
   glop::GlopParameters parameters_;
   bool interrupt_solver_;
 };
 
-GLOPInterface::GLOPInterface(MPSolver* const solver)
+GLOPInterface::GLOPInterface(MPSolver* const solver, bool mip)
     : MPSolverInterface(solver),
       linear_program_(),
       lp_solver_(),
+      branch_and_bound_(),
+      mip_(mip),
+      best_objective_bound_(0.0),
       column_status_(),
       row_status_(),
       parameters_(),
@@ -207,6 +262,14 @@ MPSolver::ResultStatus GLOPInterface::Solve(const MPSolverParameters& param) {
   std::unique_ptr<TimeLimit> time_limit =
       TimeLimit::FromParameters(parameters_);
   time_limit->RegisterExternalBooleanAsLimit(&interrupt_solver_);
+  if (mip_) return SolveMip(time_limit.get());
+  if (!starting_variable_statuses_.empty() ||
+      !starting_constraint_statuses_.empty()) {
+    lp_solver_.SetInitialBasis(starting_variable_statuses_,
+                               starting_constraint_statuses_);
+    starting_variable_statuses_.clear();
+    starting_constraint_statuses_.clear();
+  }
   const glop::ProblemStatus status =
       lp_solver_.SolveWithTimeLimit(linear_program_, time_limit.get());
 
@@ -252,6 +315,29 @@ MPSolver::ResultStatus GLOPInterface::Solve(const MPSolverParameters& param) {
   return result_status_;
 }
 
+MPSolver::ResultStatus GLOPInterface::SolveMip(TimeLimit* time_limit) {
+  branch_and_bound_.SetParameters(parameters_);
+  const glop::ProblemStatus status =
+      branch_and_bound_.SolveWithTimeLimit(linear_program_, time_limit);
+
+  // The solution must be marked as synchronized even when no solution exists.
+  sync_status_ = SOLUTION_SYNCHRONIZED;
+  result_status_ = TranslateProblemStatus(status);
+  objective_value_ = branch_and_bound_.GetObjectiveValue();
+  best_objective_bound_ = branch_and_bound_.GetBestBound();
+
+  const size_t num_vars = solver_->variables_.size();
+  column_status_.assign(num_vars, MPSolver::FREE);
+  for (int var_id = 0; var_id < num_vars; ++var_id) {
+    MPVariable* const var = solver_->variables_[var_id];
+    const glop::ColIndex lp_solver_var_id(var->index());
+    var->set_solution_value(static_cast<double>(
+        branch_and_bound_.variable_values()[lp_solver_var_id]));
+  }
+  row_status_.assign(solver_->constraints_.size(), MPSolver::FREE);
+  return result_status_;
+}
+
 bool GLOPInterface::InterruptSolve() {
   interrupt_solver_ = true;
   return true;
@@ -272,7 +358,11 @@ void GLOPInterface::SetVariableBounds(int index, double lb, double ub) {
 }
 
 void GLOPInterface::SetVariableInteger(int index, bool integer) {
-  LOG(WARNING) << "Glop doesn't deal with integer variables.";
+  if (mip_) {
+    NonIncrementalChange();
+  } else {
+    LOG(WARNING) << "Glop doesn't deal with integer variables.";
+  }
 }
 
 void GLOPInterface::SetConstraintBounds(int index, double lb, double ub) {
@@ -307,17 +397,29 @@ void GLOPInterface::SetObjectiveOffset(double value) { NonIncrementalChange(); }
 void GLOPInterface::ClearObjective() { NonIncrementalChange(); }
 
 int64 GLOPInterface::iterations() const {
-  return lp_solver_.GetNumberOfSimplexIterations();
+  if (mip_) return branch_and_bound_.GetNumberOfSimplexIterations();
+  return lp_solver_.GetNumberOfSimplexIterations() +
+         lp_solver_.GetNumberOfPdhgIterations();
 }
 
 int64 GLOPInterface::nodes() const {
-  LOG(DFATAL) << "Number of nodes only available for discrete problems";
-  return kUnknownNumberOfNodes;
+  if (!mip_) {
+    LOG(DFATAL) << "Number of nodes only available for discrete problems";
+    return kUnknownNumberOfNodes;
+  }
+  if (!CheckSolutionIsSynchronized()) return kUnknownNumberOfNodes;
+  return branch_and_bound_.GetNumberOfNodes();
 }
 
 double GLOPInterface::best_objective_bound() const {
-  LOG(DFATAL) << "Best objective bound only available for discrete problems";
-  return trivial_worst_objective_bound();
+  if (!mip_) {
+    LOG(DFATAL) << "Best objective bound only available for discrete problems";
+    return trivial_worst_objective_bound();
+  }
+  if (!CheckSolutionIsSynchronized() || !CheckBestObjectiveBoundExists()) {
+    return trivial_worst_objective_bound();
+  }
+  return best_objective_bound_;
 }
 
 MPSolver::BasisStatus GLOPInterface::row_status(int constraint_index) const {
@@ -328,18 +430,40 @@ MPSolver::BasisStatus GLOPInterface::column_status(int variable_index) const {
   return column_status_[variable_index];
 }
 
-bool GLOPInterface::IsContinuous() const { return true; }
+void GLOPInterface::SetStartingLpBasis(
+    const std::vector<MPSolver::BasisStatus>& variable_statuses,
+    const std::vector<MPSolver::BasisStatus>& constraint_statuses) {
+  if (mip_) {
+    MPSolverInterface::SetStartingLpBasis(variable_statuses,
+                                          constraint_statuses);
+    return;
+  }
+  starting_variable_statuses_.clear();
+  for (const MPSolver::BasisStatus status : variable_statuses) {
+    starting_variable_statuses_.push_back(MPSolverToGlopVariableStatus(status));
+  }
+  starting_constraint_statuses_.clear();
+  for (const MPSolver::BasisStatus status : constraint_statuses) {
+    starting_constraint_statuses_.push_back(
+        MPSolverToGlopConstraintStatus(status));
+  }
+}
 
-bool GLOPInterface::IsLP() const { return true; }
+bool GLOPInterface::IsContinuous() const { return !mip_; }
 
-bool GLOPInterface::IsMIP() const { return false; }
+bool GLOPInterface::IsLP() const { return !mip_; }
+
+bool GLOPInterface::IsMIP() const { return mip_; }
 
 std::string GLOPInterface::SolverVersion() const {
   // TODO(user): Decide how to version glop. Add a GetVersion() to LPSolver.
   return "Glop-0.0";
 }
 
-void* GLOPInterface::underlying_solver() { return &lp_solver_; }
+void* GLOPInterface::underlying_solver() {
+  if (mip_) return &branch_and_bound_;
+  return &lp_solver_;
+}
 
 void GLOPInterface::ExtractNewVariables() {
   DCHECK_EQ(0, last_variable_index_);
@@ -353,6 +477,7 @@ void GLOPInterface::ExtractNewVariables() {
     DCHECK_EQ(new_col, col);
     set_variable_as_extracted(col.value(), true);
     linear_program_.SetVariableBounds(col, var->lb(), var->ub());
+    if (mip_) linear_program_.SetVariableIntegrality(col, var->integer());
   }
 }
 
@@ -395,11 +520,14 @@ void GLOPInterface::SetParameters(const MPSolverParameters& param) {
   parameters_.Clear();
   SetCommonParameters(param);
   SetScalingMode(param.GetIntegerParam(MPSolverParameters::SCALING));
+  if (mip_) SetMIPParameters(param);
 
 }
 
 void GLOPInterface::SetRelativeMipGap(double value) {
-  if (value != MPSolverParameters::kDefaultDoubleParamValue) {
+  if (mip_) {
+    parameters_.set_mip_relative_gap(value);
+  } else if (value != MPSolverParameters::kDefaultDoubleParamValue) {
     SetDoubleParamToUnsupportedValue(MPSolverParameters::RELATIVE_MIP_GAP,
                                      value);
   }
@@ -463,6 +591,11 @@ void GLOPInterface::SetLpAlgorithm(int value) {
     case MPSolverParameters::PRIMAL:
       parameters_.set_use_dual_simplex(false);
       break;
+    case MPSolverParameters::BARRIER:
+      // Glop has no barrier algorithm, but its non-simplex algorithm, the
+      // first-order PDHG, serves the same purpose on very large problems.
+      parameters_.set_use_pdhg(true);
+      break;
     default:
       if (value != MPSolverParameters::kDefaultIntegerParamValue) {
         SetIntegerParamToUnsupportedValue(MPSolverParameters::LP_ALGORITHM,
@@ -482,6 +615,7 @@ bool GLOPInterface::SetSolverSpecificParametersAsString(
 #else
   const bool ok = google::protobuf::TextFormat::MergeFromString(parameters, &parameters_);
   lp_solver_.SetParameters(parameters_);
+  branch_and_bound_.SetParameters(parameters_);
   return ok;
 #endif
 }
@@ -492,8 +626,8 @@ void GLOPInterface::NonIncrementalChange() {
 }
 
 // Register GLOP in the global linear solver factory.
-MPSolverInterface* BuildGLOPInterface(MPSolver* const solver) {
-  return new GLOPInterface(solver);
+MPSolverInterface* BuildGLOPInterface(bool mip, MPSolver* const solver) {
+  return new GLOPInterface(solver, mip);
 }
 
 
@@ -310,7 +310,7 @@ extern MPSolverInterface* BuildGLPKInterface(bool mip, MPSolver* const solver);
 extern MPSolverInterface* BuildBopInterface(MPSolver* const solver);
 #endif
 #if defined(USE_GLOP)
-extern MPSolverInterface* BuildGLOPInterface(MPSolver* const solver);
+extern MPSolverInterface* BuildGLOPInterface(bool mip, MPSolver* const solver);
 #endif
 #if defined(USE_SCIP)
 extern MPSolverInterface* BuildSCIPInterface(MPSolver* const solver);
@@ -327,7 +327,7 @@ extern MPSolverInterface* BuildCplexInterface(bool mip, MPSolver* const solver);
 #endif
 
 #ifdef ANDROID_JNI
-extern MPSolverInterface* BuildGLOPInterface(MPSolver* const solver);
+extern MPSolverInterface* BuildGLOPInterface(bool mip, MPSolver* const solver);
 #endif
 
 namespace {
@@ -340,7 +340,9 @@ MPSolverInterface* BuildSolverInterface(MPSolver* const solver) {
 #endif
 #if defined(USE_GLOP)
     case MPSolver::GLOP_LINEAR_PROGRAMMING:
-      return BuildGLOPInterface(solver);
+      return BuildGLOPInterface(false, solver);
+    case MPSolver::GLOP_MIXED_INTEGER_PROGRAMMING:
+      return BuildGLOPInterface(true, solver);
 #endif
 #if defined(USE_GLPK)
     case MPSolver::GLPK_LINEAR_PROGRAMMING:
@@ -430,6 +432,7 @@ bool MPSolver::SupportsProblemType(OptimizationProblemType problem_type) {
     #endif
     #ifdef USE_GLOP
     if (problem_type == GLOP_LINEAR_PROGRAMMING) return true;
+    if (problem_type == GLOP_MIXED_INTEGER_PROGRAMMING) return true;
     #endif
     #if defined(USE_SLM)
     if (problem_type == SULUM_LINEAR_PROGRAMMING) return true;
@@ -725,6 +728,57 @@ bool MPSolver::LoadSolutionFromProto(const MPSolutionResponse& response) {
   return true;
 }
 
+void MPSolver::ExportLpBasisToProto(MPBasisProto* basis) const {
+  basis->Clear();
+  for (const MPVariable* const var : variables_) {
+    MPBasisProto::Entry* const entry = basis->add_variable();
+    entry->set_name(var->name());
+    entry->set_status(
+        static_cast<MPBasisProto::BasisStatus>(var->basis_status()));
+  }
+  for (const MPConstraint* const ct : constraints_) {
+    MPBasisProto::Entry* const entry = basis->add_constraint();
+    entry->set_name(ct->name());
+    entry->set_status(
+        static_cast<MPBasisProto::BasisStatus>(ct->basis_status()));
+  }
+}
+
+void MPSolver::LoadLpBasisFromProto(const MPBasisProto& basis) {
+  std::vector<BasisStatus> variable_statuses(variables_.size(), FREE);
+  int num_ignored = 0;
+  for (const MPBasisProto::Entry& entry : basis.variable()) {
+    const MPVariable* const var = LookupVariableOrNull(entry.name());
+    if (var == nullptr) {
+      ++num_ignored;
+      continue;
+    }
+    variable_statuses[var->index()] = static_cast<BasisStatus>(entry.status());
+  }
+  std::vector<BasisStatus> constraint_statuses(constraints_.size(), BASIC);
+  for (const MPBasisProto::Entry& entry : basis.constraint()) {
+    const MPConstraint* const ct = LookupConstraintOrNull(entry.name());
+    if (ct == nullptr) {
+      ++num_ignored;
+      continue;
+    }
+    constraint_statuses[ct->index()] = static_cast<BasisStatus>(entry.status());
+  }
+  VLOG(1) << num_ignored << " basis entries do not match the model.";
+  SetStartingLpBasis(variable_statuses, constraint_statuses);
+}
+
+void MPSolver::SetStartingLpBasis(
+    const std::vector<BasisStatus>& variable_statuses,
+    const std::vector<BasisStatus>& constraint_statuses) {
+  if (variable_statuses.size() != variables_.size() ||
+      constraint_statuses.size() != constraints_.size()) {
+    LOG(DFATAL) << "The starting basis does not have the model dimensions.";
+    return;
+  }
+  interface_->SetStartingLpBasis(variable_statuses, constraint_statuses);
+}
+
 void MPSolver::Clear() {
   MutableObjective()->Clear();
   STLDeleteElements(&variables_);
@@ -1135,6 +1189,22 @@ bool MPSolver::ExportModelAsMpsFormat(bool fixed_format, bool obfuscate,
   MPModelProtoExporter exporter(proto);
   return exporter.ExportModelAsMpsFormat(fixed_format, obfuscate, output);
 }
+
+bool MPSolver::ExportModelAsLpFormat(bool obfuscate,
+                                     MPModelExportOutput* output) {
+  MPModelProto proto;
+  ExportModelToProto(&proto);
+  MPModelProtoExporter exporter(proto);
+  return exporter.ExportModelAsLpFormat(obfuscate, output);
+}
+
+bool MPSolver::ExportModelAsMpsFormat(bool fixed_format, bool obfuscate,
+                                      MPModelExportOutput* output) {
+  MPModelProto proto;
+  ExportModelToProto(&proto);
+  MPModelProtoExporter exporter(proto);
+  return exporter.ExportModelAsMpsFormat(fixed_format, obfuscate, output);
+}
 #endif
 
 // ---------- MPSolverInterface ----------
@@ -1255,7 +1325,8 @@ void MPSolverInterface::SetCommonParameters(const MPSolverParameters& param) {
 // than for the rest of the solvers.
 //
 #if defined(USE_GLOP)
-  if (solver_->ProblemType() != MPSolver::GLOP_LINEAR_PROGRAMMING) {
+  if (solver_->ProblemType() != MPSolver::GLOP_LINEAR_PROGRAMMING &&
+      solver_->ProblemType() != MPSolver::GLOP_MIXED_INTEGER_PROGRAMMING) {
 #endif
     SetPrimalTolerance(
         param.GetDoubleParam(MPSolverParameters::PRIMAL_TOLERANCE));
@@ -1284,6 +1355,12 @@ void MPSolverInterface::SetMIPParameters(const MPSolverParameters& param) {
 #endif
 }
 
+void MPSolverInterface::SetStartingLpBasis(
+    const std::vector<MPSolver::BasisStatus>& variable_statuses,
+    const std::vector<MPSolver::BasisStatus>& constraint_statuses) {
+  LOG(WARNING) << "This solver does not support a starting basis.";
+}
+
 void MPSolverInterface::SetUnsupportedDoubleParam(
     MPSolverParameters::DoubleParam param) const {
   LOG(WARNING) << "Trying to set an unsupported parameter: " << param << ".";
@@ -151,6 +151,7 @@
 namespace operations_research {
 
 class MPConstraint;
+class MPModelExportOutput;
 class MPObjective;
 class MPSolverInterface;
 class MPSolverParameters;
@@ -207,6 +208,9 @@ class MPSolver {
     #if defined(USE_BOP)
     BOP_INTEGER_PROGRAMMING = 12,
     #endif
+    #if defined(USE_GLOP)
+    GLOP_MIXED_INTEGER_PROGRAMMING = 14,
+    #endif
   };
 
   MPSolver(const std::string& name, OptimizationProblemType problem_type);
@@ -418,6 +422,20 @@ class MPSolver {
   // VerifySolution() for that.
   bool LoadSolutionFromProto(const MPSolutionResponse& response);
 
+  // Advanced usage: exports the basis of the last solve of a linear program,
+  // keyed by the variable and constraint names, so that it can be saved and
+  // used with LoadLpBasisFromProto() to warm-start the solve of the same or of
+  // a slightly modified model, for instance in another process. This has the
+  // same requirements as MPVariable::basis_status().
+  void ExportLpBasisToProto(MPBasisProto* basis) const;
+
+  // Advanced usage: warm-starts the next Solve() from the given basis (see
+  // SetStartingLpBasis()). The entries of the proto are matched by name, and
+  // the ones that do not correspond to a variable or constraint of the model
+  // are ignored. The variables without an entry are nonbasic, at a bound
+  // chosen by the solver, and the constraints without an entry are basic.
+  void LoadLpBasisFromProto(const MPBasisProto& basis);
+
   // ----- Export model to files or strings -----
 #ifndef ANDROID_JNI
   // Shortcuts to the homonymous MPModelProtoExporter methods, via
@@ -425,6 +443,12 @@ class MPSolver {
   bool ExportModelAsLpFormat(bool obfuscated, std::string* model_str);
   bool ExportModelAsMpsFormat(bool fixed_format, bool obfuscated,
                               std::string* model_str);
+
+  // Same as above, but the model is written incrementally to 'output' (for
+  // instance a file, see model_exporter.h) instead of a std::string.
+  bool ExportModelAsLpFormat(bool obfuscated, MPModelExportOutput* output);
+  bool ExportModelAsMpsFormat(bool fixed_format, bool obfuscated,
+                              MPModelExportOutput* output);
 #endif
   // ----- Misc -----
 
@@ -447,6 +471,15 @@ class MPSolver {
     BASIC
   };
 
+  // Advanced usage: warm-starts the next Solve() of a linear program from the
+  // given basis, whose statuses are in the same order as the variables and
+  // constraints of the model. The basis does not need to be valid: the solver
+  // repairs it if needed. This is only supported by GLOP_LINEAR_PROGRAMMING,
+  // which then solves the problem without presolve, and is ignored with a
+  // warning by the other solvers.
+  void SetStartingLpBasis(const std::vector<BasisStatus>& variable_statuses,
+                          const std::vector<BasisStatus>& constraint_statuses);
+
   // Infinity. You can use -MPSolver::infinity() for negative infinity.
   static double infinity() { return std::numeric_limits<double>::infinity(); }
 
@@ -1151,6 +1184,12 @@ class MPSolverInterface {
   // Returns the basis status of a constraint.
   virtual MPSolver::BasisStatus column_status(int variable_index) const = 0;
 
+  // Sets the basis used to warm-start the next solve, see
+  // MPSolver::SetStartingLpBasis(). The default implementation logs a warning.
+  virtual void SetStartingLpBasis(
+      const std::vector<MPSolver::BasisStatus>& variable_statuses,
+      const std::vector<MPSolver::BasisStatus>& constraint_statuses);
+
   // Checks whether the solution is synchronized with the model, i.e. whether
   // the model has changed since the solution was computed last.
   // If it isn't, it crashes in NDEBUG, and returns false othwerwise.
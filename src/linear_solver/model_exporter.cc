@@ -23,8 +23,11 @@
 #include "base/join.h"
 #include "base/strutil.h"
 #include "base/map_util.h"
+#include "base/file.h"
+#include "base/threadpool.h"
 #include "linear_solver/linear_solver.pb.h"
 #include "util/fp_utils.h"
+#include "zlib.h"
 
 DEFINE_bool(lp_shows_unused_variables, false,
             "Decides wether variable unused in the objective and constraints"
@@ -37,14 +40,50 @@ DEFINE_int32(lp_max_line_length, 10000,
 DEFINE_bool(lp_log_invalid_name, false,
             "Whether to log invalid variable and contraint names.");
 
+DEFINE_int32(model_export_threads, 1,
+             "Number of threads used to format the columns of the exported "
+             ".mps files and the constraints of the exported .lp files.");
+
 namespace operations_research {
 
+bool StringExportOutput::Write(const char* data, size_t size) {
+  output_->append(data, size);
+  return true;
+}
+
+bool FileExportOutput::Write(const char* data, size_t size) {
+  return file_->Write(data, size) == size;
+}
+
+GzipFileExportOutput::GzipFileExportOutput(const std::string& file_name)
+    : file_(gzopen(file_name.c_str(), "wb")) {
+  LOG_IF(ERROR, file_ == nullptr) << "Cannot open " << file_name;
+}
+
+GzipFileExportOutput::~GzipFileExportOutput() {
+  if (file_ != nullptr) gzclose(file_);
+}
+
+bool GzipFileExportOutput::Write(const char* data, size_t size) {
+  if (file_ == nullptr) return false;
+  // gzwrite() takes an unsigned int size.
+  const size_t kMaxWriteSize = 1 << 30;
+  while (size > 0) {
+    const unsigned int write_size = std::min(size, kMaxWriteSize);
+    if (gzwrite(file_, data, write_size) != write_size) return false;
+    data += write_size;
+    size -= write_size;
+  }
+  return true;
+}
+
 MPModelProtoExporter::MPModelProtoExporter(const MPModelProto& proto)
     : proto_(proto),
       num_integer_variables_(0),
       num_binary_variables_(0),
       num_continuous_variables_(0),
-      current_mps_column_(0),
+      output_(nullptr),
+      output_ok_(true),
       use_fixed_mps_format_(false),
       use_obfuscated_names_(false) {}
 
@@ -226,6 +265,64 @@ bool IsBoolean(const MPVariableProto& var) {
 }
 }  // namespace
 
+namespace {
+// Size above which the sections formatted sequentially are written out.
+const size_t kExportBufferSize = 1 << 20;
+
+// Number of variables or constraints formatted together in a chunk.
+const int kNumItemsPerChunk = 10000;
+
+void CallAppend(const std::function<void(int, int, std::string*)>* append,
+                int begin, int end, std::string* output) {
+  (*append)(begin, end, output);
+}
+}  // namespace
+
+void MPModelProtoExporter::StartSection(const std::string& header) {
+  pending_section_header_ = header;
+}
+
+void MPModelProtoExporter::WriteChunk(std::string* chunk) {
+  if (chunk->empty()) return;
+  if (output_ok_ && !pending_section_header_.empty()) {
+    output_ok_ = output_->Write(pending_section_header_.data(),
+                                pending_section_header_.size());
+  }
+  pending_section_header_.clear();
+  if (output_ok_) output_ok_ = output_->Write(chunk->data(), chunk->size());
+  chunk->clear();
+}
+
+void MPModelProtoExporter::WriteChunkIfFull(std::string* chunk) {
+  if (chunk->size() >= kExportBufferSize) WriteChunk(chunk);
+}
+
+void MPModelProtoExporter::FormatAndWriteInChunks(
+    int num_items,
+    const std::function<void(int, int, std::string*)>& append) {
+  const int num_threads = std::max(1, FLAGS_model_export_threads);
+  std::vector<std::string> chunks(num_threads);
+  const int batch_size = num_threads * kNumItemsPerChunk;
+  for (int batch_begin = 0; batch_begin < num_items && output_ok_;
+       batch_begin += batch_size) {
+    const int batch_end = std::min(num_items, batch_begin + batch_size);
+    if (num_threads == 1) {
+      append(batch_begin, batch_end, &chunks[0]);
+    } else {
+      // The pool waits for all the chunks to be formatted when it is destroyed.
+      ThreadPool pool("ModelExporter", num_threads);
+      pool.StartWorkers();
+      for (int i = 0; i < num_threads; ++i) {
+        const int begin =
+            std::min(batch_end, batch_begin + i * kNumItemsPerChunk);
+        const int end = std::min(batch_end, begin + kNumItemsPerChunk);
+        pool.Add(NewCallback(&CallAppend, &append, begin, end, &chunks[i]));
+      }
+    }
+    for (std::string& chunk : chunks) WriteChunk(&chunk);
+  }
+}
+
 void MPModelProtoExporter::Setup() {
   num_binary_variables_ = 0;
   num_integer_variables_ = 0;
@@ -245,37 +342,131 @@ void MPModelProtoExporter::Setup() {
 bool MPModelProtoExporter::ExportModelAsLpFormat(bool obfuscated,
                                                  std::string* output) {
   output->clear();
+  StringExportOutput string_output(output);
+  return ExportModelAsLpFormat(obfuscated, &string_output);
+}
+
+bool MPModelProtoExporter::ExportModelAsLpFormat(bool obfuscated,
+                                                 MPModelExportOutput* output) {
   Setup();
   exported_constraint_names_ =
       ExtractAndProcessNames(proto_.constraint(), "C", obfuscated);
   exported_variable_names_ =
       ExtractAndProcessNames(proto_.variable(), "V", obfuscated);
 
+  // Check the variable indices before writing anything, so that the
+  // constraints can be formatted in parallel without errors. This also
+  // computes which variables appear in the model.
+  std::vector<bool> show_variable(proto_.variable_size(),
+                                  FLAGS_lp_shows_unused_variables);
+  for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
+    const double coeff = proto_.variable(var_index).objective_coefficient();
+    show_variable[var_index] = coeff != 0.0 || FLAGS_lp_shows_unused_variables;
+  }
+  for (const MPConstraintProto& ct_proto : proto_.constraint()) {
+    for (int i = 0; i < ct_proto.var_index_size(); ++i) {
+      const int var_index = ct_proto.var_index(i);
+      if (var_index < 0 || var_index >= proto_.variable_size()) {
+        LOG(DFATAL) << "Reference to out-of-bounds variable index # "
+                    << var_index;
+        return false;
+      }
+      show_variable[var_index] =
+          ct_proto.coefficient(i) != 0.0 || FLAGS_lp_shows_unused_variables;
+    }
+  }
+  output_ = output;
+  output_ok_ = true;
+  StartSection(std::string());
+
   // Comments section.
-  AppendComments("\\", output);
+  std::string chunk;
+  AppendComments("\\", &chunk);
 
   // Objective
-  StrAppend(output, proto_.maximize() ? "Maximize\n" : "Minimize\n");
+  StrAppend(&chunk, proto_.maximize() ? "Maximize\n" : "Minimize\n");
   LineBreaker obj_line_breaker(FLAGS_lp_max_line_length);
   obj_line_breaker.Append(" Obj: ");
   if (proto_.objective_offset() != 0.0) {
     obj_line_breaker.Append(StringPrintf("%-+.16G Constant ",
                                          proto_.objective_offset()));
   }
-  std::vector<bool> show_variable(proto_.variable_size(),
-                             FLAGS_lp_shows_unused_variables);
   for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
     const double coeff = proto_.variable(var_index).objective_coefficient();
     std::string term;
-    if (!WriteLpTerm(var_index, coeff, &term)) {
-      return false;
-    }
+    WriteLpTerm(var_index, coeff, &term);
     obj_line_breaker.Append(term);
-    show_variable[var_index] = coeff != 0.0 || FLAGS_lp_shows_unused_variables;
   }
   // Constraints
-  StrAppend(output, obj_line_breaker.GetOutput(), "\nSubject to\n");
-  for (int cst_index = 0; cst_index < proto_.constraint_size(); ++cst_index) {
+  StrAppend(&chunk, obj_line_breaker.GetOutput(), "\nSubject to\n");
+  WriteChunk(&chunk);
+  FormatAndWriteInChunks(proto_.constraint_size(),
+                         [this](int begin, int end, std::string* output) {
+    AppendLpConstraints(begin, end, output);
+  });
+
+  // Bounds
+  StringAppendF(&chunk, "Bounds\n");
+  if (proto_.objective_offset() != 0.0) {
+    StringAppendF(&chunk, " 1 <= Constant <= 1\n");
+  }
+  for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
+    if (!show_variable[var_index]) continue;
+    const MPVariableProto& var_proto = proto_.variable(var_index);
+    const double lb = var_proto.lower_bound();
+    const double ub = var_proto.upper_bound();
+    if (var_proto.is_integer() && lb == round(lb) && ub == round(ub)) {
+      StringAppendF(&chunk, " %.0f <= %s <= %.0f\n", lb,
+                    exported_variable_names_[var_index].c_str(), ub);
+    } else {
+      if (lb != -std::numeric_limits<double>::infinity()) {
+        StringAppendF(&chunk, " %-.16G <= ", lb);
+      }
+      StringAppendF(&chunk, "%s", exported_variable_names_[var_index].c_str());
+      if (ub != std::numeric_limits<double>::infinity()) {
+        StringAppendF(&chunk, " <= %-.16G", ub);
+      }
+      StringAppendF(&chunk, "\n");
+    }
+    WriteChunkIfFull(&chunk);
+  }
+
+  // Binaries
+  if (num_binary_variables_ > 0) {
+    StringAppendF(&chunk, "Binaries\n");
+    for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
+      if (!show_variable[var_index]) continue;
+      const MPVariableProto& var_proto = proto_.variable(var_index);
+      if (IsBoolean(var_proto)) {
+        StringAppendF(&chunk, " %s\n",
+                      exported_variable_names_[var_index].c_str());
+        WriteChunkIfFull(&chunk);
+      }
+    }
+  }
+
+  // Generals
+  if (num_integer_variables_ > 0) {
+    StringAppendF(&chunk, "Generals\n");
+    for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
+      if (!show_variable[var_index]) continue;
+      const MPVariableProto& var_proto = proto_.variable(var_index);
+      if (var_proto.is_integer() && !IsBoolean(var_proto)) {
+        StringAppendF(&chunk, " %s\n",
+                      exported_variable_names_[var_index].c_str());
+        WriteChunkIfFull(&chunk);
+      }
+    }
+  }
+  StringAppendF(&chunk, "End\n");
+  WriteChunk(&chunk);
+  output_ = nullptr;
+  return output_ok_;
+}
+
+void MPModelProtoExporter::AppendLpConstraints(int begin, int end,
+                                               std::string* output) const {
+  for (int cst_index = begin; cst_index < end; ++cst_index) {
     const MPConstraintProto& ct_proto = proto_.constraint(cst_index);
     const std::string& name = exported_constraint_names_[cst_index];
     LineBreaker line_breaker(FLAGS_lp_max_line_length);
@@ -284,15 +475,10 @@ bool MPModelProtoExporter::ExportModelAsLpFormat(bool obfuscated,
     // the formatting characters here.
     line_breaker.Consume(kNumFormattingChars + name.size());
     for (int i = 0; i < ct_proto.var_index_size(); ++i) {
-      const int var_index = ct_proto.var_index(i);
-      const double coeff = ct_proto.coefficient(i);
       std::string term;
-      if (!WriteLpTerm(var_index, coeff, &term)) {
-        return false;
-      }
+      // The variable indices were checked by ExportModelAsLpFormat().
+      WriteLpTerm(ct_proto.var_index(i), ct_proto.coefficient(i), &term);
       line_breaker.Append(term);
-      show_variable[var_index] =
-          coeff != 0.0 || FLAGS_lp_shows_unused_variables;
     }
     const double lb = ct_proto.lower_bound();
     const double ub = ct_proto.upper_bound();
@@ -324,59 +510,6 @@ bool MPModelProtoExporter::ExportModelAsLpFormat(bool obfuscated,
       }
     }
   }
-
-  // Bounds
-  StringAppendF(output, "Bounds\n");
-  if (proto_.objective_offset() != 0.0) {
-    StringAppendF(output, " 1 <= Constant <= 1\n");
-  }
-  for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
-    if (!show_variable[var_index]) continue;
-    const MPVariableProto& var_proto = proto_.variable(var_index);
-    const double lb = var_proto.lower_bound();
-    const double ub = var_proto.upper_bound();
-    if (var_proto.is_integer() && lb == round(lb) && ub == round(ub)) {
-      StringAppendF(output, " %.0f <= %s <= %.0f\n", lb,
-                    exported_variable_names_[var_index].c_str(), ub);
-    } else {
-      if (lb != -std::numeric_limits<double>::infinity()) {
-        StringAppendF(output, " %-.16G <= ", lb);
-      }
-      StringAppendF(output, "%s", exported_variable_names_[var_index].c_str());
-      if (ub != std::numeric_limits<double>::infinity()) {
-        StringAppendF(output, " <= %-.16G", ub);
-      }
-      StringAppendF(output, "\n");
-    }
-  }
-
-  // Binaries
-  if (num_binary_variables_ > 0) {
-    StringAppendF(output, "Binaries\n");
-    for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
-      if (!show_variable[var_index]) continue;
-      const MPVariableProto& var_proto = proto_.variable(var_index);
-      if (IsBoolean(var_proto)) {
-        StringAppendF(output, " %s\n",
-                      exported_variable_names_[var_index].c_str());
-      }
-    }
-  }
-
-  // Generals
-  if (num_integer_variables_ > 0) {
-    StringAppendF(output, "Generals\n");
-    for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
-      if (!show_variable[var_index]) continue;
-      const MPVariableProto& var_proto = proto_.variable(var_index);
-      if (var_proto.is_integer() && !IsBoolean(var_proto)) {
-        StringAppendF(output, " %s\n",
-                      exported_variable_names_[var_index].c_str());
-      }
-    }
-  }
-  StringAppendF(output, "End\n");
-  return true;
 }
 
 void MPModelProtoExporter::AppendMpsPair(const std::string& name, double value,
@@ -410,15 +543,14 @@ void MPModelProtoExporter::AppendMpsLineHeaderWithNewLine(
   *output += "\n";
 }
 
-void MPModelProtoExporter::AppendMpsTermWithContext(const std::string& head_name,
-                                                    const std::string& name,
-                                                    double value,
-                                                    std::string* output) {
-  if (current_mps_column_ == 0) {
+void MPModelProtoExporter::AppendMpsTermWithContext(
+    const std::string& head_name, const std::string& name, double value,
+    int* current_mps_column, std::string* output) const {
+  if (*current_mps_column == 0) {
     AppendMpsLineHeader("", head_name, output);
   }
   AppendMpsPair(name, value, output);
-  AppendNewLineIfTwoColumns(output);
+  AppendNewLineIfTwoColumns(current_mps_column, output);
 }
 
 void MPModelProtoExporter::AppendMpsBound(const std::string& bound_type,
@@ -429,34 +561,37 @@ void MPModelProtoExporter::AppendMpsBound(const std::string& bound_type,
   *output += "\n";
 }
 
-void MPModelProtoExporter::AppendNewLineIfTwoColumns(std::string* output) {
-  ++current_mps_column_;
-  if (current_mps_column_ == 2) {
+void MPModelProtoExporter::AppendNewLineIfTwoColumns(
+    int* current_mps_column, std::string* output) const {
+  ++*current_mps_column;
+  if (*current_mps_column == 2) {
     *output += "\n";
-    current_mps_column_ = 0;
+    *current_mps_column = 0;
   }
 }
 
 void MPModelProtoExporter::AppendMpsColumns(bool integrality,
-    const std::vector<std::vector<std::pair<int, double>>>& transpose, std::string* output) {
-  current_mps_column_ = 0;
-  for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
+                                            const Transpose& transpose,
+                                            int begin, int end,
+                                            std::string* output) const {
+  for (int var_index = begin; var_index < end; ++var_index) {
     const MPVariableProto& var_proto = proto_.variable(var_index);
     if (var_proto.is_integer() != integrality) continue;
     const std::string& var_name = exported_variable_names_[var_index];
-    current_mps_column_ = 0;
+    int current_mps_column = 0;
     if (var_proto.objective_coefficient() != 0.0) {
       AppendMpsTermWithContext(var_name, "COST",
                                var_proto.objective_coefficient(),
-                               output);
+                               &current_mps_column, output);
     }
-    for (const std::pair<int, double> cst_index_and_coeff : transpose[var_index]) {
+    for (const std::pair<int, double> cst_index_and_coeff :
+         transpose[var_index]) {
       const std::string& cst_name =
           exported_constraint_names_[cst_index_and_coeff.first];
       AppendMpsTermWithContext(var_name, cst_name, cst_index_and_coeff.second,
-                               output);
+                               &current_mps_column, output);
     }
-    AppendNewLineIfTwoColumns(output);
+    AppendNewLineIfTwoColumns(&current_mps_column, output);
   }
 }
 
@@ -464,6 +599,13 @@ bool MPModelProtoExporter::ExportModelAsMpsFormat(bool fixed_format,
                                                   bool obfuscated,
                                                   std::string* output) {
   output->clear();
+  StringExportOutput string_output(output);
+  return ExportModelAsMpsFormat(fixed_format, obfuscated, &string_output);
+}
+
+bool MPModelProtoExporter::ExportModelAsMpsFormat(bool fixed_format,
+                                                  bool obfuscated,
+                                                  MPModelExportOutput* output) {
   Setup();
   use_fixed_mps_format_ = fixed_format;
   exported_constraint_names_ =
@@ -474,39 +616,12 @@ bool MPModelProtoExporter::ExportModelAsMpsFormat(bool fixed_format,
   // use_fixed_mps_format_ was possibly modified by ExtractAndProcessNames().
   LOG_IF(WARNING, fixed_format && !use_fixed_mps_format_)
       << "Cannot use fixed format. Falling back to free format";
-  // Comments.
-  AppendComments("*", output);
-
-  // NAME section.
-  StringAppendF(output, "%-14s%s\n", "NAME", proto_.name().c_str());
-
-  // ROWS section.
-  current_mps_column_ = 0;
-  std::string rows_section;
-  AppendMpsLineHeaderWithNewLine("N", "COST", &rows_section);
-  for (int cst_index = 0; cst_index < proto_.constraint_size(); ++cst_index) {
-    const MPConstraintProto& ct_proto = proto_.constraint(cst_index);
-    const double lb = ct_proto.lower_bound();
-    const double ub = ct_proto.upper_bound();
-    const std::string& cst_name = exported_constraint_names_[cst_index];
-    if (lb == ub) {
-      AppendMpsLineHeaderWithNewLine("E", cst_name, &rows_section);
-    } else if (lb == -std::numeric_limits<double>::infinity()) {
-      DCHECK_NE(std::numeric_limits<double>::infinity(), ub);
-      AppendMpsLineHeaderWithNewLine("L", cst_name, &rows_section);
-    } else {
-      DCHECK_NE(-std::numeric_limits<double>::infinity(), lb);
-      AppendMpsLineHeaderWithNewLine("G", cst_name, &rows_section);
-    }
-  }
-  if (!rows_section.empty()) {
-    *output += "ROWS\n" + rows_section;
-  }
 
   // As the information regarding a column needs to be contiguous, we create
   // a vector associating a variable index to a vector containing the indices
-  // of the constraints where this variable appears.
-  std::vector<std::vector<std::pair<int, double>>> transpose(proto_.variable_size());
+  // of the constraints where this variable appears. This is done before
+  // writing anything, so that nothing is output for an invalid model.
+  Transpose transpose(proto_.variable_size());
   for (int cst_index = 0; cst_index < proto_.constraint_size(); ++cst_index) {
     const MPConstraintProto& ct_proto = proto_.constraint(cst_index);
     for (int k = 0; k < ct_proto.var_index_size(); ++k) {
@@ -522,60 +637,99 @@ bool MPModelProtoExporter::ExportModelAsMpsFormat(bool fixed_format,
       }
     }
   }
+  output_ = output;
+  output_ok_ = true;
+  StartSection(std::string());
+
+  // Comments.
+  std::string chunk;
+  AppendComments("*", &chunk);
+
+  // NAME section.
+  StringAppendF(&chunk, "%-14s%s\n", "NAME", proto_.name().c_str());
+  WriteChunk(&chunk);
 
-  // COLUMNS section.
-  std::string columns_section;
-  AppendMpsColumns(/*integrality=*/true, transpose, &columns_section);
-  if (!columns_section.empty()) {
-    const char* const kIntMarkerFormat = "  %-10s%-36s%-10s\n";
-    columns_section = StringPrintf(kIntMarkerFormat, "INTSTART",
-                                   "'MARKER'", "'INTORG'") + columns_section;
-    StringAppendF(&columns_section, kIntMarkerFormat,
-                  "INTEND", "'MARKER'", "'INTEND'");
+  // ROWS section.
+  StartSection("ROWS\n");
+  AppendMpsLineHeaderWithNewLine("N", "COST", &chunk);
+  for (int cst_index = 0; cst_index < proto_.constraint_size(); ++cst_index) {
+    const MPConstraintProto& ct_proto = proto_.constraint(cst_index);
+    const double lb = ct_proto.lower_bound();
+    const double ub = ct_proto.upper_bound();
+    const std::string& cst_name = exported_constraint_names_[cst_index];
+    if (lb == ub) {
+      AppendMpsLineHeaderWithNewLine("E", cst_name, &chunk);
+    } else if (lb == -std::numeric_limits<double>::infinity()) {
+      DCHECK_NE(std::numeric_limits<double>::infinity(), ub);
+      AppendMpsLineHeaderWithNewLine("L", cst_name, &chunk);
+    } else {
+      DCHECK_NE(-std::numeric_limits<double>::infinity(), lb);
+      AppendMpsLineHeaderWithNewLine("G", cst_name, &chunk);
+    }
+    WriteChunkIfFull(&chunk);
   }
-  AppendMpsColumns(/*integrality=*/false, transpose, &columns_section);
-  if (!columns_section.empty()) {
-    *output += "COLUMNS\n" + columns_section;
+  WriteChunk(&chunk);
+
+  // COLUMNS section. The integer columns are surrounded by markers, which are
+  // only output if there is at least one such column.
+  const char* const kIntMarkerFormat = "  %-10s%-36s%-10s\n";
+  StartSection(StrCat("COLUMNS\n", StringPrintf(kIntMarkerFormat, "INTSTART",
+                                                "'MARKER'", "'INTORG'")));
+  FormatAndWriteInChunks(proto_.variable_size(),
+                         [this, &transpose](int begin, int end,
+                                            std::string* output) {
+    AppendMpsColumns(/*integrality=*/true, transpose, begin, end, output);
+  });
+  if (pending_section_header_.empty()) {
+    StringAppendF(&chunk, kIntMarkerFormat, "INTEND", "'MARKER'", "'INTEND'");
+    WriteChunk(&chunk);
+  } else {
+    StartSection("COLUMNS\n");
   }
+  FormatAndWriteInChunks(proto_.variable_size(),
+                         [this, &transpose](int begin, int end,
+                                            std::string* output) {
+    AppendMpsColumns(/*integrality=*/false, transpose, begin, end, output);
+  });
 
   // RHS (right-hand-side) section.
-  current_mps_column_ = 0;
-  std::string rhs_section;
+  StartSection("RHS\n");
+  int current_mps_column = 0;
   for (int cst_index = 0; cst_index < proto_.constraint_size(); ++cst_index) {
     const MPConstraintProto& ct_proto = proto_.constraint(cst_index);
     const double lb = ct_proto.lower_bound();
     const double ub = ct_proto.upper_bound();
     const std::string& cst_name = exported_constraint_names_[cst_index];
     if (lb != -std::numeric_limits<double>::infinity()) {
-      AppendMpsTermWithContext("RHS", cst_name, lb, &rhs_section);
+      AppendMpsTermWithContext("RHS", cst_name, lb, &current_mps_column,
+                               &chunk);
     } else if (ub != +std::numeric_limits<double>::infinity()) {
-      AppendMpsTermWithContext("RHS", cst_name, ub, &rhs_section);
+      AppendMpsTermWithContext("RHS", cst_name, ub, &current_mps_column,
+                               &chunk);
     }
+    WriteChunkIfFull(&chunk);
   }
-  AppendNewLineIfTwoColumns(&rhs_section);
-  if (!rhs_section.empty()) {
-    *output += "RHS\n" + rhs_section;
-  }
+  AppendNewLineIfTwoColumns(&current_mps_column, &chunk);
+  WriteChunk(&chunk);
 
   // RANGES section.
-  current_mps_column_ = 0;
-  std::string ranges_section;
+  StartSection("RANGES\n");
+  current_mps_column = 0;
   for (int cst_index = 0; cst_index < proto_.constraint_size(); ++cst_index) {
     const MPConstraintProto& ct_proto = proto_.constraint(cst_index);
     const double range = fabs(ct_proto.upper_bound() - ct_proto.lower_bound());
     if (range != 0.0 && range != +std::numeric_limits<double>::infinity()) {
       const std::string& cst_name = exported_constraint_names_[cst_index];
-      AppendMpsTermWithContext("RANGE", cst_name, range, &ranges_section);
+      AppendMpsTermWithContext("RANGE", cst_name, range, &current_mps_column,
+                               &chunk);
+      WriteChunkIfFull(&chunk);
     }
   }
-  AppendNewLineIfTwoColumns(&ranges_section);
-  if (!ranges_section.empty()) {
-    *output += "RANGES\n" + ranges_section;
-  }
+  AppendNewLineIfTwoColumns(&current_mps_column, &chunk);
+  WriteChunk(&chunk);
 
   // BOUNDS section.
-  current_mps_column_ = 0;
-  std::string bounds_section;
+  StartSection("BOUNDS\n");
   for (int var_index = 0; var_index < proto_.variable_size(); ++var_index) {
     const MPVariableProto& var_proto = proto_.variable(var_index);
     const double lb = var_proto.lower_bound();
@@ -583,42 +737,44 @@ bool MPModelProtoExporter::ExportModelAsMpsFormat(bool fixed_format,
     const std::string& var_name = exported_variable_names_[var_index];
     if (var_proto.is_integer()) {
       if (IsBoolean(var_proto)) {
-        AppendMpsLineHeader("BV", "BOUND", &bounds_section);
-        StringAppendF(&bounds_section, "  %s\n", var_name.c_str());
+        AppendMpsLineHeader("BV", "BOUND", &chunk);
+        StringAppendF(&chunk, "  %s\n", var_name.c_str());
       } else {
         if (lb != 0.0) {
-          AppendMpsBound("LI", var_name, lb, &bounds_section);
+          AppendMpsBound("LI", var_name, lb, &chunk);
         }
         if (ub != +std::numeric_limits<double>::infinity()) {
-          AppendMpsBound("UI", var_name, ub, &bounds_section);
+          AppendMpsBound("UI", var_name, ub, &chunk);
         }
       }
     } else {
       if (lb == -std::numeric_limits<double>::infinity() &&
           ub == +std::numeric_limits<double>::infinity()) {
-        AppendMpsLineHeader("FR", "BOUND", &bounds_section);
-        StringAppendF(&bounds_section, "  %s\n", var_name.c_str());
+        AppendMpsLineHeader("FR", "BOUND", &chunk);
+        StringAppendF(&chunk, "  %s\n", var_name.c_str());
       } else if (lb == ub) {
-        AppendMpsBound("FX", var_name, lb, &bounds_section);
+        AppendMpsBound("FX", var_name, lb, &chunk);
       } else {
         if (lb != 0.0) {
-          AppendMpsBound("LO", var_name, lb, &bounds_section);
+          AppendMpsBound("LO", var_name, lb, &chunk);
         } else if (ub == +std::numeric_limits<double>::infinity()) {
-          AppendMpsLineHeader("PL", "BOUND", &bounds_section);
-          StringAppendF(&bounds_section, "  %s\n", var_name.c_str());
+          AppendMpsLineHeader("PL", "BOUND", &chunk);
+          StringAppendF(&chunk, "  %s\n", var_name.c_str());
         }
         if (ub != +std::numeric_limits<double>::infinity()) {
-          AppendMpsBound("UP", var_name, ub, &bounds_section);
+          AppendMpsBound("UP", var_name, ub, &chunk);
         }
       }
     }
+    WriteChunkIfFull(&chunk);
   }
-  if (!bounds_section.empty()) {
-    *output += "BOUNDS\n" + bounds_section;
-  }
+  WriteChunk(&chunk);
 
-  *output += "ENDATA\n";
-  return true;
+  StartSection(std::string());
+  chunk = "ENDATA\n";
+  WriteChunk(&chunk);
+  output_ = nullptr;
+  return output_ok_;
 }
 
 }  // namespace operations_research
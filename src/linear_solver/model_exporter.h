@@ -15,18 +15,82 @@
 #define OR_TOOLS_LINEAR_SOLVER_MODEL_EXPORTER_H_
 
 #include "base/hash.h"
+#include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 #include "base/macros.h"
 #include "base/hash.h"
 
+struct gzFile_s;
+
 namespace operations_research {
 
+class File;
 class MPConstraint;
 class MPObjective;
 class MPVariable;
 
 class MPModelProto;
 
+// Destination of a model exported by MPModelProtoExporter. The exporter
+// formats the model chunk by chunk and hands each chunk to Write() as soon as
+// it is complete, so the whole text of the model is never held in memory
+// unless the output itself keeps it there (like StringExportOutput).
+class MPModelExportOutput {
+ public:
+  virtual ~MPModelExportOutput() {}
+
+  // Writes the given data at the end of the output. Returns false on error,
+  // in which case the export is aborted.
+  virtual bool Write(const char* data, size_t size) = 0;
+};
+
+// Appends the exported model to a std::string.
+class StringExportOutput : public MPModelExportOutput {
+ public:
+  // The string must live as long as this class is active.
+  explicit StringExportOutput(std::string* output) : output_(output) {}
+  bool Write(const char* data, size_t size) override;
+
+ private:
+  std::string* const output_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringExportOutput);
+};
+
+// Writes the exported model to an already opened file. The file is neither
+// flushed nor closed by this class.
+class FileExportOutput : public MPModelExportOutput {
+ public:
+  // The file must live as long as this class is active.
+  explicit FileExportOutput(File* file) : file_(file) {}
+  bool Write(const char* data, size_t size) override;
+
+ private:
+  File* const file_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileExportOutput);
+};
+
+// Writes the exported model to a gzip-compressed file, which is created (or
+// truncated) by the constructor and closed by the destructor.
+class GzipFileExportOutput : public MPModelExportOutput {
+ public:
+  explicit GzipFileExportOutput(const std::string& file_name);
+  ~GzipFileExportOutput() override;
+
+  // Returns false if the file could not be opened. Write() always fails in
+  // this case.
+  bool ok() const { return file_ != nullptr; }
+  bool Write(const char* data, size_t size) override;
+
+ private:
+  gzFile_s* file_;
+
+  DISALLOW_COPY_AND_ASSIGN(GzipFileExportOutput);
+};
+
 class MPModelProtoExporter {
  public:
   // The argument must live as long as this class is active.
@@ -83,7 +147,47 @@ class MPModelProtoExporter {
   bool ExportModelAsMpsFormat(bool fixed_format, bool obfuscated,
                               std::string* model_str);
 
+  // Same as above, but the model is written incrementally to 'output' instead
+  // of being built in a std::string. This is the way to export very large
+  // models, for instance to a FileExportOutput or a GzipFileExportOutput.
+  //
+  // The columns of the MPS format and the constraints of the LP format are
+  // formatted in parallel by --model_export_threads threads, in chunks that
+  // are written in the model order. The output does not depend on the number
+  // of threads.
+  bool ExportModelAsLpFormat(bool obfuscated, MPModelExportOutput* output);
+  bool ExportModelAsMpsFormat(bool fixed_format, bool obfuscated,
+                              MPModelExportOutput* output);
+
  private:
+  // The sparse matrix stored as a vector of columns, each containing the
+  // (constraint index, coefficient) pairs of its non-zero entries.
+  typedef std::vector<std::vector<std::pair<int, double>>> Transpose;
+
+  // Starts a new section of the output. The header is only written just before
+  // the first non-empty chunk of the section, so that empty sections are not
+  // output at all.
+  void StartSection(const std::string& header);
+
+  // Writes the given chunk to output_ (preceded by the pending section header
+  // if any) and clears it. Does nothing if the chunk is empty.
+  void WriteChunk(std::string* chunk);
+
+  // Calls WriteChunk() if the chunk is larger than the buffer size. This is
+  // used to bound the memory used by the sections formatted sequentially.
+  void WriteChunkIfFull(std::string* chunk);
+
+  // Formats the items [0, num_items) by calling append(begin, end, chunk) on
+  // consecutive ranges, and writes the resulting chunks in order. The ranges
+  // are formatted in parallel if --model_export_threads is greater than 1.
+  // append() must be thread-safe.
+  void FormatAndWriteInChunks(
+      int num_items,
+      const std::function<void(int, int, std::string*)>& append);
+
+  // Appends the LP format of the constraints [begin, end) to output.
+  void AppendLpConstraints(int begin, int end, std::string* output) const;
+
   // Computes the number of continuous, integer and binary variables.
   // Called by ExportModelAsLpFormat() and ExportModelAsMpsFormat().
   void Setup();
@@ -146,20 +250,23 @@ class MPModelProtoExporter {
   // Appends an MPS term in various contexts. The term consists of a head name,
   // a name, and a value. If the line is not empty, then only the pair
   // (name, value) is appended. The number of columns, limited to 2 by the MPS
-  // format is also taken care of.
-  void AppendMpsTermWithContext(const std::string& head_name, const std::string& name,
-                                double value, std::string* output);
+  // format is also taken care of using current_mps_column, the number of
+  // pairs already on the current line.
+  void AppendMpsTermWithContext(const std::string& head_name,
+                                const std::string& name, double value,
+                                int* current_mps_column,
+                                std::string* output) const;
 
   // Appends a new-line if two columns are already present on the MPS line.
   // Used by and in complement to AppendMpsTermWithContext.
-  void AppendNewLineIfTwoColumns(std::string* output);
+  void AppendNewLineIfTwoColumns(int* current_mps_column,
+                                 std::string* output) const;
 
-  // When 'integrality' is true, appends columns corresponding to integer
-  // variables. Appends the columns for non-integer variables otherwise.
-  // The sparse matrix must be passed as a vector of columns ('transpose').
-  void AppendMpsColumns(bool integrality,
-                        const std::vector<std::vector<std::pair<int, double>>>& transpose,
-                        std::string* output);
+  // When 'integrality' is true, appends the columns [begin, end) corresponding
+  // to integer variables. Appends the columns for non-integer variables
+  // otherwise. The sparse matrix must be passed as a vector of columns.
+  void AppendMpsColumns(bool integrality, const Transpose& transpose,
+                        int begin, int end, std::string* output) const;
 
   // Appends a line describing the bound of a variablenew-line if two columns
   // are already present on the MPS line.
@@ -184,8 +291,13 @@ class MPModelProtoExporter {
   // Number of continuous variables in proto_.
   int num_continuous_variables_;
 
-  // Current MPS file column number.
-  int current_mps_column_;
+  // Where the model is currently exported, and whether all the writes so far
+  // succeeded.
+  MPModelExportOutput* output_;
+  bool output_ok_;
+
+  // Header of the current section, if it has not been written yet.
+  std::string pending_section_header_;
 
   // True is the fixed MPS format shall be used.
   bool use_fixed_mps_format_;
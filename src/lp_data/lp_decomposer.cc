@@ -28,12 +28,14 @@ namespace glop {
 LPDecomposer::LPDecomposer()
     : original_problem_(nullptr),
       clusters_(),
+      constraint_clusters_(),
       mutex_() {}
 
 void LPDecomposer::Decompose(const LinearProgram* linear_problem) {
   MutexLock mutex_lock(&mutex_);
   original_problem_ = linear_problem;
   clusters_.clear();
+  constraint_clusters_.clear();
 
   const SparseMatrix& transposed_matrix =
       original_problem_->GetTransposeSparseMatrix();
@@ -61,6 +63,15 @@ void LPDecomposer::Decompose(const LinearProgram* linear_problem) {
   for (int i = 0; i < num_classes; ++i) {
     std::sort(clusters_[i].begin(), clusters_[i].end());
   }
+
+  // A constraint belongs to the problem of any of its variables.
+  constraint_clusters_.resize(num_classes);
+  for (ColIndex ct(0); ct < num_ct; ++ct) {
+    const SparseColumn& sparse_constraint = transposed_matrix.column(ct);
+    if (sparse_constraint.IsEmpty()) continue;
+    const int cluster = classes[sparse_constraint.GetFirstRow().value()];
+    constraint_clusters_[cluster].push_back(ColToRowIndex(ct));
+  }
 }
 
 int LPDecomposer::GetNumberOfProblems() const {
@@ -84,12 +95,9 @@ void LPDecomposer::ExtractLocalProblem(int problem_index, LinearProgram* lp) {
   const std::vector<ColIndex>& cluster = clusters_[problem_index];
   StrictITIVector<ColIndex, ColIndex> global_to_local(
       original_problem_->num_variables(), kInvalidCol);
-  SparseBitset<RowIndex> constraints_to_use(
-      original_problem_->num_constraints());
   lp->SetMaximizationProblem(original_problem_->IsMaximizationProblem());
 
-  // Create variables and get all constraints of the cluster.
-  const SparseMatrix& original_matrix = original_problem_->GetSparseMatrix();
+  // Create the variables of the cluster.
   const SparseMatrix& transposed_matrix =
       original_problem_->GetTransposeSparseMatrix();
   for (int i = 0; i < cluster.size(); ++i) {
@@ -110,14 +118,9 @@ void LPDecomposer::ExtractLocalProblem(int problem_index, LinearProgram* lp) {
         original_problem_->variable_upper_bounds()[global_col]);
     lp->SetObjectiveCoefficient(
         local_col, original_problem_->objective_coefficients()[global_col]);
-
-    for (const SparseColumn::Entry e : original_matrix.column(global_col)) {
-      constraints_to_use.Set(e.row());
-    }
   }
   // Create the constraints.
-  for (const RowIndex global_row :
-       constraints_to_use.PositionsSetAtLeastOnce()) {
+  for (const RowIndex global_row : constraint_clusters_[problem_index]) {
     const RowIndex local_row = lp->CreateNewConstraint();
     lp->SetConstraintName(local_row,
                           original_problem_->GetConstraintName(global_row));
@@ -152,6 +155,40 @@ DenseRow LPDecomposer::AggregateAssignments(
   return global_assignment;
 }
 
+void LPDecomposer::AggregateSolutions(
+    const std::vector<ProblemSolution>& solutions,
+    ProblemSolution* solution) const {
+  CHECK(solution != nullptr);
+  CHECK_EQ(solutions.size(), clusters_.size());
+
+  MutexLock mutex_lock(&mutex_);
+  const ColIndex num_cols = original_problem_->num_variables();
+  const RowIndex num_rows = original_problem_->num_constraints();
+  solution->primal_values.assign(num_cols, 0.0);
+  solution->variable_statuses.assign(num_cols, VariableStatus::FREE);
+  solution->dual_values.assign(num_rows, 0.0);
+  solution->constraint_statuses.assign(num_rows, ConstraintStatus::BASIC);
+  for (int problem = 0; problem < solutions.size(); ++problem) {
+    const ProblemSolution& local_solution = solutions[problem];
+    const std::vector<ColIndex>& cluster = clusters_[problem];
+    for (int i = 0; i < cluster.size(); ++i) {
+      const ColIndex global_col = cluster[i];
+      solution->primal_values[global_col] =
+          local_solution.primal_values[ColIndex(i)];
+      solution->variable_statuses[global_col] =
+          local_solution.variable_statuses[ColIndex(i)];
+    }
+    const std::vector<RowIndex>& constraints = constraint_clusters_[problem];
+    for (int i = 0; i < constraints.size(); ++i) {
+      const RowIndex global_row = constraints[i];
+      solution->dual_values[global_row] =
+          local_solution.dual_values[RowIndex(i)];
+      solution->constraint_statuses[global_row] =
+          local_solution.constraint_statuses[RowIndex(i)];
+    }
+  }
+}
+
 DenseRow LPDecomposer::ExtractLocalAssignment(int problem_index,
                                               const DenseRow& assignment) {
   CHECK_GE(problem_index, 0);
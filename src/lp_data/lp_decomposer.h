@@ -78,10 +78,24 @@ class LPDecomposer {
   DenseRow ExtractLocalAssignment(int problem_index, const DenseRow& assignment)
       LOCKS_EXCLUDED(mutex_);
 
+  // Same as AggregateAssignments() but for all the values and statuses of the
+  // given solutions of the independent problems. The status of the result is
+  // left untouched. The constraints that do not belong to any independent
+  // problem (i.e. the empty ones) get a zero dual value and a BASIC status, so
+  // the union of the bases of the independent problems is a basis of the
+  // original problem.
+  void AggregateSolutions(const std::vector<ProblemSolution>& solutions,
+                          ProblemSolution* solution) const
+      LOCKS_EXCLUDED(mutex_);
+
  private:
   const LinearProgram* original_problem_;
   std::vector<std::vector<ColIndex>> clusters_;
 
+  // The constraints of each independent problem, in increasing order. This is
+  // also the order of the constraints in the problems of ExtractLocalProblem().
+  std::vector<std::vector<RowIndex>> constraint_clusters_;
+
   mutable Mutex mutex_;
 
   DISALLOW_COPY_AND_ASSIGN(LPDecomposer);
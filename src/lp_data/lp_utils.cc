@@ -70,6 +70,14 @@ Fractional InfinityNorm(const DenseColumn& v) {
   return infinity_norm;
 }
 
+Fractional InfinityNorm(const DenseRow& v) {
+  Fractional infinity_norm = 0.0;
+  for (ColIndex col(0); col < v.size(); ++col) {
+    infinity_norm = std::max(infinity_norm, fabs(v[col]));
+  }
+  return infinity_norm;
+}
+
 Fractional InfinityNorm(const SparseColumn& v) {
   Fractional infinity_norm = 0.0;
   for (const SparseColumn::Entry e : v) {
@@ -110,6 +110,7 @@ Fractional PreciseSquaredNorm(ScatteredColumnReference v);
 
 // Returns the maximum of the |coefficients| of 'v'.
 Fractional InfinityNorm(const DenseColumn& v);
+Fractional InfinityNorm(const DenseRow& v);
 Fractional InfinityNorm(const SparseColumn& v);
 
 // Returns the fraction of non-zero entries of the given row.
@@ -14,6 +14,7 @@
 #include "lp_data/matrix_utils.h"
 #include <algorithm>
 #include "base/hash.h"
+#include "base/threadpool.h"
 
 namespace operations_research {
 namespace glop {
@@ -107,43 +108,110 @@ ColumnFingerprint ComputeFingerprint(ColIndex col, const SparseColumn& column) {
                            inverse_dynamic_range + scaled_average);
 }
 
-}  // namespace
-
-ColMapping FindProportionalColumns(const SparseMatrix& matrix,
-                                   Fractional tolerance) {
-  const ColIndex num_cols = matrix.num_cols();
-  ColMapping mapping(num_cols, kInvalidCol);
-
-  // Compute the fingerprint of each columns and sort them.
-  std::vector<ColumnFingerprint> fingerprints;
-  for (ColIndex col(0); col < num_cols; ++col) {
-    if (!matrix.column(col).IsEmpty()) {
-      fingerprints.push_back(ComputeFingerprint(col, matrix.column(col)));
+// Appends the fingerprints of the non-empty columns in [begin, end) to
+// fingerprints.
+void ComputeFingerprints(const SparseMatrix* matrix, ColIndex begin,
+                         ColIndex end,
+                         std::vector<ColumnFingerprint>* fingerprints) {
+  for (ColIndex col(begin); col < end; ++col) {
+    if (!matrix->column(col).IsEmpty()) {
+      fingerprints->push_back(ComputeFingerprint(col, matrix->column(col)));
     }
   }
-  std::sort(fingerprints.begin(), fingerprints.end());
+}
 
-  // Find a representative of each proportional columns class. This only
-  // compares columns with a close-enough fingerprint.
-  for (int i = 0; i < fingerprints.size(); ++i) {
-    const ColIndex col_a = fingerprints[i].col;
-    if (mapping[col_a] != kInvalidCol) continue;
-    for (int j = i + 1; j < fingerprints.size(); ++j) {
-      const ColIndex col_b = fingerprints[j].col;
-      if (mapping[col_b] != kInvalidCol) continue;
+// Finds a representative of each proportional columns class among the sorted
+// fingerprints[begin, end). This only compares columns with a close-enough
+// fingerprint. Note that the range must not split a group of fingerprints with
+// the same hash, so that two ranges only touch disjoint entries of mapping.
+void FindProportionalColumnsInRange(
+    const SparseMatrix* matrix,
+    const std::vector<ColumnFingerprint>* fingerprints, int begin, int end,
+    Fractional tolerance, ColMapping* mapping) {
+  for (int i = begin; i < end; ++i) {
+    const ColIndex col_a = (*fingerprints)[i].col;
+    if ((*mapping)[col_a] != kInvalidCol) continue;
+    for (int j = i + 1; j < end; ++j) {
+      const ColIndex col_b = (*fingerprints)[j].col;
+      if ((*mapping)[col_b] != kInvalidCol) continue;
 
       // Note that we use the same tolerance for the fingerprints.
       // TODO(user): Derive precise bounds on what this tolerance should be so
       // that no proportional columns are missed.
-      if (!AreProportionalCandidates(fingerprints[i], fingerprints[j],
+      if (!AreProportionalCandidates((*fingerprints)[i], (*fingerprints)[j],
                                      tolerance)) {
         break;
       }
-      if (AreColumnsProportional(matrix.column(col_a), matrix.column(col_b),
+      if (AreColumnsProportional(matrix->column(col_a), matrix->column(col_b),
                                  tolerance)) {
-        mapping[col_b] = col_a;
+        (*mapping)[col_b] = col_a;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+ColMapping FindProportionalColumns(const SparseMatrix& matrix,
+                                   Fractional tolerance, int num_threads) {
+  const ColIndex num_cols = matrix.num_cols();
+  ColMapping mapping(num_cols, kInvalidCol);
+
+  // Compute the fingerprint of each columns and sort them. In the parallel
+  // case, each thread handles a range of columns and the results are
+  // concatenated in the column order, so the sort input is always the same.
+  std::vector<ColumnFingerprint> fingerprints;
+  if (num_threads <= 1 || num_cols.value() < 2 * num_threads) {
+    num_threads = 1;
+    ComputeFingerprints(&matrix, ColIndex(0), num_cols, &fingerprints);
+  } else {
+    std::vector<std::vector<ColumnFingerprint>> chunks(num_threads);
+    {
+      ThreadPool pool("ProportionalColumns", num_threads);
+      pool.StartWorkers();
+      for (int i = 0; i < num_threads; ++i) {
+        pool.Add(NewCallback(&ComputeFingerprints, &matrix,
+                             ColIndex(num_cols.value() * i / num_threads),
+                             ColIndex(num_cols.value() * (i + 1) / num_threads),
+                             &chunks[i]));
       }
     }
+    for (const std::vector<ColumnFingerprint>& chunk : chunks) {
+      fingerprints.insert(fingerprints.end(), chunk.begin(), chunk.end());
+    }
+  }
+  std::sort(fingerprints.begin(), fingerprints.end());
+
+  const int num_fingerprints = fingerprints.size();
+  if (num_threads == 1) {
+    FindProportionalColumnsInRange(&matrix, &fingerprints, 0, num_fingerprints,
+                                   tolerance, &mapping);
+  } else {
+    // Two columns with a different hash are never compared, so the sorted
+    // fingerprints are split in ranges that start at a hash change.
+    std::vector<int> range_starts(1, 0);
+    for (int i = 1; i < num_threads; ++i) {
+      int start = std::max(range_starts.back(),
+                           num_fingerprints * i / num_threads);
+      while (start > 0 && start < num_fingerprints &&
+             fingerprints[start].hash == fingerprints[start - 1].hash) {
+        ++start;
+      }
+      range_starts.push_back(start);
+    }
+    range_starts.push_back(num_fingerprints);
+
+    ThreadPool pool("ProportionalColumns", num_threads);
+    pool.StartWorkers();
+    for (int i = 0; i < num_threads; ++i) {
+      if (range_starts[i] == range_starts[i + 1]) continue;
+      pool.Add(NewCallback(&FindProportionalColumnsInRange,
+                           static_cast<const SparseMatrix*>(&matrix),
+                           static_cast<const std::vector<ColumnFingerprint>*>(
+                               &fingerprints),
+                           range_starts[i], range_starts[i + 1], tolerance,
+                           &mapping));
+    }
   }
 
   // Sort the mapping so that the representative of each class is the smallest
@@ -33,8 +33,12 @@ namespace glop {
 // The complexity is in most cases O(num entries of the matrix). However,
 // compared to the less efficient algorithm below, it is highly unlikely but
 // possible that some pairs of proportional columns are not detected.
+//
+// If num_threads is greater than one, the column fingerprints are computed and
+// the columns sharing the same non-zero pattern hash are compared in parallel.
+// The returned mapping does not depend on the number of threads.
 ColMapping FindProportionalColumns(const SparseMatrix& matrix,
-                                   Fractional tolerance);
+                                   Fractional tolerance, int num_threads);
 
 // A simple version of FindProportionalColumns() that compares all the columns
 // pairs one by one. This is slow, but here for reference. The complexity is
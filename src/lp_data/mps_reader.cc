@@ -15,30 +15,122 @@
 #include "lp_data/mps_reader.h"
 
 #include <math.h>
+#include <string.h>
 #include <algorithm>
 #include <memory>
+#include <unordered_map>
 #include <utility>
-#include <fstream>
 
 #include "base/callback.h"
 #include "base/commandlineflags.h"
 #include "base/logging.h"
 #include "base/stringprintf.h"
 #include "base/file.h"
-#include "base/filelinereader.h"
 #include "base/numbers.h"  // for safe_strtod
 #include "base/split.h"
+#include "base/stringpiece.h"
 #include "base/strutil.h"
 #include "base/map_util.h"  // for FindOrNull, FindWithDefault
+#include "base/threadpool.h"
 #include "lp_data/lp_print_utils.h"
+#include "util/file_contents.h"
 #include "base/status.h"
 
 DEFINE_bool(mps_free_form, false, "Read MPS files in free form.");
 DEFINE_bool(mps_stop_after_first_error, true, "Stop after the first error.");
+DEFINE_int32(mps_reader_threads, 1,
+             "Number of threads used to parse the COLUMNS section of MPS "
+             "files.");
 
 namespace operations_research {
 namespace glop {
 
+namespace {
+
+// Returns the position of the '\n' ending the line starting at begin, or end.
+const char* FindLineEnd(const char* begin, const char* end) {
+  const void* const newline = memchr(begin, '\n', end - begin);
+  return newline == nullptr ? end : static_cast<const char*>(newline);
+}
+
+// Returns the end of the line [begin, newline) without its eventual '\r'.
+const char* TrimCarriageReturn(const char* begin, const char* newline) {
+  return newline > begin && newline[-1] == '\r' ? newline - 1 : newline;
+}
+
+// Same as MPSReader::IsCommentOrBlank() for the line [begin, end).
+bool IsCommentOrBlankLine(const char* begin, const char* end) {
+  if (begin < end && *begin == '*') return true;
+  for (const char* c = begin; c < end; ++c) {
+    if (*c != ' ' && *c != '\t') return false;
+  }
+  return true;
+}
+
+// Returns true if the two pieces hold the same characters.
+bool SameString(const StringPiece& a, const StringPiece& b) {
+  return a.size() == b.size() && memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// The row index used in the COLUMNS section for the objective.
+const RowIndex kObjectiveRow(-2);
+
+}  // namespace
+
+// A coefficient read in the COLUMNS section. Its row is kObjectiveRow for the
+// objective, and kInvalidRow if the row name was not declared in the ROWS
+// section (in which case the row is created when the chunk is merged).
+struct MPSReaderColumnsEntry {
+  RowIndex row;
+  StringPiece row_name;
+  Fractional value;
+};
+
+// A line of the COLUMNS section, either a marker or a column line with the
+// given number of entries.
+struct MPSReaderColumnsLine {
+  enum Type { COLUMN, INTORG_MARKER, INTEND_MARKER, OTHER_MARKER };
+  Type type;
+  StringPiece column;
+  int num_entries;
+};
+
+struct MPSReader::ColumnsChunk {
+  ColumnsChunk() : lines(), entries(), num_lines(0), error_line(-1), error() {}
+
+  // The lines which are not comments, and their entries in the same order.
+  std::vector<MPSReaderColumnsLine> lines;
+  std::vector<MPSReaderColumnsEntry> entries;
+
+  // The number of lines of the chunk, comments included.
+  int64 num_lines;
+
+  // The index in the chunk of the line with the first error and the error
+  // message, or -1 if there was no error. With mps_stop_after_first_error,
+  // the lines after this one are not parsed.
+  int64 error_line;
+  std::string error;
+};
+
+struct MPSReader::RowNameMap {
+  struct Hash {
+    size_t operator()(const StringPiece& s) const {
+      size_t hash = 0;
+      for (const char c : s) hash = 31 * hash + c;
+      return hash;
+    }
+  };
+  struct Equal {
+    bool operator()(const StringPiece& a, const StringPiece& b) const {
+      return SameString(a, b);
+    }
+  };
+
+  // The names of the rows, owned here because LinearProgram returns copies.
+  std::vector<std::string> names;
+  std::unordered_map<StringPiece, RowIndex, Hash, Equal> map;
+};
+
 const int MPSReader::kNumFields = 6;
 const int MPSReader::kFieldStartPos[kNumFields] = {1, 4, 14, 24, 39, 49};
 const int MPSReader::kFieldLength[kNumFields] = {2, 8, 8, 12, 8, 12};
@@ -141,21 +233,295 @@ bool MPSReader::LoadFile(const std::string& file_name, LinearProgram* data) {
   Reset();
   data_ = data;
   data_->Clear();
-  std::ifstream tmp_file(file_name.c_str());
-        const bool file_exists = tmp_file.good();
-        tmp_file.close();
-        if (file_exists) {
-          FileLineReader reader(file_name.c_str());
-          reader.set_line_callback(
-              NewPermanentCallback(this, &MPSReader::ProcessLine));
-          reader.Reload();
-    data->CleanUp();
-    DisplaySummary();
-    return reader.loaded_successfully() && parse_success_;
-  } else {
-    LOG(DFATAL) << "File not found: " << file_name;
+  FileContents contents;
+  if (!contents.Open(file_name)) {
+    LOG(DFATAL) << "Can't read the file " << contents.error_message();
     return false;
   }
+  ProcessFileContents(contents.begin(), contents.end());
+  data->CleanUp();
+  DisplaySummary();
+  return parse_success_;
+}
+
+void MPSReader::ProcessFileContents(const char* begin, const char* end) {
+  std::string line;
+  const char* columns_begin = nullptr;
+  int64 num_columns_lines = 0;
+  const char* line_begin = begin;
+  while (line_begin < end) {
+    const char* const newline = FindLineEnd(line_begin, end);
+    const char* const line_end = TrimCarriageReturn(line_begin, newline);
+
+    // See ProcessLine() for how section lines are recognized.
+    const bool is_section_line = !IsCommentOrBlankLine(line_begin, line_end) &&
+                                 *line_begin != ' ';
+    if (section_ == COLUMNS && !is_section_line) {
+      if (columns_begin == nullptr) columns_begin = line_begin;
+      ++num_columns_lines;
+    } else {
+      if (columns_begin != nullptr) {
+        ProcessColumnsLines(columns_begin, line_begin, num_columns_lines);
+        columns_begin = nullptr;
+        num_columns_lines = 0;
+      }
+      line.assign(line_begin, line_end);
+      ProcessLine(&line[0]);
+    }
+    line_begin = newline + 1;
+  }
+  if (columns_begin != nullptr) {
+    ProcessColumnsLines(columns_begin, end, num_columns_lines);
+  }
+}
+
+void MPSReader::ProcessColumnsLines(const char* begin, const char* end,
+                                    int64 num_lines) {
+  const int64 first_line_num = line_num_ + 1;
+  line_num_ += num_lines;
+  if (!parse_success_ && FLAGS_mps_stop_after_first_error) return;
+
+  // Index the rows by name, so that the chunks can be parsed without modifying
+  // the problem.
+  RowNameMap rows;
+  const RowIndex num_rows = data_->num_constraints();
+  rows.names.resize(num_rows.value());
+  rows.map.reserve(num_rows.value());
+  for (RowIndex row(0); row < num_rows; ++row) {
+    rows.names[row.value()] = data_->GetConstraintName(row);
+    rows.map[StringPiece(rows.names[row.value()])] = row;
+  }
+
+  // Split the section in chunks of whole lines and parse them.
+  const int64 kMinChunkSize = 1 << 20;
+  const int num_chunks = static_cast<int>(
+      std::max(int64(1), std::min(int64(FLAGS_mps_reader_threads),
+                                  int64(end - begin) / kMinChunkSize)));
+  std::vector<ColumnsChunk> chunks(num_chunks);
+  std::vector<const char*> chunk_begins(num_chunks + 1, end);
+  chunk_begins[0] = begin;
+  for (int i = 1; i < num_chunks; ++i) {
+    const char* const split = begin + (end - begin) * i / num_chunks;
+    chunk_begins[i] = std::min(
+        end, std::max(chunk_begins[i - 1], FindLineEnd(split, end) + 1));
+  }
+  if (num_chunks == 1) {
+    ParseColumnsChunk(begin, end, &rows, &chunks[0]);
+  } else {
+    ThreadPool pool("MPSReaderColumns", num_chunks);
+    pool.StartWorkers();
+    for (int i = 0; i < num_chunks; ++i) {
+      pool.Add(NewCallback(this, &MPSReader::ParseColumnsChunk,
+                           chunk_begins[i], chunk_begins[i + 1],
+                           static_cast<const RowNameMap*>(&rows), &chunks[i]));
+    }
+  }
+
+  // Create the columns in the order of the file, and count their entries so
+  // that each column is allocated once.
+  std::vector<ColIndex> line_cols;
+  StrictITIVector<ColIndex, EntryIndex> num_new_entries;
+  int num_chunks_to_merge = num_chunks;
+  int64 chunk_first_line_num = first_line_num;
+  for (int i = 0; i < num_chunks; ++i) {
+    const ColumnsChunk& chunk = chunks[i];
+    StringPiece current_column;
+    ColIndex col(kInvalidCol);
+    int entry_index = 0;
+    for (const MPSReaderColumnsLine& line : chunk.lines) {
+      if (line.type != MPSReaderColumnsLine::COLUMN) {
+        if (line.type == MPSReaderColumnsLine::INTORG_MARKER) {
+          in_integer_section_ = true;
+        } else if (line.type == MPSReaderColumnsLine::INTEND_MARKER) {
+          in_integer_section_ = false;
+        }
+        col = kInvalidCol;
+        line_cols.push_back(kInvalidCol);
+        continue;
+      }
+      if (col == kInvalidCol || !SameString(line.column, current_column)) {
+        current_column = line.column;
+        col = data_->FindOrCreateVariable(line.column.ToString());
+        is_binary_by_default_.resize(col + 1, false);
+        if (in_integer_section_) {
+          data_->SetVariableIntegrality(col, true);
+          // The default bounds for integer variables are [0, 1].
+          data_->SetVariableBounds(col, 0.0, 1.0);
+          is_binary_by_default_[col] = true;
+        } else {
+          data_->SetVariableBounds(col, 0.0, kInfinity);
+        }
+        num_new_entries.resize(data_->num_variables(), EntryIndex(0));
+      }
+      line_cols.push_back(col);
+      for (int j = 0; j < line.num_entries; ++j, ++entry_index) {
+        if (chunk.entries[entry_index].row != kObjectiveRow) {
+          ++num_new_entries[col];
+        }
+      }
+    }
+    if (chunk.error_line >= 0) {
+      if (log_errors_) {
+        LOG(ERROR) << "At line " << chunk_first_line_num + chunk.error_line
+                   << ": " << chunk.error;
+      }
+      parse_success_ = false;
+      if (FLAGS_mps_stop_after_first_error) {
+        num_chunks_to_merge = i + 1;
+        break;
+      }
+    }
+    chunk_first_line_num += chunk.num_lines;
+  }
+  for (ColIndex col(0); col < num_new_entries.size(); ++col) {
+    if (num_new_entries[col] == 0) continue;
+    SparseColumn* const column = data_->GetMutableSparseColumn(col);
+    column->Reserve(column->num_entries() + num_new_entries[col]);
+  }
+
+  // Store the coefficients.
+  int line_index = 0;
+  for (int i = 0; i < num_chunks_to_merge; ++i) {
+    const ColumnsChunk& chunk = chunks[i];
+    int entry_index = 0;
+    for (const MPSReaderColumnsLine& line : chunk.lines) {
+      const ColIndex col = line_cols[line_index++];
+      for (int j = 0; j < line.num_entries; ++j, ++entry_index) {
+        const MPSReaderColumnsEntry& entry = chunk.entries[entry_index];
+        if (entry.row == kObjectiveRow) {
+          data_->SetObjectiveCoefficient(col, entry.value);
+        } else {
+          const RowIndex row =
+              entry.row != kInvalidRow
+                  ? entry.row
+                  : data_->FindOrCreateConstraint(entry.row_name.ToString());
+          data_->SetCoefficient(row, col, entry.value);
+        }
+      }
+    }
+  }
+}
+
+void MPSReader::ParseColumnsChunk(const char* begin, const char* end,
+                                  const RowNameMap* rows,
+                                  ColumnsChunk* chunk) const {
+  const StringPiece objective_name(objective_name_);
+  const int start_index = free_form_ ? 0 : 1;
+  StringPiece fields[kNumFields];
+  const char* line_begin = begin;
+  while (line_begin < end) {
+    const char* const newline = FindLineEnd(line_begin, end);
+    const char* const line_end = TrimCarriageReturn(line_begin, newline);
+    const int64 line_index = chunk->num_lines++;
+    const StringPiece line(line_begin, line_end - line_begin);
+    line_begin = newline + 1;
+    if (IsCommentOrBlankLine(line.data(), line.data() + line.size())) continue;
+
+    // Take into account the INTORG and INTEND markers.
+    MPSReaderColumnsLine columns_line;
+    columns_line.num_entries = 0;
+    if (line.find("'MARKER'") != StringPiece::npos) {
+      columns_line.type =
+          line.find("'INTORG'") != StringPiece::npos
+              ? MPSReaderColumnsLine::INTORG_MARKER
+              : line.find("'INTEND'") != StringPiece::npos
+                    ? MPSReaderColumnsLine::INTEND_MARKER
+                    : MPSReaderColumnsLine::OTHER_MARKER;
+      chunk->lines.push_back(columns_line);
+      continue;
+    }
+
+    // Same as SplitLineIntoFields(), but without copies.
+    std::string error;
+    int num_fields = 0;
+    if (free_form_) {
+      for (int i = 0; i < line.size();) {
+        if (line[i] == ' ') {
+          ++i;
+          continue;
+        }
+        int j = i;
+        while (j < line.size() && line[j] != ' ') ++j;
+        if (num_fields == kNumFields) {
+          error = "Too many fields";
+          break;
+        }
+        fields[num_fields++] = StringPiece(line.data() + i, j - i);
+        i = j;
+      }
+      for (int i = num_fields; i < kNumFields; ++i) fields[i].clear();
+    } else {
+      num_fields = kNumFields;
+      for (int i = 0; i < kNumFields; ++i) {
+        if (kFieldStartPos[i] < line.size()) {
+          StringPiece field = line.substr(kFieldStartPos[i], kFieldLength[i]);
+          while (!field.empty() && field[field.size() - 1] == ' ') {
+            field.remove_suffix(1);
+          }
+          fields[i] = field;
+        } else {
+          fields[i].clear();
+        }
+      }
+    }
+
+    columns_line.type = MPSReaderColumnsLine::COLUMN;
+    columns_line.column = fields[start_index];
+    for (int pair = 0; error.empty() && pair < 2; ++pair) {
+      if (pair == 1 && num_fields - start_index < 4) break;
+      const StringPiece row_name = fields[start_index + 1 + 2 * pair];
+      const StringPiece row_value = fields[start_index + 2 + 2 * pair];
+      if (row_name.empty() || SameString(row_name, "$")) continue;
+
+      // safe_strtod() needs a null-terminated std::string.
+      char value_string[64];
+      double value = 0.0;
+      if (row_value.size() >= sizeof(value_string)) {
+        error = "Failed to convert std::string to double. String = " +
+                row_value.ToString();
+        break;
+      }
+      memcpy(value_string, row_value.data(), row_value.size());
+      value_string[row_value.size()] = '\0';
+      if (!safe_strtod(value_string, &value)) {
+        error = StringPrintf(
+            "Failed to convert std::string to double. String = %s. "
+            "free_form_ = %d",
+            value_string, free_form_);
+        break;
+      }
+      if (value == 0.0) continue;
+      MPSReaderColumnsEntry entry;
+      entry.row_name = row_name;
+      entry.value = value;
+      if (SameString(row_name, objective_name)) {
+        entry.row = kObjectiveRow;
+      } else {
+        const auto it = rows->map.find(row_name);
+        entry.row = it == rows->map.end() ? kInvalidRow : it->second;
+      }
+      chunk->entries.push_back(entry);
+      ++columns_line.num_entries;
+    }
+    if (!error.empty()) {
+      if (chunk->error_line < 0) {
+        chunk->error_line = line_index;
+        chunk->error = error + ". (Line contents = '" + line.ToString() + "').";
+      }
+      if (FLAGS_mps_stop_after_first_error) {
+        // Count the remaining lines, which are not parsed.
+        while (line_begin < end) {
+          line_begin = FindLineEnd(line_begin, end) + 1;
+          ++chunk->num_lines;
+        }
+        return;
+      }
+      // Drop the entries of the faulty line.
+      chunk->entries.resize(chunk->entries.size() - columns_line.num_entries);
+      continue;
+    }
+    chunk->lines.push_back(columns_line);
+  }
 }
 
 // TODO(user): Ideally have a method to compare instances of LinearProgram
@@ -56,6 +56,12 @@ typedef enum {
 // All Load() methods clear the previously loaded instance and stores the result
 // in the given LinearProgram. They returns false in case of failure to read the
 // instance.
+//
+// The file is memory-mapped when possible. Files with a ".gz" extension are
+// entirely decompressed in memory through zlib. The COLUMNS section, which usually makes most of
+// the file, is tokenized without any std::string copy and in parallel chunks
+// (see the mps_reader_threads flag), and the columns of the matrix are
+// allocated once to their final size.
 class MPSReader {
  public:
   MPSReader();
@@ -118,6 +124,27 @@ class MPSReader {
   // Line processor.
   void ProcessLine(char* line);
 
+  // Processes the whole contents of a file. All the lines are passed to
+  // ProcessLine(), except the ones of the COLUMNS section which are processed
+  // in one go by ProcessColumnsLines().
+  void ProcessFileContents(const char* begin, const char* end);
+
+  // Processes the lines in [begin, end), which are all the lines of a COLUMNS
+  // section, possibly including comments and blank lines. num_lines is their
+  // number, used to keep line_num_ up to date.
+  void ProcessColumnsLines(const char* begin, const char* end, int64 num_lines);
+
+  // The result of ParseColumnsChunk() and a map from the row names to their
+  // index, both defined in the .cc.
+  struct ColumnsChunk;
+  struct RowNameMap;
+
+  // Tokenizes the lines of the COLUMNS section in [begin, end) into chunk,
+  // without modifying the problem. This can be called concurrently on
+  // different chunks.
+  void ParseColumnsChunk(const char* begin, const char* end,
+                         const RowNameMap* rows, ColumnsChunk* chunk) const;
+
   // Process section NAME in the MPS file.
   void ProcessNameSection();
 
@@ -202,8 +202,9 @@ void SparseMatrix::PopulateFromTranspose(const Matrix& input) {
 }
 
 void SparseMatrix::PopulateFromSparseMatrix(const SparseMatrix& matrix) {
-  Reset(ColIndex(0), matrix.num_rows_);
+  // Note that the assignment reuses the memory of the existing columns.
   columns_ = matrix.columns_;
+  num_rows_ = matrix.num_rows_;
 }
 
 template <typename Matrix>
@@ -409,7 +410,13 @@ std::string SparseMatrix::Dump() const {
 }
 
 void SparseMatrix::Reset(ColIndex num_cols, RowIndex num_rows) {
-  Clear();
+  // The columns that are kept are only cleared, so that a matrix populated many
+  // times (like the transpose of a LinearProgram during presolve) reuses the
+  // memory of its columns instead of allocating each of them again.
+  const ColIndex num_kept_cols = std::min(num_cols, columns_.size());
+  for (ColIndex col(0); col < num_kept_cols; ++col) {
+    columns_[col].Clear();
+  }
   columns_.resize(num_cols, SparseColumn());
   num_rows_ = num_rows;
 }
@@ -451,6 +458,57 @@ void CompactSparseMatrix::PopulateFromMatrixView(const MatrixView& input) {
   starts_[input.num_cols()] = index;
 }
 
+void CompactSparseMatrix::PopulateFromSparseMatrix(const SparseMatrix& input) {
+  num_cols_ = input.num_cols();
+  num_rows_ = input.num_rows();
+  const EntryIndex num_entries = input.num_entries();
+  starts_.assign(num_cols_ + 1, EntryIndex(0));
+  coefficients_.assign(num_entries, 0.0);
+  rows_.assign(num_entries, RowIndex(0));
+  EntryIndex index(0);
+  for (ColIndex col(0); col < num_cols_; ++col) {
+    starts_[col] = index;
+    for (const SparseColumn::Entry e : input.column(col)) {
+      coefficients_[index] = e.coefficient();
+      rows_[index] = e.row();
+      ++index;
+    }
+  }
+  starts_[num_cols_] = index;
+}
+
+void CompactSparseMatrix::PopulateFromTranspose(const SparseMatrix& input) {
+  num_cols_ = RowToColIndex(input.num_rows());
+  num_rows_ = ColToRowIndex(input.num_cols());
+
+  // Same algorithm as in the CompactSparseMatrix version below.
+  starts_.assign(num_cols_ + 1, EntryIndex(0));
+  for (ColIndex col(0); col < input.num_cols(); ++col) {
+    for (const SparseColumn::Entry e : input.column(col)) {
+      ++starts_[RowToColIndex(e.row()) + 1];
+    }
+  }
+  for (ColIndex col(1); col < starts_.size(); ++col) {
+    starts_[col] += starts_[col - 1];
+  }
+  coefficients_.resize(starts_.back(), 0.0);
+  rows_.resize(starts_.back(), kInvalidRow);
+  for (ColIndex col(0); col < input.num_cols(); ++col) {
+    const RowIndex transposed_row = ColToRowIndex(col);
+    for (const SparseColumn::Entry e : input.column(col)) {
+      const ColIndex transposed_col = RowToColIndex(e.row());
+      const EntryIndex index = starts_[transposed_col];
+      ++starts_[transposed_col];
+      coefficients_[index] = e.coefficient();
+      rows_[index] = transposed_row;
+    }
+  }
+  for (ColIndex col(starts_.size() - 1); col > 0; col--) {
+    starts_[col] = starts_[col - 1];
+  }
+  starts_[ColIndex(0)] = 0;
+}
+
 void CompactSparseMatrix::PopulateFromTranspose(
     const CompactSparseMatrix& input) {
   num_cols_ = RowToColIndex(input.num_rows());
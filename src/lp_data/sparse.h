@@ -274,21 +274,22 @@ class CompactSparseMatrix {
  public:
   CompactSparseMatrix() {}
 
-  // Convenient constructor for tests.
-  // TODO(user): If this is needed in production code, it can be done faster.
   explicit CompactSparseMatrix(const SparseMatrix& matrix) {
-    PopulateFromMatrixView(MatrixView(matrix));
+    PopulateFromSparseMatrix(matrix);
   }
 
-  // Creates a CompactSparseMatrix from the given MatrixView. The matrices are
-  // the same, only the representation differ. Note that the entry order in
-  // each column is preserved.
+  // Creates a CompactSparseMatrix from the given MatrixView or SparseMatrix.
+  // The matrices are the same, only the representation differ. Note that the
+  // entry order in each column is preserved.
   void PopulateFromMatrixView(const MatrixView& input);
+  void PopulateFromSparseMatrix(const SparseMatrix& input);
 
   // Creates a CompactSparseMatrix from the transpose of the given
-  // CompactSparseMatrix. Note that the entries in each columns will be ordered
-  // by row indices.
+  // CompactSparseMatrix or SparseMatrix. Note that the entries in each columns
+  // will be ordered by row indices. This only allocates three arrays, whatever
+  // the number of columns of the result.
   void PopulateFromTranspose(const CompactSparseMatrix& input);
+  void PopulateFromTranspose(const SparseMatrix& input);
 
   // Clears the matrix and sets its number of rows. If none of the Populate()
   // function has been called, Reset() must be called before calling any of the
@@ -346,11 +347,43 @@ class CompactSparseMatrix {
   RowIndex EntryRow(EntryIndex i) const { return rows_[i]; }
 
   // Class to iterate on the entries of a given column with the same interface
-  // as for SparseColumn.
-  //
-  // TODO(user): Also add the 'for (ColumnView::Entry e : view) {}' iterator.
+  // as for SparseColumn, including:
+  // for (const CompactSparseMatrix::ColumnView::Entry e : view) {
+  //   const RowIndex row = e.row();
+  //   const Fractional coefficient = e.coefficient();
+  // }
   class ColumnView {
    public:
+    class Entry {
+     public:
+      RowIndex row() const { return *row_; }
+      Fractional coefficient() const { return *coefficient_; }
+
+     protected:
+      Entry(const RowIndex* row, const Fractional* coefficient)
+          : row_(row), coefficient_(coefficient) {}
+      const RowIndex* row_;
+      const Fractional* coefficient_;
+    };
+
+    class Iterator : private Entry {
+     public:
+      void operator++() {
+        ++Entry::row_;
+        ++Entry::coefficient_;
+      }
+      // Same remark as for SparseVector::Iterator, '<' is safer than '!='.
+      bool operator!=(const Iterator& other) const {
+        return Entry::row_ < other.row_;
+      }
+      const Entry& operator*() const { return *static_cast<const Entry*>(this); }
+
+     private:
+      Iterator(const RowIndex* row, const Fractional* coefficient)
+          : Entry(row, coefficient) {}
+      friend class ColumnView;
+    };
+
     ColumnView(EntryIndex num_entries, const RowIndex* const rows,
                const Fractional* const coefficients)
         : num_entries_(num_entries), rows_(rows), coefficients_(coefficients) {}
@@ -359,6 +392,11 @@ class CompactSparseMatrix {
       return coefficients_[i.value()];
     }
     RowIndex EntryRow(EntryIndex i) const { return rows_[i.value()]; }
+    Iterator begin() const { return Iterator(rows_, coefficients_); }
+    Iterator end() const {
+      return Iterator(rows_ + num_entries_.value(),
+                      coefficients_ + num_entries_.value());
+    }
 
    private:
     const EntryIndex num_entries_;
@@ -591,6 +591,16 @@ void MakeAllLiteralsPositive(LinearBooleanProblem* problem) {
 void FindLinearBooleanProblemSymmetries(
     const LinearBooleanProblem& problem,
     std::vector<std::unique_ptr<SparsePermutation>>* generators) {
+  FindLinearBooleanProblemSymmetries(
+      problem,
+      /*deterministic_time_limit=*/std::numeric_limits<double>::infinity(),
+      /*num_threads=*/1, generators);
+}
+
+void FindLinearBooleanProblemSymmetries(
+    const LinearBooleanProblem& problem, double deterministic_time_limit,
+    int num_threads,
+    std::vector<std::unique_ptr<SparsePermutation>>* generators) {
   typedef GraphSymmetryFinder::Graph Graph;
   std::vector<int> equivalence_classes;
   std::unique_ptr<Graph> graph(
@@ -622,11 +632,20 @@ void FindLinearBooleanProblemSymmetries(
   }
   GraphSymmetryFinder symmetry_finder(*graph,
                                       /*is_undirected=*/true);
+  symmetry_finder.SetNumThreads(num_threads);
   std::vector<int> factorized_automorphism_group_size;
-  // TODO(user): inject the appropriate time limit here.
-  CHECK_OK(symmetry_finder.FindSymmetries(
+  const util::Status status = symmetry_finder.FindSymmetries(
       /*time_limit_seconds=*/std::numeric_limits<double>::infinity(),
-      &equivalence_classes, generators, &factorized_automorphism_group_size));
+      deterministic_time_limit, &equivalence_classes, generators,
+      &factorized_automorphism_group_size);
+  if (status.error_code() == util::error::DEADLINE_EXCEEDED) {
+    // The generators found so far are still valid, see FindSymmetries().
+    LOG(INFO) << "Symmetry search interrupted: " << status.error_message();
+  } else {
+    CHECK_OK(status);
+  }
+  LOG(INFO) << "Symmetry search deterministic time: "
+            << symmetry_finder.deterministic_time();
 
   // Remove from the permutations the part not concerning the literals.
   // Note that some permutation may becomes empty, which means that we had
@@ -660,6 +679,94 @@ void FindLinearBooleanProblemSymmetries(
   LOG(INFO) << "Average support size: " << average_support_size;
 }
 
+void AddLexLeaderSymmetryBreakingClauses(
+    const std::vector<std::unique_ptr<SparsePermutation>>& generators,
+    int max_num_compared_variables, LinearBooleanProblem* problem) {
+  if (!problem->has_original_num_variables()) {
+    problem->set_original_num_variables(problem->num_variables());
+  }
+  const int num_variables = problem->num_variables();
+  const auto add_clause = [problem](const std::vector<Literal>& literals) {
+    LinearBooleanConstraint* constraint = problem->add_constraints();
+    constraint->set_lower_bound(1);
+    for (const Literal literal : literals) {
+      constraint->add_literals(literal.SignedValue());
+      constraint->add_coefficients(1);
+    }
+  };
+
+  int num_new_clauses = 0;
+  int next_new_variable = num_variables;
+  std::vector<int> image(2 * num_variables);
+  std::vector<VariableIndex> moved_variables;
+  for (const std::unique_ptr<SparsePermutation>& generator : generators) {
+    // Compute the image of each literal and the moved variables, sorted by
+    // index. Note that the literals of the problem are the nodes
+    // [0, 2 * num_variables) of the permutation.
+    moved_variables.clear();
+    for (int c = 0; c < generator->NumCycles(); ++c) {
+      const int last = generator->LastElementInCycle(c);
+      int previous = last;
+      for (const int literal_index : generator->Cycle(c)) {
+        image[previous] = literal_index;
+        previous = literal_index;
+      }
+      DCHECK_EQ(previous, last);
+    }
+    for (const int literal_index : generator->Support()) {
+      const Literal literal = Literal(LiteralIndex(literal_index));
+      if (literal.IsPositive()) moved_variables.push_back(literal.Variable());
+    }
+    std::sort(moved_variables.begin(), moved_variables.end());
+    if (moved_variables.size() > max_num_compared_variables) {
+      moved_variables.resize(max_num_compared_variables);
+    }
+
+    // Encode x <= g(x) on the compared variables. The literal "equal" is true
+    // if all the previous variables are equal to their image; it is absent
+    // (always true) for the first variable. For the variable x_i with image
+    // y_i (which is a literal), we add:
+    //   equal => (x_i => y_i)
+    //   equal and x_i and y_i => next_equal
+    //   equal and not(x_i) and not(y_i) => next_equal
+    // Note that next_equal is allowed to be true when the prefixes differ.
+    // This only restricts the assignment further, but the smallest assignment
+    // of each orbit still satisfies all the clauses.
+    std::vector<Literal> equal;
+    for (int i = 0; i < moved_variables.size(); ++i) {
+      const Literal x(moved_variables[i], true);
+      const Literal y(LiteralIndex(image[x.Index().value()]));
+      std::vector<Literal> clause = equal;
+      clause.push_back(x.Negated());
+      if (y == x.Negated()) {
+        // x_i can't be equal to its image, so we are done.
+        add_clause(clause);
+        ++num_new_clauses;
+        break;
+      }
+      clause.push_back(y);
+      add_clause(clause);
+      ++num_new_clauses;
+      if (i + 1 == moved_variables.size()) break;
+
+      const Literal next_equal(VariableIndex(next_new_variable++), true);
+      clause = equal;
+      clause.push_back(x.Negated());
+      clause.push_back(next_equal);
+      add_clause(clause);
+      clause = equal;
+      clause.push_back(y);
+      clause.push_back(next_equal);
+      add_clause(clause);
+      num_new_clauses += 2;
+      equal.assign(1, next_equal.Negated());
+    }
+  }
+  problem->set_num_variables(next_new_variable);
+  LOG(INFO) << "Added " << num_new_clauses << " lex-leader clauses and "
+            << next_new_variable - num_variables << " new variables.";
+}
+
 void ApplyLiteralMappingToBooleanProblem(
     const ITIVector<LiteralIndex, LiteralIndex>& mapping,
     LinearBooleanProblem* problem) {
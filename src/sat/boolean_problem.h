@@ -108,6 +108,32 @@ void FindLinearBooleanProblemSymmetries(
     const LinearBooleanProblem& problem,
     std::vector<std::unique_ptr<SparsePermutation>>* generators);
 
+// Same as above, but the search stops after the given deterministic time (see
+// GraphSymmetryFinder::deterministic_time()) and refines the large parts of
+// the partition with num_threads threads. The result only depends on the
+// deterministic time limit, not on the number of threads. When the limit is
+// reached, the generators found so far are returned: they are all valid
+// symmetries, but they may not generate the full symmetry group.
+void FindLinearBooleanProblemSymmetries(
+    const LinearBooleanProblem& problem, double deterministic_time_limit,
+    int num_threads,
+    std::vector<std::unique_ptr<SparsePermutation>>* generators);
+
+// Adds to the problem the "lex-leader" clauses of the given symmetries: for
+// each generator g, only the assignments x such that x <= g(x) in the
+// lexicographic order (variables sorted by index, false < true) are kept. This
+// keeps at least one solution in each orbit, so the problem stays satisfiable
+// (and keeps its optimal objective value) if and only if it was before.
+//
+// This is a static alternative to the SymmetryPropagator. For each generator,
+// the comparison is limited to the first max_num_compared_variables variables
+// moved by the generator, each of them but the last needing a new auxiliary
+// variable and three clauses. The auxiliary variables are appended after the
+// existing ones, and original_num_variables is set if it wasn't already.
+void AddLexLeaderSymmetryBreakingClauses(
+    const std::vector<std::unique_ptr<SparsePermutation>>& generators,
+    int max_num_compared_variables, LinearBooleanProblem* problem);
+
 // Maps all the literals of the problem. Note that this converts the cost of a
 // variable correctly, that is if a variable with cost is mapped to another, the
 // cost of the later is updated.
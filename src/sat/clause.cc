@@ -24,6 +24,7 @@
 #include "base/sysinfo.h"
 #include "base/join.h"
 #include "base/stl_util.h"
+#include "base/strongly_connected_components.h"
 #include "util/time_limit.h"
 
 namespace operations_research {
@@ -53,6 +54,27 @@ bool CleanUpPredicate(const Watcher& watcher) {
   return !watcher.clause->IsAttached();
 }
 
+// Graph interface needed by FindStronglyConnectedComponents() on top of the
+// implication lists of a BinaryImplicationGraph.
+class ImplicationListGraph {
+ public:
+  explicit ImplicationListGraph(
+      const ITIVector<LiteralIndex, std::vector<Literal>>& implications)
+      : implications_(implications) {}
+
+  const std::vector<int32>& operator[](int32 index) const {
+    scratchpad_.clear();
+    for (const Literal l : implications_[LiteralIndex(index)]) {
+      scratchpad_.push_back(l.Index().value());
+    }
+    return scratchpad_;
+  }
+
+ private:
+  const ITIVector<LiteralIndex, std::vector<Literal>>& implications_;
+  mutable std::vector<int32> scratchpad_;
+};
+
 }  // namespace
 
 // ----- LiteralWatchers -----
@@ -567,6 +589,48 @@ void BinaryImplicationGraph::RemoveFixedVariables(
   }
 }
 
+void BinaryImplicationGraph::RemoveAllClausesContaining(
+    VariableIndex var, std::vector<BinaryClause>* removed) {
+  SCOPED_TIME_STAT(&stats_);
+  for (const Literal x : {Literal(var, true), Literal(var, false)}) {
+    // The clause (x, b) is stored as not(x) => b and not(b) => x.
+    for (const Literal b : implications_[x.NegatedIndex()]) {
+      removed->push_back(BinaryClause(x, b));
+      --num_implications_;
+      if (b.Variable() == var) continue;
+      RemoveIf(&implications_[b.NegatedIndex()],
+               [x](Literal l) { return l == x; });
+    }
+    STLClearObject(&(implications_[x.NegatedIndex()]));
+  }
+}
+
+bool BinaryImplicationGraph::FindEquivalentLiterals(
+    ITIVector<LiteralIndex, LiteralIndex>* representative) const {
+  SCOPED_TIME_STAT(&stats_);
+  const int32 size = implications_.size();
+  representative->resize(size);
+  for (LiteralIndex i(0); i < size; ++i) (*representative)[i] = i;
+
+  std::vector<std::vector<int32>> scc;
+  FindStronglyConnectedComponents(size, ImplicationListGraph(implications_),
+                                  &scc);
+  for (const std::vector<int32>& component : scc) {
+    if (component.size() == 1) continue;
+    Literal rep = Literal(LiteralIndex(component[0]));
+    for (const int32 i : component) {
+      const Literal l = Literal(LiteralIndex(i));
+      if (l.Variable() < rep.Variable()) rep = l;
+    }
+    for (const int32 i : component) {
+      const Literal l = Literal(LiteralIndex(i));
+      if (l == rep.Negated()) return false;
+      (*representative)[l.Index()] = rep.Index();
+    }
+  }
+  return true;
+}
+
 // ----- SatClause -----
 
 // static
@@ -604,7 +668,13 @@ bool SatClause::RemoveFixedLiteralsAndTestIfTrue(
   }
   for (int i = j; i < size_; ++i) {
     if (assignment.VariableIsAssigned(literals_[i].Variable())) {
-      if (assignment.LiteralIsTrue(literals_[i])) return true;
+      if (assignment.LiteralIsTrue(literals_[i])) {
+        // Restore the literals overwritten so far so that the content of the
+        // clause is unchanged (up to a permutation) when it is deleted.
+        std::copy(removed_literals->begin(), removed_literals->end(),
+                  &literals_[j]);
+        return true;
+      }
       removed_literals->push_back(literals_[i]);
     } else {
       literals_[j] = literals_[i];
@@ -429,6 +429,26 @@ class BinaryImplicationGraph : public Propagator {
     }
   }
 
+  // Returns the list of literals directly implied by the given one. Note that
+  // this list may contain duplicates.
+  const std::vector<Literal>& DirectImplications(Literal l) const {
+    return implications_[l.Index()];
+  }
+
+  // Removes all the binary clauses containing the given variable and appends
+  // them to the given vector. This must only be called at decision level 0.
+  void RemoveAllClausesContaining(VariableIndex var,
+                                  std::vector<BinaryClause>* removed);
+
+  // Computes the strongly connected components of the implication graph. All
+  // the literals of a component are equivalent, and this fills representative
+  // so that representative[l] is the literal of smallest variable index of the
+  // component of l. Note that we always have representative[not(l)] ==
+  // not(representative[l]). Returns false if a literal is equivalent to its
+  // negation, which means that the problem is UNSAT.
+  bool FindEquivalentLiterals(
+      ITIVector<LiteralIndex, LiteralIndex>* representative) const;
+
  private:
   // Propagates all the direct implications of the given literal becoming true.
   // Returns false if a conflict was encountered, in which case
@@ -0,0 +1,69 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sat/drat_writer.h"
+
+#include "base/logging.h"
+
+namespace operations_research {
+namespace sat {
+
+namespace {
+// The buffer is written to the file once it reaches this size.
+const int kBufferSize = 1 << 16;
+}  // namespace
+
+DratWriter::DratWriter(File* output) : output_(output), num_flushed_bytes_(0) {
+  CHECK(output_ != nullptr);
+  buffer_.reserve(kBufferSize + 1024);
+}
+
+DratWriter::~DratWriter() { Flush(); }
+
+void DratWriter::AddClause(ClauseRef clause) { WriteClause('a', clause); }
+
+void DratWriter::DeleteClause(ClauseRef clause) { WriteClause('d', clause); }
+
+void DratWriter::WriteClause(char type, ClauseRef clause) {
+  buffer_.push_back(type);
+  for (const Literal literal : clause) {
+    const int value = literal.SignedValue();
+    uint32 encoded = value > 0 ? 2 * value : -2 * value + 1;
+    while (encoded > 127) {
+      buffer_.push_back(static_cast<char>(128 | (encoded & 127)));
+      encoded >>= 7;
+    }
+    buffer_.push_back(static_cast<char>(encoded));
+  }
+  buffer_.push_back(0);
+  WriteBufferIfNeeded();
+}
+
+void DratWriter::WriteBufferIfNeeded() {
+  if (buffer_.size() < kBufferSize) return;
+  output_->WriteOrDie(buffer_.data(), buffer_.size());
+  num_flushed_bytes_ += buffer_.size();
+  buffer_.clear();
+}
+
+void DratWriter::Flush() {
+  if (!buffer_.empty()) {
+    output_->WriteOrDie(buffer_.data(), buffer_.size());
+    num_flushed_bytes_ += buffer_.size();
+    buffer_.clear();
+  }
+  output_->Flush();
+}
+
+}  // namespace sat
+}  // namespace operations_research
@@ -0,0 +1,77 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file contains a streaming writer for the DRAT (Deletion Resolution
+// Asymmetric Tautology) proof format. Contrary to the in-memory resolution
+// graph of unsat_proof.h, nothing is kept in memory: the clauses learned and
+// deleted by the solver are appended to a file as they appear, and an external
+// checker like drat-trim can later certify an UNSAT result.
+//
+// References:
+// - Nathan Wetzler, Marijn J. H. Heule, Warren A. Hunt, "DRAT-trim: Efficient
+//   Checking and Trimming Using Expressive Clausal Proofs", SAT 2014.
+// - The binary format: https://github.com/marijnheule/drat-trim
+
+#ifndef OR_TOOLS_SAT_DRAT_WRITER_H_
+#define OR_TOOLS_SAT_DRAT_WRITER_H_
+
+#include <string>
+
+#include "base/file.h"
+#include "sat/sat_base.h"
+
+namespace operations_research {
+namespace sat {
+
+// Writes a proof in the binary DRAT format. Each line is a byte 'a' (addition)
+// or 'd' (deletion) followed by the literals of the clause and a zero. A
+// literal with DIMACS value x is written as the unsigned number 2 * |x| + (x <
+// 0) using a variable-length encoding of 7 bits per byte, the high bit of each
+// byte indicating that more bytes follow.
+//
+// The output is buffered and only written to the file by chunks, so the
+// overhead for the solver is just the encoding of the clauses. Note that the
+// file can be a named pipe read by a checker running concurrently.
+class DratWriter {
+ public:
+  // The given file must be open for writing. It is not owned and is not closed
+  // by this class, but it is flushed on destruction.
+  explicit DratWriter(File* output);
+  ~DratWriter();
+
+  // Appends the addition (resp. the deletion) of the given clause to the
+  // proof. Use ClauseRef() for the empty clause.
+  void AddClause(ClauseRef clause);
+  void DeleteClause(ClauseRef clause);
+
+  // Writes the buffered content to the file and flushes it.
+  void Flush();
+
+  // Returns the number of bytes written so far, including the buffered ones.
+  int64 NumBytes() const { return num_flushed_bytes_ + buffer_.size(); }
+
+ private:
+  void WriteClause(char type, ClauseRef clause);
+  void WriteBufferIfNeeded();
+
+  File* output_;
+  std::string buffer_;
+  int64 num_flushed_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(DratWriter);
+};
+
+}  // namespace sat
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_SAT_DRAT_WRITER_H_
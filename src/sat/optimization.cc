@@ -15,7 +15,9 @@
 
 #include <deque>
 #include <queue>
+#include <set>
 
+#include "base/threadpool.h"
 #include "google/protobuf/descriptor.h"
 #include "sat/encoding.h"
 
@@ -939,6 +941,89 @@ bool EncodingNodeByDepth(const EncodingNode* a, const EncodingNode* b) {
 
 bool EmptyEncodingNode(const EncodingNode* a) { return a->size() == 0; }
 
+// Returns the min weight of all the nodes in the given core. The core must be
+// made of the negation of the first literal of some nodes, in the same order.
+Coefficient ComputeCoreMinWeight(const std::vector<EncodingNode*>& nodes,
+                                 const std::vector<Literal>& core) {
+  Coefficient min_weight = kCoefficientMax;
+  int index = 0;
+  for (int i = 0; i < core.size(); ++i) {
+    for (; index < nodes.size() &&
+               nodes[index]->literal(0).Negated() != core[i];
+         ++index) {
+    }
+    CHECK_LT(index, nodes.size());
+    min_weight = std::min(min_weight, nodes[index]->weight());
+  }
+  return min_weight;
+}
+
+// Relaxes the given core (same requirements as in ComputeCoreMinWeight()),
+// min_weight must be the min weight of its nodes. Returns the node whose bound
+// was increased: the node of a singleton core, or the node created by merging
+// the nodes of the core which replaces them at the end of nodes. The solver
+// must be at the root level.
+EncodingNode* ProcessCore(const std::vector<Literal>& core,
+                          Coefficient min_weight,
+                          std::deque<EncodingNode>* repository,
+                          std::vector<EncodingNode*>* nodes,
+                          SatSolver* solver) {
+  if (core.size() == 1) {
+    // The core will be reduced at the beginning of the next loop.
+    // Find the associated node, and call IncreaseNodeSize() on it.
+    for (EncodingNode* n : *nodes) {
+      if (n->literal(0).Negated() == core[0]) {
+        IncreaseNodeSize(n, solver);
+
+        // This may prove the model UNSAT, see SolveWithOLL().
+        solver->AddUnitClause(core[0].Negated());
+        return n;
+      }
+    }
+    LOG(FATAL) << "Core literal not found.";
+  }
+
+  // Remove from nodes the EncodingNode in the core, merge them, and add the
+  // resulting EncodingNode at the back.
+  int index = 0;
+  int new_node_index = 0;
+  std::vector<EncodingNode*> to_merge;
+  for (int i = 0; i < core.size(); ++i) {
+    // Since the nodes appear in order in the core, we can find the
+    // relevant "objective" variable efficiently with a simple linear scan
+    // in the nodes vector (done with index).
+    for (; (*nodes)[index]->literal(0).Negated() != core[i]; ++index) {
+      CHECK_LT(index, nodes->size());
+      (*nodes)[new_node_index] = (*nodes)[index];
+      ++new_node_index;
+    }
+    CHECK_LT(index, nodes->size());
+    to_merge.push_back((*nodes)[index]);
+
+    // Special case if the weight > min_weight. we keep it, but reduce its
+    // cost. This is the same "trick" as in WPM1 used to deal with weight.
+    // We basically split a clause with a larger weight in two identical
+    // clauses, one with weight min_weight that will be merged and one with
+    // the remaining weight.
+    if ((*nodes)[index]->weight() > min_weight) {
+      (*nodes)[index]->set_weight((*nodes)[index]->weight() - min_weight);
+      (*nodes)[new_node_index] = (*nodes)[index];
+      ++new_node_index;
+    }
+    ++index;
+  }
+  for (; index < nodes->size(); ++index) {
+    (*nodes)[new_node_index] = (*nodes)[index];
+    ++new_node_index;
+  }
+  nodes->resize(new_node_index);
+  nodes->push_back(LazyMergeAllNodeWithPQ(to_merge, solver, repository));
+  IncreaseNodeSize(nodes->back(), solver);
+  nodes->back()->set_weight(min_weight);
+  CHECK(solver->AddUnitClause(nodes->back()->literal(0)));
+  return nodes->back();
+}
+
 }  // namespace
 
 SatSolver::Status SolveWithCardinalityEncodingAndCore(
@@ -1076,18 +1161,7 @@ SatSolver::Status SolveWithCardinalityEncodingAndCore(
 
     // Compute the min weight of all the nodes in the core.
     // The lower bound will be increased by that much.
-    Coefficient min_weight = kCoefficientMax;
-    {
-      int index = 0;
-      for (int i = 0; i < core.size(); ++i) {
-        for (; index < nodes.size() &&
-                   nodes[index]->literal(0).Negated() != core[i];
-             ++index) {
-        }
-        CHECK_LT(index, nodes.size());
-        min_weight = std::min(min_weight, nodes[index]->weight());
-      }
-    }
+    const Coefficient min_weight = ComputeCoreMinWeight(nodes, core);
     previous_core_info =
         StringPrintf("core:%zu mw:%lld", core.size(), min_weight.value());
 
@@ -1100,57 +1174,353 @@ SatSolver::Status SolveWithCardinalityEncodingAndCore(
 
     // Backtrack to be able to add new constraints.
     solver->Backtrack(0);
+    const EncodingNode* node =
+        ProcessCore(core, min_weight, &repository, &nodes, solver);
+    max_depth = std::max(max_depth, node->depth());
+  }
+}
 
-    int new_node_index = 0;
-    if (core.size() == 1) {
-      // The core will be reduced at the beginning of the next loop.
-      // Find the associated node, and call IncreaseNodeSize() on it.
-      CHECK(solver->Assignment().LiteralIsFalse(core[0]));
-      for (EncodingNode* n : nodes) {
-        if (n->literal(0).Negated() == core[0]) {
-          IncreaseNodeSize(n, solver);
-          break;
+namespace {
+
+// Extracts disjoint cores of the given problem using only the given
+// assumptions with a new SatSolver. Each time a core is found, its literals
+// are removed from the assumptions, until they are satisfiable. The status is
+// set to MODEL_UNSAT if the problem is proven infeasible, in which case the
+// cores are meaningless.
+void ExtractDisjointCoresWithNewSolver(
+    const LinearBooleanProblem* problem, const SatParameters* parameters,
+    std::vector<Literal>* assumptions, std::vector<std::vector<Literal>>* cores,
+    SatSolver::Status* status) {
+  SatSolver solver;
+  solver.SetParameters(*parameters);
+  if (!LoadBooleanProblem(*problem, &solver)) {
+    *status = SatSolver::MODEL_UNSAT;
+    return;
+  }
+  while (!assumptions->empty()) {
+    *status = solver.ResetAndSolveWithGivenAssumptions(*assumptions);
+    if (*status != SatSolver::ASSUMPTIONS_UNSAT) return;
+    std::vector<Literal> core = solver.GetLastIncompatibleDecisions();
+    if (parameters->minimize_core()) {
+      MinimizeCore(&solver, &core);
+      if (solver.IsModelUnsat()) {
+        *status = SatSolver::MODEL_UNSAT;
+        return;
+      }
+    }
+
+    // The core literals appear in the same order as in the assumptions.
+    int index = 0;
+    int new_size = 0;
+    for (int i = 0; i < assumptions->size(); ++i) {
+      if (index < core.size() && (*assumptions)[i] == core[index]) {
+        ++index;
+      } else {
+        (*assumptions)[new_size] = (*assumptions)[i];
+        ++new_size;
+      }
+    }
+    CHECK_EQ(index, core.size());
+    assumptions->resize(new_size);
+    cores->push_back(core);
+  }
+}
+
+// Splits the given assumptions in num_threads subsets and calls
+// ExtractDisjointCoresWithNewSolver() on each of them in parallel. The found
+// cores are thus disjoint, and they are returned in a deterministic order.
+// Returns false if one of the solvers proved the problem infeasible.
+bool ExtractDisjointCoresInParallel(const LinearBooleanProblem& problem,
+                                    const SatParameters& parameters,
+                                    const std::vector<Literal>& assumptions,
+                                    int num_threads,
+                                    std::vector<std::vector<Literal>>* cores) {
+  num_threads =
+      std::max(1, std::min(num_threads, static_cast<int>(assumptions.size())));
+
+  // The assumptions are distributed in a round-robin fashion so that the
+  // subsets have a similar weight distribution. Note that each subset keeps the
+  // order of the given assumptions.
+  std::vector<std::vector<Literal>> subsets(num_threads);
+  for (int i = 0; i < assumptions.size(); ++i) {
+    subsets[i % num_threads].push_back(assumptions[i]);
+  }
+  std::vector<std::vector<std::vector<Literal>>> subset_cores(num_threads);
+  std::vector<SatSolver::Status> statuses(num_threads,
+                                          SatSolver::ASSUMPTIONS_UNSAT);
+  {
+    ThreadPool pool("CoreExtraction", num_threads);
+    pool.StartWorkers();
+    for (int i = 0; i < num_threads; ++i) {
+      pool.Add(NewCallback(&ExtractDisjointCoresWithNewSolver, &problem,
+                           &parameters, &subsets[i], &subset_cores[i],
+                           &statuses[i]));
+    }
+  }
+  for (const SatSolver::Status status : statuses) {
+    if (status == SatSolver::MODEL_UNSAT) return false;
+  }
+  for (std::vector<std::vector<Literal>>& c : subset_cores) {
+    for (std::vector<Literal>& core : c) {
+      cores->push_back(std::vector<Literal>());
+      cores->back().swap(core);
+    }
+  }
+  return true;
+}
+
+// Core exhaustion. As long as the first active literal of the given node can
+// be shown to be true when it is the only assumption, this increases the
+// bound of the node. Returns the resulting increase of the objective lower
+// bound. This stops early if the model is proven UNSAT.
+Coefficient ExhaustCore(EncodingNode* node, SatSolver* solver) {
+  Coefficient increase(0);
+  while (true) {
+    solver->Backtrack(0);
+    increase += node->Reduce(*solver) * node->weight();
+    if (node->size() == 0) break;
+    const std::vector<Literal> assumption(1, node->literal(0).Negated());
+    if (solver->ResetAndSolveWithGivenAssumptions(assumption) !=
+        SatSolver::ASSUMPTIONS_UNSAT) {
+      break;
+    }
+    solver->Backtrack(0);
+    IncreaseNodeSize(node, solver);
+    if (!solver->AddUnitClause(node->literal(0))) break;
+  }
+  solver->Backtrack(0);
+  return increase;
+}
+
+}  // namespace
+
+SatSolver::Status SolveWithOLL(LogBehavior log,
+                               const LinearBooleanProblem& problem,
+                               SatSolver* solver, std::vector<bool>* solution) {
+  Logger logger(log);
+  const SatParameters parameters = solver->parameters();
+  std::deque<EncodingNode> repository;
+
+  // Create one initial nodes per variables with cost.
+  Coefficient offset(0);
+  std::vector<EncodingNode*> nodes =
+      CreateInitialEncodingNodes(problem.objective(), &offset, &repository);
+
+  // Initialize the bounds.
+  // This is in term of number of variables not at their minimal value.
+  Coefficient lower_bound(0);
+  Coefficient upper_bound(kint64max);
+  if (!solution->empty()) {
+    CHECK(IsAssignmentValid(problem, *solution));
+    upper_bound = ComputeObjectiveValue(problem, *solution) + offset;
+  }
+
+  // Print the number of variables with a non-zero cost.
+  logger.Log(StringPrintf("c #weights:%zu #vars:%d #constraints:%d",
+                          nodes.size(), problem.num_variables(),
+                          problem.constraints_size()));
+
+  // This is used by the "stratified" approach.
+  Coefficient stratified_lower_bound(0);
+  if (parameters.max_sat_stratification() ==
+      SatParameters::STRATIFICATION_DESCENT) {
+    // In this case, we initialize it to the maximum assumption weights.
+    for (EncodingNode* n : nodes) {
+      stratified_lower_bound = std::max(stratified_lower_bound, n->weight());
+    }
+  }
+
+  // The disjoint cores found since the last relaxation, and the assumptions
+  // they contain which are not used until these cores are relaxed. Note that
+  // while there are such cores, the nodes are not modified so that the core
+  // literals still correspond to their first literal.
+  std::vector<std::vector<Literal>> cores;
+  std::set<LiteralIndex> excluded_assumptions;
+  bool relax_cores = false;
+
+  if (parameters.max_sat_num_core_extraction_threads() > 1) {
+    std::vector<Literal> assumptions;
+    for (EncodingNode* n : nodes) {
+      if (n->weight() >= stratified_lower_bound) {
+        assumptions.push_back(n->literal(0).Negated());
+      }
+    }
+    if (!ExtractDisjointCoresInParallel(
+            problem, parameters, assumptions,
+            parameters.max_sat_num_core_extraction_threads(), &cores)) {
+      return SatSolver::MODEL_UNSAT;
+    }
+    for (const std::vector<Literal>& core : cores) {
+      for (const Literal l : core) excluded_assumptions.insert(l.Index());
+    }
+    logger.Log(StringPrintf("c parallel core extraction: %zu cores",
+                            cores.size()));
+    relax_cores = !parameters.max_sat_use_weight_aware_core_extraction();
+  }
+
+  // Start the algorithm.
+  int max_depth = 0;
+  std::string previous_core_info = "";
+  for (int iter = 0;; ++iter) {
+    solver->Backtrack(0);
+    if (relax_cores || cores.empty()) {
+      // Relax all the found cores. Since they are disjoint, the relaxation of
+      // one of them doesn't change the nodes of the others. Note that the
+      // exhaustion is done afterwards because it may empty some nodes.
+      std::vector<EncodingNode*> relaxed_nodes;
+      for (const std::vector<Literal>& core : cores) {
+        relaxed_nodes.push_back(ProcessCore(core,
+                                            ComputeCoreMinWeight(nodes, core),
+                                            &repository, &nodes, solver));
+        max_depth = std::max(max_depth, relaxed_nodes.back()->depth());
+      }
+      if (parameters.max_sat_use_core_exhaustion()) {
+        for (EncodingNode* node : relaxed_nodes) {
+          if (solver->IsModelUnsat()) break;
+          lower_bound += ExhaustCore(node, solver);
         }
       }
-    } else {
-      // Remove from nodes the EncodingNode in the core, merge them, and add the
-      // resulting EncodingNode at the back.
-      int index = 0;
-      std::vector<EncodingNode*> to_merge;
-      for (int i = 0; i < core.size(); ++i) {
-        // Since the nodes appear in order in the core, we can find the
-        // relevant "objective" variable efficiently with a simple linear scan
-        // in the nodes vector (done with index).
-        for (; nodes[index]->literal(0).Negated() != core[i]; ++index) {
-          CHECK_LT(index, nodes.size());
-          nodes[new_node_index] = nodes[index];
-          ++new_node_index;
+      cores.clear();
+      excluded_assumptions.clear();
+      relax_cores = false;
+
+      // Remove the left-most variables fixed to one from each node.
+      // Also update the lower_bound. Note that Reduce() needs the solver to be
+      // at the root node in order to work.
+      for (EncodingNode* n : nodes) {
+        lower_bound += n->Reduce(*solver) * n->weight();
+      }
+
+      // Fix the nodes right-most variables that are above the gap.
+      if (upper_bound != kCoefficientMax) {
+        const Coefficient gap = upper_bound - lower_bound;
+        if (gap == 0) return SatSolver::MODEL_SAT;
+        for (EncodingNode* n : nodes) {
+          n->ApplyUpperBound((gap / n->weight()).value(), solver);
         }
-        CHECK_LT(index, nodes.size());
-        to_merge.push_back(nodes[index]);
-
-        // Special case if the weight > min_weight. we keep it, but reduce its
-        // cost. This is the same "trick" as in WPM1 used to deal with weight.
-        // We basically split a clause with a larger weight in two identical
-        // clauses, one with weight min_weight that will be merged and one with
-        // the remaining weight.
-        if (nodes[index]->weight() > min_weight) {
-          nodes[index]->set_weight(nodes[index]->weight() - min_weight);
-          nodes[new_node_index] = nodes[index];
-          ++new_node_index;
+      }
+
+      // Remove the empty nodes.
+      nodes.erase(
+          std::remove_if(nodes.begin(), nodes.end(), EmptyEncodingNode),
+          nodes.end());
+
+      // Sort the nodes.
+      switch (parameters.max_sat_assumption_order()) {
+        case SatParameters::DEFAULT_ASSUMPTION_ORDER:
+          break;
+        case SatParameters::ORDER_ASSUMPTION_BY_DEPTH:
+          std::sort(nodes.begin(), nodes.end(), EncodingNodeByDepth);
+          break;
+        case SatParameters::ORDER_ASSUMPTION_BY_WEIGHT:
+          std::sort(nodes.begin(), nodes.end(), EncodingNodeByWeight);
+          break;
+      }
+      if (parameters.max_sat_reverse_assumption_order()) {
+        std::reverse(nodes.begin(), nodes.end());
+      }
+    }
+
+    // Extract the assumptions from the nodes.
+    std::vector<Literal> assumptions;
+    for (EncodingNode* n : nodes) {
+      const Literal a = n->literal(0).Negated();
+      if (n->weight() >= stratified_lower_bound &&
+          excluded_assumptions.count(a.Index()) == 0) {
+        assumptions.push_back(a);
+      }
+    }
+    if (assumptions.empty() && !cores.empty()) {
+      relax_cores = true;
+      continue;
+    }
+
+    // Display the progress.
+    const std::string gap_string =
+        (upper_bound == kCoefficientMax)
+            ? ""
+            : StringPrintf(" gap:%lld", (upper_bound - lower_bound).value());
+    logger.Log(StringPrintf(
+        "c iter:%d [%s] lb:%lld%s assumptions:%zu cores:%zu depth:%d", iter,
+        previous_core_info.c_str(),
+        lower_bound.value() - offset.value() +
+            static_cast<int64>(problem.objective().offset()),
+        gap_string.c_str(), assumptions.size(), cores.size(), max_depth));
+
+    // The relaxation of the cores may prove that there is no solution better
+    // than the current one, or none at all if there is no current solution.
+    if (solver->IsModelUnsat()) {
+      return solution->empty() ? SatSolver::MODEL_UNSAT : SatSolver::MODEL_SAT;
+    }
+
+    // Solve under the assumptions.
+    const SatSolver::Status result =
+        solver->ResetAndSolveWithGivenAssumptions(assumptions);
+    if (result == SatSolver::MODEL_SAT) {
+      // Extract the new solution and save it if it is the best found so far.
+      std::vector<bool> temp_solution;
+      ExtractAssignment(problem, *solver, &temp_solution);
+      CHECK(IsAssignmentValid(problem, temp_solution));
+      const Coefficient obj = ComputeObjectiveValue(problem, temp_solution);
+      if (obj + offset < upper_bound) {
+        *solution = temp_solution;
+        logger.Log(CnfObjectiveLine(problem, obj));
+        upper_bound = obj + offset;
+      }
+
+      // The remaining assumptions are satisfiable, relax the found cores.
+      if (!cores.empty()) {
+        relax_cores = true;
+        continue;
+      }
+
+      // If not all assumptions where taken, continue with a lower stratified
+      // bound. Otherwise we have an optimal solution.
+      const Coefficient old_lower_bound = stratified_lower_bound;
+      for (EncodingNode* n : nodes) {
+        if (n->weight() < old_lower_bound) {
+          if (stratified_lower_bound == old_lower_bound ||
+              n->weight() > stratified_lower_bound) {
+            stratified_lower_bound = n->weight();
+          }
         }
-        ++index;
       }
-      for (; index < nodes.size(); ++index) {
-        nodes[new_node_index] = nodes[index];
-        ++new_node_index;
+      if (stratified_lower_bound < old_lower_bound) continue;
+      return SatSolver::MODEL_SAT;
+    }
+    if (result == SatSolver::MODEL_UNSAT) {
+      return solution->empty() ? SatSolver::MODEL_UNSAT : SatSolver::MODEL_SAT;
+    }
+    if (result != SatSolver::ASSUMPTIONS_UNSAT) return result;
+
+    // We have a new core.
+    std::vector<Literal> core = solver->GetLastIncompatibleDecisions();
+    if (parameters.minimize_core()) {
+      MinimizeCore(solver, &core);
+      if (solver->IsModelUnsat()) {
+        return solution->empty() ? SatSolver::MODEL_UNSAT
+                                 : SatSolver::MODEL_SAT;
       }
-      nodes.resize(new_node_index);
-      nodes.push_back(LazyMergeAllNodeWithPQ(to_merge, solver, &repository));
-      IncreaseNodeSize(nodes.back(), solver);
-      max_depth = std::max(max_depth, nodes.back()->depth());
-      nodes.back()->set_weight(min_weight);
-      CHECK(solver->AddUnitClause(nodes.back()->literal(0)));
+    }
+    const Coefficient min_weight = ComputeCoreMinWeight(nodes, core);
+    previous_core_info =
+        StringPrintf("core:%zu mw:%lld", core.size(), min_weight.value());
+
+    // Increase stratified_lower_bound according to the parameters.
+    if (stratified_lower_bound < min_weight &&
+        parameters.max_sat_stratification() ==
+            SatParameters::STRATIFICATION_ASCENT) {
+      stratified_lower_bound = min_weight;
+    }
+
+    // A singleton core is relaxed right away since its literal is now fixed
+    // at the root level.
+    cores.push_back(core);
+    if (core.size() > 1 &&
+        parameters.max_sat_use_weight_aware_core_extraction()) {
+      for (const Literal l : core) excluded_assumptions.insert(l.Index());
+    } else {
+      relax_cores = true;
     }
   }
 }
@@ -112,6 +112,22 @@ SatSolver::Status SolveWithCardinalityEncodingAndCore(
     LogBehavior log, const LinearBooleanProblem& problem, SatSolver* solver,
     std::vector<bool>* solution);
 
+// Core-guided algorithm in the spirit of OLL (and its RC2 implementation). It
+// uses the same incremental totalizers over EncodingNode and the same weight
+// stratification as SolveWithCardinalityEncodingAndCore(), but also:
+// - delays the relaxation of the cores until the remaining assumptions are
+//   satisfiable (see max_sat_use_weight_aware_core_extraction),
+// - exhausts each relaxed core (see max_sat_use_core_exhaustion),
+// - can extract the first disjoint cores in parallel with independent solvers
+//   loaded with the given problem (see max_sat_num_core_extraction_threads).
+//
+// References: A. Morgado, C. Dodaro, J. Marques-Silva, "Core-Guided MaxSAT with
+// Soft Cardinality Constraints", CP 2014. J. Berg, M. Jarvisalo, "Weight-Aware
+// Core Extraction in SAT-Based MaxSAT Solving", CP 2017.
+SatSolver::Status SolveWithOLL(LogBehavior log,
+                               const LinearBooleanProblem& problem,
+                               SatSolver* solver, std::vector<bool>* solution);
+
 }  // namespace sat
 }  // namespace operations_research
 
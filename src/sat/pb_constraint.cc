@@ -829,6 +829,7 @@ bool PbConstraints::AddConstraint(const std::vector<LiteralWithCoeff>& cst,
   // Special case if this is the first constraint.
   if (constraints_.empty()) {
     to_update_.resize(trail->NumVariables() << 1);
+    cardinality_to_update_.resize(trail->NumVariables() << 1);
     enqueue_helper_.propagator_id = propagator_id_;
     enqueue_helper_.reasons.resize(trail->NumVariables());
     propagation_trail_index_ = trail->Index();
@@ -857,9 +858,18 @@ bool PbConstraints::AddConstraint(const std::vector<LiteralWithCoeff>& cst,
         // ResolutionNode. TODO(user): The old one could be unlocked at this
         // point.
         candidate->ChangeResolutionNode(node);
-        return candidate->InitializeRhs(rhs, propagation_trail_index_,
-                                        &thresholds_[i], trail,
-                                        &enqueue_helper_);
+        if (!candidate->IsCardinality()) {
+          return candidate->InitializeRhs(rhs, propagation_trail_index_,
+                                          &thresholds_[i], trail,
+                                          &enqueue_helper_);
+        }
+        Coefficient threshold(0);
+        const bool result = candidate->InitializeRhs(
+            rhs, propagation_trail_index_, &threshold, trail, &enqueue_helper_);
+        cardinality_states_[i].threshold = threshold.value();
+        cardinality_states_[i].untrail_trail_index =
+            LastProcessedTrueLiteralTrailIndex(cst, *trail);
+        return result;
       } else {
         // The constraint is redundant, so there is nothing to do.
         return true;
@@ -875,8 +885,22 @@ bool PbConstraints::AddConstraint(const std::vector<LiteralWithCoeff>& cst,
   }
 
   const ConstraintIndex cst_index(constraints_.size());
+  const bool is_cardinality = c->IsCardinality();
   duplicate_candidates.push_back(c.get());
   constraints_.emplace_back(c.release());
+  cardinality_states_.push_back(CardinalityState());
+  if (is_cardinality) {
+    // Note that untrailing the returned literal may not change the constraint
+    // state, but an unneeded Untrail() call is harmless.
+    CardinalityState& state = cardinality_states_.back();
+    state.threshold = thresholds_.back().value();
+    state.untrail_trail_index = LastProcessedTrueLiteralTrailIndex(cst, *trail);
+    for (LiteralWithCoeff term : cst) {
+      DCHECK_LT(term.literal.Index(), cardinality_to_update_.size());
+      cardinality_to_update_[term.literal.Index()].push_back(cst_index);
+    }
+    return true;
+  }
   for (LiteralWithCoeff term : cst) {
     DCHECK_LT(term.literal.Index(), to_update_.size());
     to_update_[term.literal.Index()].push_back(ConstraintIndexWithCoeff(
@@ -886,6 +910,19 @@ bool PbConstraints::AddConstraint(const std::vector<LiteralWithCoeff>& cst,
   return true;
 }
 
+int PbConstraints::LastProcessedTrueLiteralTrailIndex(
+    const std::vector<LiteralWithCoeff>& cst, const Trail& trail) const {
+  int result = -1;
+  for (LiteralWithCoeff term : cst) {
+    if (!trail.Assignment().LiteralIsTrue(term.literal)) continue;
+    const int trail_index = trail.Info(term.literal.Variable()).trail_index;
+    if (trail_index < propagation_trail_index_) {
+      result = std::max(result, trail_index);
+    }
+  }
+  return result;
+}
+
 bool PbConstraints::AddLearnedConstraint(const std::vector<LiteralWithCoeff>& cst,
                                          Coefficient rhs, ResolutionNode* node,
                                          Trail* trail) {
@@ -916,28 +953,50 @@ bool PbConstraints::PropagateNext(Trail* trail) {
         thresholds_[update.index] - update.coefficient;
     thresholds_[update.index] = threshold;
     if (threshold < 0 && !conflict) {
-      UpperBoundedLinearConstraint* const cst =
-          constraints_[update.index.value()].get();
       update.need_untrail_inspection = true;
-      ++num_constraint_lookups_;
-      const int old_value = cst->already_propagated_end();
-      if (!cst->Propagate(source_trail_index, &thresholds_[update.index], trail,
-                          &enqueue_helper_)) {
-        trail->MutableConflict()->swap(enqueue_helper_.conflict);
-        trail->SetFailingResolutionNode(cst->ResolutionNodePointer());
-        conflicting_constraint_index_ = update.index;
-        conflict = true;
-
-        // We bump the activity of the conflict.
-        BumpActivity(constraints_[update.index.value()].get());
-      }
-      num_inspected_constraint_literals_ +=
-          old_value - cst->already_propagated_end();
+      conflict = !PropagateConstraint(update.index, source_trail_index,
+                                      &thresholds_[update.index], trail);
+    }
+  }
+
+  // Same for the cardinality constraints.
+  num_threshold_updates_ += cardinality_to_update_[true_literal.Index()].size();
+  for (const ConstraintIndex index :
+       cardinality_to_update_[true_literal.Index()]) {
+    CardinalityState& state = cardinality_states_[index];
+    --state.threshold;
+    if (state.threshold < 0 && !conflict) {
+      state.untrail_trail_index = source_trail_index;
+      Coefficient threshold(state.threshold);
+      conflict = !PropagateConstraint(index, source_trail_index, &threshold,
+                                      trail);
+      state.threshold = threshold.value();
     }
   }
   return !conflict;
 }
 
+bool PbConstraints::PropagateConstraint(ConstraintIndex index,
+                                        int source_trail_index,
+                                        Coefficient* threshold, Trail* trail) {
+  UpperBoundedLinearConstraint* const cst = constraints_[index.value()].get();
+  ++num_constraint_lookups_;
+  const int old_value = cst->already_propagated_end();
+  const bool result =
+      cst->Propagate(source_trail_index, threshold, trail, &enqueue_helper_);
+  num_inspected_constraint_literals_ +=
+      old_value - cst->already_propagated_end();
+  if (!result) {
+    trail->MutableConflict()->swap(enqueue_helper_.conflict);
+    trail->SetFailingResolutionNode(cst->ResolutionNodePointer());
+    conflicting_constraint_index_ = index;
+
+    // We bump the activity of the conflict.
+    BumpActivity(cst);
+  }
+  return result;
+}
+
 bool PbConstraints::Propagate(Trail* trail) {
   const int old_index = trail->Index();
   while (trail->Index() == old_index && propagation_trail_index_ < old_index) {
@@ -962,10 +1021,26 @@ void PbConstraints::Untrail(const Trail& trail, int trail_index) {
         to_untrail_.Set(update.index);
       }
     }
+    for (const ConstraintIndex index :
+         cardinality_to_update_[literal.Index()]) {
+      CardinalityState& state = cardinality_states_[index];
+      ++state.threshold;
+      if (state.untrail_trail_index == propagation_trail_index_) {
+        state.untrail_trail_index = -1;
+        to_untrail_.Set(index);
+      }
+    }
   }
   for (ConstraintIndex cst_index : to_untrail_.PositionsSetAtLeastOnce()) {
-    constraints_[cst_index.value()]->Untrail(&(thresholds_[cst_index]),
-                                             trail_index);
+    UpperBoundedLinearConstraint* const cst =
+        constraints_[cst_index.value()].get();
+    if (cst->IsCardinality()) {
+      Coefficient threshold(cardinality_states_[cst_index].threshold);
+      cst->Untrail(&threshold, trail_index);
+      cardinality_states_[cst_index].threshold = threshold.value();
+    } else {
+      cst->Untrail(&(thresholds_[cst_index]), trail_index);
+    }
   }
 }
 
@@ -1107,6 +1182,7 @@ void PbConstraints::DeleteConstraintMarkedForDeletion() {
       if (new_index < i) {
         constraints_[new_index.value()] = std::move(constraints_[i.value()]);
         thresholds_[new_index] = thresholds_[i];
+        cardinality_states_[new_index] = cardinality_states_[i];
       }
       ++new_index;
     } else {
@@ -1125,6 +1201,7 @@ void PbConstraints::DeleteConstraintMarkedForDeletion() {
   }
   constraints_.resize(new_index.value());
   thresholds_.resize(new_index.value());
+  cardinality_states_.resize(new_index.value());
 
   // This is the slow part, we need to remap all the ConstraintIndex to the
   // new ones.
@@ -1141,6 +1218,15 @@ void PbConstraints::DeleteConstraintMarkedForDeletion() {
     }
     updates.resize(new_index);
   }
+  for (LiteralIndex lit(0); lit < cardinality_to_update_.size(); ++lit) {
+    std::vector<ConstraintIndex>& updates = cardinality_to_update_[lit];
+    int new_index = 0;
+    for (int i = 0; i < updates.size(); ++i) {
+      const ConstraintIndex m = index_mapping[updates[i]];
+      if (m != -1) updates[new_index++] = m;
+    }
+    updates.resize(new_index);
+  }
 }
 
 }  // namespace sat
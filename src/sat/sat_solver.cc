@@ -25,6 +25,7 @@
 #include "base/split.h"
 #include "base/join.h"
 #include "base/stl_util.h"
+#include "sat/simplification.h"
 #include "util/saturated_arithmetic.h"
 
 namespace operations_research {
@@ -53,8 +54,11 @@ SatSolver::SatSolver()
       conflicts_until_next_strategy_change_(0),
       strategy_counter_(0),
       same_reason_identifier_(trail_),
+      drat_writer_(nullptr),
       is_relevant_for_core_computation_(true),
       time_limit_(TimeLimit::Infinite()),
+      deterministic_time_of_last_inprocessing_(0.0),
+      num_eliminated_variables_(0),
       deterministic_time_at_last_advanced_time_limit_(0.0),
       stats_("SatSolver") {
   trail_.RegisterPropagator(&binary_implication_graph_);
@@ -98,6 +102,11 @@ void SatSolver::SetNumVariables(int num_variables) {
   pb_constraints_.Resize(num_variables);
   decisions_.resize(num_variables);
   same_reason_identifier_.Resize(num_variables);
+  is_eliminated_.resize(num_variables, false);
+  is_frozen_.resize(num_variables, false);
+  if (postsolver_ != nullptr) {
+    postsolver_->IncreaseNumVariablesTo(num_variables);
+  }
 
   // Used by NextBranch() for the decision heuristic.
   activities_.resize(num_variables, 0.0);
@@ -138,7 +147,8 @@ double SatSolver::deterministic_time() const {
                  // Here there is a factor 2 because of the untrail.
                  20.0 * pb_constraints_.num_constraint_lookups() +
                  2.0 * pb_constraints_.num_threshold_updates() +
-                 1.0 * pb_constraints_.num_inspected_constraint_literals());
+                 1.0 * pb_constraints_.num_inspected_constraint_literals() +
+                 1.0 * counters_.num_inprocessing_inspections);
 }
 
 const SatParameters& SatSolver::parameters() const {
@@ -178,6 +188,9 @@ bool SatSolver::IsMemoryLimitReached() const {
 }
 
 bool SatSolver::SetModelUnsat() {
+  if (drat_writer_ != nullptr && !is_model_unsat_) {
+    drat_writer_->AddClause(ClauseRef());
+  }
   is_model_unsat_ = true;
   return false;
 }
@@ -185,6 +198,7 @@ bool SatSolver::SetModelUnsat() {
 bool SatSolver::AddUnitClause(Literal true_literal) {
   SCOPED_TIME_STAT(&stats_);
   CHECK_EQ(CurrentDecisionLevel(), 0);
+  CHECK(!VariableWasEliminated(true_literal.Variable()));
   if (is_model_unsat_) return false;
   if (trail_.Assignment().LiteralIsFalse(true_literal)) return SetModelUnsat();
   if (trail_.Assignment().LiteralIsTrue(true_literal)) return true;
@@ -323,6 +337,11 @@ bool SatSolver::AddLinearConstraint(bool use_lower_bound,
   SCOPED_TIME_STAT(&stats_);
   CHECK_EQ(CurrentDecisionLevel(), 0);
   if (is_model_unsat_) return false;
+  if (num_eliminated_variables_ > 0) {
+    for (const LiteralWithCoeff& term : *cst) {
+      CHECK(!VariableWasEliminated(term.literal.Variable()));
+    }
+  }
 
   // This block removes assigned literals from the constraint.
   //
@@ -331,8 +350,11 @@ bool SatSolver::AddLinearConstraint(bool use_lower_bound,
   // ResolutionNode associated with this constraint. However, for pseudo-Boolean
   // constraints, we would loose the minimization of the reason which seems
   // important in order to get smaller core.
+  //
+  // This is also disabled with a DRAT proof, so that the clauses of the solver
+  // are exactly the ones known by the proof checker.
   Coefficient fixed_variable_shift(0);
-  if (!parameters_.unsat_proof()) {
+  if (!parameters_.unsat_proof() && drat_writer_ == nullptr) {
     int index = 0;
     for (const LiteralWithCoeff& term : *cst) {
       if (trail_.Assignment().LiteralIsFalse(term.literal)) continue;
@@ -379,6 +401,7 @@ bool SatSolver::AddLinearConstraint(bool use_lower_bound,
 void SatSolver::AddLearnedClauseAndEnqueueUnitPropagation(
     const std::vector<Literal>& literals, bool is_redundant, ResolutionNode* node) {
   SCOPED_TIME_STAT(&stats_);
+  if (drat_writer_ != nullptr) drat_writer_->AddClause(ClauseRef(literals));
   if (literals.size() == 1) {
     // A length 1 clause fix a literal for all the search.
     // ComputeBacktrackLevel() should have returned 0.
@@ -901,6 +924,8 @@ bool SatSolver::AddBinaryClauses(const std::vector<BinaryClause>& clauses) {
   SCOPED_TIME_STAT(&stats_);
   CHECK_EQ(CurrentDecisionLevel(), 0);
   for (BinaryClause c : clauses) {
+    CHECK(!VariableWasEliminated(c.a.Variable()));
+    CHECK(!VariableWasEliminated(c.b.Variable()));
     if (trail_.Assignment().LiteralIsFalse(c.a) &&
         trail_.Assignment().LiteralIsFalse(c.b)) {
       return SetModelUnsat();
@@ -933,12 +958,64 @@ SatSolver::Status SatSolver::ResetAndSolveWithGivenAssumptions(
   CHECK_LE(assumptions.size(), num_variables_);
   Backtrack(0);
   for (int i = 0; i < assumptions.size(); ++i) {
+    CHECK(!VariableWasEliminated(assumptions[i].Variable()));
     decisions_[i].literal = assumptions[i];
   }
   assumption_level_ = assumptions.size();
   return SolveInternal(time_limit_.get());
 }
 
+Literal SatSolver::NewClauseGroup() {
+  SCOPED_TIME_STAT(&stats_);
+  const VariableIndex var = num_variables_;
+  SetNumVariables(num_variables_.value() + 1);
+  FreezeVariable(var);
+  const Literal selector(var, true);
+  active_clause_groups_.push_back(selector);
+  return selector;
+}
+
+bool SatSolver::AddClauseToGroup(Literal selector,
+                                 const std::vector<Literal>& literals) {
+  SCOPED_TIME_STAT(&stats_);
+  DCHECK(std::find(active_clause_groups_.begin(), active_clause_groups_.end(),
+                   selector) != active_clause_groups_.end());
+  Backtrack(0);
+  std::vector<Literal> clause(literals);
+  clause.push_back(selector.Negated());
+  return AddProblemClause(clause);
+}
+
+void SatSolver::RemoveClauseGroup(Literal selector) {
+  SCOPED_TIME_STAT(&stats_);
+  const auto it = std::find(active_clause_groups_.begin(),
+                            active_clause_groups_.end(), selector);
+  CHECK(it != active_clause_groups_.end());
+  active_clause_groups_.erase(it);
+  Backtrack(0);
+  if (!AddUnitClause(selector.Negated())) return;
+
+  // This detaches the clauses of the group and the learned clauses containing
+  // not(selector) since they are now always true.
+  ProcessNewlyFixedVariableResolutionNodes();
+  ProcessNewlyFixedVariables();
+}
+
+SatSolver::Status SatSolver::SolveIncrementally(
+    const std::vector<Literal>& assumptions) {
+  SCOPED_TIME_STAT(&stats_);
+  if (is_model_unsat_) return MODEL_UNSAT;
+  std::vector<Literal> all_assumptions(active_clause_groups_);
+  all_assumptions.insert(all_assumptions.end(), assumptions.begin(),
+                         assumptions.end());
+  return ResetAndSolveWithGivenAssumptions(all_assumptions);
+}
+
+void SatSolver::FreezeVariable(VariableIndex var) {
+  CHECK(!VariableWasEliminated(var));
+  is_frozen_[var] = true;
+}
+
 SatSolver::Status SatSolver::StatusWithLog(Status status) {
   if (parameters_.log_search_progress()) {
     LOG(INFO) << RunningStatisticsString();
@@ -1076,9 +1153,14 @@ SatSolver::Status SatSolver::SolveInternal(TimeLimit* time_limit) {
         assumption_level_ = CurrentDecisionLevel();
       }
 
-      // At a leaf?
-      if (trail_.Index() == num_variables_.value()) {
-        return StatusWithLog(MODEL_SAT);
+      // At a leaf? Note that the eliminated variables are only assigned once
+      // all the other variables are.
+      if (trail_.Index() + num_eliminated_variables_ >=
+          num_variables_.value()) {
+        if (num_eliminated_variables_ > 0) AssignEliminatedVariables();
+        if (trail_.Index() == num_variables_.value()) {
+          return StatusWithLog(MODEL_SAT);
+        }
       }
 
       // Restart?
@@ -1112,7 +1194,7 @@ SatSolver::Status SatSolver::SolveInternal(TimeLimit* time_limit) {
       }
       if (restart) {
         restart_count_++;
-        Backtrack(assumption_level_);
+        Backtrack(ComputeRestartLevel());
 
         // Strategy switch?
         if (conflicts_until_next_strategy_change_ == 0) {
@@ -1128,6 +1210,13 @@ SatSolver::Status SatSolver::SolveInternal(TimeLimit* time_limit) {
         lbd_running_average_.ClearWindow();
         conflicts_until_next_restart_ =
             parameters_.luby_restart_period() * SUniv(luby_count_ + 1);
+
+        // Simplify the clause database. We loop afterwards since this may
+        // fix new variables.
+        if (CurrentDecisionLevel() == 0 && parameters_.use_inprocessing()) {
+          if (!InprocessIfNeeded()) return StatusWithLog(MODEL_UNSAT);
+          continue;
+        }
       }
 
       DCHECK_GE(CurrentDecisionLevel(), assumption_level_);
@@ -1136,6 +1225,39 @@ SatSolver::Status SatSolver::SolveInternal(TimeLimit* time_limit) {
   }
 }
 
+int SatSolver::ComputeRestartLevel() {
+  SCOPED_TIME_STAT(&stats_);
+  if (!parameters_.use_trail_reuse_on_restart()) return assumption_level_;
+
+  // The inprocessing can only run at level zero.
+  if (assumption_level_ == 0 && InprocessingIsDue()) return 0;
+
+  // Find the variable that NextBranch() would choose. Like in NextBranch(), the
+  // assigned variables are removed from the top of the priority queue.
+  if (!is_var_ordering_initialized_) InitializeVariableOrdering();
+  while (!var_ordering_.IsEmpty()) {
+    const VariableIndex var(var_ordering_.Top() - &queue_elements_.front());
+    if (!trail_.Assignment().VariableIsAssigned(var) && !is_eliminated_[var]) {
+      break;
+    }
+    var_ordering_.Pop();
+    if (trail_.Assignment().VariableIsAssigned(var)) {
+      pq_need_update_for_var_at_trail_index_.Set(trail_.Info(var).trail_index);
+    }
+  }
+  if (var_ordering_.IsEmpty()) return assumption_level_;
+  const double next_activity = var_ordering_.Top()->weight;
+
+  // Keep all the decisions that would be taken before this variable.
+  int level = assumption_level_;
+  while (level < CurrentDecisionLevel() &&
+         activities_[decisions_[level].literal.Variable()] > next_activity) {
+    ++level;
+  }
+  counters_.num_reused_decisions += level - assumption_level_;
+  return level;
+}
+
 SatSolver::Status SatSolver::SolveWithTimeLimit(TimeLimit* time_limit) {
   deterministic_time_at_last_advanced_time_limit_ = deterministic_time();
   return SolveInternal(time_limit);
@@ -1267,6 +1389,15 @@ void SatSolver::BumpClauseActivity(SatClause* clause) {
       }
   }
 
+  // Keep the LBD up to date so that the clause can move to the second tier.
+  // Note that above, the lbd may already have been updated.
+  if (new_lbd + 1 < it->second.lbd &&
+      parameters_.clause_cleanup_tier2_lbd_bound() >
+          parameters_.clause_cleanup_lbd_bound()) {
+    it->second.lbd = new_lbd + 1;
+  }
+  it->second.last_bump_num_failures = counters_.num_failures;
+
   // Increase the activity.
   const double activity = it->second.activity += clause_activity_increment_;
   if (activity > parameters_.max_clause_activity_value()) {
@@ -1418,7 +1549,18 @@ std::string SatSolver::StatusString(Status status) const {
                           counters_.num_failures) +
          StringPrintf("  num subsumed clauses: %lld\n",
                       counters_.num_subsumed_clauses) +
-         StringPrintf("  num restarts: %d\n", restart_count_) +
+         StringPrintf("  num restarts: %d  (reused decisions: %lld)\n",
+                      restart_count_, counters_.num_reused_decisions) +
+         StringPrintf("  num inprocessing rounds: %lld\n",
+                      counters_.num_inprocessing_rounds) +
+         StringPrintf("  num substituted literals: %lld\n",
+                      counters_.num_substituted_literals) +
+         StringPrintf("  num vivified literals removed: %lld\n",
+                      counters_.num_vivified_literals_removed) +
+         StringPrintf("  num inprocessing subsumed clauses: %lld\n",
+                      counters_.num_inprocessing_subsumed_clauses) +
+         StringPrintf("  num eliminated variables: %lld\n",
+                      counters_.num_eliminated_variables) +
          StringPrintf("  pb num threshold updates: %lld\n",
                       pb_constraints_.num_threshold_updates()) +
          StringPrintf("  pb num constraint lookups: %lld\n",
@@ -1478,10 +1620,20 @@ void SatSolver::ProcessNewlyFixedVariables() {
   SCOPED_TIME_STAT(&stats_);
   DCHECK_EQ(CurrentDecisionLevel(), 0);
   std::vector<Literal> removed_literals;
+  std::vector<Literal> old_literals;
   std::vector<ResolutionNode*> resolution_nodes;
   int num_detached_clauses = 0;
   int num_binary = 0;
 
+  // The fixed literals are added to the proof as unit clauses because the
+  // clauses that propagated them may be deleted below.
+  if (drat_writer_ != nullptr) {
+    for (int i = num_processed_fixed_variables_; i < trail_.Index(); ++i) {
+      const Literal unit = trail_[i];
+      drat_writer_->AddClause(ClauseRef(&unit, &unit + 1));
+    }
+  }
+
   // We remove the clauses that are always true and the fixed literals from the
   // others.
   for (SatClause* clause : clauses_) {
@@ -1494,8 +1646,21 @@ void SatSolver::ProcessNewlyFixedVariables() {
         clauses_propagator_.LazyDetach(clause);
         ++num_detached_clauses;
       } else if (!removed_literals.empty()) {
+        if (drat_writer_ != nullptr) {
+          // The shortened clause is added before the old one is deleted.
+          // Note that the old clause is the new one plus the removed literals.
+          drat_writer_->AddClause(ClauseRef(clause->begin(), clause->end()));
+          old_literals.assign(clause->begin(), clause->end());
+          old_literals.insert(old_literals.end(), removed_literals.begin(),
+                              removed_literals.end());
+          drat_writer_->DeleteClause(ClauseRef(old_literals));
+        }
+        // Note that with a DRAT proof, the clause is not converted to a binary
+        // one since the later deletion of the SatClause would also delete the
+        // binary clause from the proof.
         if (clause->Size() == 2 &&
-            parameters_.treat_binary_clauses_separately()) {
+            parameters_.treat_binary_clauses_separately() &&
+            drat_writer_ == nullptr) {
           // This clause is now a binary clause, treat it separately. Note that
           // it is safe to do that because this clause can't be used as a reason
           // since we are at level zero and the clause is not satisfied.
@@ -1684,17 +1849,24 @@ Literal SatSolver::NextBranch() {
       var = VariableIndex(
           (*var_ordering_.Raw())[random_.Uniform(var_ordering_.Raw()->size())] -
           &queue_elements_.front());
-      if (!trail_.Assignment().VariableIsAssigned(var)) break;
-      pq_need_update_for_var_at_trail_index_.Set(trail_.Info(var).trail_index);
+      if (!trail_.Assignment().VariableIsAssigned(var)) {
+        if (!is_eliminated_[var]) break;
+      } else {
+        pq_need_update_for_var_at_trail_index_.Set(
+            trail_.Info(var).trail_index);
+      }
       var_ordering_.Remove(&queue_elements_[var]);
     }
   } else {
     // The loop is done this way in order to leave the final choice in the heap.
     DCHECK(!var_ordering_.IsEmpty());
     var = VariableIndex(var_ordering_.Top() - &queue_elements_.front());
-    while (trail_.Assignment().VariableIsAssigned(var)) {
+    while (trail_.Assignment().VariableIsAssigned(var) || is_eliminated_[var]) {
       var_ordering_.Pop();
-      pq_need_update_for_var_at_trail_index_.Set(trail_.Info(var).trail_index);
+      if (trail_.Assignment().VariableIsAssigned(var)) {
+        pq_need_update_for_var_at_trail_index_.Set(
+            trail_.Info(var).trail_index);
+      }
       DCHECK(!var_ordering_.IsEmpty());
       var = VariableIndex(var_ordering_.Top() - &queue_elements_.front());
     }
@@ -1849,8 +2021,9 @@ void SatSolver::UntrailWithoutPQUpdate(int target_trail_index) {
     const VariableIndex var = literal.Variable();
     polarity_[var].SetLastAssignmentValue(literal.IsPositive());
 
-    // We check that the priority queue doesn't need to be updated.
-    if (DEBUG_MODE && is_var_ordering_initialized_) {
+    // We check that the priority queue doesn't need to be updated. Note that
+    // the eliminated variables may have been removed from it.
+    if (DEBUG_MODE && is_var_ordering_initialized_ && !is_eliminated_[var]) {
       DCHECK(var_ordering_.Contains(&(queue_elements_[var])));
       DCHECK_EQ(activities_[var], queue_elements_[var].weight);
     }
@@ -1882,7 +2055,7 @@ void SatSolver::Untrail(int target_trail_index) {
         element->weight = new_weight;
         var_ordering_.Add(element);
       }
-    } else {
+    } else if (!is_eliminated_[var]) {
       DCHECK(var_ordering_.Contains(&(queue_elements_[var])));
       DCHECK_EQ(activities_[var], queue_elements_[var].weight);
     }
@@ -2630,6 +2803,9 @@ void SatSolver::DeleteDetachedClauses() {
   }
   for (std::vector<SatClause*>::iterator it = iter; it != clauses_.end(); ++it) {
     clauses_info_.erase(*it);
+    if (drat_writer_ != nullptr) {
+      drat_writer_->DeleteClause(ClauseRef((*it)->begin(), (*it)->end()));
+    }
   }
   STLDeleteContainerPointers(iter, clauses_.end());
   clauses_.erase(iter, clauses_.end());
@@ -2640,8 +2816,14 @@ void SatSolver::CleanClauseDatabaseIfNeeded() {
   SCOPED_TIME_STAT(&stats_);
 
   // Creates a list of clauses that can be deleted. Note that only the clauses
-  // that appear in clauses_info_ can potentially be removed.
+  // that appear in clauses_info_ can potentially be removed, and that the
+  // recently used clauses of the second tier are kept as well.
   typedef std::pair<SatClause*, ClauseInfo> Entry;
+  const int tier2_lbd_bound = parameters_.clause_cleanup_tier2_lbd_bound();
+  const int64 tier2_min_num_failures =
+      counters_.num_failures -
+      parameters_.clause_cleanup_tier2_max_unused_conflicts();
+  int num_tier2_clauses = 0;
   std::vector<Entry> entries;
   for (auto& entry : clauses_info_) {
     if (ClauseIsUsedAsReason(entry.first)) continue;
@@ -2649,9 +2831,15 @@ void SatSolver::CleanClauseDatabaseIfNeeded() {
       entry.second.protected_during_next_cleanup = false;
       continue;
     }
+    if (entry.second.lbd <= tier2_lbd_bound &&
+        entry.second.last_bump_num_failures >= tier2_min_num_failures) {
+      ++num_tier2_clauses;
+      continue;
+    }
     entries.push_back(entry);
   }
-  const int num_protected_clauses = clauses_info_.size() - entries.size();
+  const int num_protected_clauses =
+      clauses_info_.size() - entries.size() - num_tier2_clauses;
 
   if (parameters_.clause_cleanup_ordering() == SatParameters::CLAUSE_LBD) {
     // Order the clauses by decreasing LBD and then increasing activity.
@@ -2704,10 +2892,475 @@ void SatSolver::CleanClauseDatabaseIfNeeded() {
 
   num_learned_clause_before_cleanup_ = parameters_.clause_cleanup_period();
   VLOG(1) << "Database cleanup, #protected:" << num_protected_clauses
+          << " #tier2:" << num_tier2_clauses
           << " #kept:" << num_kept_clauses
           << " #deleted:" << num_deleted_clauses;
 }
 
+bool SatSolver::InprocessingIsDue() const {
+  // The inprocessing doesn't keep the resolution nodes up to date.
+  if (!parameters_.use_inprocessing() || parameters_.unsat_proof()) {
+    return false;
+  }
+  return deterministic_time() - deterministic_time_of_last_inprocessing_ >=
+         parameters_.inprocessing_min_deterministic_time_between_rounds();
+}
+
+bool SatSolver::InprocessIfNeeded() {
+  DCHECK_EQ(CurrentDecisionLevel(), 0);
+  DCHECK_EQ(assumption_level_, 0);
+  DCHECK(PropagationIsDone());
+  if (!InprocessingIsDue()) return true;
+  SCOPED_TIME_STAT(&stats_);
+  const double start_time = deterministic_time();
+  const double search_time =
+      start_time - deterministic_time_of_last_inprocessing_;
+  ++counters_.num_inprocessing_rounds;
+  const double limit =
+      start_time +
+      parameters_.inprocessing_deterministic_time_ratio() * search_time;
+  const int old_num_fixed_variables = trail_.Index();
+  const int old_num_clauses = clauses_.size();
+  const int64 old_num_implications =
+      binary_implication_graph_.NumberOfImplications();
+
+  // Start from a clause database without fixed literals.
+  if (num_processed_fixed_variables_ < trail_.Index()) {
+    ProcessNewlyFixedVariables();
+  }
+  DeleteDetachedClauses();
+
+  if (!SubstituteEquivalentLiterals()) return SetModelUnsat();
+  if (!VivifyLearnedClauses(limit)) return SetModelUnsat();
+  RemoveSubsumedClauses(limit);
+  if (parameters_.inprocessing_use_bve() &&
+      pb_constraints_.NumberOfConstraints() == 0 &&
+      external_propagators_.empty() && !track_binary_clauses_) {
+    if (!EliminateVariables(limit)) return SetModelUnsat();
+  }
+
+  if (num_processed_fixed_variables_ < trail_.Index()) {
+    ProcessNewlyFixedVariables();
+  }
+  DeleteDetachedClauses();
+  deterministic_time_of_last_inprocessing_ = deterministic_time();
+  if (parameters_.log_search_progress()) {
+    LOG(INFO) << "Inprocessing #" << counters_.num_inprocessing_rounds
+              << " fixed:" << old_num_fixed_variables << " -> "
+              << trail_.Index() << " clauses:" << old_num_clauses << " -> "
+              << clauses_.size() << " bin:" << old_num_implications << " -> "
+              << binary_implication_graph_.NumberOfImplications()
+              << " eliminated:" << num_eliminated_variables_ << " dtime:"
+              << deterministic_time_of_last_inprocessing_ - start_time;
+  }
+  return true;
+}
+
+bool SatSolver::AddInprocessingClause(std::vector<Literal>* literals,
+                                      SatClause* replaced) {
+  DCHECK_EQ(CurrentDecisionLevel(), 0);
+  DCHECK(replaced == nullptr || !replaced->IsAttached());
+  int new_size = 0;
+  for (const Literal l : *literals) {
+    if (trail_.Assignment().LiteralIsTrue(l)) return true;
+    if (trail_.Assignment().LiteralIsFalse(l)) continue;
+    (*literals)[new_size++] = l;
+  }
+  literals->resize(new_size);
+  if (literals->empty()) return false;
+  if (drat_writer_ != nullptr) drat_writer_->AddClause(ClauseRef(*literals));
+  if (literals->size() == 1) {
+    trail_.EnqueueWithUnitReason((*literals)[0], nullptr);
+    return Propagate();
+  }
+  if (literals->size() == 2 && parameters_.treat_binary_clauses_separately()) {
+    AddBinaryClauseInternal((*literals)[0], (*literals)[1]);
+    return true;
+  }
+  const bool is_redundant = replaced != nullptr && replaced->IsRedundant();
+  SatClause* clause = SatClause::Create(*literals, is_redundant, nullptr);
+  clauses_.push_back(clause);
+  if (is_redundant) {
+    const auto it = clauses_info_.find(replaced);
+    if (it != clauses_info_.end()) clauses_info_[clause] = it->second;
+  }
+  return clauses_propagator_.AttachAndPropagate(clause, &trail_);
+}
+
+bool SatSolver::SubstituteEquivalentLiterals() {
+  SCOPED_TIME_STAT(&stats_);
+  if (binary_implication_graph_.NumberOfImplications() == 0) return true;
+  ITIVector<LiteralIndex, LiteralIndex> representative;
+  if (!binary_implication_graph_.FindEquivalentLiterals(&representative)) {
+    return false;
+  }
+  counters_.num_inprocessing_inspections +=
+      representative.size() +
+      2 * binary_implication_graph_.NumberOfImplications();
+
+  std::vector<SatClause*> to_substitute;
+  for (SatClause* clause : clauses_) {
+    if (!clause->IsAttached()) continue;
+    counters_.num_inprocessing_inspections += clause->Size();
+    for (const Literal l : *clause) {
+      if (representative[l.Index()] != l.Index()) {
+        to_substitute.push_back(clause);
+        break;
+      }
+    }
+  }
+  if (to_substitute.empty()) return true;
+  for (SatClause* clause : to_substitute) {
+    clauses_propagator_.LazyDetach(clause);
+  }
+  clauses_propagator_.CleanUpWatchers();
+
+  // Note that a clause that becomes trivially true is just removed: it is
+  // implied by the binary clauses encoding the equivalences.
+  std::vector<Literal> literals;
+  for (SatClause* clause : to_substitute) {
+    literals.clear();
+    for (const Literal l : *clause) {
+      const Literal rep = Literal(representative[l.Index()]);
+      if (rep != l) ++counters_.num_substituted_literals;
+      literals.push_back(rep);
+    }
+    std::sort(literals.begin(), literals.end());
+    literals.erase(std::unique(literals.begin(), literals.end()),
+                   literals.end());
+    bool is_trivially_true = false;
+    for (int i = 1; i < literals.size(); ++i) {
+      if (literals[i] == literals[i - 1].Negated()) {
+        is_trivially_true = true;
+        break;
+      }
+    }
+    if (is_trivially_true) continue;
+    if (!AddInprocessingClause(&literals, clause)) return false;
+  }
+  return true;
+}
+
+bool SatSolver::VivifyLearnedClauses(double deterministic_time_limit) {
+  SCOPED_TIME_STAT(&stats_);
+
+  // This makes sure that EnqueueNewDecision() will not modify the clauses
+  // while we vivify them.
+  if (num_processed_fixed_variables_ < trail_.Index()) {
+    ProcessNewlyFixedVariables();
+  }
+
+  // We vivify the learned clauses that were not vivified yet by increasing LBD.
+  // Note that we iterate over clauses_ and use a stable sort so that the order
+  // is deterministic.
+  std::vector<std::pair<int, SatClause*>> candidates;
+  for (SatClause* clause : clauses_) {
+    if (!clause->IsAttached() || !clause->IsRedundant()) continue;
+    const auto it = clauses_info_.find(clause);
+    if (it == clauses_info_.end() || it->second.vivified) continue;
+    candidates.push_back(std::make_pair(it->second.lbd, clause));
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const std::pair<int, SatClause*>& a,
+                      const std::pair<int, SatClause*>& b) {
+                     return a.first < b.first;
+                   });
+  if (candidates.size() > parameters_.inprocessing_max_num_vivified_clauses()) {
+    candidates.resize(parameters_.inprocessing_max_num_vivified_clauses());
+  }
+
+  // Each literal of the clause is assigned to false in turn. The clause can be
+  // shortened to the literals processed so far if this leads to a conflict or
+  // if the current literal is already true, and the literals already false can
+  // be removed. Note that the clause stays attached while it is processed, but
+  // any clause derived this way is still implied by the problem. Since the
+  // propagation may reorder the literals of an attached clause, we work on a
+  // copy of them.
+  std::vector<std::pair<SatClause*, std::vector<Literal>>> shortened;
+  std::vector<Literal> clause_literals;
+  std::vector<Literal> literals;
+  for (const std::pair<int, SatClause*>& entry : candidates) {
+    if (deterministic_time() > deterministic_time_limit) break;
+    SatClause* clause = entry.second;
+    if (!clause->IsAttached()) continue;
+    clauses_info_[clause].vivified = true;
+    clause_literals.assign(clause->begin(), clause->end());
+    literals.clear();
+    const int size = clause_literals.size();
+    for (int i = 0; i < size; ++i) {
+      const Literal l = clause_literals[i];
+      if (trail_.Assignment().LiteralIsFalse(l)) continue;
+      literals.push_back(l);
+      if (trail_.Assignment().LiteralIsTrue(l)) break;
+      if (i + 1 == size) break;
+      if (!EnqueueDecisionIfNotConflicting(l.Negated())) break;
+    }
+    Backtrack(0);
+    if (literals.size() < size) {
+      counters_.num_vivified_literals_removed += size - literals.size();
+      shortened.push_back(std::make_pair(clause, literals));
+    }
+  }
+  if (shortened.empty()) return true;
+  for (const auto& entry : shortened) {
+    clauses_propagator_.LazyDetach(entry.first);
+  }
+  clauses_propagator_.CleanUpWatchers();
+  for (auto& entry : shortened) {
+    if (!AddInprocessingClause(&entry.second, entry.first)) return false;
+  }
+  return true;
+}
+
+void SatSolver::RemoveSubsumedClauses(double deterministic_time_limit) {
+  SCOPED_TIME_STAT(&stats_);
+  ITIVector<LiteralIndex, std::vector<SatClause*>> occurrences(
+      2 * num_variables_.value());
+  std::vector<SatClause*> candidates;
+  for (SatClause* clause : clauses_) {
+    if (!clause->IsAttached()) continue;
+    candidates.push_back(clause);
+    for (const Literal l : *clause) {
+      occurrences[l.Index()].push_back(clause);
+    }
+    counters_.num_inprocessing_inspections += clause->Size();
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](SatClause* a, SatClause* b) {
+                     return a->Size() < b->Size();
+                   });
+
+  SparseBitset<LiteralIndex> is_marked;
+  is_marked.ClearAndResize(LiteralIndex(2 * num_variables_.value()));
+  int num_subsumed = 0;
+  for (SatClause* clause : candidates) {
+    if (!clause->IsAttached()) continue;
+    if (deterministic_time() > deterministic_time_limit) break;
+    for (const Literal l : *clause) is_marked.Set(l.Index());
+
+    // Subsumption by a binary clause (l, b), stored as not(l) => b. Note that
+    // the binary clauses are never deleted, so they can subsume any clause.
+    bool is_subsumed = false;
+    for (const Literal l : *clause) {
+      const std::vector<Literal>& implications =
+          binary_implication_graph_.DirectImplications(l.Negated());
+      counters_.num_inprocessing_inspections += implications.size();
+      for (const Literal b : implications) {
+        if (is_marked[b.Index()]) {
+          is_subsumed = true;
+          break;
+        }
+      }
+      if (is_subsumed) break;
+    }
+    if (is_subsumed) {
+      clauses_propagator_.LazyDetach(clause);
+      ++num_subsumed;
+      is_marked.ClearAll();
+      continue;
+    }
+
+    // Backward subsumption of the larger clauses, using the occurrence list of
+    // the literal of clause that appears the least.
+    Literal best = clause->FirstLiteral();
+    for (const Literal l : *clause) {
+      if (occurrences[l.Index()].size() < occurrences[best.Index()].size()) {
+        best = l;
+      }
+    }
+    for (SatClause* other : occurrences[best.Index()]) {
+      if (other == clause || !other->IsAttached()) continue;
+      if (other->Size() < clause->Size()) continue;
+
+      // A learned clause can't replace a problem clause since it may be
+      // deleted later.
+      if (clause->IsRedundant() && !other->IsRedundant()) continue;
+      counters_.num_inprocessing_inspections += other->Size();
+      int num_common = 0;
+      for (const Literal l : *other) {
+        if (is_marked[l.Index()]) ++num_common;
+      }
+      if (num_common == clause->Size()) {
+        clauses_propagator_.LazyDetach(other);
+        ++num_subsumed;
+      }
+    }
+    is_marked.ClearAll();
+  }
+  clauses_propagator_.CleanUpWatchers();
+  counters_.num_inprocessing_subsumed_clauses += num_subsumed;
+}
+
+bool SatSolver::EliminateVariables(double deterministic_time_limit) {
+  SCOPED_TIME_STAT(&stats_);
+  if (postsolver_ == nullptr) {
+    postsolver_.reset(new SatPostsolver(num_variables_.value()));
+  }
+
+  // Occurrence lists of all the clauses. The learned ones are only needed so
+  // that they can be deleted along with the eliminated variable.
+  ITIVector<LiteralIndex, std::vector<SatClause*>> occurrences(
+      2 * num_variables_.value());
+  ITIVector<LiteralIndex, int> num_problem_clauses(2 * num_variables_.value(),
+                                                   0);
+  for (SatClause* clause : clauses_) {
+    if (!clause->IsAttached()) continue;
+    for (const Literal l : *clause) {
+      occurrences[l.Index()].push_back(clause);
+      if (!clause->IsRedundant()) ++num_problem_clauses[l.Index()];
+    }
+    counters_.num_inprocessing_inspections += clause->Size();
+  }
+
+  // The variables are processed by increasing number of potential resolvents.
+  const int threshold = parameters_.presolve_bve_threshold();
+  std::vector<std::pair<int, VariableIndex>> candidates;
+  for (VariableIndex var(0); var < num_variables_; ++var) {
+    if (is_eliminated_[var] || is_frozen_[var] ||
+        trail_.Assignment().VariableIsAssigned(var)) {
+      continue;
+    }
+    const Literal x(var, true);
+    const int s1 =
+        num_problem_clauses[x.Index()] +
+        binary_implication_graph_.DirectImplications(x.Negated()).size();
+    const int s2 = num_problem_clauses[x.NegatedIndex()] +
+                   binary_implication_graph_.DirectImplications(x).size();
+    if (s1 == 0 && s2 == 0) continue;
+    if (s1 > 1 && s2 > 1 && s1 * s2 > threshold) continue;
+    candidates.push_back(std::make_pair(s1 * s2, var));
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const std::pair<int, VariableIndex>& a,
+                      const std::pair<int, VariableIndex>& b) {
+                     return a.first < b.first;
+                   });
+
+  const int clause_weight = parameters_.presolve_bve_clause_weight();
+  std::vector<std::vector<Literal>> positive;
+  std::vector<std::vector<Literal>> negative;
+  std::vector<BinaryClause> removed_binary_clauses;
+  std::vector<Literal> resolvant;
+  for (const std::pair<int, VariableIndex>& entry : candidates) {
+    if (deterministic_time() > deterministic_time_limit) break;
+    const VariableIndex var = entry.second;
+    if (trail_.Assignment().VariableIsAssigned(var)) continue;
+
+    // Collects the problem clauses containing var, sorted as expected by
+    // ComputeResolvant(). The binary clauses are also problem clauses here.
+    const Literal x(var, true);
+    int current_size = 0;
+    for (const bool is_positive : {true, false}) {
+      const Literal lit = is_positive ? x : x.Negated();
+      std::vector<std::vector<Literal>>* clauses =
+          is_positive ? &positive : &negative;
+      clauses->clear();
+      for (SatClause* clause : occurrences[lit.Index()]) {
+        if (!clause->IsAttached() || clause->IsRedundant()) continue;
+        clauses->push_back(
+            std::vector<Literal>(clause->begin(), clause->end()));
+      }
+      for (const Literal b :
+           binary_implication_graph_.DirectImplications(lit.Negated())) {
+        clauses->push_back({lit, b});
+      }
+      for (std::vector<Literal>& clause : *clauses) {
+        std::sort(clause.begin(), clause.end());
+        current_size += clause_weight + clause.size();
+      }
+    }
+    const int s1 = positive.size();
+    const int s2 = negative.size();
+    if (s1 > 1 && s2 > 1 && s1 * s2 > threshold) continue;
+
+    // Test whether we should remove var, exactly like the SatPresolver.
+    int new_size = 0;
+    for (const std::vector<Literal>& a : positive) {
+      for (const std::vector<Literal>& b : negative) {
+        counters_.num_inprocessing_inspections += a.size() + b.size();
+        const int rs = ComputeResolvantSize(x, ClauseRef(a), ClauseRef(b));
+        if (rs >= 0) new_size += clause_weight + rs;
+        if (new_size > current_size) break;
+      }
+      if (new_size > current_size) break;
+    }
+    if (new_size > current_size) continue;
+
+    // Eliminate var.
+    for (const std::vector<Literal>& a : positive) {
+      postsolver_->Add(x, ClauseRef(a));
+    }
+    for (const std::vector<Literal>& b : negative) {
+      postsolver_->Add(x.Negated(), ClauseRef(b));
+    }
+    for (const Literal lit : {x, x.Negated()}) {
+      for (SatClause* clause : occurrences[lit.Index()]) {
+        if (clause->IsAttached()) clauses_propagator_.LazyDetach(clause);
+      }
+      STLClearObject(&occurrences[lit.Index()]);
+    }
+    clauses_propagator_.CleanUpWatchers();
+    removed_binary_clauses.clear();
+    binary_implication_graph_.RemoveAllClausesContaining(
+        var, &removed_binary_clauses);
+    is_eliminated_[var] = true;
+    ++num_eliminated_variables_;
+    ++counters_.num_eliminated_variables;
+
+    for (const std::vector<Literal>& a : positive) {
+      for (const std::vector<Literal>& b : negative) {
+        if (!ComputeResolvant(x, ClauseRef(a), ClauseRef(b), &resolvant)) {
+          continue;
+        }
+        const int old_num_clauses = clauses_.size();
+        if (!AddInprocessingClause(&resolvant, nullptr)) return false;
+        if (clauses_.size() > old_num_clauses) {
+          for (const Literal l : *clauses_.back()) {
+            occurrences[l.Index()].push_back(clauses_.back());
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void SatSolver::AssignEliminatedVariables() {
+  SCOPED_TIME_STAT(&stats_);
+  DCHECK(PropagationIsDone());
+  int num_unassigned = 0;
+  for (VariableIndex var(0); var < num_variables_; ++var) {
+    if (is_eliminated_[var] && !trail_.Assignment().VariableIsAssigned(var)) {
+      ++num_unassigned;
+    }
+  }
+  if (num_unassigned == 0 ||
+      trail_.Index() + num_unassigned < num_variables_.value()) {
+    return;
+  }
+
+  // Postsolve the assignment of the non-eliminated variables. Note that the
+  // eliminated variables do not appear in any constraint, so assigning them
+  // doesn't propagate anything.
+  VariablesAssignment assignment(num_variables_.value());
+  for (int i = 0; i < trail_.Index(); ++i) {
+    if (!is_eliminated_[trail_[i].Variable()]) {
+      assignment.AssignFromTrueLiteral(trail_[i]);
+    }
+  }
+  postsolver_->Postsolve(&assignment);
+  for (VariableIndex var(0); var < num_variables_; ++var) {
+    if (!is_eliminated_[var]) continue;
+    const Literal literal = assignment.GetTrueLiteralForAssignedVariable(var);
+    if (trail_.Assignment().VariableIsAssigned(var)) {
+      DCHECK(trail_.Assignment().LiteralIsTrue(literal));
+    } else {
+      EnqueueNewDecision(literal);
+      CHECK(Propagate());
+    }
+  }
+}
+
 void SatSolver::InitRestart() {
   SCOPED_TIME_STAT(&stats_);
   restart_count_ = 0;
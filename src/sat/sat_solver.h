@@ -35,6 +35,7 @@
 #include "base/random.h"
 #include "sat/pb_constraint.h"
 #include "sat/clause.h"
+#include "sat/drat_writer.h"
 #include "sat/sat_base.h"
 #include "sat/sat_parameters.pb.h"
 #include "sat/unsat_proof.h"
@@ -47,6 +48,8 @@
 namespace operations_research {
 namespace sat {
 
+class SatPostsolver;
+
 // A constant used by the EnqueueDecision*() API.
 const int kUnsatTrailIndex = -1;
 
@@ -224,6 +227,60 @@ class SatSolver {
   // the problem UNSAT.
   std::vector<Literal> GetLastIncompatibleDecisions();
 
+  // Incremental interface. The same solver can be used to solve a sequence of
+  // problems where each one extends the previous one with new variables and
+  // constraints, and where some constraints can be removed through clause
+  // groups. A typical use is bounded model checking where the formula is
+  // unrolled one more step before each call.
+  //
+  // A clause group is identified by a fresh "selector" literal s returned by
+  // NewClauseGroup(). AddClauseToGroup(s, C) adds the clause (not(s) or C), and
+  // SolveIncrementally() assumes s for all the active groups. Removing a group
+  // just fixes s to false at level zero, which permanently satisfies all the
+  // clauses of the group.
+  //
+  // Guarantees between two calls:
+  // - The problem clauses and constraints are never removed, except the ones
+  //   of a removed group.
+  // - Since the assumptions are decisions, a clause learned from the clauses
+  //   of a group always contains not(s). It is thus kept as long as the group
+  //   is active, and deleted with it. All the other learned clauses are
+  //   implied by the permanent constraints and stay valid forever. Note that
+  //   any learned clause can still be removed by the usual clause database
+  //   cleaning (see the clause_cleanup_* parameters).
+  // - The variable activities and polarities are kept, the new variables start
+  //   with an activity of zero.
+  //
+  // Note that a constraint can only be added at level zero, so one must call
+  // Backtrack(0) before adding a constraint with the Add*() functions after a
+  // solve. The functions below take care of this. Also, the variables that
+  // will appear in future constraints must be protected with FreezeVariable()
+  // if the inprocessing bounded variable elimination is used.
+
+  // Creates a new clause group and returns its selector. The selector variable
+  // is a new variable which is frozen.
+  Literal NewClauseGroup();
+
+  // Adds the given clause to the given group. The group must not have been
+  // removed. Returns false if the problem is detected to be UNSAT, which can
+  // only happen if the clause is already UNSAT for the permanent constraints.
+  bool AddClauseToGroup(Literal selector, const std::vector<Literal>& literals);
+
+  // Removes the given group. Its clauses and the learned clauses that depend
+  // on it are deleted right away.
+  void RemoveClauseGroup(Literal selector);
+
+  // Solves the problem with all the active groups and the given assumptions.
+  // This returns ASSUMPTIONS_UNSAT if the problem is UNSAT only because of
+  // them, in which case the core returned by GetLastIncompatibleDecisions()
+  // may contain some group selectors.
+  Status SolveIncrementally(const std::vector<Literal>& assumptions);
+
+  // Prevents the given variable from being removed by the inprocessing bounded
+  // variable elimination so that it can be used in future constraints and
+  // assumptions. This must be called before the solve that would eliminate it.
+  void FreezeVariable(VariableIndex var);
+
   // Returns an UNSAT core. That is a subset of the problem clauses that are
   // still UNSAT. A problem constraint of index #i is the one that was added
   // with the i-th call to one of the Add*() functions, see
@@ -234,6 +291,18 @@ class SatSolver {
   // - It must have returned MODEL_UNSAT.
   void ComputeUnsatCore(std::vector<int>* core);
 
+  // Streams a DRAT proof of the search to the given writer, see drat_writer.h.
+  // The writer is not owned and must outlive the solver. This must be called
+  // before any clause is added since the checker works from the clauses given
+  // to the Add*() functions.
+  //
+  // The proof is only valid for a pure SAT problem solved without assumptions
+  // and without clauses or constraints coming from outside the search: no
+  // pseudo-Boolean constraints, symmetries, external propagators or
+  // AddBinaryClauses() since the clauses learned from them are not always
+  // implied by unit propagation on the problem clauses.
+  void SetDratWriter(DratWriter* drat_writer) { drat_writer_ = drat_writer; }
+
   // Advanced usage. The next 3 functions allow to drive the search from outside
   // the solver.
 
@@ -341,6 +410,14 @@ class SatSolver {
   const Trail& LiteralTrail() const { return trail_; }
   const VariablesAssignment& Assignment() const { return trail_.Assignment(); }
 
+  // Returns true if the given variable was removed from the clause database by
+  // the inprocessing bounded variable elimination. No constraint or assumption
+  // involving such a variable can be added to the solver. See the
+  // inprocessing_use_bve parameter.
+  bool VariableWasEliminated(VariableIndex var) const {
+    return var < is_eliminated_.size() && is_eliminated_[var];
+  }
+
   // Some statistics since the creation of the solver.
   int64 num_branches() const;
   int64 num_failures() const;
@@ -600,6 +677,57 @@ class SatSolver {
   // it if needed. Also updates the learned clause limit for the next cleanup.
   void CleanClauseDatabaseIfNeeded();
 
+  // Runs one round of inprocessing on the live clause database if enough
+  // deterministic time was spent in the search since the last one. This must
+  // be called at decision level 0, without assumptions, after the propagation.
+  // Returns false if the model was proven UNSAT.
+  bool InprocessIfNeeded();
+
+  // Returns true if the next call to InprocessIfNeeded() will do some work.
+  bool InprocessingIsDue() const;
+
+  // Returns the decision level to backtrack to on a restart. This is the
+  // assumption level unless use_trail_reuse_on_restart() is true, in which
+  // case the prefix of decisions that NextBranch() would take again is kept.
+  int ComputeRestartLevel();
+
+  // The inprocessing steps, in the order in which they are run. The given
+  // limit is a deterministic time (as returned by deterministic_time()) after
+  // which a step aborts. The functions returning a Boolean return false if the
+  // model was proven UNSAT.
+  //
+  // - SubstituteEquivalentLiterals() replaces each literal of the clauses by
+  //   the representative of its strongly connected component in the binary
+  //   implication graph. Since the binary clauses encoding the equivalences
+  //   are kept, this doesn't need any postsolve.
+  // - VivifyLearnedClauses() propagates the negation of the literals of the
+  //   learned clauses one by one and shortens them using the propagated
+  //   literals and the conflicts.
+  // - RemoveSubsumedClauses() performs backward subsumption with the binary
+  //   and the larger clauses.
+  // - EliminateVariables() is the bounded variable elimination of the
+  //   SatPresolver applied to the live clauses. The removed clauses are stored
+  //   in postsolver_.
+  bool SubstituteEquivalentLiterals();
+  bool VivifyLearnedClauses(double deterministic_time_limit);
+  void RemoveSubsumedClauses(double deterministic_time_limit);
+  bool EliminateVariables(double deterministic_time_limit);
+
+  // Adds a clause derived during the inprocessing. This must be called at
+  // decision level 0 after the propagation. The fixed literals are removed, and
+  // the clause is added as a unit, a binary or a larger clause depending on its
+  // final size. If replaced is not null, it must be a clause implied by the new
+  // one, already detached by the caller. The new clause then inherits its
+  // redundancy and its clauses_info_ entry. Otherwise the new clause is a
+  // problem clause. Returns false if the model was proven UNSAT.
+  bool AddInprocessingClause(std::vector<Literal>* literals,
+                             SatClause* replaced);
+
+  // Assigns all the eliminated variables so that the clauses removed by the
+  // bounded variable elimination are satisfied. This is called once all the
+  // other variables are assigned and uses new decisions for this.
+  void AssignEliminatedVariables();
+
   // Bumps the activity of all variables appearing in the conflict.
   // See VSIDS decision heuristic: Chaff: Engineering an Efficient SAT Solver.
   // M.W. Moskewicz et al. ANNUAL ACM IEEE DESIGN AUTOMATION CONFERENCE 2001.
@@ -657,6 +785,13 @@ class SatSolver {
     double activity = 0.0;
     int32 lbd = 0;
     bool protected_during_next_cleanup = false;
+
+    // The value of counters_.num_failures the last time the clause activity
+    // was bumped. Used to keep the recently used tier-2 clauses.
+    int64 last_bump_num_failures = 0;
+
+    // Set once the clause has been vivified by the inprocessing.
+    bool vivified = false;
   };
   hash_map<SatClause*, ClauseInfo> clauses_info_;
 
@@ -720,6 +855,18 @@ class SatSolver {
     int64 num_literals_forgotten;
     int64 num_subsumed_clauses;
 
+    // Restart stats.
+    int64 num_reused_decisions;
+
+    // Inprocessing stats. The number of inspections is used to account for
+    // the inprocessing work that isn't a propagation in the deterministic time.
+    int64 num_inprocessing_rounds;
+    int64 num_inprocessing_inspections;
+    int64 num_substituted_literals;
+    int64 num_vivified_literals_removed;
+    int64 num_inprocessing_subsumed_clauses;
+    int64 num_eliminated_variables;
+
     Counters()
         : num_branches(0),
           num_random_branches(0),
@@ -729,7 +876,14 @@ class SatSolver {
           num_learned_pb_literals_(0),
           num_literals_learned(0),
           num_literals_forgotten(0),
-          num_subsumed_clauses(0) {}
+          num_subsumed_clauses(0),
+          num_reused_decisions(0),
+          num_inprocessing_rounds(0),
+          num_inprocessing_inspections(0),
+          num_substituted_literals(0),
+          num_vivified_literals_removed(0),
+          num_inprocessing_subsumed_clauses(0),
+          num_eliminated_variables(0) {}
   };
   Counters counters_;
 
@@ -860,6 +1014,9 @@ class SatSolver {
   // This is only used is parameters_.unsat_proof() is true.
   UnsatProof unsat_proof_;
 
+  // If not null, all the learned and deleted clauses are written to it.
+  DratWriter* drat_writer_;
+
   // A random number generator.
   mutable MTRandom random_;
 
@@ -888,6 +1045,24 @@ class SatSolver {
   // The solver time limit.
   std::unique_ptr<TimeLimit> time_limit_;
 
+  // The deterministic time at the end of the last inprocessing round.
+  double deterministic_time_of_last_inprocessing_;
+
+  // The variables removed by the inprocessing bounded variable elimination and
+  // the postsolver used to assign them. The eliminated variables are never
+  // chosen by NextBranch(), they are only assigned by
+  // AssignEliminatedVariables().
+  ITIVector<VariableIndex, bool> is_eliminated_;
+  int num_eliminated_variables_;
+  std::unique_ptr<SatPostsolver> postsolver_;
+
+  // The variables that must not be eliminated, see FreezeVariable().
+  ITIVector<VariableIndex, bool> is_frozen_;
+
+  // The selectors of the clause groups that were not removed, in creation
+  // order. See NewClauseGroup().
+  std::vector<Literal> active_clause_groups_;
+
   // The deterministic time when the time limit was updated.
   // As the deterministic time in the time limit has to be advanced manually,
   // it is necessary to keep track of the last time the time was advanced.
@@ -13,7 +13,10 @@
 
 #include "sat/simplification.h"
 
+#include <functional>
+
 #include "base/timer.h"
+#include "base/threadpool.h"
 #include "base/strongly_connected_components.h"
 #include "base/stl_util.h"
 #include "algorithms/dynamic_partition.h"
@@ -29,8 +32,8 @@ SatPostsolver::SatPostsolver(int num_variables) {
   assignment_.Resize(num_variables);
 }
 
-void SatPostsolver::Add(Literal x, const std::vector<Literal>& clause) {
-  CHECK(!clause.empty());
+void SatPostsolver::Add(Literal x, ClauseRef clause) {
+  CHECK(!clause.IsEmpty());
   DCHECK(std::find(clause.begin(), clause.end(), x) != clause.end());
   associated_literal_.push_back(ApplyReverseMapping(x));
   clauses_start_.push_back(clauses_literals_.size());
@@ -61,6 +64,16 @@ void SatPostsolver::ApplyMapping(
   std::swap(new_mapping, reverse_mapping_);
 }
 
+void SatPostsolver::IncreaseNumVariablesTo(int num_variables) {
+  CHECK_GE(num_variables, reverse_mapping_.size());
+  VariableIndex next_initial_var(assignment_.NumberOfVariables());
+  for (VariableIndex var(reverse_mapping_.size()); var < num_variables; ++var) {
+    reverse_mapping_.push_back(next_initial_var);
+    ++next_initial_var;
+  }
+  assignment_.Resize(next_initial_var.value());
+}
+
 Literal SatPostsolver::ApplyReverseMapping(Literal l) {
   CHECK_LT(l.Variable(), reverse_mapping_.size());
   CHECK_NE(reverse_mapping_[l.Variable()], VariableIndex(-1));
@@ -124,6 +137,46 @@ std::vector<bool> SatPostsolver::PostsolveSolution(const std::vector<bool>& solu
   return postsolved_solution;
 }
 
+namespace {
+
+// Returns a 64 bits signature of the variables of the given clause.
+uint64 ComputeSignature(ClauseRef clause) {
+  uint64 signature = 0;
+  for (const Literal l : clause) {
+    signature |= uint64{1} << (l.Variable().value() & 63);
+  }
+  return signature;
+}
+
+void CallOnRange(const std::function<void(int, int, int)>* compute,
+                 int range, int begin, int end) {
+  (*compute)(range, begin, end);
+}
+
+// Calls compute(i, begin, end) on the i-th of at most num_threads consecutive
+// ranges [begin, end) that partition [0, num_items), in parallel on
+// num_threads threads. The ranges must be independent, i.e. compute() must
+// only write data indexed by its range.
+void RunOnRanges(int num_items, int num_threads,
+                 const std::function<void(int, int, int)>& compute) {
+  num_threads = std::max(1, std::min(num_threads, num_items));
+  if (num_threads == 1) {
+    compute(0, 0, num_items);
+    return;
+  }
+  ThreadPool pool("SatPresolver", num_threads);
+  pool.StartWorkers();
+  for (int i = 0; i < num_threads; ++i) {
+    pool.Add(NewCallback(
+        &CallOnRange, &compute, i,
+        static_cast<int>(static_cast<int64>(num_items) * i / num_threads),
+        static_cast<int>(static_cast<int64>(num_items) * (i + 1) /
+                         num_threads)));
+  }
+}
+
+}  // namespace
+
 void SatPresolver::AddBinaryClause(Literal a, Literal b) {
   Literal c[2];
   c[0] = a;
@@ -133,57 +186,146 @@ void SatPresolver::AddBinaryClause(Literal a, Literal b) {
 
 void SatPresolver::AddClause(ClauseRef clause) {
   CHECK_GT(clause.size(), 0) << "Added an empty clause to the presolver";
-  const ClauseIndex ci(clauses_.size());
-  clauses_.push_back(std::vector<Literal>(clause.begin(), clause.end()));
-  in_clause_to_process_.push_back(true);
-  clause_to_process_.push_back(ci);
-
-  std::vector<Literal>& clause_ref = clauses_.back();
-  if (!equiv_mapping_.empty()) {
-    for (int i = 0; i < clause_ref.size(); ++i) {
-      clause_ref[i] = Literal(equiv_mapping_[clause_ref[i].Index()]);
-    }
+  const int64 start = clause_literals_.size();
+  for (const Literal l : clause) {
+    clause_literals_.push_back(
+        equiv_mapping_.empty() ? l : Literal(equiv_mapping_[l.Index()]));
   }
-  std::sort(clause_ref.begin(), clause_ref.end());
-  clause_ref.erase(std::unique(clause_ref.begin(), clause_ref.end()),
-                   clause_ref.end());
+  const std::vector<Literal>::iterator begin = clause_literals_.begin() + start;
+  std::sort(begin, clause_literals_.end());
+  clause_literals_.erase(std::unique(begin, clause_literals_.end()),
+                         clause_literals_.end());
 
   // Check for trivial clauses:
-  for (int i = 1; i < clause_ref.size(); ++i) {
-    if (clause_ref[i] == clause_ref[i - 1].Negated()) {
+  for (int64 i = start + 1; i < clause_literals_.size(); ++i) {
+    if (clause_literals_[i] == clause_literals_[i - 1].Negated()) {
       // The clause is trivial!
       ++num_trivial_clauses_;
-      clause_to_process_.pop_back();
-      clauses_.pop_back();
-      in_clause_to_process_.pop_back();
+      clause_literals_.resize(start);
       return;
     }
   }
 
-  const Literal max_literal = clause_ref.back();
+  // Note that the occurence lists and the signature of this clause will only
+  // be computed by RebuildOccurrenceListsIfNeeded(), this way they can be
+  // computed efficiently for all the initial clauses at once.
+  const ClauseIndex ci(clause_start_.size());
+  clause_start_.push_back(start);
+  clause_size_.push_back(clause_literals_.size() - start);
+  clause_signature_.push_back(0);
+  in_clause_to_process_.push_back(true);
+  clause_to_process_.push_back(ci);
+  occurrence_lists_are_valid_ = false;
+
+  const Literal max_literal = clause_literals_.back();
   const int required_size =
       std::max(max_literal.Index().value(), max_literal.NegatedIndex().value()) + 1;
-  if (required_size > literal_to_clauses_.size()) {
-    literal_to_clauses_.resize(required_size);
+  if (required_size > literal_to_clause_sizes_.size()) {
     literal_to_clause_sizes_.resize(required_size);
   }
-  for (Literal e : clause_ref) {
-    literal_to_clauses_[e.Index()].push_back(ci);
+  for (const Literal e : Clause(ci)) {
     literal_to_clause_sizes_[e.Index()]++;
   }
 }
 
 void SatPresolver::AddClauseInternal(std::vector<Literal>* clause) {
   CHECK_GT(clause->size(), 0) << "TODO(fdid): Unsat during presolve?";
-  const ClauseIndex ci(clauses_.size());
-  clauses_.push_back(std::vector<Literal>());
-  clauses_.back().swap(*clause);
+  DCHECK(occurrence_lists_are_valid_);
+  const ClauseIndex ci(clause_start_.size());
+  clause_start_.push_back(clause_literals_.size());
+  clause_size_.push_back(clause->size());
+  clause_literals_.insert(clause_literals_.end(), clause->begin(),
+                          clause->end());
+  clause_signature_.push_back(ComputeSignature(Clause(ci)));
   in_clause_to_process_.push_back(true);
   clause_to_process_.push_back(ci);
-  for (Literal e : clauses_.back()) {
-    literal_to_clauses_[e.Index()].push_back(ci);
+  for (const Literal e : *clause) {
+    AddToOccurrenceList(e.Index(), ci);
     literal_to_clause_sizes_[e.Index()]++;
   }
+  clause->clear();
+}
+
+void SatPresolver::AddToOccurrenceList(LiteralIndex l, ClauseIndex ci) {
+  if (occurrence_size_[l] == occurrence_capacity_[l]) {
+    const int64 new_start = occurrences_.size();
+    const int new_capacity = std::max(4, 2 * occurrence_capacity_[l]);
+    occurrences_.resize(new_start + new_capacity);
+    std::copy(occurrences_.begin() + occurrence_start_[l],
+              occurrences_.begin() + occurrence_start_[l] + occurrence_size_[l],
+              occurrences_.begin() + new_start);
+    num_garbage_occurrences_ += occurrence_capacity_[l];
+    occurrence_start_[l] = new_start;
+    occurrence_capacity_[l] = new_capacity;
+  }
+  occurrences_[occurrence_start_[l] + occurrence_size_[l]] = ci;
+  ++occurrence_size_[l];
+}
+
+void SatPresolver::RemoveFromOccurrenceList(LiteralIndex l, ClauseIndex ci) {
+  const std::vector<ClauseIndex>::iterator begin =
+      occurrences_.begin() + occurrence_start_[l];
+  const std::vector<ClauseIndex>::iterator end = begin + occurrence_size_[l];
+  const std::vector<ClauseIndex>::iterator iter = std::find(begin, end, ci);
+  DCHECK(iter != end);
+  std::copy(iter + 1, end, iter);
+  --occurrence_size_[l];
+}
+
+void SatPresolver::RebuildOccurrenceListsIfNeeded() {
+  if (occurrence_lists_are_valid_ &&
+      2 * num_garbage_occurrences_ <= occurrences_.size()) {
+    return;
+  }
+
+  // The signatures only need to be computed for the clauses added by
+  // AddClause(), but recomputing all of them costs about the same as the
+  // rebuild below and is done in parallel.
+  const int num_clauses = NumClauses();
+  RunOnRanges(num_clauses, parameters_.presolve_num_threads(),
+              [this](int range, int begin, int end) {
+                for (ClauseIndex ci(begin); ci < end; ++ci) {
+                  clause_signature_[ci] = ComputeSignature(Clause(ci));
+                }
+              });
+
+  // Since literal_to_clause_sizes_ is exact, we can lay out all the lists
+  // contiguously in one pass over the clauses, without any reallocation.
+  const int num_literals = literal_to_clause_sizes_.size();
+  occurrence_start_.assign(num_literals, 0);
+  occurrence_size_.assign(num_literals, 0);
+  occurrence_capacity_.assign(num_literals, 0);
+  int64 num_occurrences = 0;
+  for (LiteralIndex l(0); l < num_literals; ++l) {
+    occurrence_start_[l] = num_occurrences;
+    occurrence_capacity_[l] = literal_to_clause_sizes_[l];
+    num_occurrences += literal_to_clause_sizes_[l];
+  }
+  std::vector<ClauseIndex>(num_occurrences).swap(occurrences_);
+  for (ClauseIndex ci(0); ci < num_clauses; ++ci) {
+    for (const Literal e : Clause(ci)) {
+      occurrences_[occurrence_start_[e.Index()] + occurrence_size_[e.Index()]] =
+          ci;
+      ++occurrence_size_[e.Index()];
+    }
+  }
+  num_garbage_occurrences_ = 0;
+  occurrence_lists_are_valid_ = true;
+}
+
+void SatPresolver::CompactClausesIfNeeded() {
+  if (2 * num_garbage_literals_ <= clause_literals_.size()) return;
+  int64 new_start = 0;
+  for (ClauseIndex ci(0); ci < NumClauses(); ++ci) {
+    std::copy(clause_literals_.begin() + clause_start_[ci],
+              clause_literals_.begin() + clause_start_[ci] + clause_size_[ci],
+              clause_literals_.begin() + new_start);
+    clause_start_[ci] = new_start;
+    new_start += clause_size_[ci];
+  }
+  clause_literals_.resize(new_start);
+  clause_literals_.shrink_to_fit();
+  num_garbage_literals_ = 0;
 }
 
 ITIVector<VariableIndex, VariableIndex> SatPresolver::VariableMapping() const {
@@ -206,9 +348,14 @@ void SatPresolver::LoadProblemIntoSatSolver(SatSolver* solver) {
   // literal_to_clause_sizes_ for VariableMapping() to work.
   var_pq_.Clear();
   var_pq_elements_.clear();
-  in_clause_to_process_.clear();
-  clause_to_process_.clear();
-  literal_to_clauses_.clear();
+  STLClearObject(&in_clause_to_process_);
+  STLClearObject(&clause_to_process_);
+  STLClearObject(&clause_signature_);
+  STLClearObject(&occurrences_);
+  occurrence_start_.clear();
+  occurrence_size_.clear();
+  occurrence_capacity_.clear();
+  occurrence_lists_are_valid_ = false;
 
   const ITIVector<VariableIndex, VariableIndex> mapping = VariableMapping();
   int new_size = 0;
@@ -218,23 +365,94 @@ void SatPresolver::LoadProblemIntoSatSolver(SatSolver* solver) {
 
   std::vector<Literal> temp;
   solver->SetNumVariables(new_size);
-  for (std::vector<Literal>& clause_ref : clauses_) {
+  for (ClauseIndex ci(0); ci < NumClauses(); ++ci) {
     temp.clear();
-    for (Literal l : clause_ref) {
+    for (Literal l : Clause(ci)) {
       CHECK_NE(mapping[l.Variable()], VariableIndex(-1));
       temp.push_back(Literal(mapping[l.Variable()], l.IsPositive()));
     }
     if (!temp.empty()) solver->AddProblemClause(temp);
-    STLClearObject(&clause_ref);
   }
+  STLClearObject(&clause_literals_);
+  STLClearObject(&clause_start_);
+  STLClearObject(&clause_size_);
+  num_garbage_literals_ = 0;
 }
 
 bool SatPresolver::ProcessAllClauses() {
+  // Each batch contains the clauses added to the queue while the previous one
+  // was processed, so this processes them in FIFO order.
+  std::vector<ClauseIndex> batch;
   while (!clause_to_process_.empty()) {
-    const ClauseIndex ci = clause_to_process_.front();
-    in_clause_to_process_[ci] = false;
-    clause_to_process_.pop_front();
-    if (!ProcessClauseToSimplifyOthers(ci)) return false;
+    batch.clear();
+    batch.swap(clause_to_process_);
+    for (const ClauseIndex ci : batch) {
+      in_clause_to_process_[ci] = false;
+      if (!ProcessClauseToSimplifyOthers(ci)) return false;
+    }
+  }
+  return true;
+}
+
+bool SatPresolver::ProcessAllClausesInParallel(int num_threads) {
+  CompactClausesIfNeeded();
+  RebuildOccurrenceListsIfNeeded();
+  std::vector<ClauseIndex> to_process;
+  to_process.swap(clause_to_process_);
+  for (const ClauseIndex ci : to_process) in_clause_to_process_[ci] = false;
+
+  // Detection. Each range only reads the clause database and only writes in
+  // its own list of candidate (simplifying clause, simplified clause) pairs.
+  num_threads = std::max(1, num_threads);
+  std::vector<std::vector<std::pair<ClauseIndex, ClauseIndex>>> candidates(
+      num_threads);
+  RunOnRanges(to_process.size(), num_threads,
+              [this, &to_process, &candidates](int range, int begin, int end) {
+    std::vector<std::pair<ClauseIndex, ClauseIndex>>* const output =
+        &candidates[range];
+    LiteralIndex opposite_literal;
+    for (int i = begin; i < end; ++i) {
+      const ClauseIndex ci = to_process[i];
+      if (clause_size_[ci] == 0) continue;
+      const Literal lit = FindLiteralWithShortestOccurenceList(Clause(ci));
+      for (const LiteralIndex l : {lit.Index(), lit.NegatedIndex()}) {
+        const int64 start = occurrence_start_[l];
+        for (int64 j = start; j < start + occurrence_size_[l]; ++j) {
+          const ClauseIndex other = occurrences_[j];
+          if (other == ci || clause_size_[other] == 0) continue;
+          if ((clause_signature_[ci] & ~clause_signature_[other]) != 0) {
+            continue;
+          }
+          if (CanSimplifyClause(Clause(ci), Clause(other), &opposite_literal)) {
+            output->push_back(std::make_pair(ci, other));
+          }
+        }
+      }
+    }
+  });
+
+  // Application, in the same order as the sequential algorithm. Because the
+  // clauses may have changed since the detection, everything is checked again.
+  LiteralIndex opposite_literal;
+  for (const std::vector<std::pair<ClauseIndex, ClauseIndex>>& output :
+       candidates) {
+    for (const std::pair<ClauseIndex, ClauseIndex>& p : output) {
+      const ClauseIndex ci = p.second;
+      if (clause_size_[p.first] == 0 || clause_size_[ci] == 0) continue;
+      if (!SimplifyClauseWith(p.first, ci, &opposite_literal)) continue;
+      if (opposite_literal == LiteralIndex(-1)) {
+        Remove(ci);
+        continue;
+      }
+      if (clause_size_[ci] == 0) return false;  // UNSAT.
+      RemoveFromOccurrenceList(opposite_literal, ci);
+      --literal_to_clause_sizes_[opposite_literal];
+      UpdatePriorityQueue(Literal(opposite_literal).Variable());
+      if (!in_clause_to_process_[ci]) {
+        in_clause_to_process_[ci] = true;
+        clause_to_process_.push_back(ci);
+      }
+    }
   }
   return true;
 }
@@ -247,6 +465,9 @@ bool SatPresolver::Presolve() {
 
   // TODO(user): When a clause is strengthened, add it to a queue so it can
   // be processed again?
+  if (!ProcessAllClausesInParallel(parameters_.presolve_num_threads())) {
+    return false;
+  }
   if (!ProcessAllClauses()) return false;
   DisplayStats(timer.Get());
 
@@ -263,42 +484,60 @@ bool SatPresolver::Presolve() {
   return true;
 }
 
+bool SatPresolver::SimplifyClauseWith(ClauseIndex a, ClauseIndex b,
+                                      LiteralIndex* opposite_literal) {
+  if ((clause_signature_[a] & ~clause_signature_[b]) != 0) return false;
+  if (!CanSimplifyClause(Clause(a), Clause(b), opposite_literal)) return false;
+  if (*opposite_literal != LiteralIndex(-1)) {
+    const std::vector<Literal>::iterator begin =
+        clause_literals_.begin() + clause_start_[b];
+    const std::vector<Literal>::iterator end = begin + clause_size_[b];
+    const std::vector<Literal>::iterator iter =
+        std::find(begin, end, Literal(*opposite_literal));
+    std::copy(iter + 1, end, iter);
+    --clause_size_[b];
+    ++num_garbage_literals_;
+    clause_signature_[b] = ComputeSignature(Clause(b));
+  }
+  return true;
+}
+
 // TODO(user): Binary clauses are really common, and we can probably do this
 // more efficiently for them. For instance, we could just take the intersection
 // of two sorted lists to get the simplified clauses.
-//
-// TODO(user): SimplifyClause can returns true only if the variables in 'a' are
-// a subset of the one in 'b'. Use an int64 signature for speeding up the test.
 bool SatPresolver::ProcessClauseToSimplifyOthers(ClauseIndex clause_index) {
-  const std::vector<Literal>& clause = clauses_[clause_index];
-  if (clause.empty()) return true;
-  DCHECK(std::is_sorted(clause.begin(), clause.end()));
+  if (clause_size_[clause_index] == 0) return true;
+  CompactClausesIfNeeded();
+  RebuildOccurrenceListsIfNeeded();
+  DCHECK(std::is_sorted(Clause(clause_index).begin(),
+                        Clause(clause_index).end()));
 
   LiteralIndex opposite_literal;
-  const Literal lit = FindLiteralWithShortestOccurenceList(clause);
+  const Literal lit =
+      FindLiteralWithShortestOccurenceList(Clause(clause_index));
 
   // Try to simplify the clauses containing 'lit'. We take advantage of this
-  // loop to also remove the empty sets from the list.
+  // loop to also remove the empty sets from the list. Note that no clause is
+  // added by this function, so the occurence lists are not moved.
   {
     int new_index = 0;
-    std::vector<ClauseIndex>& occurence_list_ref = literal_to_clauses_[lit.Index()];
-    for (ClauseIndex ci : occurence_list_ref) {
-      if (clauses_[ci].empty()) continue;
+    ClauseIndex* const occurence_list =
+        occurrences_.data() + occurrence_start_[lit.Index()];
+    const int size = occurrence_size_[lit.Index()];
+    for (int i = 0; i < size; ++i) {
+      const ClauseIndex ci = occurence_list[i];
+      if (clause_size_[ci] == 0) continue;
       if (ci != clause_index &&
-          SimplifyClause(clause, &clauses_[ci], &opposite_literal)) {
+          SimplifyClauseWith(clause_index, ci, &opposite_literal)) {
         if (opposite_literal == LiteralIndex(-1)) {
           Remove(ci);
           continue;
         } else {
           CHECK_NE(opposite_literal, lit.Index());
-          if (clauses_[ci].empty()) return false;  // UNSAT.
+          if (clause_size_[ci] == 0) return false;  // UNSAT.
           // Remove ci from the occurence list. Note that the occurence list
           // can't be shortest_list or its negation.
-          auto iter =
-              std::find(literal_to_clauses_[opposite_literal].begin(),
-                        literal_to_clauses_[opposite_literal].end(), ci);
-          DCHECK(iter != literal_to_clauses_[opposite_literal].end());
-          literal_to_clauses_[opposite_literal].erase(iter);
+          RemoveFromOccurrenceList(opposite_literal, ci);
 
           --literal_to_clause_sizes_[opposite_literal];
           UpdatePriorityQueue(Literal(opposite_literal).Variable());
@@ -309,10 +548,10 @@ bool SatPresolver::ProcessClauseToSimplifyOthers(ClauseIndex clause_index) {
           }
         }
       }
-      occurence_list_ref[new_index] = ci;
+      occurence_list[new_index] = ci;
       ++new_index;
     }
-    occurence_list_ref.resize(new_index);
+    occurrence_size_[lit.Index()] = new_index;
     CHECK_EQ(literal_to_clause_sizes_[lit.Index()], new_index);
     literal_to_clause_sizes_[lit.Index()] = new_index;
   }
@@ -322,16 +561,18 @@ bool SatPresolver::ProcessClauseToSimplifyOthers(ClauseIndex clause_index) {
   {
     int new_index = 0;
     bool something_removed = false;
-    std::vector<ClauseIndex>& occurence_list_ref =
-        literal_to_clauses_[lit.NegatedIndex()];
-    for (ClauseIndex ci : occurence_list_ref) {
-      if (clauses_[ci].empty()) continue;
+    ClauseIndex* const occurence_list =
+        occurrences_.data() + occurrence_start_[lit.NegatedIndex()];
+    const int size = occurrence_size_[lit.NegatedIndex()];
+    for (int i = 0; i < size; ++i) {
+      const ClauseIndex ci = occurence_list[i];
+      if (clause_size_[ci] == 0) continue;
 
       // TODO(user): not super optimal since we could abort earlier if
       // opposite_literal is not the negation of shortest_list.
-      if (SimplifyClause(clause, &clauses_[ci], &opposite_literal)) {
+      if (SimplifyClauseWith(clause_index, ci, &opposite_literal)) {
         CHECK_EQ(opposite_literal, lit.NegatedIndex());
-        if (clauses_[ci].empty()) return false;  // UNSAT.
+        if (clause_size_[ci] == 0) return false;  // UNSAT.
         if (!in_clause_to_process_[ci]) {
           in_clause_to_process_[ci] = true;
           clause_to_process_.push_back(ci);
@@ -339,10 +580,10 @@ bool SatPresolver::ProcessClauseToSimplifyOthers(ClauseIndex clause_index) {
         something_removed = true;
         continue;
       }
-      occurence_list_ref[new_index] = ci;
+      occurence_list[new_index] = ci;
       ++new_index;
     }
-    occurence_list_ref.resize(new_index);
+    occurrence_size_[lit.NegatedIndex()] = new_index;
     literal_to_clause_sizes_[lit.NegatedIndex()] = new_index;
     if (something_removed) {
       UpdatePriorityQueue(Literal(lit.NegatedIndex()).Variable());
@@ -352,10 +593,14 @@ bool SatPresolver::ProcessClauseToSimplifyOthers(ClauseIndex clause_index) {
 }
 
 void SatPresolver::RemoveAndRegisterForPostsolveAllClauseContaining(Literal x) {
-  for (ClauseIndex i : literal_to_clauses_[x.Index()]) {
-    if (!clauses_[i].empty()) RemoveAndRegisterForPostsolve(i, x);
+  const int64 start = occurrence_start_[x.Index()];
+  for (int64 i = start; i < start + occurrence_size_[x.Index()]; ++i) {
+    const ClauseIndex ci = occurrences_[i];
+    if (clause_size_[ci] != 0) RemoveAndRegisterForPostsolve(ci, x);
   }
-  STLClearObject(&literal_to_clauses_[x.Index()]);
+  num_garbage_occurrences_ += occurrence_capacity_[x.Index()];
+  occurrence_size_[x.Index()] = 0;
+  occurrence_capacity_[x.Index()] = 0;
   literal_to_clause_sizes_[x.Index()] = 0;
 }
 
@@ -372,32 +617,46 @@ bool SatPresolver::CrossProduct(Literal x) {
   if (s1 > 1 && s2 > 1 && s1 * s2 > parameters_.presolve_bve_threshold()) {
     return false;
   }
+  CompactClausesIfNeeded();
+  RebuildOccurrenceListsIfNeeded();
+
+  // Note that the resolvants added below contain neither x nor not(x), so the
+  // occurence lists of x and not(x) are not modified, but occurrences_ may be
+  // reallocated. This is why we iterate over them using indices.
+  int64 start_x = occurrence_start_[x.Index()];
+  int64 end_x = start_x + occurrence_size_[x.Index()];
+  int64 start_not_x = occurrence_start_[x.NegatedIndex()];
+  int64 end_not_x = start_not_x + occurrence_size_[x.NegatedIndex()];
 
   // Compute the threshold under which we don't remove x.Variable().
   int threshold = 0;
   const int clause_weight = parameters_.presolve_bve_clause_weight();
-  for (ClauseIndex i : literal_to_clauses_[x.Index()]) {
-    if (!clauses_[i].empty()) {
-      threshold += clause_weight + clauses_[i].size();
-    }
+  for (int64 k = start_x; k < end_x; ++k) {
+    const ClauseIndex i = occurrences_[k];
+    if (clause_size_[i] != 0) threshold += clause_weight + clause_size_[i];
   }
-  for (ClauseIndex i : literal_to_clauses_[x.NegatedIndex()]) {
-    if (!clauses_[i].empty()) {
-      threshold += clause_weight + clauses_[i].size();
-    }
+  for (int64 k = start_not_x; k < end_not_x; ++k) {
+    const ClauseIndex i = occurrences_[k];
+    if (clause_size_[i] != 0) threshold += clause_weight + clause_size_[i];
   }
 
   // For the BCE, we prefer s2 to be small.
-  if (s1 < s2) x = x.Negated();
+  if (s1 < s2) {
+    x = x.Negated();
+    std::swap(start_x, start_not_x);
+    std::swap(end_x, end_not_x);
+  }
 
   // Test whether we should remove the x.Variable().
   int size = 0;
-  for (ClauseIndex i : literal_to_clauses_[x.Index()]) {
-    if (clauses_[i].empty()) continue;
+  for (int64 k = start_x; k < end_x; ++k) {
+    const ClauseIndex i = occurrences_[k];
+    if (clause_size_[i] == 0) continue;
     bool no_resolvant = true;
-    for (ClauseIndex j : literal_to_clauses_[x.NegatedIndex()]) {
-      if (clauses_[j].empty()) continue;
-      const int rs = ComputeResolvantSize(x, clauses_[i], clauses_[j]);
+    for (int64 l = start_not_x; l < end_not_x; ++l) {
+      const ClauseIndex j = occurrences_[l];
+      if (clause_size_[j] == 0) continue;
+      const int rs = ComputeResolvantSize(x, Clause(i), Clause(j));
       if (rs >= 0) {
         no_resolvant = false;
         size += clause_weight + rs;
@@ -427,11 +686,13 @@ bool SatPresolver::CrossProduct(Literal x) {
   // Note that the variable priority queue will only be updated during the
   // deletion.
   std::vector<Literal> temp;
-  for (ClauseIndex i : literal_to_clauses_[x.Index()]) {
-    if (clauses_[i].empty()) continue;
-    for (ClauseIndex j : literal_to_clauses_[x.NegatedIndex()]) {
-      if (clauses_[j].empty()) continue;
-      if (ComputeResolvant(x, clauses_[i], clauses_[j], &temp)) {
+  for (int64 k = start_x; k < end_x; ++k) {
+    const ClauseIndex i = occurrences_[k];
+    if (clause_size_[i] == 0) continue;
+    for (int64 l = start_not_x; l < end_not_x; ++l) {
+      const ClauseIndex j = occurrences_[l];
+      if (clause_size_[j] == 0) continue;
+      if (ComputeResolvant(x, Clause(i), Clause(j), &temp)) {
         AddClauseInternal(&temp);
       }
     }
@@ -450,26 +711,22 @@ bool SatPresolver::CrossProduct(Literal x) {
 }
 
 void SatPresolver::Remove(ClauseIndex ci) {
-  for (Literal e : clauses_[ci]) {
+  for (Literal e : Clause(ci)) {
     literal_to_clause_sizes_[e.Index()]--;
     UpdatePriorityQueue(e.Variable());
   }
-  STLClearObject(&clauses_[ci]);
+  num_garbage_literals_ += clause_size_[ci];
+  clause_size_[ci] = 0;
 }
 
 void SatPresolver::RemoveAndRegisterForPostsolve(ClauseIndex ci, Literal x) {
-  for (Literal e : clauses_[ci]) {
-    literal_to_clause_sizes_[e.Index()]--;
-    UpdatePriorityQueue(e.Variable());
-  }
-  postsolver_->Add(x, clauses_[ci]);
-  STLClearObject(&clauses_[ci]);
+  postsolver_->Add(x, Clause(ci));
+  Remove(ci);
 }
 
-Literal SatPresolver::FindLiteralWithShortestOccurenceList(
-    const std::vector<Literal>& clause) {
-  CHECK(!clause.empty());
-  Literal result = clause.front();
+Literal SatPresolver::FindLiteralWithShortestOccurenceList(ClauseRef clause) {
+  CHECK(!clause.IsEmpty());
+  Literal result = *clause.begin();
   for (const Literal l : clause) {
     if (literal_to_clause_sizes_[l.Index()] <
         literal_to_clause_sizes_[result.Index()]) {
@@ -504,14 +761,14 @@ void SatPresolver::InitializePriorityQueue() {
 }
 
 void SatPresolver::DisplayStats(double elapsed_seconds) {
-  int num_literals = 0;
+  int64 num_literals = 0;
   int num_clauses = 0;
   int num_singleton_clauses = 0;
-  for (const std::vector<Literal>& c : clauses_) {
-    if (!c.empty()) {
-      if (c.size() == 1) ++num_singleton_clauses;
+  for (const int32 size : clause_size_) {
+    if (size != 0) {
+      if (size == 1) ++num_singleton_clauses;
       ++num_clauses;
-      num_literals += c.size();
+      num_literals += size;
     }
   }
   int num_one_side = 0;
@@ -538,21 +795,34 @@ void SatPresolver::DisplayStats(double elapsed_seconds) {
 
 bool SimplifyClause(const std::vector<Literal>& a, std::vector<Literal>* b,
                     LiteralIndex* opposite_literal) {
-  if (b->size() < a.size()) return false;
+  if (!CanSimplifyClause(ClauseRef(a.data(), a.data() + a.size()),
+                         ClauseRef(b->data(), b->data() + b->size()),
+                         opposite_literal)) {
+    return false;
+  }
+  if (*opposite_literal != LiteralIndex(-1)) {
+    b->erase(std::find(b->begin(), b->end(), Literal(*opposite_literal)));
+  }
+  return true;
+}
+
+bool CanSimplifyClause(ClauseRef a, ClauseRef b,
+                       LiteralIndex* opposite_literal) {
+  if (b.size() < a.size()) return false;
   DCHECK(std::is_sorted(a.begin(), a.end()));
-  DCHECK(std::is_sorted(b->begin(), b->end()));
+  DCHECK(std::is_sorted(b.begin(), b.end()));
 
   *opposite_literal = LiteralIndex(-1);
 
   int num_diff = 0;
-  std::vector<Literal>::const_iterator ia = a.begin();
-  std::vector<Literal>::iterator ib = b->begin();
-  std::vector<Literal>::iterator to_remove = b->begin();
+  const Literal* ia = a.begin();
+  const Literal* ib = b.begin();
+  const Literal* to_remove = b.begin();
 
   // Because we abort early when size_diff becomes negative, the second test
   // in the while loop is not needed.
-  int size_diff = b->size() - a.size();
-  while (ia != a.end() /* && ib != b->end() */) {
+  int size_diff = b.size() - a.size();
+  while (ia != a.end() /* && ib != b.end() */) {
     if (*ia == *ib) {  // Same literal.
       ++ia;
       ++ib;
@@ -572,21 +842,18 @@ bool SimplifyClause(const std::vector<Literal>& a, std::vector<Literal>* b,
       if (--size_diff < 0) return false;
     }
   }
-  if (num_diff == 1) {
-    *opposite_literal = to_remove->Index();
-    b->erase(to_remove);
-  }
+  if (num_diff == 1) *opposite_literal = to_remove->Index();
   return true;
 }
 
-bool ComputeResolvant(Literal x, const std::vector<Literal>& a,
-                      const std::vector<Literal>& b, std::vector<Literal>* out) {
+bool ComputeResolvant(Literal x, ClauseRef a, ClauseRef b,
+                      std::vector<Literal>* out) {
   DCHECK(std::is_sorted(a.begin(), a.end()));
   DCHECK(std::is_sorted(b.begin(), b.end()));
 
   out->clear();
-  std::vector<Literal>::const_iterator ia = a.begin();
-  std::vector<Literal>::const_iterator ib = b.begin();
+  const Literal* ia = a.begin();
+  const Literal* ib = b.begin();
   while ((ia != a.end()) && (ib != b.end())) {
     if (*ia == *ib) {
       out->push_back(*ia);
@@ -613,14 +880,13 @@ bool ComputeResolvant(Literal x, const std::vector<Literal>& a,
 }
 
 // Note that this function takes a big chunk of the presolve running time.
-int ComputeResolvantSize(Literal x, const std::vector<Literal>& a,
-                         const std::vector<Literal>& b) {
+int ComputeResolvantSize(Literal x, ClauseRef a, ClauseRef b) {
   DCHECK(std::is_sorted(a.begin(), a.end()));
   DCHECK(std::is_sorted(b.begin(), b.end()));
 
-  int size = static_cast<int>(a.size() + b.size()) - 2;
-  std::vector<Literal>::const_iterator ia = a.begin();
-  std::vector<Literal>::const_iterator ib = b.begin();
+  int size = a.size() + b.size() - 2;
+  const Literal* ia = a.begin();
+  const Literal* ib = b.begin();
   while ((ia != a.end()) && (ib != b.end())) {
     if (*ia == *ib) {
       --size;
@@ -772,7 +1038,7 @@ void ProbeAndFindEquivalentLiteral(
         temp.clear();
         temp.push_back(Literal(i));
         temp.push_back(Literal(rep).Negated());
-        postsolver->Add(Literal(i), temp);
+        postsolver->Add(Literal(i), ClauseRef(temp));
       }
     }
   }
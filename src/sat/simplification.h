@@ -43,7 +43,7 @@ class SatPostsolver {
   // The postsolver will process the Add() calls in reverse order. If the given
   // clause has all its literals at false, it simply sets the literal x to true.
   // Note that x must be a literal of the given clause.
-  void Add(Literal x, const std::vector<Literal>& clause);
+  void Add(Literal x, ClauseRef clause);
 
   // Tells the postsolver that the given literal must be true in any solution.
   // We currently check that the variable is not already fixed.
@@ -66,9 +66,20 @@ class SatPostsolver {
   std::vector<bool> ExtractAndPostsolveSolution(const SatSolver& solver);
   std::vector<bool> PostsolveSolution(const std::vector<bool>& solution);
 
+  // Increases the number of variables of the current problem. The new
+  // variables are mapped to new variables of the initial problem. This is
+  // used when the postsolver follows a problem that can grow, like the one of
+  // the SatSolver inprocessing.
+  void IncreaseNumVariablesTo(int num_variables);
+
+  // Completes in place an assignment of the initial problem: the unassigned
+  // variables are set to true, and then the Add() calls are processed in
+  // reverse order so that all the registered clauses are satisfied. Note that
+  // this only changes the value of the literals given to Add().
+  void Postsolve(VariablesAssignment* assignment) const;
+
  private:
   Literal ApplyReverseMapping(Literal l);
-  void Postsolve(VariablesAssignment* assignment) const;
 
   // Stores the arguments of the Add() calls: clauses_start_[i] is the index of
   // the first literal of the clause #i in the clauses_literals_ deque.
@@ -108,7 +119,11 @@ class SatPresolver {
   typedef int32 ClauseIndex;
 
   explicit SatPresolver(SatPostsolver* postsolver)
-      : postsolver_(postsolver), num_trivial_clauses_(0) {}
+      : num_garbage_literals_(0),
+        num_garbage_occurrences_(0),
+        occurrence_lists_are_valid_(false),
+        postsolver_(postsolver),
+        num_trivial_clauses_(0) {}
   void SetParameters(const SatParameters& params) { parameters_ = params; }
 
   // Registers a mapping to encode equivalent literals.
@@ -131,8 +146,13 @@ class SatPresolver {
 
   // All the clauses managed by this class.
   // Note that deleted clauses keep their indices (they are just empty).
-  int NumClauses() const { return clauses_.size(); }
-  const std::vector<Literal>& Clause(ClauseIndex ci) const { return clauses_[ci]; }
+  // The returned ClauseRef is only valid until the next modification of the
+  // clause database.
+  int NumClauses() const { return clause_start_.size(); }
+  ClauseRef Clause(ClauseIndex ci) const {
+    const Literal* const start = clause_literals_.data() + clause_start_[ci];
+    return ClauseRef(start, start + clause_size_[ci]);
+  }
 
   // The number of variables. This is computed automatically from the clauses
   // added to the SatPresolver.
@@ -172,6 +192,12 @@ class SatPresolver {
   // after this call.
   void AddClauseInternal(std::vector<Literal>* clause);
 
+  // Returns true if the clause a can be used to simplify the clause b, see
+  // SimplifyClause(). In the self-subsuming resolution case, the opposite
+  // literal is removed from b but b is not removed from its occurence list.
+  bool SimplifyClauseWith(ClauseIndex a, ClauseIndex b,
+                          LiteralIndex* opposite_literal);
+
   // Clause removal function.
   void Remove(ClauseIndex ci);
   void RemoveAndRegisterForPostsolve(ClauseIndex ci, Literal x);
@@ -183,9 +209,28 @@ class SatPresolver {
   // the problem is shown to be UNSAT.
   bool ProcessAllClauses();
 
+  // Same as ProcessAllClauses() for the clauses currently in
+  // clause_to_process_, except that the possible simplifications are first
+  // detected on num_threads threads, all on the current clause database, and
+  // then applied in clause order. The strengthened clauses are added back to
+  // clause_to_process_. Returns false if the problem is shown to be UNSAT.
+  bool ProcessAllClausesInParallel(int num_threads);
+
+  // Occurence lists handling. The lists of the literals of a clause added by
+  // AddClause() are only updated by RebuildOccurrenceListsIfNeeded(), which
+  // must be called before they are used.
+  void AddToOccurrenceList(LiteralIndex l, ClauseIndex ci);
+  void RemoveFromOccurrenceList(LiteralIndex l, ClauseIndex ci);
+  void RebuildOccurrenceListsIfNeeded();
+
+  // Reclaims the space used by the literals of the removed clauses if it
+  // represents more than half of clause_literals_. Note that this invalidates
+  // all the ClauseRef returned by Clause().
+  void CompactClausesIfNeeded();
+
   // Finds the literal from the clause that occur the less in the clause
   // database.
-  Literal FindLiteralWithShortestOccurenceList(const std::vector<Literal>& clause);
+  Literal FindLiteralWithShortestOccurenceList(ClauseRef clause);
 
   // Display some statistics on the current clause database.
   void DisplayStats(double elapsed_seconds);
@@ -216,17 +261,40 @@ class SatPresolver {
   AdjustablePriorityQueue<PQElement> var_pq_;
 
   // List of clauses on which we need to call ProcessClauseToSimplifyOthers().
-  // See ProcessAllClauses().
+  // See ProcessAllClauses() which uses it as a FIFO queue.
   std::vector<bool> in_clause_to_process_;
-  std::deque<ClauseIndex> clause_to_process_;
-
-  // The set of all clauses.
-  // An empty clause means that it has been removed.
-  std::vector<std::vector<Literal>> clauses_;  // Indexed by ClauseIndex
-
-  // Occurence list. For each literal, contains the ClauseIndex of the clause
-  // that contains it (ordered by clause index).
-  ITIVector<LiteralIndex, std::vector<ClauseIndex>> literal_to_clauses_;
+  std::vector<ClauseIndex> clause_to_process_;
+
+  // The set of all clauses. They are stored contiguously in clause_literals_
+  // to avoid one allocation per clause: the clause ci is made of the
+  // clause_size_[ci] literals starting at clause_start_[ci]. An empty clause
+  // means that it has been removed. The literals of the removed clauses and the
+  // ones removed by self-subsuming resolution are garbage that is reclaimed by
+  // CompactClausesIfNeeded().
+  std::vector<Literal> clause_literals_;
+  std::vector<int64> clause_start_;  // Indexed by ClauseIndex
+  std::vector<int32> clause_size_;   // Indexed by ClauseIndex
+  int64 num_garbage_literals_;
+
+  // A 64 bits signature of the variables of each clause. A clause can only
+  // simplify another one if its signature is included in the other signature.
+  // The signatures of the clauses added by AddClause() are computed by
+  // RebuildOccurrenceListsIfNeeded().
+  std::vector<uint64> clause_signature_;  // Indexed by ClauseIndex
+
+  // Occurence lists. For each literal l, the occurrence_size_[l] entries of
+  // occurrences_ starting at occurrence_start_[l] are the ClauseIndex of the
+  // clauses that contains it (ordered by clause index). A list that needs to
+  // grow past its capacity is moved at the end of occurrences_, and all the
+  // lists are rebuilt in one pass when the garbage left this way becomes too
+  // large. Note that only indices into occurrences_ stay valid when a clause is
+  // added.
+  std::vector<ClauseIndex> occurrences_;
+  ITIVector<LiteralIndex, int64> occurrence_start_;
+  ITIVector<LiteralIndex, int32> occurrence_size_;
+  ITIVector<LiteralIndex, int32> occurrence_capacity_;
+  int64 num_garbage_occurrences_;
+  bool occurrence_lists_are_valid_;
 
   // Because we only lazily clean the occurence list after clause deletions,
   // we keep the size of the occurence list (without the deleted clause) here.
@@ -254,6 +322,10 @@ class SatPresolver {
 bool SimplifyClause(const std::vector<Literal>& a, std::vector<Literal>* b,
                     LiteralIndex* opposite_literal);
 
+// Same as SimplifyClause() except that b is not modified.
+bool CanSimplifyClause(ClauseRef a, ClauseRef b,
+                       LiteralIndex* opposite_literal);
+
 // Visible for testing. Computes the resolvant of 'a' and 'b' obtained by
 // performing the resolution on 'x'. If the resolvant is trivially true this
 // returns false, otherwise it returns true and fill 'out' with the resolvant.
@@ -264,13 +336,12 @@ bool SimplifyClause(const std::vector<Literal>& a, std::vector<Literal>* b,
 //
 // This is the basic operation when a variable is eliminated by clause
 // distribution.
-bool ComputeResolvant(Literal x, const std::vector<Literal>& a,
-                      const std::vector<Literal>& b, std::vector<Literal>* out);
+bool ComputeResolvant(Literal x, ClauseRef a, ClauseRef b,
+                      std::vector<Literal>* out);
 
 // Same as ComputeResolvant() but just returns the resolvant size.
 // Returns -1 when ComputeResolvant() returns false.
-int ComputeResolvantSize(Literal x, const std::vector<Literal>& a,
-                         const std::vector<Literal>& b);
+int ComputeResolvantSize(Literal x, ClauseRef a, ClauseRef b);
 
 // Presolver that does literals probing and finds equivalent literals by
 // computing the strongly connected components of the graph:
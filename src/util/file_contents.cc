@@ -0,0 +1,101 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/file_contents.h"
+
+#include <errno.h>
+#include <string.h>
+#include <memory>
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "base/join.h"
+#include "base/strutil.h"
+#include "zlib.h"
+
+namespace operations_research {
+
+FileContents::~FileContents() {
+#if !defined(_MSC_VER)
+  if (mapped_data_ != nullptr) munmap(mapped_data_, mapped_size_);
+#endif
+}
+
+bool FileContents::Open(const std::string& file_name) {
+  if (!HasSuffixString(file_name, ".gz")) {
+    if (Map(file_name)) return true;
+
+    // There is no point in trying zlib if the file can not even be opened.
+    if (!error_message_.empty()) return false;
+  }
+  return ReadThroughZlib(file_name);
+}
+
+bool FileContents::Map(const std::string& file_name) {
+#if defined(_MSC_VER)
+  return false;
+#else
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    error_message_ = StrCat(file_name, ": ", strerror(errno));
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  void* const data =
+      mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) return false;
+  mapped_data_ = data;
+  mapped_size_ = file_stat.st_size;
+  return true;
+#endif
+}
+
+bool FileContents::ReadThroughZlib(const std::string& file_name) {
+  errno = 0;
+  gzFile file = gzopen(file_name.c_str(), "rb");
+  if (file == nullptr) {
+    // gzopen() leaves errno to zero if it could not allocate its state.
+    error_message_ = StrCat(file_name, ": ",
+                            errno != 0 ? strerror(errno) : "out of memory");
+    return false;
+  }
+  const int kBufferSize = 1 << 20;
+  std::unique_ptr<char[]> block(new char[kBufferSize]);
+  int num_read = 0;
+  while ((num_read = gzread(file, block.get(), kBufferSize)) > 0) {
+    buffer_.append(block.get(), num_read);
+  }
+  // A truncated file is only reported through gzerror(), gzread() returns 0
+  // at its end as for a complete file.
+  int error_code = Z_OK;
+  const char* const error = gzerror(file, &error_code);
+  if (error_code != Z_OK) {
+    // The zlib messages already start with the file name.
+    error_message_ = error_code == Z_ERRNO
+                         ? StrCat(file_name, ": ", strerror(errno))
+                         : std::string(error);
+  }
+  gzclose(file);
+  return error_code == Z_OK;
+}
+
+}  // namespace operations_research
@@ -0,0 +1,70 @@
+// Copyright 2010-2014 Google
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Read-only access to the whole contents of a file, for the parsers of large
+// input files (MPS, cnf, opb, ...) that want to scan raw characters instead of
+// building a std::string per line.
+
+#ifndef OR_TOOLS_UTIL_FILE_CONTENTS_H_
+#define OR_TOOLS_UTIL_FILE_CONTENTS_H_
+
+#include <stddef.h>
+#include <string>
+
+#include "base/macros.h"
+
+namespace operations_research {
+
+// The contents of a file, memory-mapped when possible. Otherwise, and for
+// ".gz" files, the file is read through zlib, which also transparently reads
+// uncompressed files. Note that a ".gz" file is entirely decompressed into
+// memory, so it needs as much memory as its uncompressed size.
+//
+// Usage:
+//   FileContents contents;
+//   if (!contents.Open(filename)) ...
+//   for (const char* c = contents.begin(); c < contents.end(); ++c) ...
+class FileContents {
+ public:
+  FileContents()
+      : mapped_data_(nullptr), mapped_size_(0), buffer_(), error_message_() {}
+  ~FileContents();
+
+  // Returns false if the file could not be read, in which case
+  // error_message() tells why. Must be called only once.
+  bool Open(const std::string& file_name);
+  const std::string& error_message() const { return error_message_; }
+
+  const char* begin() const {
+    return mapped_data_ != nullptr ? static_cast<const char*>(mapped_data_)
+                                   : buffer_.data();
+  }
+  const char* end() const {
+    return begin() + (mapped_data_ != nullptr ? mapped_size_ : buffer_.size());
+  }
+
+ private:
+  bool Map(const std::string& file_name);
+  bool ReadThroughZlib(const std::string& file_name);
+
+  void* mapped_data_;
+  size_t mapped_size_;
+  std::string buffer_;
+  std::string error_message_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileContents);
+};
+
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_UTIL_FILE_CONTENTS_H_